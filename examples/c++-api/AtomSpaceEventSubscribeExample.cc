@@ -32,10 +32,12 @@ int main(int argc, char ** args)
     AtomSpace as;
     AttentionBank& bank(attentionbank(&as));
 
-    boost::signals2::connection AtomAddedSignalConn,
-                                AVChangedSignalConn,
-                                TVChangedSignalConn,
-                                AtomsRemovedSignalConn,
+    // The AtomSpace signals return a lightweight SignalConnection;
+    // the AttentionBank signals are still boost::signals2 signals.
+    SignalConnection AtomAddedSignalConn,
+                     TVChangedSignalConn,
+                     AtomsRemovedSignalConn;
+    boost::signals2::connection AVChangedSignalConn,
                                 AtomAddedToAttentionalFocusSignalConn,
                                 AtomRemovedFromAttentionalFocusSignalConn;
 
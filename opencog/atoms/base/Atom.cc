@@ -24,6 +24,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <set>
 #include <sstream>
 
@@ -31,6 +32,7 @@
 #include <unistd.h>
 #endif
 
+#include <opencog/util/exceptions.h>
 #include <opencog/util/misc.h>
 #include <opencog/util/platform.h>
 
@@ -107,35 +109,57 @@ static const Handle& truth_key(void)
 	return tk;
 }
 
-void Atom::setTruthValue(const TruthValuePtr& newTV)
+// Keys are compared by content, not by address, just as the
+// std::map that used to hold the values did. That is, a key created
+// outside of any atomspace still matches the same key inside of one.
+static inline bool same_key(const Handle& a, const Handle& b)
 {
-    if (nullptr == newTV) return;
+	if (a == b) return true;
+	if (nullptr == a or nullptr == b) return false;
+	if (a->get_hash() != b->get_hash()) return false;
+	return *a == *b;
+}
+
+// The slot holds a null pointer, not DEFAULT_TV, for the default
+// truth value, so that getKeys() does not report the truth key for
+// atoms that never had a truth value of their own.
+static inline TruthValuePtr tv_slot(const TruthValuePtr& tv)
+{
+    if (nullptr == tv or tv->isDefaultTV()) return nullptr;
+    return tv;
+}
+
+void Atom::setTruthValue(const TruthValuePtr& tv)
+{
+    if (nullptr == tv) return;
+    TruthValuePtr newTV(tv->isDefaultTV() ? TruthValue::DEFAULT_TV() : tv);
 
     // We need to guarantee that the signal goes out with the
     // correct truth value.  That is, another setter could be changing
-    // this, even as we are.  So make a copy, first.
-    TruthValuePtr oldTV(getTruthValue());
+    // this, even as we are.  The atomic exchange hands back exactly
+    // the value that we replaced.
+    TruthValuePtr oldTV(std::atomic_exchange(&_truth_value, tv_slot(newTV)));
+    if (nullptr == oldTV) oldTV = TruthValue::DEFAULT_TV();
 
     // If both old and new are e.g. DEFAULT_TV, then do nothing.
     if (oldTV.get() == newTV.get()) return;
 
-    // ... and we still need to make sure that only one thread is
-    // writing this at a time. std:shared_ptr is NOT thread-safe against
-    // multiple writers: see "Example 5" in
-    // http://www.boost.org/doc/libs/1_53_0/libs/smart_ptr/shared_ptr.htm#ThreadSafety
-    setValue (truth_key(), ProtoAtomCast(newTV));
-
     if (_atom_space != nullptr) {
         TVCHSigl& tvch = _atom_space->_atom_table.TVChangedSignal();
-        tvch(get_handle(), oldTV, newTV);
+        if (not tvch.empty())
+            tvch(get_handle(), oldTV, newTV);
     }
 }
 
 TruthValuePtr Atom::getTruthValue() const
 {
-    ProtoAtomPtr pap(getValue(truth_key()));
-    if (nullptr == pap) return TruthValue::DEFAULT_TV();
-    return TruthValueCast(pap);
+    // std::shared_ptr is NOT thread-safe against a simultaneous
+    // reader and writer: see "Example 5" in
+    // http://www.boost.org/doc/libs/1_53_0/libs/smart_ptr/shared_ptr.htm#ThreadSafety
+    // The atomic load makes a safe copy, without taking _mtx.
+    TruthValuePtr tv(std::atomic_load(&_truth_value));
+    if (nullptr == tv) return TruthValue::DEFAULT_TV();
+    return tv;
 }
 
 // ==============================================================
@@ -143,21 +167,47 @@ TruthValuePtr Atom::getTruthValue() const
 /// If the value is a null pointer, then the key is removed.
 void Atom::setValue(const Handle& key, const ProtoAtomPtr& value)
 {
-	std::lock_guard<std::mutex> lck(_mtx);
-	if (nullptr != value)
+	// The truth value lives in its own slot, and only a truth value
+	// can go there.
+	if (same_key(key, truth_key()))
 	{
-		_values[key] = value;
+		TruthValuePtr tv(TruthValueCast(value));
+		if (nullptr != value and nullptr == tv)
+			throw InvalidParamException(TRACE_INFO,
+				"Only a TruthValue can be stored at the truth value key; got %s",
+				value->to_string().c_str());
+		std::atomic_store(&_truth_value, tv_slot(tv));
+		return;
 	}
-	else
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	for (auto it = _values.begin(); it != _values.end(); it++)
 	{
+		if (not same_key(it->first, key)) continue;
+
+		if (nullptr != value)
+		{
+			it->second = value;
+			return;
+		}
+
 		// If the value is a null pointer, then the value at
-		// this key should be blanked out, i.e. unset.
-		_values.erase(key);
+		// this key should be blanked out, i.e. unset. The order
+		// of the values does not matter; move the last one here.
+		*it = std::move(_values.back());
+		_values.pop_back();
+		return;
 	}
+
+	if (nullptr != value)
+		_values.emplace_back(key, value);
 }
 
 ProtoAtomPtr Atom::getValue(const Handle& key) const
 {
+    if (same_key(key, truth_key()))
+        return ProtoAtomCast(std::atomic_load(&_truth_value));
+
     // OK. The atomic thread-safety of shared-pointers is subtle. See
     // http://www.boost.org/doc/libs/1_53_0/libs/smart_ptr/shared_ptr.htm#ThreadSafety
     // and http://cppwisdom.quora.com/shared_ptr-is-almost-thread-safe
@@ -171,14 +221,21 @@ ProtoAtomPtr Atom::getValue(const Handle& key) const
 
     ProtoAtomPtr pap;
     std::lock_guard<std::mutex> lck(_mtx);
-    auto pr = _values.find(key);
-    if (_values.end() != pr) pap = pr->second;
+    for (const auto& pr : _values)
+    {
+        if (not same_key(pr.first, key)) continue;
+        pap = pr.second;
+        break;
+    }
     return pap;
 }
 
 HandleSet Atom::getKeys() const
 {
     HandleSet keyset;
+    if (nullptr != std::atomic_load(&_truth_value))
+        keyset.insert(truth_key());
+
     std::lock_guard<std::mutex> lck(_mtx);
     for (const auto& pr : _values)
         keyset.insert(pr.first);
@@ -289,25 +346,153 @@ void Atom::drop_incoming_set()
 {
     if (nullptr == _incoming_set) return;
     std::lock_guard<std::mutex> lck (_mtx);
-    _incoming_set->_iset.clear();
+    _incoming_set->_buckets.clear();
     _incoming_set = nullptr;
 }
 
+// ==============================================================
+// The incoming-set hash tables.
+
+// Fibonacci hashing of the link address. The low bits of a heap
+// address are always zero, so they are shifted out first.
+static inline size_t slot_hash(uintptr_t key, size_t mask)
+{
+    uint64_t h = ((uint64_t) (key >> 4)) * 0x9E3779B97F4A7C15ULL;
+    return ((size_t) (h ^ (h >> 32))) & mask;
+}
+
+/// Rebuild the table with `cap` slots, dropping the tombstones and
+/// any links that have died without being removed.
+void Atom::InSet::Bucket::rehash(size_t cap)
+{
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.resize(cap);
+    live = 0;
+    used = 0;
+
+    size_t mask = cap - 1;
+    for (Slot& s : old)
+    {
+        if (TOMBSTONE >= s.key or s.link.expired()) continue;
+        size_t i = slot_hash(s.key, mask);
+        while (EMPTY != slots[i].key) i = (i + 1) & mask;
+        slots[i].key = s.key;
+        slots[i].link = std::move(s.link);
+        live++;
+        used++;
+    }
+}
+
+void Atom::InSet::Bucket::insert(const LinkPtr& l)
+{
+    // Keep the load, including tombstones, at or below 3/4, so that
+    // there is always an empty slot to stop the probing.
+    if (4 * (used + 1) > 3 * slots.size())
+    {
+        size_t cap = slots.size() ? slots.size() : 2;
+        while (2 * (live + 1) > cap) cap *= 2;
+        rehash(cap);
+    }
+
+    uintptr_t key = (uintptr_t) l.get();
+    size_t mask = slots.size() - 1;
+    size_t i = slot_hash(key, mask);
+    Slot* tomb = nullptr;
+    while (EMPTY != slots[i].key)
+    {
+        if (key == slots[i].key)
+        {
+            // Already here. The address might belong to a dead link
+            // that was never removed; if so, take over its slot.
+            if (slots[i].link.expired()) slots[i].link = l;
+            return;
+        }
+        if (TOMBSTONE == slots[i].key and nullptr == tomb)
+            tomb = &slots[i];
+        i = (i + 1) & mask;
+    }
+
+    live++;
+    if (tomb)
+    {
+        tomb->key = key;
+        tomb->link = l;
+        return;
+    }
+    slots[i].key = key;
+    slots[i].link = l;
+    used++;
+}
+
+bool Atom::InSet::Bucket::remove(const Link* l)
+{
+    if (0 == live) return false;
+
+    uintptr_t key = (uintptr_t) l;
+    size_t mask = slots.size() - 1;
+    size_t i = slot_hash(key, mask);
+    while (EMPTY != slots[i].key)
+    {
+        if (key == slots[i].key)
+        {
+            slots[i].key = TOMBSTONE;
+            slots[i].link.reset();
+            live--;
+
+            // Give back memory once the table is mostly empty.
+            if (8 < slots.size() and 8 * live < slots.size())
+                rehash(slots.size() / 4);
+            return true;
+        }
+        i = (i + 1) & mask;
+    }
+    return false;
+}
+
+const Atom::InSet::Bucket* Atom::InSet::find(Type t) const
+{
+    auto it = std::lower_bound(_buckets.begin(), _buckets.end(), t,
+        [](const Bucket& b, Type t) { return b.type < t; });
+    if (it == _buckets.end() or it->type != t) return nullptr;
+    return &(*it);
+}
+
+/// Return the bucket for type t, creating it if needed.
+Atom::InSet::Bucket& Atom::InSet::get(Type t)
+{
+    auto it = std::lower_bound(_buckets.begin(), _buckets.end(), t,
+        [](const Bucket& b, Type t) { return b.type < t; });
+    if (it != _buckets.end() and it->type == t) return *it;
+    return *_buckets.emplace(it, t);
+}
+
+void Atom::InSet::remove(const LinkPtr& l)
+{
+    Type t = l->get_type();
+    auto it = std::lower_bound(_buckets.begin(), _buckets.end(), t,
+        [](const Bucket& b, Type t) { return b.type < t; });
+    if (it == _buckets.end() or it->type != t) return;
+    it->remove(l.get());
+    if (0 == it->live) _buckets.erase(it);
+}
+
+size_t Atom::InSet::size(void) const
+{
+    size_t cnt = 0;
+    for (const Bucket& b : _buckets) cnt += b.live;
+    return cnt;
+}
+
+// ==============================================================
+
 /// Add an atom to the incoming set.
 void Atom::insert_atom(const LinkPtr& a)
 {
     if (nullptr == _incoming_set) return;
     std::lock_guard<std::mutex> lck (_mtx);
 
-    Type at = a->get_type();
-    auto bucket = _incoming_set->_iset.find(at);
-    if (bucket == _incoming_set->_iset.end())
-    {
-        auto pr = _incoming_set->_iset.emplace(
-                   std::make_pair(at, WincomingSet()));
-        bucket = pr.first;
-    }
-    bucket->second.insert(a);
+    _incoming_set->get(a->get_type()).insert(a);
 
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_addAtomSignal(shared_from_this(), a);
@@ -322,9 +507,7 @@ void Atom::remove_atom(const LinkPtr& a)
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_removeAtomSignal(shared_from_this(), a);
 #endif /* INCOMING_SET_SIGNALS */
-    Type at = a->get_type();
-    auto bucket = _incoming_set->_iset.find(at);
-    bucket->second.erase(a);
+    _incoming_set->remove(a);
 }
 
 /// Remove old, and add new, atomically, so that every user
@@ -338,19 +521,8 @@ void Atom::swap_atom(const LinkPtr& old, const LinkPtr& neu)
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_removeAtomSignal(shared_from_this(), old);
 #endif /* INCOMING_SET_SIGNALS */
-    Type ot = old->get_type();
-    auto bucket = _incoming_set->_iset.find(ot);
-    bucket->second.erase(old);
-
-    Type nt = neu->get_type();
-    bucket = _incoming_set->_iset.find(nt);
-    if (bucket == _incoming_set->_iset.end())
-    {
-        auto pr = _incoming_set->_iset.emplace(
-                   std::make_pair(nt, WincomingSet()));
-        bucket = pr.first;
-    }
-    bucket->second.insert(neu);
+    _incoming_set->remove(old);
+    _incoming_set->get(neu->get_type()).insert(neu);
 
 #ifdef INCOMING_SET_SIGNALS
     _incoming_set->_addAtomSignal(shared_from_this(), neu);
@@ -361,11 +533,16 @@ size_t Atom::getIncomingSetSize() const
 {
     if (nullptr == _incoming_set) return 0;
     std::lock_guard<std::mutex> lck (_mtx);
+    return _incoming_set->size();
+}
 
-    size_t cnt = 0;
-    for (const auto pr : _incoming_set->_iset)
-        cnt += pr.second.size();
-    return cnt;
+size_t Atom::getIncomingSetSizeByType(Type type) const
+{
+    if (nullptr == _incoming_set) return 0;
+    std::lock_guard<std::mutex> lck (_mtx);
+    const InSet::Bucket* bucket = _incoming_set->find(type);
+    if (nullptr == bucket) return 0;
+    return bucket->live;
 }
 
 // We return a copy here, and not a reference, because the set itself
@@ -382,14 +559,14 @@ IncomingSet Atom::getIncomingSet(AtomSpace* as) const
         // Prevent update of set while a copy is being made.
         std::lock_guard<std::mutex> lck (_mtx);
         IncomingSet iset;
-        for (const auto bucket : _incoming_set->_iset)
+        iset.reserve(_incoming_set->size());
+        for (const InSet::Bucket& bucket : _incoming_set->_buckets)
         {
-            for (const WinkPtr& w : bucket.second)
-            {
+            bucket.foreach([&](const WinkPtr& w) {
                 LinkPtr l(w.lock());
                 if (l and atab->in_environ(l))
                     iset.emplace_back(l);
-            }
+            });
         }
         return iset;
     }
@@ -397,13 +574,13 @@ IncomingSet Atom::getIncomingSet(AtomSpace* as) const
     // Prevent update of set while a copy is being made.
     std::lock_guard<std::mutex> lck (_mtx);
     IncomingSet iset;
-    for (const auto bucket : _incoming_set->_iset)
+    iset.reserve(_incoming_set->size());
+    for (const InSet::Bucket& bucket : _incoming_set->_buckets)
     {
-        for (const WinkPtr& w : bucket.second)
-        {
+        bucket.foreach([&](const WinkPtr& w) {
             LinkPtr l(w.lock());
             if (l) iset.emplace_back(l);
-        }
+        });
     }
     return iset;
 }
@@ -419,14 +596,14 @@ IncomingSet Atom::getIncomingSetByType(Type type) const
     if (nullptr == _incoming_set) return result;
     std::lock_guard<std::mutex> lck(_mtx);
 
-    const auto bucket = _incoming_set->_iset.find(type);
-    if (bucket == _incoming_set->_iset.cend()) return result;
+    const InSet::Bucket* bucket = _incoming_set->find(type);
+    if (nullptr == bucket) return result;
 
-    for (const WinkPtr& w : bucket->second)
-    {
+    result.reserve(bucket->live);
+    bucket->foreach([&](const WinkPtr& w) {
         LinkPtr h(w.lock());
         if (h) result.emplace_back(h);
-    }
+    });
     return result;
 }
 
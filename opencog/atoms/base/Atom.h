@@ -27,11 +27,14 @@
 #ifndef _OPENCOG_ATOM_H
 #define _OPENCOG_ATOM_H
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <boost/signals2.hpp>
 
@@ -108,6 +111,7 @@ class Atom
     friend class AtomTable;       // Needs to call MarkedForRemoval()
     friend class AtomSpace;       // Needs to call getAtomTable()
     friend class DeleteLink;      // Needs to call getAtomTable()
+    friend class FixedIntegerIndex; // Needs to set _index_slot
     friend class ProtocolBufferSerializer; // Needs to de/ser-ialize an Atom
 
     //! Sets the AtomSpace in which this Atom is inserted.
@@ -127,8 +131,21 @@ protected:
 
     AtomSpace *_atom_space;
 
-    /// All of the values on the atom, including the TV.
-    mutable std::map<const Handle, ProtoAtomPtr> _values;
+    /// Position of this atom in the AtomTable type index. Guarded
+    /// by the type index lock for this atom's type.
+    size_t _index_slot;
+
+    /// The truth value gets its own slot, since it is read far more
+    /// often than any other value.  It is only ever accessed with
+    /// std::atomic_load() and std::atomic_store(), so that readers
+    /// do not need the per-atom lock.  Null means DEFAULT_TV.
+    TruthValuePtr _truth_value;
+
+    /// All of the other values on the atom.  Almost all atoms have
+    /// zero, one or two of these, so a flat vector, searched linearly,
+    /// is smaller and faster than a std::map. Guarded by _mtx.
+    typedef std::vector<std::pair<Handle, ProtoAtomPtr>> ValueSeq;
+    mutable ValueSeq _values;
 
     // Lock, used to serialize changes.
     // This costs 40 bytes per atom.  Tried using a single, global lock,
@@ -150,15 +167,16 @@ protected:
       : ProtoAtom(t),
         _flags(0),
         _content_hash(Handle::INVALID_HASH),
-        _atom_space(nullptr)
+        _atom_space(nullptr),
+        _index_slot(0)
     {}
 
     // The incoming set is not tracked by the garbage collector;
     // this is required, in order to avoid cyclic references.
     // That is, we use weak pointers here, not strong ones.
-    // std::set<ptr> uses 48 bytes (per atom).  See the README file
-    // in this directory for a slightly longer explanation for why
-    // weak pointers are needed, and why bdwgc cannot be used.
+    // See the README file in this directory for a slightly longer
+    // explanation for why weak pointers are needed, and why bdwgc
+    // cannot be used.
     struct InSet
     {
         // We want five things:
@@ -171,15 +189,62 @@ protected:
         //    arguably a bug, though.
         //
         // In order to get b), we have to store atoms in buckets, each
-        // bucket holding only one type.  To satisfy d), the buckets
-        // need to be either hash tables or rb-trees. Scanning for
-        // uniqueness in a vector is prohibitavely slow.  Note that
-        // incoming sets containing 10K atoms are not unusual, and can
-        // be the source of bottlnecks.  Note that an atomspace can
-        // contain a hundred-million atoms, so the solution has to be
-        // small. This rules out using using a vector to store the
-        // buckets (I tried).
-        std::map<Type, WincomingSet> _iset;
+        // bucket holding only one type.  To satisfy d) and e), each
+        // bucket is a small open-addressed hash table, keyed on the
+        // address of the link. Scanning for uniqueness in a vector is
+        // prohibitavely slow; incoming sets containing 10K atoms are
+        // not unusual, and hubs can have millions. An rb-tree costs a
+        // separate heap node (64 bytes or more) per incoming link;
+        // the hash table costs one 24-byte slot in a flat array, and
+        // iterating over it does not chase pointers.
+        //
+        // Removing a link leaves a tombstone behind.  Tombstones, and
+        // any links that died without being removed, are swept out
+        // the next time that the table is rehashed.  Most atoms have
+        // incoming links of only one or two types, so the buckets
+        // themselves are kept in a small vector, sorted by type.
+        enum : uintptr_t { EMPTY = 0, TOMBSTONE = 1 };
+        struct Slot
+        {
+            uintptr_t key;   // EMPTY, TOMBSTONE, or the Link address.
+            WinkPtr link;
+            Slot(void) : key(EMPTY) {}
+        };
+
+        struct Bucket
+        {
+            Type type;
+            size_t live;     // Number of links held.
+            size_t used;     // Live links plus tombstones.
+            std::vector<Slot> slots;  // Size is zero or a power of two.
+
+            Bucket(Type t) : type(t), live(0), used(0) {}
+            void insert(const LinkPtr&);
+            bool remove(const Link*);
+            void rehash(size_t);
+
+            template <typename Func>
+            void foreach(Func func) const
+            {
+                for (const Slot& s : slots)
+                    if (TOMBSTONE < s.key) func(s.link);
+            }
+
+            // As above, but stop as soon as func returns true.
+            template <typename Func>
+            bool foreach_until(Func func) const
+            {
+                for (const Slot& s : slots)
+                    if (TOMBSTONE < s.key and func(s.link)) return true;
+                return false;
+            }
+        };
+        std::vector<Bucket> _buckets;
+
+        const Bucket* find(Type) const;
+        Bucket& get(Type);
+        void remove(const LinkPtr&);
+        size_t size(void) const;
 
 #ifdef INCOMING_SET_SIGNALS
         // Some people want to know if the incoming set has changed...
@@ -268,12 +333,14 @@ public:
     //! Sets the TruthValue object of the atom.
     void setTruthValue(const TruthValuePtr&);
 
-    /// Associate `value` to `key` for this atom.
+    /// Associate `value` to `key` for this atom. The truth value key
+    /// only accepts a TruthValue; anything else throws.
     void setValue(const Handle& key, const ProtoAtomPtr& value);
     /// Get value at `key` for this atom.
     ProtoAtomPtr getValue(const Handle& key) const;
 
-    /// Get the set of all keys in use for this Atom.
+    /// Get the set of all keys in use for this Atom. The truth value
+    /// key is included only if the truth value is not the default.
     HandleSet getKeys() const;
 
     /// Copy all the values from the other atom to this one.
@@ -285,6 +352,9 @@ public:
     //! Get the size of the incoming set.
     size_t getIncomingSetSize() const;
 
+    //! Get the number of links of the given type in the incoming set.
+    size_t getIncomingSetSizeByType(Type) const;
+
     //! Return the incoming set of this atom.
     //! If the AtomSpace pointer is non-null, then only those atoms
     //! that belonged to that atomspace at the time this call was made
@@ -308,13 +378,12 @@ public:
     {
         if (nullptr == _incoming_set) return result;
         std::lock_guard<std::mutex> lck(_mtx);
-        for (const auto bucket : _incoming_set->_iset)
+        for (const InSet::Bucket& bucket : _incoming_set->_buckets)
         {
-            for (const WinkPtr& w : bucket.second)
-            {
+            bucket.foreach([&](const WinkPtr& w) {
                 Handle h(w.lock());
                 if (h) { *result = h; result ++; }
-            }
+            });
         }
         return result;
     }
@@ -349,14 +418,37 @@ public:
         if (nullptr == _incoming_set) return result;
         std::lock_guard<std::mutex> lck(_mtx);
 
-        const auto bucket = _incoming_set->_iset.find(type);
-        if (bucket == _incoming_set->_iset.cend()) return result;
+        const InSet::Bucket* bucket = _incoming_set->find(type);
+        if (nullptr == bucket) return result;
 
-        for (const WinkPtr& w : bucket->second)
-        {
+        bucket->foreach([&](const WinkPtr& w) {
             Handle h(w.lock());
             if (h) { *result = h; result ++; }
-        }
+        });
+        return result;
+    }
+
+    /**
+     * As above, but return no more than `max` atoms, without looking
+     * at the rest of the incoming set. The atoms come in no particular
+     * order; since the buckets are hashed on the address of the link,
+     * they are as good as a random sample.
+     */
+    template <typename OutputIterator> OutputIterator
+    getIncomingSetByType(OutputIterator result, Type type, size_t max) const
+    {
+        if (0 == max or nullptr == _incoming_set) return result;
+        std::lock_guard<std::mutex> lck(_mtx);
+
+        const InSet::Bucket* bucket = _incoming_set->find(type);
+        if (nullptr == bucket) return result;
+
+        size_t n = 0;
+        bucket->foreach_until([&](const WinkPtr& w) -> bool {
+            Handle h(w.lock());
+            if (h) { *result = h; result ++; n++; }
+            return max <= n;
+        });
         return result;
     }
 
@@ -0,0 +1,172 @@
+/*
+ * opencog/atoms/base/AtomHash.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_ATOM_HASH_H
+#define _OPENCOG_ATOM_HASH_H
+
+#include <cstdint>
+#include <cstring>
+
+// Uncomment this (or build with -DLEGACY_ATOM_HASH) to go back to the
+// original std::hash and shift-add content hashes.  The hashes are not
+// stored anywhere, so switching only requires a rebuild.
+// #define LEGACY_ATOM_HASH
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+namespace opencog
+{
+
+/**
+ * Hashing primitives for atom content hashes.
+ *
+ * This is a variant of wyhash (Wang Yi, public domain). It reads the
+ * input eight bytes at a time, and mixes with a single 64x64->128 bit
+ * multiply, folding the high half back into the low half.  wyhash
+ * passes SMHasher, and is faster than std::hash on the short strings
+ * that typical node names are.
+ *
+ * The old shift-add chain for links ((h<<5)+h+x) is linear, and so
+ * different outgoing sets collide easily; every collision turns an
+ * AtomTable lookup into a deep equality check.
+ */
+namespace atom_hash
+{
+
+static const uint64_t P0 = 0xa0761d6478bd642full;
+static const uint64_t P1 = 0xe7037ed1a0b428dbull;
+static const uint64_t P2 = 0x8ebc6af09c88c6e3ull;
+static const uint64_t P3 = 0x589965cc75374cc3ull;
+
+/// Multiply, and return the low and high halves in a and b.
+static inline void mum(uint64_t& a, uint64_t& b)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = a;
+    r *= b;
+    a = (uint64_t) r;
+    b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32;
+    uint64_t la = (uint32_t) a, lb = (uint32_t) b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    a = lo;
+    b = hi;
+#endif
+}
+
+static inline uint64_t mix(uint64_t a, uint64_t b)
+{
+    mum(a, b);
+    return a ^ b;
+}
+
+static inline uint64_t read8(const uint8_t* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t read4(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t read3(const uint8_t* p, size_t k)
+{
+    return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+}
+
+/// Hash a block of bytes.
+static inline uint64_t bytes(const void* key, size_t len, uint64_t seed)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(key);
+    seed ^= mix(seed ^ P0, P1);
+    uint64_t a, b;
+    if (len <= 16)
+    {
+        if (4 <= len)
+        {
+            size_t off = (len >> 3) << 2;
+            a = (read4(p) << 32) | read4(p + off);
+            b = (read4(p + len - 4) << 32) | read4(p + len - 4 - off);
+        }
+        else if (0 < len)
+        {
+            a = read3(p, len);
+            b = 0;
+        }
+        else a = b = 0;
+    }
+    else
+    {
+        size_t i = len;
+        if (48 < i)
+        {
+            // Three independent lanes, so that the multiplies overlap.
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+                see1 = mix(read8(p + 16) ^ P2, read8(p + 24) ^ see1);
+                see2 = mix(read8(p + 32) ^ P3, read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (48 < i);
+            seed ^= see1 ^ see2;
+        }
+        while (16 < i)
+        {
+            seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+    a ^= P1;
+    b ^= seed;
+    mum(a, b);
+    return mix(a ^ P0 ^ len, b ^ P1);
+}
+
+/// Fold one more 64-bit value into a running hash. Not commutative:
+/// combine(combine(h, x), y) != combine(combine(h, y), x).
+static inline uint64_t combine(uint64_t h, uint64_t v)
+{
+    return mix(h ^ P2, v ^ P3);
+}
+
+} // namespace atom_hash
+} // namespace opencog
+
+/** @}*/
+#endif // _OPENCOG_ATOM_HASH_H
@@ -0,0 +1,255 @@
+/*
+ * opencog/atoms/base/AtomPool.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <mutex>
+#include <new>
+
+#include <opencog/atoms/base/AtomPool.h>
+
+using namespace opencog;
+
+// Sizes are rounded up to a multiple of GRAIN; there is one size
+// class per multiple, up to NUM_CLASSES * GRAIN bytes.
+static const size_t GRAIN = 16;
+static const size_t NUM_CLASSES = 64;
+
+// Each slab holds many blocks of one size class.
+static const size_t SLAB_SIZE = 256 * 1024;
+
+// Each thread holds at most CACHE_MAX free blocks per size class,
+// and moves CACHE_BATCH of them at a time to or from the shared list.
+static const size_t CACHE_MAX = 128;
+static const size_t CACHE_BATCH = 64;
+
+namespace {
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct SizeClass
+{
+    std::mutex mtx;
+    size_t block;
+
+    // Shared free list, and the unused tail of the newest slab.
+    FreeBlock* free;
+    char* bump;
+    char* bump_end;
+
+    // Blocks given out to threads (live, or in a thread cache), and
+    // total bytes in slabs. Guarded by mtx.
+    size_t out;
+    size_t reserved;
+
+    SizeClass(void) : block(0), free(nullptr), bump(nullptr),
+                      bump_end(nullptr), out(0), reserved(0) {}
+
+    // Hand up to n blocks to a thread; returns how many.
+    size_t take(FreeBlock*& head, size_t n)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        size_t got = 0;
+        while (got < n)
+        {
+            FreeBlock* b = free;
+            if (b)
+                free = b->next;
+            else
+            {
+                if (bump_end < bump + block)
+                {
+                    bump = static_cast<char*>(::operator new(SLAB_SIZE));
+                    bump_end = bump + SLAB_SIZE;
+                    reserved += SLAB_SIZE;
+                }
+                b = reinterpret_cast<FreeBlock*>(bump);
+                bump += block;
+            }
+            b->next = head;
+            head = b;
+            got++;
+        }
+        out += got;
+        return got;
+    }
+
+    // Take back n blocks, linked from head.
+    void give(FreeBlock* head, size_t n)
+    {
+        if (0 == n) return;
+        FreeBlock* tail = head;
+        while (tail->next) tail = tail->next;
+
+        std::lock_guard<std::mutex> lck(mtx);
+        tail->next = free;
+        free = head;
+        out -= n;
+    }
+};
+
+// The size classes are never destroyed: atoms may be freed during
+// static destruction, long after this file's statics are gone.
+SizeClass* classes(void)
+{
+    static SizeClass* cls = []()
+    {
+        SizeClass* c = new SizeClass[NUM_CLASSES];
+        for (size_t i = 0; i < NUM_CLASSES; i++)
+            c[i].block = (i+1) * GRAIN;
+        return c;
+    }();
+    return cls;
+}
+
+struct ThreadCache
+{
+    FreeBlock* head[NUM_CLASSES];
+    size_t count[NUM_CLASSES];
+
+    ThreadCache(void)
+    {
+        for (size_t i = 0; i < NUM_CLASSES; i++)
+        {
+            head[i] = nullptr;
+            count[i] = 0;
+        }
+    }
+    ~ThreadCache();
+};
+
+// Set once this thread's cache has been destroyed; atoms that are
+// released after that (e.g. by other thread_local destructors) go
+// straight back to the shared list.  This is trivially destructible,
+// so it stays valid for the life of the thread.
+static thread_local bool cache_gone = false;
+static thread_local ThreadCache cache;
+
+ThreadCache::~ThreadCache()
+{
+    cache_gone = true;
+    SizeClass* cls = classes();
+    for (size_t i = 0; i < NUM_CLASSES; i++)
+        cls[i].give(head[i], count[i]);
+}
+
+// Return the first n blocks of the list at head, and cut them off.
+FreeBlock* split(FreeBlock*& head, size_t n)
+{
+    FreeBlock* first = head;
+    FreeBlock* last = head;
+    for (size_t i = 1; i < n; i++) last = last->next;
+    head = last->next;
+    last->next = nullptr;
+    return first;
+}
+
+} // anonymous namespace
+
+void* AtomPool::allocate(size_t sz)
+{
+    size_t idx = (sz + GRAIN - 1) / GRAIN;
+    if (0 == idx or NUM_CLASSES < idx) return ::operator new(sz);
+    idx--;
+
+    SizeClass& sc = classes()[idx];
+    if (cache_gone)
+    {
+        FreeBlock* b = nullptr;
+        sc.take(b, 1);
+        return b;
+    }
+
+    if (0 == cache.count[idx])
+        cache.count[idx] = sc.take(cache.head[idx], CACHE_BATCH);
+
+    FreeBlock* b = cache.head[idx];
+    cache.head[idx] = b->next;
+    cache.count[idx]--;
+    return b;
+}
+
+void AtomPool::deallocate(void* p, size_t sz)
+{
+    size_t idx = (sz + GRAIN - 1) / GRAIN;
+    if (0 == idx or NUM_CLASSES < idx)
+    {
+        ::operator delete(p);
+        return;
+    }
+    idx--;
+
+    SizeClass& sc = classes()[idx];
+    FreeBlock* b = static_cast<FreeBlock*>(p);
+    if (cache_gone)
+    {
+        b->next = nullptr;
+        sc.give(b, 1);
+        return;
+    }
+
+    b->next = cache.head[idx];
+    cache.head[idx] = b;
+    cache.count[idx]++;
+
+    // Don't hoard: a thread that frees what other threads allocated
+    // would otherwise collect every block.
+    if (CACHE_MAX < cache.count[idx])
+    {
+        sc.give(split(cache.head[idx], CACHE_BATCH), CACHE_BATCH);
+        cache.count[idx] -= CACHE_BATCH;
+    }
+}
+
+size_t AtomPool::block_size(size_t sz)
+{
+    size_t idx = (sz + GRAIN - 1) / GRAIN;
+    if (0 == idx or NUM_CLASSES < idx) return sz;
+    return idx * GRAIN;
+}
+
+size_t AtomPool::bytes_in_use(void)
+{
+    // This counts the blocks sitting in per-thread caches as in use;
+    // that is at most CACHE_MAX blocks per thread and size class.
+    size_t total = 0;
+    SizeClass* cls = classes();
+    for (size_t i = 0; i < NUM_CLASSES; i++)
+    {
+        std::lock_guard<std::mutex> lck(cls[i].mtx);
+        total += cls[i].out * cls[i].block;
+    }
+    return total;
+}
+
+size_t AtomPool::bytes_reserved(void)
+{
+    size_t total = 0;
+    SizeClass* cls = classes();
+    for (size_t i = 0; i < NUM_CLASSES; i++)
+    {
+        std::lock_guard<std::mutex> lck(cls[i].mtx);
+        total += cls[i].reserved;
+    }
+    return total;
+}
@@ -0,0 +1,117 @@
+/*
+ * opencog/atoms/base/AtomPool.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_ATOM_POOL_H
+#define _OPENCOG_ATOM_POOL_H
+
+#include <cstddef>
+#include <memory>
+
+// Comment this out to allocate atoms with plain std::make_shared,
+// e.g. when hunting memory bugs with valgrind or AddressSanitizer,
+// which cannot see inside the slabs.
+#define USE_ATOM_POOL
+
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+namespace opencog
+{
+
+/**
+ * Slab allocator for atoms.
+ *
+ * Atoms are small, fixed-size, and created by the hundreds of millions;
+ * giving each one its own malloc() costs a header per block, and
+ * scatters atoms all over the heap.  The pool instead carves blocks
+ * out of large slabs, one set of slabs per (16-byte-rounded) size, so
+ * that atoms of the same kind are packed next to each other.
+ *
+ * Each thread keeps a small cache of free blocks, so the common case
+ * of allocating and freeing takes no lock.  Freed blocks are kept for
+ * re-use; slabs are never returned to the operating system.
+ *
+ * Use it with std::allocate_shared(), so that the shared_ptr control
+ * block lands in the same slab block as the atom itself.
+ */
+struct AtomPool
+{
+    /// Allocate `sz` bytes. Sizes beyond the largest size class fall
+    /// through to the ordinary operator new.
+    static void* allocate(size_t sz);
+    static void deallocate(void*, size_t sz);
+
+    /// The number of bytes actually set aside for an allocation of
+    /// `sz` bytes, not counting the (amortized) slab overhead.
+    static size_t block_size(size_t sz);
+
+    /// Bytes handed out to live objects, and bytes held in slabs
+    /// (live or free), over all size classes.
+    static size_t bytes_in_use(void);
+    static size_t bytes_reserved(void);
+};
+
+/// Standard allocator interface to the AtomPool.
+template <typename T>
+struct AtomAllocator
+{
+    typedef T value_type;
+
+    AtomAllocator(void) noexcept {}
+    template <typename U>
+    AtomAllocator(const AtomAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(AtomPool::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n)
+    {
+        AtomPool::deallocate(p, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const AtomAllocator<T>&, const AtomAllocator<U>&)
+{ return true; }
+
+template <typename T, typename U>
+bool operator!=(const AtomAllocator<T>&, const AtomAllocator<U>&)
+{ return false; }
+
+/// Create an atom (or anything else), with the object and its
+/// reference count allocated from the pool.
+template <typename T, typename... Args>
+std::shared_ptr<T> make_pooled(Args&&... args)
+{
+#ifdef USE_ATOM_POOL
+    return std::allocate_shared<T>(AtomAllocator<T>(),
+                                   std::forward<Args>(args)...);
+#else
+    return std::make_shared<T>(std::forward<Args>(args)...);
+#endif
+}
+
+} // namespace opencog
+
+/** @}*/
+#endif // _OPENCOG_ATOM_POOL_H
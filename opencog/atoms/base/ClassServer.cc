@@ -41,10 +41,45 @@
 
 using namespace opencog;
 
+ClassServer::TypeMatrix::TypeMatrix(size_t c)
+    : cap(c), stride(c / 64), bits(new std::atomic<uint64_t>[c * (c / 64)])
+{
+    for (size_t i = 0; i < c * stride; i++)
+        bits[i].store(0, std::memory_order_relaxed);
+}
+
 ClassServer::ClassServer(void)
 {
     nTypes = 0;
     _maxDepth = 0;
+
+    _isa_matrices.emplace_back(new TypeMatrix(64));
+    _isa_matrix = _isa_matrices.back().get();
+}
+
+/// Mark `type` as a descendant of `parent`, in both the recursiveMap
+/// and the isA() bit-matrix.  Must be called with type_mutex held.
+void ClassServer::setRecursive(Type parent, Type type)
+{
+    recursiveMap[parent][type] = true;
+
+    TypeMatrix* m = _isa_matrix.load(std::memory_order_relaxed);
+    if (nTypes > m->cap)
+    {
+        // Grow the matrix, and copy over the old rows.
+        size_t cap = m->cap;
+        while (cap < nTypes) cap *= 2;
+        TypeMatrix* bigger = new TypeMatrix(cap);
+        for (size_t r = 0; r < m->cap; r++)
+            for (size_t w = 0; w < m->stride; w++)
+                bigger->bits[r * bigger->stride + w].store(
+                    m->bits[r * m->stride + w].load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+        _isa_matrices.emplace_back(bigger);
+        _isa_matrix.store(bigger, std::memory_order_release);
+        m = bigger;
+    }
+    m->set(parent, type);
 }
 
 static int tmod = 0;
@@ -105,7 +140,7 @@ Type ClassServer::declType(const Type parent, const std::string& name)
 
     inheritanceMap[type][type]   = true;
     inheritanceMap[parent][type] = true;
-    recursiveMap[type][type]     = true;
+    setRecursive(type, type);
     name2CodeMap[name]           = type;
     _code2NameMap[type]          = &(name2CodeMap.find(name)->first);
     _mod[type]                   = tmod;
@@ -128,7 +163,7 @@ void ClassServer::setParentRecursively(Type parent, Type type, Type& maxd)
     if (recursiveMap[parent][type]) return;
 
     bool incr = false;
-    recursiveMap[parent][type] = true;
+    setRecursive(parent, type);
     for (Type i = 0; i < nTypes; ++i) {
         if ((recursiveMap[i][parent]) and (i != parent)) {
             incr = true;
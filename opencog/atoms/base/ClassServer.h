@@ -24,6 +24,9 @@
 #ifndef _OPENCOG_CLASS_SERVER_H
 #define _OPENCOG_CLASS_SERVER_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
@@ -69,6 +72,40 @@ private:
      */
     mutable std::mutex type_mutex;
 
+    /* isA() does not use the type_mutex at all. Instead, it reads a
+     * bit-matrix copy of the recursiveMap, published through an atomic
+     * pointer.  Declaring types only ever sets bits, never clears them,
+     * so new bits are set in place, with atomic ORs.  A new, larger
+     * matrix is built and published only when the number of types
+     * outgrows the current one.  Retired matrices are kept until
+     * shutdown, since a reader might still be looking at one; because
+     * the size doubles each time, they take less room than the live
+     * one does.
+     */
+    struct TypeMatrix
+    {
+        size_t cap;           // Rows and columns; a multiple of 64.
+        size_t stride;        // Words per row.
+        std::unique_ptr<std::atomic<uint64_t>[]> bits;
+
+        TypeMatrix(size_t);
+        bool test(Type super, Type sub) const
+        {
+            uint64_t w = bits[super * stride + sub / 64]
+                         .load(std::memory_order_relaxed);
+            return (w >> (sub % 64)) & 1;
+        }
+        void set(Type super, Type sub)
+        {
+            bits[super * stride + sub / 64]
+                .fetch_or(((uint64_t) 1) << (sub % 64),
+                          std::memory_order_release);
+        }
+    };
+    std::atomic<TypeMatrix*> _isa_matrix;
+    std::vector<std::unique_ptr<TypeMatrix>> _isa_matrices;
+    void setRecursive(Type parent, Type type);
+
     Type nTypes;
     Type _maxDepth;
 
@@ -186,16 +223,13 @@ public:
      */
     bool isA(Type sub, Type super)
     {
-        /* Because this method is called extremely often, we want
-         * the best-case fast-path for it.  Since updates are extremely
-         * unlikely after initialization, we use a multi-reader lock,
-         * and don't care at all about writer starvation, since there
-         * will almost never be writers. However, see comments above
-         * about multi-reader-locks -- we are not using them just right
-         * now, because they don't seem to actually help. */
-        std::lock_guard<std::mutex> l(type_mutex);
-        if ((sub >= nTypes) || (super >= nTypes)) return false;
-        return recursiveMap[super][sub];
+        /* Because this method is called extremely often, from many
+         * threads at once, we want the best-case fast-path for it:
+         * one atomic load and one bit test, and no lock.  See the
+         * TypeMatrix description, above. */
+        const TypeMatrix* m = _isa_matrix.load(std::memory_order_acquire);
+        if ((sub >= m->cap) || (super >= m->cap)) return false;
+        return m->test(super, sub);
     }
 
     bool isA_non_recursive(Type sub, Type super);
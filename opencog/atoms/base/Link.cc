@@ -26,6 +26,7 @@
 #include <opencog/util/exceptions.h>
 #include <opencog/util/Logger.h>
 
+#include <opencog/atoms/base/AtomHash.h>
 #include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atomspace/AtomTable.h>
@@ -163,12 +164,21 @@ bool Link::operator<(const Atom& other) const
 /// chains the hash values of the child atoms, as well.
 ContentHash Link::compute_hash() const
 {
+#ifdef LEGACY_ATOM_HASH
 	// 1<<44 - 377 is prime
 	ContentHash hsh = ((1UL<<44) - 377) * get_type();
 	for (const Handle& h: _outgoing)
 	{
 		hsh += (hsh <<5) + h->get_hash(); // recursive!
 	}
+#else
+	// The type and the arity seed the hash.
+	ContentHash hsh = atom_hash::combine(get_type(), _outgoing.size());
+	for (const Handle& h: _outgoing)
+	{
+		hsh = atom_hash::combine(hsh, h->get_hash()); // recursive!
+	}
+#endif
 
 	// Links will always have the MSB set.
 	ContentHash mask = ((ContentHash) 1UL) << (8*sizeof(ContentHash) - 1);
@@ -28,6 +28,7 @@
 
 #include <opencog/util/oc_assert.h>
 #include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/AtomPool.h>
 
 namespace opencog
 {
@@ -243,7 +244,7 @@ template< class... Args >
 Handle createLink( Args&&... args )
 {
 	// Do we need to say (std::forward<Args>(args)...) instead ???
-	LinkPtr tmp(std::make_shared<Link>(args ...));
+	LinkPtr tmp(make_pooled<Link>(args ...));
 	return classserver().factory(tmp->get_handle());
 }
 
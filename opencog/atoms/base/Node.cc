@@ -24,6 +24,7 @@
 #include <stdio.h>
 
 #include <opencog/util/Logger.h>
+#include <opencog/atoms/base/AtomHash.h>
 #include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atomspace/AtomTable.h>
@@ -104,10 +105,17 @@ bool Node::operator<(const Atom& other) const
 
 ContentHash Node::compute_hash() const
 {
+#ifdef LEGACY_ATOM_HASH
 	ContentHash hsh = std::hash<std::string>()(get_name());
 
 	// 1<<43 - 369 is a prime number.
 	hsh += (hsh<<5) + ((1UL<<43)-369) * get_type();
+#else
+	// The type is the seed, so that nodes of different types, but
+	// with the same name, get unrelated hashes.
+	const std::string& name(get_name());
+	ContentHash hsh = atom_hash::bytes(name.data(), name.size(), get_type());
+#endif
 
 	// Nodes will never have the MSB set.
 	ContentHash mask = ~(((ContentHash) 1UL) << (8*sizeof(ContentHash) - 1));
@@ -28,6 +28,7 @@
 
 #include <opencog/util/oc_assert.h>
 #include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/AtomPool.h>
 
 namespace opencog
 {
@@ -128,7 +129,7 @@ template< class... Args >
 Handle createNode( Args&&... args )
 {
    // Do we need to say (std::forward<Args>(args)...) instead ???
-   NodePtr tmp(std::make_shared<Node>(args ...));
+   NodePtr tmp(make_pooled<Node>(args ...));
    return classserver().factory(tmp->get_handle());
 }
 
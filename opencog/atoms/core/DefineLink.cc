@@ -27,6 +27,8 @@
 
 using namespace opencog;
 
+std::atomic<size_t> DefineLink::_generation(0);
+
 void DefineLink::init()
 {
 	if (not classserver().isA(get_type(), DEFINE_LINK))
@@ -23,6 +23,8 @@
 #ifndef _OPENCOG_DEFINE_LINK_H
 #define _OPENCOG_DEFINE_LINK_H
 
+#include <atomic>
+
 #include <opencog/atoms/core/UniqueLink.h>
 
 namespace opencog
@@ -61,6 +63,8 @@ class DefineLink : public UniqueLink
 {
 protected:
 	void init();
+
+	static std::atomic<size_t> _generation;
 public:
 	DefineLink(const HandleSeq&, Type=DEFINE_LINK);
 
@@ -81,6 +85,15 @@ public:
 	 */
 	static Handle get_definition(const Handle& alias);
 
+	/**
+	 * A counter that goes up every time that a DefineLink is added
+	 * to, or removed from, an AtomSpace. Anything that caches the
+	 * result of get_definition() can compare against this, to find
+	 * out if it has gone stale.
+	 */
+	static size_t get_generation(void) { return _generation; }
+	static void definitions_changed(void) { _generation++; }
+
 	static Handle factory(const Handle&);
 };
 
@@ -169,6 +169,9 @@ public:
 	const Variables& get_variables(void) const { return _varlist; }
 	const Pattern& get_pattern(void) const { return _pat; }
 
+	// The number of components joined by virtual clauses.
+	size_t get_num_components(void) const { return _num_comps; }
+
 	// Return the list of fixed and virtual clauses we are holding.
 	const HandleSeq& get_fixed(void) const { return _fixed; }
 	const HandleSeq& get_virtual(void) const { return _virtual; }
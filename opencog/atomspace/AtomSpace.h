@@ -57,6 +57,7 @@ class AtomSpace
     friend class AtomStorage;
     friend class BackingStore;
     friend class SQLAtomStorage;     // Needs to call get_atomtable()
+    friend class LocalAtomStorage;   // Needs to call get_atomtable()
     friend class ZMQPersistSCM;
     friend class ::AtomTableUTest;
     friend class ::AtomSpaceUTest;
@@ -122,6 +123,12 @@ public:
         { return _atom_table.getNumAtomsOfType(type, subclass); }
     inline UUID get_uuid(void) const { return _atom_table.get_uuid(); }
 
+    /**
+     * Print how many atoms share a content hash, and how full the
+     * hash buckets are. See AtomTable::getHashStats().
+     */
+    void print_hash_stats(void) const { _atom_table.printHashStats(); }
+
     //! Clear the atomspace, remove all atoms
     void clear()
         { _atom_table.clear(); }
@@ -213,8 +220,9 @@ public:
 
     /**
      * Make sure all atom writes have completed, before returning.
-     * This only has an effect when the atomspace is backed by some
-     * sort of storage, or is sending atoms to some remote location
+     * This only has an effect when atoms were added with the async
+     * flag set, or when the atomspace is backed by some sort of
+     * storage, or is sending atoms to some remote location
      * asynchronously. This simply guarantees that the asynch
      * operations have completed.
      * NB: at this time, we don't distinguish barrier and flush.
@@ -512,6 +520,17 @@ public:
         return _atom_table.getHandlesByType(result, type, subclass);
     }
 
+    /**
+     * Return a cursor over all atoms of the given type (subclasses
+     * optionally). Unlike get_handles_by_type(), this does not copy
+     * the whole type index; see AtomTable::TypeCursor.
+     */
+    AtomTable::TypeCursor get_type_cursor(Type type,
+                                          bool subclass=false) const
+    {
+        return AtomTable::TypeCursor(_atom_table, type, subclass);
+    }
+
     /* ----------------------------------------------------------- */
     /* The foreach routines offer an alternative interface
      * to the getHandleSet API.
@@ -550,18 +569,37 @@ public:
     /* ----------------------------------------------------------- */
     // ---- Signals
 
-    boost::signals2::connection addAtomSignal(const AtomSignal::slot_type& function)
+    SignalConnection addAtomSignal(const AtomSignal::slot_type& function)
     {
         return _atom_table.addAtomSignal().connect(function);
     }
-    boost::signals2::connection removeAtomSignal(const AtomPtrSignal::slot_type& function)
+    SignalConnection removeAtomSignal(const AtomPtrSignal::slot_type& function)
     {
         return _atom_table.removeAtomSignal().connect(function);
     }
-    boost::signals2::connection TVChangedSignal(const TVCHSigl::slot_type& function)
+    SignalConnection TVChangedSignal(const TVCHSigl::slot_type& function)
     {
         return _atom_table.TVChangedSignal().connect(function);
     }
+
+    // Batched variants: the slot is called with a vector of (up to)
+    // batch_size events at a time.  Whatever is left over is delivered
+    // by barrier(), or when the connection is disconnected.
+    SignalConnection addAtomSignalBatched(
+        const AtomSignal::batch_slot_type& function, size_t batch_size)
+    {
+        return _atom_table.addAtomSignal().connect_batched(function, batch_size);
+    }
+    SignalConnection removeAtomSignalBatched(
+        const AtomPtrSignal::batch_slot_type& function, size_t batch_size)
+    {
+        return _atom_table.removeAtomSignal().connect_batched(function, batch_size);
+    }
+    SignalConnection TVChangedSignalBatched(
+        const TVCHSigl::batch_slot_type& function, size_t batch_size)
+    {
+        return _atom_table.TVChangedSignal().connect_batched(function, batch_size);
+    }
 };
 
 /** @}*/
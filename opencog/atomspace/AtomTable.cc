@@ -31,13 +31,17 @@
 #include <iterator>
 #include <mutex>
 #include <set>
+#include <thread>
 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <boost/bind.hpp>
 
 #include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/core/DefineLink.h>
 #include <opencog/atoms/core/DeleteLink.h>
 #include <opencog/atoms/core/ScopeLink.h>
 #include <opencog/atoms/core/StateLink.h>
@@ -48,21 +52,21 @@
 //#define DPRINTF printf
 #define DPRINTF(...)
 
+// Number of worker threads used for async atom insertion.
+#define NUM_INDEX_QUEUES 4
+
 using namespace opencog;
 
+// Set in the async index worker threads. Signal handlers running
+// there must not wait on the index queue, as that would deadlock.
+static thread_local bool in_index_worker = false;
+
 // Nothing should ever get the uuid of zero. Zero is reserved for
 // "no atomtable" (in the persist code).
 static std::atomic<UUID> _id_pool(1);
 
 AtomTable::AtomTable(AtomTable* parent, AtomSpace* holder, bool transient) :
-    _classserver(classserver()),
-    // Hmm. Right now async doesn't work anyway, so lets not create
-    // threads for it. It just makes using gdb that much harder.
-    // FIXME later. Actually, the async idea is not going to work as
-    // originally envisioned, anyway.  What we really need are
-    // consistent views of the atomtable.
-    // _index_queue(this, &AtomTable::put_atom_into_index, transient?0:4)
-    _index_queue(this, &AtomTable::put_atom_into_index, 0)
+    _classserver(classserver())
 {
     _as = holder;
     _environ = parent;
@@ -70,6 +74,8 @@ AtomTable::AtomTable(AtomTable* parent, AtomSpace* holder, bool transient) :
     _size = 0;
     _num_nodes = 0;
     _num_links = 0;
+    _active_scans = 0;
+    _scan_epoch = 0;
     size_t ntypes = _classserver.getNumberOfClasses();
     _size_by_type.resize(ntypes);
     _transient = transient;
@@ -82,25 +88,31 @@ AtomTable::AtomTable(AtomTable* parent, AtomSpace* holder, bool transient) :
 
 AtomTable::~AtomTable()
 {
+    // Finish any pending async inserts before tearing down.
+    barrier();
+
     // Disconnect signals. Only then clear the resolver.
     std::lock_guard<std::recursive_mutex> lck(_mtx);
     addedTypeConnection.disconnect();
 
     // No one who shall look at these atoms shall ever again
     // find a reference to this atomtable.
-    for (auto& pr : _atom_store) {
-        Handle& atom_to_delete = pr.second;
-        atom_to_delete->_atom_space = nullptr;
-
-        // Aiee ... We added this link to every incoming set;
-        // thus, it is our responsibility to remove it as well.
-        // This is a stinky design, but I see no other way,
-        // because it seems that we can't do this in the Atom
-        // destructor (which is where this should be happening).
-        if (atom_to_delete->is_link()) {
-            LinkPtr link_to_delete = LinkCast(atom_to_delete);
-            for (AtomPtr atom_in_out_set : atom_to_delete->getOutgoingSet()) {
-                atom_in_out_set->remove_atom(link_to_delete);
+    for (AtomStoreShard& shard : _atom_store) {
+        std::lock_guard<std::mutex> slck(shard.mtx);
+        for (auto& pr : shard.store) {
+            Handle& atom_to_delete = pr.second;
+            atom_to_delete->_atom_space = nullptr;
+
+            // Aiee ... We added this link to every incoming set;
+            // thus, it is our responsibility to remove it as well.
+            // This is a stinky design, but I see no other way,
+            // because it seems that we can't do this in the Atom
+            // destructor (which is where this should be happening).
+            if (atom_to_delete->is_link()) {
+                LinkPtr link_to_delete = LinkCast(atom_to_delete);
+                for (AtomPtr atom_in_out_set : atom_to_delete->getOutgoingSet()) {
+                    atom_in_out_set->remove_atom(link_to_delete);
+                }
             }
         }
     }
@@ -149,28 +161,34 @@ void AtomTable::clear_all_atoms()
     // Clear the by-type size cache.
     Type total_types = _size_by_type.size();
     for (Type type = ATOM; type < total_types; type++)
+    {
+        std::lock_guard<std::recursive_mutex> tlck(typeIndex.get_mutex(type));
         _size_by_type[type] = 0;
+    }
 
     // Clear the atoms in the set.
-    for (auto& pr : _atom_store) {
-        Handle& atom_to_clear = pr.second;
-        atom_to_clear->_atom_space = nullptr;
-
-        // If this is a link we need to remove this atom from the incoming
-        // sets for any atoms in this atom's outgoing set. See note in
-        // the analogous loop in ~AtomTable above.
-        if (atom_to_clear->is_link()) {
-            LinkPtr link_to_clear = LinkCast(atom_to_clear);
-            for (AtomPtr atom_in_out_set : atom_to_clear->getOutgoingSet()) {
-                atom_in_out_set->remove_atom(link_to_clear);
+    for (AtomStoreShard& shard : _atom_store) {
+        std::lock_guard<std::mutex> slck(shard.mtx);
+        for (auto& pr : shard.store) {
+            Handle& atom_to_clear = pr.second;
+            atom_to_clear->_atom_space = nullptr;
+
+            // If this is a link we need to remove this atom from the
+            // incoming sets for any atoms in this atom's outgoing set.
+            // See note in the analogous loop in ~AtomTable above.
+            if (atom_to_clear->is_link()) {
+                LinkPtr link_to_clear = LinkCast(atom_to_clear);
+                for (AtomPtr atom_in_out_set : atom_to_clear->getOutgoingSet()) {
+                    atom_in_out_set->remove_atom(link_to_clear);
+                }
             }
         }
-    }
 
-    // Clear the atom store. This will delete all the atoms since
-    // this will be the last shared_ptr referecence, and set the
-    // size of the set to 0.
-    _atom_store.clear();
+        // Clear the atom store. This will delete all the atoms since
+        // this will be the last shared_ptr referecence, and set the
+        // size of the set to 0.
+        shard.store.clear();
+    }
 }
 
 void AtomTable::clear()
@@ -214,8 +232,7 @@ AtomTable& AtomTable::operator=(const AtomTable& other)
 }
 
 AtomTable::AtomTable(const AtomTable& other) :
-    _classserver(classserver()),
-    _index_queue(this, &AtomTable::put_atom_into_index)
+    _classserver(classserver())
 {
     throw opencog::RuntimeException(TRACE_INFO,
             "AtomTable - Cannot copy an object of this class");
@@ -227,14 +244,15 @@ Handle AtomTable::getHandle(Type t, const std::string& n) const
     return getNodeHandle(a);
 }
 
-Handle AtomTable::getNodeHandle(const AtomPtr& orig) const
+/// Look for an atom equal to `a` in this table only (not in the
+/// environment). Only the shard holding the hash of `a` is locked.
+Handle AtomTable::lookup(const AtomPtr& a) const
 {
-    AtomPtr a(orig);
-
     ContentHash ch = a->get_hash();
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
+    AtomStoreShard& shard = get_shard(ch);
+    std::lock_guard<std::mutex> slck(shard.mtx);
 
-    auto range = _atom_store.equal_range(ch);
+    auto range = shard.store.equal_range(ch);
     auto bkt = range.first;
     auto end = range.second;
     for (; bkt != end; bkt++) {
@@ -242,9 +260,16 @@ Handle AtomTable::getNodeHandle(const AtomPtr& orig) const
             return bkt->second;
         }
     }
+    return Handle::UNDEFINED;
+}
+
+Handle AtomTable::getNodeHandle(const AtomPtr& orig) const
+{
+    Handle h(lookup(orig));
+    if (h) return h;
 
     if (_environ)
-        return _environ->getHandle(a);
+        return _environ->getHandle(orig);
     return Handle::UNDEFINED;
 }
 
@@ -272,20 +297,9 @@ Handle AtomTable::getLinkHandle(const AtomPtr& orig) const
     }
     if (changed) a = createLink(resolved_seq, t);
 
-    // Start searching to see if we have this atom.
-    ContentHash ch = a->get_hash();
-
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
     // So ... check to see if we have it or not.
-    auto range = _atom_store.equal_range(ch);
-    auto bkt = range.first;
-    auto end = range.second;
-    for (; bkt != end; bkt++) {
-        if (*((AtomPtr) bkt->second) == *a) {
-            return bkt->second;
-        }
-    }
+    Handle h(lookup(a));
+    if (h) return h;
 
     if (_environ) {
         return _environ->getHandle(a);
@@ -403,66 +417,163 @@ Handle AtomTable::add(AtomPtr atom, bool async)
             atom = createLink(*LinkCast(atom));
     }
 
-    // Lock before checking to see if this kind of atom is already in
-    // the atomspace.  Lock, to prevent two different threads from
-    // trying to add exactly the same atom.
-    std::unique_lock<std::recursive_mutex> lck(_mtx);
-    Handle hcheck(getHandle(orig));
-    if (hcheck) return hcheck;
+    // Is there an equivalent atom in the environment? This table
+    // itself is checked below, while holding the shard lock.
+    if (_environ) {
+        Handle hcheck(_environ->getHandle(orig));
+        if (hcheck) return hcheck;
+    }
 
+    // This is our private copy; nothing else can see it yet.
     atom->copyValues(Handle(orig));
 
-    if (atom->is_link()) {
-        if (STATE_LINK == atom_type) {
-            // If this is a closed StateLink, (i.e. has no variables)
-            // then make sure that the old state gets removed from the
-            // atomtable. The atomtable must contain no more than one
-            // closed state at a time.  Also: we must be careful to
-            // update the incoming set in an atomic fashion, so that
-            // the pattern matcher never finds two closed StateLinks
-            // for any one given alias.  Any number of non-closed
-            // StateLinks are allowed.
-
-            StateLinkPtr slp(StateLinkCast(atom));
-            if (slp->is_closed()) {
-                try {
-                    Handle alias = slp->get_alias();
-                    Handle old_state = StateLink::get_link(alias);
-                    atom->setAtomSpace(_as);
-                    alias->swap_atom(LinkCast(old_state), slp);
-                    extract(old_state, true);
-                } catch (const InvalidParamException& ex) {}
-            }
+    // Lock the shard before checking to see if this kind of atom is
+    // already in the atomspace.  Lock, to prevent two different
+    // threads from trying to add exactly the same atom.  Only the one
+    // shard is locked; adds of unrelated atoms proceed in parallel.
+    //
+    // A link also locks the shards of its outgoing atoms, in their
+    // own tables. extract() marks an atom for removal under its shard
+    // lock, and only then reads its incoming set. So, either the
+    // link gets into the incoming set before the mark, and a
+    // recursive extract finds it, or the link sees the mark here,
+    // and is not added. The shard locks are taken in address order.
+    ContentHash ch = atom->get_hash();
+    AtomStoreShard& shard = get_shard(ch);
+    std::vector<std::mutex*> mtxs({&shard.mtx});
+    bool index_incoming = atom->is_link() and not _transient;
+    if (index_incoming) {
+        for (const Handle& ho : atom->getOutgoingSet()) {
+            AtomTable* ot = ho->getAtomTable();
+            if (ot) mtxs.push_back(&ot->get_shard(ho->get_hash()).mtx);
         }
+        std::sort(mtxs.begin(), mtxs.end());
+        mtxs.erase(std::unique(mtxs.begin(), mtxs.end()), mtxs.end());
+    }
 
-        // Build the incoming set of outgoing atom h.
-        size_t arity = atom->get_arity();
-        LinkPtr llc(LinkCast(atom));
-        for (size_t i = 0; i < arity; i++) {
-            llc->_outgoing[i]->insert_atom(llc);
+    // A closed StateLink replaces the old state of its alias. This
+    // removes atoms, and so must be serialized with extract(), and
+    // with other state changes; _mtx comes before the shard locks.
+    StateLinkPtr slp;
+    if (STATE_LINK == atom_type and not _transient) {
+        slp = StateLinkCast(atom);
+        if (not slp->is_closed()) slp = nullptr;
+    }
+    std::unique_lock<std::recursive_mutex> lck(_mtx, std::defer_lock);
+
+    std::vector<std::unique_lock<std::mutex>> slcks;
+    while (true) {
+        if (slp) lck.lock();
+        for (std::mutex* m : mtxs) slcks.emplace_back(*m);
+
+        auto range = shard.store.equal_range(ch);
+        for (auto bkt = range.first; bkt != range.second; bkt++) {
+            if (*((AtomPtr) bkt->second) == *atom)
+                return bkt->second;
+        }
+        if (not index_incoming) break;
+
+        // An outgoing atom that is gone cannot be linked to. One that
+        // is being extracted by another thread might yet survive, if
+        // the extract is not recursive, and the atom is still in use.
+        // extract() holds the table lock from the mark until the atom
+        // is either removed or unmarked; so wait on that, and look
+        // again.
+        AtomTable* busy = nullptr;
+        for (const Handle& ho : atom->getOutgoingSet()) {
+            AtomTable* ot = ho->getAtomTable();
+            if (nullptr == ot)
+                throw InvalidParamException(TRACE_INFO,
+                    "AtomTable - cannot add a link to a removed atom: %s",
+                    ho->to_string().c_str());
+            if (ho->isMarkedForRemoval()) busy = ot;
         }
+        if (nullptr == busy) break;
+
+        slcks.clear();
+        if (slp) lck.unlock();
+        { std::lock_guard<std::recursive_mutex> wait(busy->_mtx); }
     }
 
+    // The old state has to be found before the new one is put into
+    // the incoming set of the alias; otherwise, the new state might
+    // be found instead.
+    Handle old_state;
+    if (slp) {
+        try {
+            old_state = StateLink::get_link(slp->get_alias());
+        } catch (const InvalidParamException& ex) {}
+    }
+
+    // Start tracking the incoming set before the atom becomes
+    // visible, so that links added by other threads are recorded.
     atom->keep_incoming_set();
     atom->setAtomSpace(_as);
 
+    Handle h(atom->get_handle());
+    shard.store.insert({ch, h});
     _size++;
-    if (atom->is_node()) _num_nodes++;
-    if (atom->is_link()) _num_links++;
-    _size_by_type[atom->_type] ++;
 
-    Handle h(atom->get_handle());
-    _atom_store.insert({atom->get_hash(), h});
+    // Build the incoming sets of the outgoing atoms, while they are
+    // still locked against extraction.  The new state takes the
+    // place of the old one in one step, so that the pattern matcher
+    // never finds two closed StateLinks for any one given alias.
+    // Any number of non-closed StateLinks are allowed.
+    if (index_incoming) {
+        LinkPtr llc(LinkCast(atom));
+        size_t arity = llc->_outgoing.size();
+        for (size_t i = 0; i < arity; i++) {
+            if (0 == i and old_state)
+                llc->_outgoing[i]->swap_atom(LinkCast(old_state), llc);
+            else
+                llc->_outgoing[i]->insert_atom(llc);
+        }
+    }
 
-    if (not _transient and not async)
-        put_atom_into_index(atom);
+    // We can now unlock; the atom is claimed.  The remaining updates
+    // (type index) are made without the shard locks. Other threads
+    // may briefly see the atom before it has been indexed by type;
+    // this is the same guarantee as the async path.
+    slcks.clear();
 
-    // We can now unlock, since we are done.
-    lck.unlock();
+    // The old state is no longer in the incoming set of the alias;
+    // remove it from the atomtable, too. The atomtable must contain
+    // no more than one closed state at a time.
+    if (old_state) extract(old_state, true);
+    if (slp) lck.unlock();
 
-    // Update the indexes asynchronously
-    if (not _transient and async)
-        _index_queue.enqueue(atom);
+    if (atom->is_node()) _num_nodes++;
+    if (atom->is_link()) _num_links++;
+    {
+        std::lock_guard<std::recursive_mutex> tlck(typeIndex.get_mutex(atom->_type));
+        _size_by_type[atom->_type] ++;
+    }
+
+    if (_transient)
+    {
+        // Transient tables are not indexed, but they do need
+        // incoming sets.
+        if (atom->is_link()) {
+            LinkPtr llc(LinkCast(atom));
+            for (const Handle& ho : llc->_outgoing)
+                ho->insert_atom(llc);
+            if (_classserver.isA(atom_type, DEFINE_LINK))
+                DefineLink::definitions_changed();
+        }
+    }
+    else if (not async)
+    {
+        put_atom_into_index(atom);
+    }
+    else
+    {
+        // Update the incoming sets and indexes asynchronously.
+        std::call_once(_index_queue_started, [this]() {
+            _index_queue.reset(new async_caller<AtomTable, AtomPtr>(
+                this, &AtomTable::async_index, NUM_INDEX_QUEUES));
+        });
+        _index_queue->enqueue(atom);
+    }
 
     DPRINTF("Atom added: %s\n", atom->to_string().c_str());
     return h;
@@ -474,42 +585,66 @@ void AtomTable::put_atom_into_index(const AtomPtr& atom)
         throw RuntimeException(TRACE_INFO,
           "AtomTable - transient should not index atoms!");
 
-    std::unique_lock<std::recursive_mutex> lck(_mtx);
-    Atom* pat = atom.operator->();
-    typeIndex.insertAtom(pat);
+    // If the atom got extracted before an async worker got to it,
+    // then there is nothing left to do.
+    if (nullptr == atom->getAtomSpace() and nullptr != _as) return;
 
-    // We can now unlock, since we are done. In particular, the signals
+    // The incoming sets of the outgoing atoms were built by add().
+    // The definition is now visible to get_definition().
+    if (atom->is_link() and _classserver.isA(atom->_type, DEFINE_LINK))
+        DefineLink::definitions_changed();
+
+    // The type index does its own (per-type) locking. The signals
     // need to run unlocked, since they may result in more atom table
     // additions.
-    lck.unlock();
+    Atom* pat = atom.operator->();
+    typeIndex.insertAtom(pat);
 
     // Now that we are completely done, emit the added signal.
     // Don't emit signal until after the indexes are updated!
-    _addAtomSignal(atom->get_handle());
+    if (not _addAtomSignal.empty())
+        _addAtomSignal(atom->get_handle());
+}
+
+/// Entry point for the async worker threads.
+void AtomTable::async_index(const AtomPtr& atom)
+{
+    in_index_worker = true;
+    put_atom_into_index(atom);
 }
 
 void AtomTable::barrier()
 {
-    _index_queue.flush_queue();
+    if (in_index_worker) return;
+    if (_index_queue) _index_queue->flush_queue();
+
+    // Hand any partially-filled batches to the batched listeners.
+    _addAtomSignal.flush();
+    _removeAtomSignal.flush();
+    _TVChangedSignal.flush();
 }
 
 size_t AtomTable::getSize() const
 {
     // No one except the unit tests ever worries about the atom table
     // size. This sanity check might be able to avoid unpleasant
-    // surprises.
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-    if (_size != _atom_store.size())
+    // surprises. The size is only changed while holding a shard lock,
+    // so holding all of them gives a consistent count.  The typeIndex
+    // is not checked: it is updated after the atom is published, and
+    // so may lag behind during concurrent (or async) inserts.
+    for (AtomStoreShard& shard : _atom_store) shard.mtx.lock();
+    size_t stored = 0;
+    for (const AtomStoreShard& shard : _atom_store)
+        stored += shard.store.size();
+    size_t sz = _size;
+    for (AtomStoreShard& shard : _atom_store) shard.mtx.unlock();
+
+    if (sz != stored)
         throw RuntimeException(TRACE_INFO,
             "Internal Error: Inconsistent AtomTable hash size! %lu vs. %lu",
-            _size, _atom_store.size());
+            sz, stored);
 
-    if (_size != typeIndex.size())
-        throw RuntimeException(TRACE_INFO,
-            "Internal Error: Inconsistent AtomTable typeIndex size! %lu vs. %lu",
-            _size, typeIndex.size());
-
-    return _size;
+    return sz;
 }
 
 size_t AtomTable::getNumNodes() const
@@ -524,17 +659,22 @@ size_t AtomTable::getNumLinks() const
 
 size_t AtomTable::getNumAtomsOfType(Type type, bool subclass) const
 {
-    std::lock_guard<std::recursive_mutex> lck(_mtx);
-
-    size_t result = _size_by_type[type];
+    size_t result;
+    {
+        std::lock_guard<std::recursive_mutex> tlck(typeIndex.get_mutex(type));
+        result = _size_by_type[type];
+    }
     if (subclass)
     {
         // Also count subclasses of this type, if need be.
         Type ntypes = _size_by_type.size();
         for (Type t = ATOM; t<ntypes; t++)
         {
-            if (t != type and _classserver.isA(type, t))
+            if (t != type and _classserver.isA(t, type))
+            {
+                std::lock_guard<std::recursive_mutex> tlck(typeIndex.get_mutex(t));
                 result += _size_by_type[t];
+            }
         }
     }
 
@@ -544,25 +684,276 @@ size_t AtomTable::getNumAtomsOfType(Type type, bool subclass) const
     return result;
 }
 
+AtomTable::HashStats AtomTable::getHashStats(void) const
+{
+    HashStats st;
+    st.atoms = 0;
+    st.distinct = 0;
+    st.collisions = 0;
+    st.max_same_hash = 0;
+    st.buckets = 0;
+    st.max_bucket = 0;
+    st.bucket_sizes.resize(9, 0);
+
+    // One shard at a time; the totals are not a consistent snapshot
+    // if atoms are being added, but they are close enough.
+    for (AtomStoreShard& shard : _atom_store)
+    {
+        std::lock_guard<std::mutex> slck(shard.mtx);
+        const auto& store = shard.store;
+        st.atoms += store.size();
+
+        // Equal keys are adjacent in an unordered_multimap.
+        auto it = store.begin();
+        while (it != store.end())
+        {
+            size_t run = store.count(it->first);
+            st.distinct++;
+            if (1 < run) st.collisions += run;
+            if (st.max_same_hash < run) st.max_same_hash = run;
+            std::advance(it, run);
+        }
+
+        size_t nb = store.bucket_count();
+        st.buckets += nb;
+        for (size_t b = 0; b < nb; b++)
+        {
+            size_t bs = store.bucket_size(b);
+            if (st.max_bucket < bs) st.max_bucket = bs;
+            st.bucket_sizes[std::min(bs, st.bucket_sizes.size() - 1)]++;
+        }
+    }
+    return st;
+}
+
+void AtomTable::printHashStats(void) const
+{
+    HashStats st = getHashStats();
+    printf("hash-stats: atoms=%zu distinct hashes=%zu\n",
+           st.atoms, st.distinct);
+    printf("hash-stats: atoms sharing a hash=%zu (%f pct) most per hash=%zu\n",
+           st.collisions, 100.0 * st.collisions / std::max<size_t>(1, st.atoms),
+           st.max_same_hash);
+    printf("hash-stats: buckets=%zu load factor=%f fullest bucket=%zu\n",
+           st.buckets, st.atoms / std::max<double>(1, st.buckets),
+           st.max_bucket);
+    size_t last = st.bucket_sizes.size() - 1;
+    for (size_t i = 0; i <= last; i++)
+        printf("hash-stats: buckets with %zu%s atoms: %zu\n",
+               i, (i == last) ? " or more" : "", st.bucket_sizes[i]);
+}
+
 Handle AtomTable::getRandom(RandGen *rng) const
 {
     size_t x = rng->randint(getSize());
 
     Handle randy(Handle::UNDEFINED);
 
-    // XXX TODO it would be considerably more efficient to go into the
-    // the type index, and decrement x by the size of the index for
-    // each type.  This would speed up the algo by about 100 (by about
-    // the number of types that are in use...).
-    foreachHandleByType(
-        [&](Handle h)->void {
-            if (0 == x) randy = h;
-            x--;
+    // The type index is dense, so we can skip over whole types,
+    // and then jump straight to the atom.
+    bool found = false;
+    typeIndex.foreach_set(
+        [&](const AtomSet& s)->void {
+            if (found) return;
+            if (x < s.size())
+            {
+                randy = s[x]->get_handle();
+                found = true;
+                return;
+            }
+            x -= s.size();
         },
         ATOM, true);
     return randy;
 }
 
+// ================================================================
+// Chunked scans
+
+AtomTable::TypeCursor::TypeCursor(const AtomTable& table, Type type,
+                                  bool subclass, bool parent)
+    : _curwalk(0), _next(0)
+{
+    // The parents are visited first.
+    std::vector<const AtomTable*> tables;
+    for (const AtomTable* t = &table; t; t = parent ? t->_environ : nullptr)
+        tables.push_back(t);
+
+    for (auto t = tables.rbegin(); t != tables.rend(); t++)
+    {
+        const TypeIndex& ti = (*t)->typeIndex;
+        Type ntypes = ti.get_num_types();
+        for (Type ty = type; ty < ntypes; ty = ti.next_type(type, ty, subclass))
+            _walks.push_back({*t, ty, 0});
+    }
+
+    // Register only once the vector is complete, and will not move.
+    // All of the end positions are taken now, so that atoms added
+    // during the walk are never visited, whatever their type.
+    for (Walk& w : _walks)
+        w.table->typeIndex.begin_cursor(w.type, &w.pos);
+}
+
+AtomTable::TypeCursor::TypeCursor(TypeCursor&& other)
+    : _walks(std::move(other._walks)), _curwalk(other._curwalk),
+      _chunk(std::move(other._chunk)), _next(other._next)
+{
+    // Moving the vector keeps its elements where they are, so the
+    // registered positions stay valid.
+    other._walks.clear();
+    other._curwalk = 0;
+}
+
+AtomTable::TypeCursor::~TypeCursor()
+{
+    end_walks();
+}
+
+void AtomTable::TypeCursor::end_walks(void)
+{
+    for (; _curwalk < _walks.size(); _curwalk++)
+    {
+        Walk& w = _walks[_curwalk];
+        w.table->typeIndex.end_cursor(w.type, &w.pos);
+    }
+}
+
+bool AtomTable::TypeCursor::refill(void)
+{
+    _chunk.clear();
+    _next = 0;
+    for (; _curwalk < _walks.size(); _curwalk++)
+    {
+        Walk& w = _walks[_curwalk];
+        w.table->typeIndex.copy_chunk(w.type, w.pos, _chunk, CHUNK);
+        if (not _chunk.empty()) return true;
+        w.table->typeIndex.end_cursor(w.type, &w.pos);
+    }
+    return false;
+}
+
+bool AtomTable::TypeCursor::next(Handle& h)
+{
+    while (_next < _chunk.size() or refill())
+    {
+        const Handle& c = _chunk[_next++];
+        if (c->isMarkedForRemoval()) continue;
+        h = c;
+        return true;
+    }
+    return false;
+}
+
+// ================================================================
+// Parallel scans
+
+AtomTable::ScanSnapshot::ScanSnapshot(const AtomTable& table,
+                                      Type type, bool subclass)
+    : _table(table)
+{
+    // Register the scan *before* copying the index, so that any atom
+    // that makes it into the snapshot, and is then extracted, gets
+    // retired instead of freed.
+    {
+        std::lock_guard<std::mutex> lck(_table._retire_mtx);
+        _epoch = ++_table._scan_epoch;
+        _table._live_scans.insert(_epoch);
+        _table._active_scans++;
+    }
+
+    _atoms.reserve(_table.getNumAtomsOfType(type, subclass));
+    _table.typeIndex.foreach_set(
+        [&](const AtomSet& s)->void {
+            _atoms.insert(_atoms.end(), s.begin(), s.end());
+        }, type, subclass);
+}
+
+AtomTable::ScanSnapshot::~ScanSnapshot()
+{
+    std::vector<AtomPtr> gone;
+    {
+        std::lock_guard<std::mutex> lck(_table._retire_mtx);
+        _table._live_scans.erase(_epoch);
+        _table._active_scans--;
+
+        // The tags only ever grow, so the atoms that no running scan
+        // can hold are all at the front.
+        size_t oldest = _table._live_scans.empty() ?
+            SIZE_MAX : *_table._live_scans.begin();
+        auto& retired = _table._retired;
+        while (not retired.empty() and retired.front().first < oldest)
+        {
+            gone.emplace_back(std::move(retired.front().second));
+            retired.pop_front();
+        }
+    }
+    // The retired atoms are released here, outside of the lock.
+}
+
+void AtomTable::retire(const AtomPtr& atom)
+{
+    // The atom has already been removed from the type index, under
+    // the type lock.  A scan that copied it out of the index did so
+    // after registering itself, so it is visible here.
+    if (0 == _active_scans) return;
+
+    std::lock_guard<std::mutex> lck(_retire_mtx);
+    if (0 < _active_scans) _retired.emplace_back(_scan_epoch, atom);
+}
+
+void AtomTable::run_chunks(size_t n, unsigned nthreads,
+                           const std::function<void(size_t, size_t)>& chunk)
+{
+    if (0 == nthreads) nthreads = std::thread::hardware_concurrency();
+    if (0 == nthreads) nthreads = 1;
+
+    // Small enough chunks that the threads stay balanced, large
+    // enough that claiming one is noise.
+    size_t chunk_size = std::max<size_t>(1024, n / (16 * nthreads));
+    size_t nchunks = (n + chunk_size - 1) / chunk_size;
+    if (nchunks < nthreads) nthreads = nchunks;
+    if (nthreads <= 1)
+    {
+        if (0 < n) chunk(0, n);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mtx;
+
+    auto worker = [&]()
+    {
+        while (not failed)
+        {
+            size_t c = next.fetch_add(1);
+            if (nchunks <= c) return;
+            size_t begin = c * chunk_size;
+            size_t end = std::min(n, begin + chunk_size);
+            try
+            {
+                chunk(begin, end);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lck(error_mtx);
+                if (not error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    // The calling thread works too.
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < nthreads; i++)
+        pool.push_back(std::thread(worker));
+    worker();
+    for (std::thread& t : pool) t.join();
+
+    if (error) std::rethrow_exception(error);
+}
+
 AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
 {
     AtomPtrSet result;
@@ -586,14 +977,25 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
         return other->extract(handle, recursive);
     }
 
+    // Any pending async inserts must land first; otherwise a worker
+    // could put the atom back into the index after we remove it.
+    if (_index_queue and not in_index_worker)
+        _index_queue->flush_queue();
+
     // Lock before fetching the incoming set. Since getting the
     // incoming set also grabs a lock, we need this mutex to be
     // recursive. We need to lock here to avoid confusion if multiple
-    // threads are trying to delete the same atom.
+    // threads are trying to delete the same atom.  The lock is held
+    // until the atom is either removed or unmarked; add() relies on
+    // this, to wait for the fate of a marked outgoing atom.
     std::unique_lock<std::recursive_mutex> lck(_mtx);
 
-    if (atom->isMarkedForRemoval()) return result;
-    atom->markForRemoval();
+    // Mark under the shard lock; see add() for why.
+    {
+        std::lock_guard<std::mutex> slck(get_shard(atom->get_hash()).mtx);
+        if (atom->isMarkedForRemoval()) return result;
+        atom->markForRemoval();
+    }
 
     // If recursive-flag is set, also extract all the links in the atom's
     // incoming set
@@ -709,29 +1111,39 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
     // lck.lock();
 
     // Decrements the size of the table
-    _size--;
+    {
+        ContentHash ch = atom->get_hash();
+        AtomStoreShard& shard = get_shard(ch);
+        std::lock_guard<std::mutex> slck(shard.mtx);
+        auto range = shard.store.equal_range(ch);
+        auto bkt = range.first;
+        auto end = range.second;
+        for (; bkt != end; bkt++) {
+            if (handle == bkt->second) {
+                shard.store.erase(bkt);
+                _size--;
+                break;
+            }
+        }
+    }
     if (atom->is_node()) _num_nodes--;
     if (atom->is_link()) _num_links--;
-    _size_by_type[atom->_type] --;
-
-    auto range = _atom_store.equal_range(atom->get_hash());
-    auto bkt = range.first;
-    auto end = range.second;
-    for (; bkt != end; bkt++) {
-        if (handle == bkt->second) {
-            _atom_store.erase(bkt);
-            break;
-        }
+    {
+        std::lock_guard<std::recursive_mutex> tlck(typeIndex.get_mutex(atom->_type));
+        _size_by_type[atom->_type] --;
     }
 
     Atom* pat = atom.operator->();
     typeIndex.removeAtom(pat);
+    retire(atom);
 
     if (atom->is_link()) {
         LinkPtr lll(LinkCast(atom));
         for (AtomPtr a : lll->_outgoing) {
             a->remove_atom(lll);
         }
+        if (_classserver.isA(atom->_type, DEFINE_LINK))
+            DefineLink::definitions_changed();
     }
 
     // XXX Setting the atom table causes AVChanged signals to be emitted.
@@ -748,9 +1160,18 @@ AtomPtrSet AtomTable::extract(Handle& handle, bool recursive)
 void AtomTable::typeAdded(Type t)
 {
     std::lock_guard<std::recursive_mutex> lck(_mtx);
+
+    // Resizing moves the per-type counts; block all the type locks.
+    for (size_t i=0; i<FixedIntegerIndex::NUM_LOCK_STRIPES; i++)
+        typeIndex.get_mutex(i).lock();
+
     //resize all Type-based indexes
     size_t new_size = _classserver.getNumberOfClasses();
     _size_by_type.resize(new_size);
+
+    for (size_t i=0; i<FixedIntegerIndex::NUM_LOCK_STRIPES; i++)
+        typeIndex.get_mutex(i).unlock();
+
     typeIndex.resize();
 }
 
@@ -25,20 +25,26 @@
 #ifndef _OPENCOG_ATOMTABLE_H
 #define _OPENCOG_ATOMTABLE_H
 
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 #include <boost/signals2.hpp>
 
 #include <opencog/util/async_method_caller.h>
-#include <opencog/util/oc_omp.h>
 #include <opencog/util/RandGen.h>
 
 #include <opencog/truthvalue/TruthValue.h>
 
 #include <opencog/atoms/base/ClassServer.h>
 
+#include <opencog/atomspace/SigSlot.h>
 #include <opencog/atomspace/TypeIndex.h>
 
 class AtomSpaceUTest;
@@ -52,18 +58,15 @@ namespace opencog
 
 typedef std::set<AtomPtr> AtomPtrSet;
 
-// XXX FIXME boost::signals2 is painfully bloated and slow. It accounts
-// for 5% or 10% of the total performance of the atomspace (try it -
-// comment out the emit-signal functions below, and measure.
-// Alternately, launch gdb, get into the signal, and look at the stack.
-// boost::signals2 uses eleven stack frames to do its thing. Eleven!
-// Really!) Should be enough to use SigSlot in cogutil.  Need to just
-// finish this work.
-typedef boost::signals2::signal<void (const Handle&)> AtomSignal;
-typedef boost::signals2::signal<void (const AtomPtr&)> AtomPtrSignal;
-typedef boost::signals2::signal<void (const Handle&,
-                                      const TruthValuePtr&,
-                                      const TruthValuePtr&)> TVCHSigl;
+// The atom signals are emitted on every add, remove and TV change,
+// so they use the lightweight SigSlot dispatcher, rather than
+// boost::signals2 (which costs 5% to 10% of atomspace throughput).
+// When no one is connected, emitting costs one atomic load.
+typedef SigSlot<const Handle&> AtomSignal;
+typedef SigSlot<const AtomPtr&> AtomPtrSignal;
+typedef SigSlot<const Handle&,
+                const TruthValuePtr&,
+                const TruthValuePtr&> TVCHSigl;
 
 class AtomSpace;
 
@@ -81,31 +84,96 @@ class AtomTable
 private:
     ClassServer& _classserver;
 
-    // Single, global mutex for locking the indexes.
-    // Its recursive because we need to lock twice during atom insertion
-    // and removal: we need to keep the indexes stable while we search
-    // them during add/remove.
+    // Mutex for serializing atom removal, and other structural changes
+    // that touch more than one atom at a time (StateLink swaps,
+    // DeleteLink expansion).  Its recursive because extraction recurses
+    // through the incoming set.  Ordinary insertion and lookup do NOT
+    // take this lock; they use the per-shard and per-type locks below.
+    // extract() holds it from the moment it marks an atom for removal
+    // until the atom is either gone or unmarked; add() waits on it for
+    // a marked outgoing atom.
     mutable std::recursive_mutex _mtx;
 
     // Cached count of the number of atoms in the table.
-    size_t _size;
-    size_t _num_nodes;
-    size_t _num_links;
+    std::atomic<size_t> _size;
+    std::atomic<size_t> _num_nodes;
+    std::atomic<size_t> _num_links;
 
-    // Cached count of the number of atoms of each type.
+    // Cached count of the number of atoms of each type. Each entry
+    // is guarded by the typeIndex lock for that type.
     std::vector<size_t> _size_by_type;
 
     // Index of all the atoms in the table, addressible by thier hash.
-    std::unordered_multimap<ContentHash, Handle> _atom_store;
+    // The index is split into shards, each with its own lock, so that
+    // inserts and lookups of unrelated atoms proceed in parallel.
+    // A shard lock is never held while calling out of the table, so
+    // it can be a plain (non-recursive) mutex. The lock order is
+    // _mtx, then the shards (in address order), then the type index
+    // stripes, then the incoming set of a single atom.
+    struct AtomStoreShard
+    {
+        std::mutex mtx;
+        std::unordered_multimap<ContentHash, Handle> store;
+    };
+    static const size_t NUM_STORE_SHARDS = 64;
+    mutable AtomStoreShard _atom_store[NUM_STORE_SHARDS];
+
+    AtomStoreShard& get_shard(ContentHash ch) const
+    {
+        // Mix in the high bits; Link hashes are not well-distributed
+        // in the low bits.
+        return _atom_store[(ch ^ (ch >> 29)) % NUM_STORE_SHARDS];
+    }
+
+    Handle lookup(const AtomPtr&) const;
 
     //!@{
     //! Index for quick retrieval of certain kinds of atoms.
     TypeIndex typeIndex;
 
-    async_caller<AtomTable, AtomPtr> _index_queue;
+    // Worker threads for the async add path.  These are started
+    // only on the first async add, so that tables that never use
+    // async (e.g. scratch spaces) don't carry idle threads around.
+    std::unique_ptr<async_caller<AtomTable, AtomPtr>> _index_queue;
+    std::once_flag _index_queue_started;
     void put_atom_into_index(const AtomPtr&);
+    void async_index(const AtomPtr&);
     //!@}
 
+    // Parallel scans work on a snapshot of raw atom pointers. While
+    // any scan is running, extracted atoms are parked in _retired, so
+    // that the pointers in every snapshot stay valid.  Each scan is
+    // numbered as it starts, and each retired atom is tagged with the
+    // number of the latest scan at the time; only scans with that
+    // number or lower can hold it.  So, when a scan finishes, the
+    // atoms retired before the oldest scan still running started are
+    // let go, even if other scans keep overlapping.  All of this is
+    // only changed while holding _retire_mtx; _active_scans mirrors
+    // the size of _live_scans, for a quick check without the lock.
+    mutable std::atomic<size_t> _active_scans;
+    mutable std::mutex _retire_mtx;
+    mutable size_t _scan_epoch;
+    mutable std::set<size_t> _live_scans;
+    mutable std::deque<std::pair<size_t, AtomPtr>> _retired;
+    void retire(const AtomPtr&);
+
+    class ScanSnapshot
+    {
+        const AtomTable& _table;
+        size_t _epoch;
+        std::vector<Atom*> _atoms;
+    public:
+        ScanSnapshot(const AtomTable&, Type, bool subclass);
+        ~ScanSnapshot();
+        const std::vector<Atom*>& atoms(void) const { return _atoms; }
+    };
+
+    // Split [0, n) into chunks, and run `chunk` on them from
+    // `nthreads` threads (zero means one per core).  Rethrows the
+    // first exception thrown by any chunk.
+    static void run_chunks(size_t n, unsigned nthreads,
+                           const std::function<void(size_t, size_t)>& chunk);
+
     /**
      * signal connection used to find out about atom type additions in the
      * ClassServer
@@ -199,6 +267,27 @@ public:
     size_t getNumLinks() const;
     size_t getNumAtomsOfType(Type type, bool subclass=true) const;
 
+    /**
+     * Diagnostics for the content-hash index: how many atoms share a
+     * hash (each such lookup ends in a deep equality check), and how
+     * evenly the atoms are spread over the hash buckets.
+     */
+    struct HashStats
+    {
+        size_t atoms;          // atoms in the index
+        size_t distinct;       // distinct content hashes
+        size_t collisions;     // atoms that share their hash with another
+        size_t max_same_hash;  // most atoms with one and the same hash
+        size_t buckets;        // hash buckets, over all shards
+        size_t max_bucket;     // atoms in the fullest bucket
+
+        // bucket_sizes[i] is the number of buckets holding i atoms;
+        // the last entry counts all the larger buckets.
+        std::vector<size_t> bucket_sizes;
+    };
+    HashStats getHashStats(void) const;
+    void printHashStats(void) const;
+
     /**
      * Returns the exact atom for the given name and type.
      * Note: Type must inherit from NODE. Otherwise, it returns
@@ -230,12 +319,13 @@ public:
                      bool subclass=false,
                      bool parent=true) const
     {
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
         if (parent && _environ)
-            _environ->getHandlesByType(result, type, subclass, parent);
-        return std::copy(typeIndex.begin(type, subclass),
-                         typeIndex.end(),
-                         result);
+            result = _environ->getHandlesByType(result, type, subclass, parent);
+        typeIndex.foreach_set(
+             [&](const AtomSet& s)->void {
+                  for (Atom* a : s) { *result = a->get_handle(); ++result; }
+             }, type, subclass);
+        return result;
     }
 
     /** Calls function 'func' on all atoms */
@@ -245,39 +335,113 @@ public:
                         bool subclass=false,
                         bool parent=true) const
     {
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
         if (parent && _environ)
             _environ->foreachHandleByType(func, type, subclass);
-        std::for_each(typeIndex.begin(type, subclass),
-                      typeIndex.end(),
-             [&](const Handle& h)->void {
-                  (func)(h);
-             });
+        // The callback runs without any index lock held; it is
+        // allowed to add and remove atoms, of any type.
+        typeIndex.foreach_atom(
+             [&](const Handle& h)->void { (func)(h); }, type, subclass);
     }
 
+    /**
+     * Calls function 'func' on all atoms of the given type, from
+     * several threads at once.
+     *
+     * The scan works on a snapshot of the type index: the index is
+     * copied (one short lock per type), and then split into chunks,
+     * which the worker threads claim one at a time, so that fast
+     * threads pick up the slack of slow ones.  No locks are held
+     * while 'func' runs, so other threads may add and remove atoms
+     * during the scan.  Atoms added during the scan are not visited;
+     * atoms removed during the scan may or may not be visited, but
+     * are kept alive until the scan finishes.
+     *
+     * This does not use OpenMP, so it can be called from inside an
+     * OpenMP loop, and it does not change the OpenMP settings.
+     *
+     * @param nthreads How many threads to use; zero means one per core.
+     */
     template <typename Function> void
     foreachParallelByType(Function func,
                         Type type,
                         bool subclass=false,
-                        bool parent=true) const
+                        bool parent=true,
+                        unsigned nthreads=0) const
     {
-        std::lock_guard<std::recursive_mutex> lck(_mtx);
         if (parent && _environ)
-            _environ->foreachParallelByType(func, type, subclass);
-
-        // Parallelize, always, no matter what!
-        opencog::setting_omp(opencog::num_threads(), 1);
-
-        OMP_ALGO::for_each(typeIndex.begin(type, subclass),
-                      typeIndex.end(),
-             [&](const Handle& h)->void {
-                  (func)(h);
+            _environ->foreachParallelByType(func, type, subclass,
+                                            parent, nthreads);
+
+        ScanSnapshot snap(*this, type, subclass);
+        const std::vector<Atom*>& atoms = snap.atoms();
+        run_chunks(atoms.size(), nthreads,
+             [&](size_t begin, size_t end)->void {
+                  for (size_t i = begin; i < end; i++)
+                  {
+                      Atom* a = atoms[i];
+                      if (a->isMarkedForRemoval()) continue;
+                      (func)(a->get_handle());
+                  }
              });
-
-        // Reset to default.
-        opencog::setting_omp(opencog::num_threads());
     }
 
+    /**
+     * Walks over all atoms of the given type, a chunk at a time, so
+     * that the caller can stop early, and so that huge types are
+     * never copied out of the index in one go.  Only a small, fixed
+     * number of handles is held at any time, and each chunk is copied
+     * under a short lock, so other threads may add and remove atoms
+     * during the walk.
+     *
+     * The walk covers the atoms that were in the table when the
+     * cursor was made.  Atoms added after that are not visited, and
+     * atoms removed before being reached are skipped.  Every other
+     * atom is visited exactly once: the cursor registers its position
+     * in each type with the type index, which keeps the atoms not yet
+     * visited below it when others are removed.
+     *
+     * As with getHandlesByType(), atoms in the parent environments
+     * are visited first.
+     *
+     * Example:
+     * @code
+     *     AtomTable::TypeCursor cur(table, LINK, true);
+     *     Handle h;
+     *     while (cur.next(h)) { ... }
+     * @endcode
+     */
+    class TypeCursor
+    {
+        // Handles held at a time.
+        static const size_t CHUNK = 256;
+
+        // One type in one table; pos is registered with the type
+        // index, and so must not move until the walk is done.
+        struct Walk
+        {
+            const AtomTable* table;
+            Type type;
+            size_t pos;
+        };
+        std::vector<Walk> _walks;
+        size_t _curwalk;
+        HandleSeq _chunk;
+        size_t _next;
+
+        bool refill(void);
+        void end_walks(void);
+    public:
+        TypeCursor(const AtomTable&, Type, bool subclass=false,
+                   bool parent=true);
+        TypeCursor(TypeCursor&&);
+        TypeCursor(const TypeCursor&) = delete;
+        TypeCursor& operator=(const TypeCursor&) = delete;
+        ~TypeCursor();
+
+        /// Fetch the next atom; return false when there are no more.
+        bool next(Handle&);
+    };
+
     /* Exposes the type iterators so we can do more complicated
      * looping without having to create a vector to hold the handles.
      *
@@ -296,17 +460,16 @@ public:
      * two are merged (how, exactly? Is this done corrrectly!?)
      *
      * If the async flag is set, then the atom addition is performed
-     * asynchronously; the atom might not be fully added by the time
-     * this method returns, although it will get added eventually.
-     * Async addition can improve the multi-threaded performance of
-     * lots of parallel adds.  The barrier() method can be used to
-     * force synchronization.
-     *
-     * XXX The async code path doesn't really do anything yet, since
-     * it also uses the big global lock, at the moment.  This needs
-     * fixing, mostly be creating a second mutex for the atom insertion,
-     * and also giving each index its own unique mutex, to avoid
-     * collisions.  So the API is here, but more work is still needed.
+     * asynchronously: this method returns as soon as the atom has
+     * been de-duplicated and placed in the hash index, so that
+     * getHandle() will find it, and the returned handle is final.
+     * Placing the atom into the incoming sets of its outgoing atoms,
+     * into the type index, and emitting the atom-added signal are
+     * done later, by worker threads.  Async addition can improve the
+     * multi-threaded performance of lots of parallel adds, since hub
+     * atoms with large incoming sets are no longer touched in the
+     * caller's thread.  The barrier() method can be used to force
+     * synchronization.
      *
      * @param The new atom to be added.
      * @return The handle of the newly added atom.
@@ -316,7 +479,10 @@ public:
     /**
      * Read-write synchronization barrier fence.  When called, this
      * will not return until all the atoms previously added to the
-     * atomspace have been fully inserted.
+     * atomspace have been fully inserted, i.e. are in all incoming
+     * sets and indexes, and their added-signals have been delivered.
+     * Signal listeners connected in batched mode are handed whatever
+     * is left in their partially-filled batches.
      */
     void barrier(void);
 
@@ -26,16 +26,21 @@ using namespace opencog;
 size_t FixedIntegerIndex::size(void) const
 {
 	size_t cnt = 0;
-	for (const auto& s : idx)
-		cnt += s.size();
+	size_t nbins = idx.size();
+	for (size_t i = 0; i < nbins; i++)
+		cnt += size(i);
 	return cnt;
 }
 
 bool FixedIntegerIndex::contains_duplicate() const
 {
-	for (const AtomSet& atoms : idx)
-		if (contains_duplicate(atoms))
+	size_t nbins = idx.size();
+	for (size_t i = 0; i < nbins; i++)
+	{
+		std::lock_guard<std::recursive_mutex> lck(get_mutex(i));
+		if (contains_duplicate(idx[i]))
 			return true;
+	}
 	return false;
 }
 
@@ -22,6 +22,8 @@
 #ifndef _OPENCOG_FIXEDINTEGERINDEX_H
 #define _OPENCOG_FIXEDINTEGERINDEX_H
 
+#include <algorithm>
+#include <mutex>
 #include <vector>
 
 #include <opencog/util/Logger.h>
@@ -37,49 +39,125 @@ namespace opencog
  *  @{
  */
 
-typedef std::unordered_set<Atom*> UnorderedAtomSet;
-
-// This is possibly very costly and only used to get deterministic
-// behavior
-typedef std::set<Atom*, content_based_atom_ptr_less> ContentBasedOrderedAtomSet;
-
-#ifdef REPRODUCIBLE_ATOMSPACE
-typedef ContentBasedOrderedAtomSet AtomSet;
-#else
-typedef UnorderedAtomSet AtomSet;
-#endif
+// The atoms of one type, packed densely, so that scans are sequential
+// and can be split into chunks for parallel work.  The position of an
+// atom in this vector is stored on the atom (Atom::_index_slot), so
+// that removal is O(1): the last atom is swapped into the hole.
+//
+// The order is the order of insertion, modulo removals; it does not
+// depend on memory addresses, so a deterministic program sees a
+// deterministic scan order.
+typedef std::vector<Atom*> AtomSet;
 
 /**
  * Implements a vector of atom sets; each set can be found via an
- * integer index.
+ * integer index.  An atom may be in at most one set of one index at
+ * a time, since its position in the set is recorded on the atom.
  */
 class FixedIntegerIndex
 {
 	friend class ::AtomSpaceUTest;
 
+public:
+	// Number of lock stripes. Each index bin is guarded by the lock
+	// at (bin % NUM_LOCK_STRIPES), so that inserts and removes into
+	// different bins can proceed in parallel. The locks are recursive,
+	// because callbacks run during a scan may add atoms of the same
+	// type.
+	static const size_t NUM_LOCK_STRIPES = 64;
+
 protected:
 	std::vector<AtomSet> idx;
+	mutable std::recursive_mutex _locks[NUM_LOCK_STRIPES];
+
+	// The positions of the cursors walking each bin, from the back
+	// towards the front. Below the position are the atoms that the
+	// cursor has yet to visit; see remove(). Guarded by the same lock
+	// stripe as the bin.
+	mutable std::vector<std::vector<size_t*>> _cursors;
+
 	void resize(size_t sz)
 	{
+		// Resizing can move every bin; nothing else may be touching
+		// the index while this happens.
+		for (size_t i=0; i<NUM_LOCK_STRIPES; i++) _locks[i].lock();
 		idx.resize(sz);
+		_cursors.resize(sz);
+		for (size_t i=0; i<NUM_LOCK_STRIPES; i++) _locks[i].unlock();
 	}
 
 public:
 	~FixedIntegerIndex() {}
+
+	/// Return the lock guarding the i'th bin.
+	std::recursive_mutex& get_mutex(size_t i) const
+	{
+		return _locks[i % NUM_LOCK_STRIPES];
+	}
+
 	void insert(size_t i, Atom* a)
 	{
+		std::lock_guard<std::recursive_mutex> lck(get_mutex(i));
 		AtomSet& s(idx.at(i));
-		s.insert(a);
+		a->_index_slot = s.size();
+		s.push_back(a);
 	}
 
 	void remove(size_t i, Atom* a)
 	{
+		std::lock_guard<std::recursive_mutex> lck(get_mutex(i));
 		AtomSet &s = idx.at(i);
-		s.erase(a);
+
+		// Not in this set; nothing to do.
+		size_t slot = a->_index_slot;
+		if (s.size() <= slot or s[slot] != a) return;
+
+		// Fill the hole with the last atom not yet visited by each
+		// cursor that has yet to reach it, nearest cursor first, so
+		// that the unvisited atoms stay below each position. Then the
+		// last atom in the bin fills the final hole. Thus, no cursor
+		// skips an atom, or sees one twice.
+		std::vector<size_t*>& curs = _cursors[i];
+		if (not curs.empty())
+			std::sort(curs.begin(), curs.end(),
+			          [](size_t* a, size_t* b) { return *a < *b; });
+		for (size_t* pos : curs)
+		{
+			if (*pos <= slot) continue;
+			size_t below = --*pos;
+			if (below == slot) continue;
+			s[slot] = s[below];
+			s[slot]->_index_slot = slot;
+			slot = below;
+		}
+
+		Atom* last = s.back();
+		s[slot] = last;
+		last->_index_slot = slot;
+		s.pop_back();
+	}
+
+	/// Start a cursor on the i'th bin, at its current end; it will
+	/// visit only the atoms already in the bin. The position is moved
+	/// down by remove(), and must stay at the same address until
+	/// end_cursor() is called.
+	void begin_cursor(size_t i, size_t* pos) const
+	{
+		std::lock_guard<std::recursive_mutex> lck(get_mutex(i));
+		*pos = idx.at(i).size();
+		_cursors[i].push_back(pos);
+	}
+
+	void end_cursor(size_t i, size_t* pos) const
+	{
+		std::lock_guard<std::recursive_mutex> lck(get_mutex(i));
+		std::vector<size_t*>& curs = _cursors[i];
+		curs.erase(std::remove(curs.begin(), curs.end(), pos), curs.end());
 	}
 
 	size_t size(size_t i) const
 	{
+		std::lock_guard<std::recursive_mutex> lck(get_mutex(i));
 		const AtomSet& s(idx.at(i));
 		return s.size();
 	}
@@ -0,0 +1,264 @@
+/*
+ * opencog/atomspace/SigSlot.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SIGSLOT_H
+#define _OPENCOG_SIGSLOT_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace opencog
+{
+/** \addtogroup grp_atomspace
+ *  @{
+ */
+
+/**
+ * A minimal signal/slot dispatcher, used for the AtomTable signals.
+ *
+ * This replaces boost::signals2, which costs 5% to 10% of atomspace
+ * throughput. Emitting with no subscribers is a single relaxed atomic
+ * load. Emitting with subscribers walks an immutable, copy-on-write
+ * list of slots, without taking any locks.  Connecting and
+ * disconnecting are rare, and are serialized with a mutex.
+ *
+ * Because emitters walk a snapshot of the slot list, a slot may still
+ * be called once by a concurrent emitter, after it was disconnected.
+ *
+ * Slots can also be connected in batched mode: the events are copied
+ * into a per-slot buffer, and delivered as a vector, either when the
+ * buffer fills up, or when flush() is called.  This is intended for
+ * listeners (e.g. storage backends) that do better with groups of
+ * changes than with one callback per atom.
+ */
+class SignalConnection
+{
+public:
+    // Type-erased interface to the signal, so that connections
+    // don't need to know the signal arguments.
+    struct Disconnector
+    {
+        virtual ~Disconnector() {}
+        virtual void disconnect(size_t) = 0;
+        virtual bool connected(size_t) = 0;
+    };
+
+private:
+    std::weak_ptr<Disconnector> _sig;
+    size_t _id;
+
+public:
+    SignalConnection(void) : _id(0) {}
+    SignalConnection(const std::weak_ptr<Disconnector>& sig, size_t id)
+        : _sig(sig), _id(id) {}
+
+    /// Stop delivery to this slot. Safe to call more than once,
+    /// and safe to call after the signal itself is gone.
+    void disconnect(void)
+    {
+        std::shared_ptr<Disconnector> sig(_sig.lock());
+        if (sig) sig->disconnect(_id);
+        _sig.reset();
+    }
+
+    bool connected(void) const
+    {
+        std::shared_ptr<Disconnector> sig(_sig.lock());
+        return sig and sig->connected(_id);
+    }
+};
+
+template <typename... Args>
+class SigSlot
+{
+public:
+    typedef std::function<void(Args...)> slot_type;
+    typedef std::tuple<typename std::decay<Args>::type...> event_type;
+    typedef std::vector<event_type> batch_type;
+    typedef std::function<void(const batch_type&)> batch_slot_type;
+
+private:
+    struct Slot
+    {
+        size_t id;
+        slot_type func;
+
+        // Batched delivery; used only if func is empty.
+        batch_slot_type batch_func;
+        size_t batch_size;
+        std::mutex mtx;
+        batch_type pending;
+
+        // Hand over the pending events, if any.
+        void deliver(void)
+        {
+            batch_type ready;
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                ready.swap(pending);
+            }
+            if (0 < ready.size()) batch_func(ready);
+        }
+    };
+    typedef std::shared_ptr<Slot> SlotPtr;
+    typedef std::vector<SlotPtr> SlotList;
+
+    struct Impl : public SignalConnection::Disconnector,
+                  public std::enable_shared_from_this<Impl>
+    {
+        // Copy-on-write; read with std::atomic_load().
+        std::shared_ptr<const SlotList> slots;
+        std::atomic<size_t> nslots;
+        std::mutex mtx;
+        size_t next_id;
+
+        Impl(void) : slots(std::make_shared<SlotList>()),
+                     nslots(0), next_id(1) {}
+
+        SignalConnection add(const SlotPtr& s)
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            s->id = next_id++;
+            std::shared_ptr<SlotList> nl(std::make_shared<SlotList>(*slots));
+            nl->push_back(s);
+            std::atomic_store(&slots, std::shared_ptr<const SlotList>(nl));
+            nslots = nl->size();
+            return SignalConnection(std::weak_ptr<Disconnector>(
+                std::static_pointer_cast<Disconnector>(
+                    this->shared_from_this())), s->id);
+        }
+
+        void disconnect(size_t id)
+        {
+            SlotPtr gone;
+            {
+                std::lock_guard<std::mutex> lck(mtx);
+                std::shared_ptr<SlotList> nl(std::make_shared<SlotList>());
+                for (const SlotPtr& s : *slots)
+                {
+                    if (s->id == id) gone = s;
+                    else nl->push_back(s);
+                }
+                if (nullptr == gone) return;
+                std::atomic_store(&slots, std::shared_ptr<const SlotList>(nl));
+                nslots = nl->size();
+            }
+
+            // Don't lose events that were already buffered.
+            if (not gone->func) gone->deliver();
+        }
+
+        bool connected(size_t id)
+        {
+            std::shared_ptr<const SlotList> sl(std::atomic_load(&slots));
+            for (const SlotPtr& s : *sl)
+                if (s->id == id) return true;
+            return false;
+        }
+    };
+
+    std::shared_ptr<Impl> _impl;
+
+    SigSlot(const SigSlot&) = delete;
+    SigSlot& operator=(const SigSlot&) = delete;
+
+public:
+    SigSlot(void) : _impl(std::make_shared<Impl>()) {}
+
+    /// Return true if nothing is listening. Emitters can use this
+    /// to avoid computing the signal arguments.
+    bool empty(void) const
+    {
+        return 0 == _impl->nslots.load(std::memory_order_relaxed);
+    }
+
+    /// Call `func` on every emit.
+    SignalConnection connect(const slot_type& func)
+    {
+        SlotPtr s(std::make_shared<Slot>());
+        s->func = func;
+        s->batch_size = 0;
+        return _impl->add(s);
+    }
+
+    /// Call `func` with groups of (up to) `batch_size` events.
+    /// Remaining events are delivered by flush().
+    SignalConnection connect_batched(const batch_slot_type& func,
+                                     size_t batch_size)
+    {
+        SlotPtr s(std::make_shared<Slot>());
+        s->batch_func = func;
+        s->batch_size = (0 < batch_size) ? batch_size : 1;
+        return _impl->add(s);
+    }
+
+    /// Emit the signal.
+    void operator()(Args... args) const
+    {
+        if (empty()) return;
+
+        std::shared_ptr<const SlotList> sl(std::atomic_load(&_impl->slots));
+        for (const SlotPtr& s : *sl)
+        {
+            if (s->func)
+            {
+                s->func(args...);
+                continue;
+            }
+
+            batch_type ready;
+            {
+                std::lock_guard<std::mutex> lck(s->mtx);
+                s->pending.emplace_back(args...);
+                if (s->pending.size() < s->batch_size) continue;
+                ready.swap(s->pending);
+            }
+            s->batch_func(ready);
+        }
+    }
+
+    /// Deliver all partially-filled batches.
+    void flush(void)
+    {
+        if (empty()) return;
+
+        std::shared_ptr<const SlotList> sl(std::atomic_load(&_impl->slots));
+        for (const SlotPtr& s : *sl)
+            if (not s->func) s->deliver();
+    }
+
+    /// Number of connected slots.
+    size_t num_slots(void) const
+    {
+        return _impl->nslots.load(std::memory_order_relaxed);
+    }
+};
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_SIGSLOT_H
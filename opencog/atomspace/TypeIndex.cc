@@ -38,6 +38,27 @@ void TypeIndex::resize(void)
 
 // ================================================================
 
+void TypeIndex::copy_chunk(Type t, size_t& pos, HandleSeq& chunk,
+                           size_t max) const
+{
+	std::lock_guard<std::recursive_mutex> lck(get_mutex(t));
+	const AtomSet& s(idx[t]);
+
+	size_t stop = pos < max ? 0 : pos - max;
+	while (stop < pos)
+		chunk.emplace_back(s[--pos]->get_handle());
+}
+
+Type TypeIndex::next_type(Type t, Type cur, bool subclass) const
+{
+	if (not subclass) return num_types;
+	for (cur++; cur < num_types; cur++)
+		if (classserver().isA(cur, t)) return cur;
+	return num_types;
+}
+
+// ================================================================
+
 TypeIndex::iterator TypeIndex::begin(Type t, bool sub) const
 {
 	iterator it(t, sub);
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atoms/base/types.h>
 #include <opencog/atomspace/FixedIntegerIndex.h>
@@ -37,8 +38,9 @@ namespace opencog
  */
 
 /**
- * Implements an integer index as an RB-tree (C++ set) That is, given
- * an atom Type, this returns all of the Handles for that Type.
+ * Implements an integer index as a set of dense vectors, one per type.
+ * That is, given an atom Type, this returns all of the Handles for that
+ * Type.  Scanning a type walks a contiguous array of atom pointers.
  *
  * The primary interface for this is an iterator, and that is because
  * the index will typically contain millions of atoms, and this is far
@@ -46,8 +48,9 @@ namespace opencog
  * faster.
  *
  * @todo The iterator is NOT thread-safe against the insertion or
- * removal of atoms!  Either inserting or removing an atom will cause
- * the iterator references to be freed, leading to mystery crashes!
+ * removal of atoms!  Inserting an atom may reallocate the vector, and
+ * removing one moves another atom into its place, leading to mystery
+ * crashes or skipped atoms!  Use foreach_set() instead.
  */
 class TypeIndex : public FixedIntegerIndex
 {
@@ -65,6 +68,82 @@ class TypeIndex : public FixedIntegerIndex
 			remove(a->get_type(), a);
 		}
 
+		/**
+		 * Call `func` on the AtomSet of type `t`, and, if `subclass`
+		 * is set, on the sets of all subtypes of `t`.  Each set is
+		 * visited while holding its lock stripe. Thus, `func` must
+		 * only read the set: it must not add or remove atoms, nor
+		 * take any other AtomTable lock, since the lock order is
+		 * AtomTable::_mtx, then the hash shards, then the stripes.
+		 * Use foreach_atom() to run arbitrary code on each atom.
+		 */
+		template <typename SetFunction>
+		void foreach_set(SetFunction func, Type t, bool subclass) const
+		{
+			// A subclass of t is NEVER smaller than t.
+			// Thus, we can start our search there.
+			for (Type it = t; it < num_types; it++)
+			{
+				if (it != t)
+				{
+					if (not subclass) break;
+					if (not classserver().isA(it, t)) continue;
+				}
+				std::lock_guard<std::recursive_mutex> lck(get_mutex(it));
+				func(idx[it]);
+			}
+		}
+
+		/**
+		 * Call `func` on each atom of type `t`, and, if `subclass`
+		 * is set, of all subtypes of `t`.  The atoms of each type
+		 * are copied out under the lock stripe, and `func` is called
+		 * after it is released, so that `func` is free to add or
+		 * remove atoms, or to take other locks. Atoms added during
+		 * the walk may or may not be seen; atoms removed during the
+		 * walk may still be passed to `func`.
+		 */
+		template <typename Function>
+		void foreach_atom(Function func, Type t, bool subclass) const
+		{
+			HandleSeq copy;
+			for (Type it = t; it < num_types; it++)
+			{
+				if (it != t)
+				{
+					if (not subclass) break;
+					if (not classserver().isA(it, t)) continue;
+				}
+				copy.clear();
+				{
+					std::lock_guard<std::recursive_mutex> lck(get_mutex(it));
+					copy.reserve(idx[it].size());
+					for (Atom* a : idx[it])
+						copy.emplace_back(a->get_handle());
+				}
+				for (const Handle& h : copy) func(h);
+			}
+		}
+
+		/**
+		 * Copy up to `max` atoms of type `t` into `chunk`, going
+		 * from the back of the set towards the front; `pos` is the
+		 * number of atoms at the front not yet copied, and is moved
+		 * down past the ones copied. `pos` must have been registered
+		 * with begin_cursor(), so that removals between chunks keep
+		 * the atoms not yet copied below it.
+		 */
+		void copy_chunk(Type t, size_t& pos, HandleSeq& chunk,
+		                size_t max) const;
+
+		/**
+		 * Return the first type after `cur` that is `t`, or, if
+		 * `subclass` is set, a subtype of `t`. Returns the number of
+		 * types, when there are no more.
+		 */
+		Type next_type(Type t, Type cur, bool subclass) const;
+		Type get_num_types(void) const { return num_types; }
+
 		class iterator
 			: public HandleIterator
 		{
@@ -32,6 +32,7 @@
 
 #include <boost/signals2.hpp>
 
+#include <opencog/atomspace/SigSlot.h>
 #include <opencog/truthvalue/AttentionValue.h>
 #include <opencog/attentionbank/ImportanceIndex.h>
 
@@ -71,7 +72,7 @@ class AttentionBank
     /** AV changes */
     void AVChanged(const Handle&, const AttentionValuePtr&, const AttentionValuePtr&);
 
-    boost::signals2::connection _removeAtomConnection;
+    SignalConnection _removeAtomConnection;
 
     /**
      * Signal emitted when an atom crosses in or out of the
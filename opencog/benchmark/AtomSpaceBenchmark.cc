@@ -1,9 +1,12 @@
 
 /** AtomSpaceBenchmark.cc */
 
+#include <atomic>
+#include <cmath>
 #include <ctime>
 #include <iostream>
 #include <fstream>
+#include <thread>
 #include <sys/time.h>
 #include <sys/resource.h>
 
@@ -13,6 +16,8 @@
 #include <opencog/util/random.h>
 
 #include <opencog/atoms/base/types.h>
+#include <opencog/atoms/base/AtomPool.h>
+#include <opencog/atoms/base/FloatValue.h>
 #include <opencog/atoms/base/Node.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/truthvalue/AttentionValue.h>
@@ -60,10 +65,16 @@ AtomSpaceBenchmark::AtomSpaceBenchmark()
 
     counter = 0;
     showTypeSizes = false;
+    showHashStats = false;
     baseNclock = 2000;
     baseNreps = 200 * baseNclock;
     baseNloops = 1;
     Nreserve = 0;
+    maxThreads = 0;
+    asyncAdd = false;
+    numListeners = 0;
+    concurrentWriter = false;
+    powerLaw = false;
 
     memoize = false;
     compile = false;
@@ -88,6 +99,21 @@ AtomSpaceBenchmark::~AtomSpaceBenchmark()
     delete randomGenerator;
 }
 
+// Bytes taken by an atom object, as allocated by createNode() and
+// createLink(). The shared_ptr control block (a vtable pointer and two
+// counts) is allocated in the same block, and the AtomPool rounds the
+// block up to its size class.
+template <typename T>
+static size_t pooled_size(void)
+{
+    size_t sz = sizeof(T) + sizeof(void*) + 2*sizeof(int);
+#ifdef USE_ATOM_POOL
+    return AtomPool::block_size(sz);
+#else
+    return sz;
+#endif
+}
+
 // This is wrong, because it fails to count also the amount of RAM
 // used by the AtomTable to store indexes, as well as the AttentionBank
 // to store the AttentionValues.
@@ -110,13 +136,13 @@ size_t AtomSpaceBenchmark::estimateOfAtomSize(Handle h)
     NodePtr n(NodeCast(h));
     if (n)
     {
-        total = sizeof(Node);
+        total += pooled_size<Node>();
         total += n->get_name().capacity();
     }
     else
     {
         LinkPtr l(LinkCast(h));
-        total = sizeof(Link);
+        total += pooled_size<Link>();
         total += l->getOutgoingSet().capacity() * sizeof(Handle);
         for (Handle ho: l->getOutgoingSet())
         {
@@ -183,6 +209,31 @@ void AtomSpaceBenchmark::printTypeSizes()
     Handle el = LK(EVALUATION_LINK, np, ll);
     cout << "EvaluationLink with two ConceptNodes = "
          << estimateOfAtomSize(el) << endl;
+    cout << DIVIDER_LINE << endl;
+
+    // Measure what the atom objects really cost, by filling a scratch
+    // atomspace. This still leaves out the indexes and the names.
+    const size_t natoms = 100000;
+    size_t before = AtomPool::bytes_in_use();
+    {
+        AtomSpace scratch;
+        Handle prev = scratch.add_node(CONCEPT_NODE, "scratch");
+        for (size_t i = 0; i < natoms; i++)
+        {
+            Handle nd = scratch.add_node(CONCEPT_NODE, std::to_string(i));
+            prev = scratch.add_link(LIST_LINK, nd, prev);
+        }
+        size_t used = AtomPool::bytes_in_use() - before;
+        cout << "Atom pool bytes per atom (ConceptNode) = "
+             << pooled_size<Node>() << endl;
+        cout << "Atom pool bytes per atom (ListLink) = "
+             << pooled_size<Link>() << endl;
+        cout << "Atom pool bytes per atom (measured, " << 2*natoms
+             << " atoms) = " << used / (2*natoms) << endl;
+    }
+    cout << "Atom pool total: " << AtomPool::bytes_in_use()
+         << " bytes in use, " << AtomPool::bytes_reserved()
+         << " bytes reserved" << endl;
 }
 
 void AtomSpaceBenchmark::showMethods()
@@ -190,17 +241,24 @@ void AtomSpaceBenchmark::showMethods()
     /// @todo should really encapsulate each test method in a struct or class
     cout << "Methods that can be tested:" << endl;
     cout << "  getType" << endl;
+    cout << "  isA" << endl;
     cout << "  getTruthValue" << endl;
     cout << "  setTruthValue" << endl;
+    cout << "  getValue" << endl;
 #ifdef ZMQ_EXPERIMENT
     cout << "  getTruthValueZMQ" << endl;
 #endif
     cout << "  getOutgoingSet" << endl;
     cout << "  getIncomingSet" << endl;
+    cout << "  getIncomingSetByType" << endl;
     cout << "  addNode" << endl;
     cout << "  addLink" << endl;
     cout << "  removeAtom" << endl;
     cout << "  getHandlesByType" << endl;
+    cout << "  foreachHandleByType" << endl;
+    cout << "  foreachParallelByType" << endl;
+    cout << "  getHandle" << endl;
+    cout << "  reAdd" << endl;
     cout << "  push_back" << endl;
     cout << "  emplace_back" << endl;
     cout << "  reserve" << endl;
@@ -221,6 +279,12 @@ void AtomSpaceBenchmark::setMethod(std::string methodToTest)
         foundMethod = true;
     }
 
+    if (methodToTest == "all" or methodToTest == "isA") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_isA);
+        methodNames.push_back("isA");
+        foundMethod = true;
+    }
+
     if (methodToTest == "all" or methodToTest == "getTruthValue") {
         methodsToTest.push_back( &AtomSpaceBenchmark::bm_getTruthValue);
         methodNames.push_back("getTruthValue");
@@ -241,6 +305,12 @@ void AtomSpaceBenchmark::setMethod(std::string methodToTest)
         foundMethod = true;
     }
 
+    if (methodToTest == "all" or methodToTest == "getValue") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_getValue);
+        methodNames.push_back("getValue");
+        foundMethod = true;
+    }
+
     if (methodToTest == "all" or methodToTest == "pointerCast") {
         methodsToTest.push_back( &AtomSpaceBenchmark::bm_pointerCast);
         methodNames.push_back("pointerCast");
@@ -253,6 +323,12 @@ void AtomSpaceBenchmark::setMethod(std::string methodToTest)
         foundMethod = true;
     }
 
+    if (methodToTest == "all" or methodToTest == "getIncomingSetByType") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_getIncomingSetByType);
+        methodNames.push_back("getIncomingSetByType");
+        foundMethod = true;
+    }
+
     if (methodToTest == "all" or methodToTest == "getOutgoingSet") {
         methodsToTest.push_back( &AtomSpaceBenchmark::bm_getOutgoingSet);
         methodNames.push_back("getOutgoingSet");
@@ -283,6 +359,30 @@ void AtomSpaceBenchmark::setMethod(std::string methodToTest)
         foundMethod = true;
     }
 
+    if (methodToTest == "all" or methodToTest == "foreachHandleByType") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_foreachHandleByType);
+        methodNames.push_back("foreachHandleByType");
+        foundMethod = true;
+    }
+
+    if (methodToTest == "all" or methodToTest == "foreachParallelByType") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_foreachParallelByType);
+        methodNames.push_back("foreachParallelByType");
+        foundMethod = true;
+    }
+
+    if (methodToTest == "all" or methodToTest == "getHandle") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_getHandle);
+        methodNames.push_back("getHandle");
+        foundMethod = true;
+    }
+
+    if (methodToTest == "all" or methodToTest == "reAdd") {
+        methodsToTest.push_back( &AtomSpaceBenchmark::bm_reAdd);
+        methodNames.push_back("reAdd");
+        foundMethod = true;
+    }
+
     if (methodToTest == "all" or methodToTest == "push_back") {
         methodsToTest.push_back( &AtomSpaceBenchmark::bm_push_back);
         methodNames.push_back("push_back");
@@ -345,6 +445,18 @@ void AtomSpaceBenchmark::doBenchmark(const std::string& methodName,
             Nreps = asz / (4*Nclock*Nloops/3);
     }
 
+    // A full scan is one operation; scanning the whole atomspace
+    // Nclock times per rep would take forever.
+    bool isScan = (methodToCall == &AtomSpaceBenchmark::bm_foreachHandleByType or
+                   methodToCall == &AtomSpaceBenchmark::bm_foreachParallelByType);
+    if (isScan)
+    {
+        Nclock = 1;
+        Nreps = baseNreps / baseNclock;
+        if (0 == Nreps) Nreps = 1;
+    }
+    scannedAtoms = 0;
+
     clock_t sumAsyncTime = 0;
     long rssStart;
     std::vector<record_t> records;
@@ -374,6 +486,7 @@ void AtomSpaceBenchmark::doBenchmark(const std::string& methodName,
     int counter = 0;
     rssStart = getMemUsage();
     long rssFromIncrease = 0;
+    startWriter();
     timeval tim;
     gettimeofday(&tim, NULL);
     double t1 = tim.tv_sec + (tim.tv_usec/1000000.0);
@@ -407,14 +520,26 @@ void AtomSpaceBenchmark::doBenchmark(const std::string& methodName,
         if (i % diff == 0) cerr << "." << flush;
     }
     Handle rh = getRandomHandle();
+    if (asyncAdd)
+    {
+        if (BENCH_TABLE == testKind) atab->barrier();
+        else if (asp) asp->barrier();
+    }
     gettimeofday(&tim, NULL);
     double t2 = tim.tv_sec + (tim.tv_usec/1000000.0);
+    stopWriterThread();
     printf("\n%.6lf seconds elapsed (%.2f per second)\n",
          t2-t1, 1.0f / ((t2-t1) / (Nreps*Nclock)));
+    if (concurrentWriter)
+        printf("Concurrent writer: %zu adds and removes (%.2f per second)\n",
+            writerOps.load(), writerOps / (t2-t1));
     // rssEnd = getMemUsage();
     cout << "Sum clock() time for all requests: " << sumAsyncTime << " (" <<
         (float) sumAsyncTime / CLOCKS_PER_SEC << " seconds, "<<
         1.0f/(((float)sumAsyncTime/CLOCKS_PER_SEC) / (Nreps*Nclock*Nloops)) << " requests per second)" << endl;
+    if (isScan and 0 < sumAsyncTime)
+        printf("Scanned %zu atoms (%.0f atoms per second)\n", scannedAtoms,
+            scannedAtoms / ((double) sumAsyncTime / CLOCKS_PER_SEC));
     //cout << "Memory (max RSS) change after benchmark: " <<
     //    (rssEnd - rssStart - rssFromIncrease) / 1024 << "kb" << endl;
 
@@ -447,7 +572,7 @@ void AtomSpaceBenchmark::startBenchmark(int numThreads)
     if (poissonDistribution) delete poissonDistribution;
     poissonDistribution = new std::poisson_distribution<unsigned>(linkSize_mean);
 
-    // num threads does nothing at the moment;
+    // num threads does nothing at the moment; see maxThreads instead.
     if (showTypeSizes) printTypeSizes();
 
     for (unsigned int i = 0; i < methodNames.size(); i++) {
@@ -482,12 +607,22 @@ void AtomSpaceBenchmark::startBenchmark(int numThreads)
 #endif
         }
         numberOfTypes = classserver().getNumberOfClasses();
+        connectListeners();
 
         if (buildTestData) buildAtomSpace(atomCount, percentLinks, false);
+        if (showHashStats)
+        {
+            if (testKind == BENCH_TABLE) atab->printHashStats();
+            else asp->print_hash_stats();
+        }
         UUID_end = tlbuf.getMaxUUID();
 
-        doBenchmark(methodNames[i], methodsToTest[i]);
+        if (0 < maxThreads)
+            doThreadedBenchmark(methodNames[i]);
+        else
+            doBenchmark(methodNames[i], methodsToTest[i]);
 
+        disconnectListeners();
         if (testKind == BENCH_TABLE)
             delete atab;
         else {
@@ -504,6 +639,71 @@ void AtomSpaceBenchmark::startBenchmark(int numThreads)
     //cout << estimateOfAtomSize(Handle(1020)) << endl;
 }
 
+// Connect numListeners trivial slots to each of the atom signals, so
+// that the cost of signal delivery can be compared against the
+// no-subscriber case.
+static std::atomic<size_t> signal_count(0);
+static void count_handle(const Handle&) { signal_count++; }
+static void count_atom(const AtomPtr&) { signal_count++; }
+static void count_tv(const Handle&, const TruthValuePtr&,
+                     const TruthValuePtr&) { signal_count++; }
+
+void AtomSpaceBenchmark::connectListeners()
+{
+    for (unsigned int i = 0; i < numListeners; i++)
+    {
+        if (testKind == BENCH_TABLE)
+        {
+            listeners.push_back(atab->addAtomSignal().connect(count_handle));
+            listeners.push_back(atab->removeAtomSignal().connect(count_atom));
+            listeners.push_back(atab->TVChangedSignal().connect(count_tv));
+            continue;
+        }
+        listeners.push_back(asp->addAtomSignal(count_handle));
+        listeners.push_back(asp->removeAtomSignal(count_atom));
+        listeners.push_back(asp->TVChangedSignal(count_tv));
+    }
+}
+
+void AtomSpaceBenchmark::disconnectListeners()
+{
+    for (SignalConnection& c : listeners) c.disconnect();
+    listeners.clear();
+}
+
+void AtomSpaceBenchmark::startWriter()
+{
+    if (not concurrentWriter) return;
+    stopWriter = false;
+    writerOps = 0;
+    writer = std::thread([this]()
+    {
+        size_t i = 0;
+        while (not stopWriter)
+        {
+            std::string name = "writer " + std::to_string(i++ % 1000);
+            if (testKind == BENCH_TABLE)
+            {
+                Handle h(atab->add(createNode(CONCEPT_NODE, name), false));
+                atab->extract(h);
+            }
+            else
+            {
+                Handle h(asp->add_node(CONCEPT_NODE, name));
+                asp->remove_atom(h);
+            }
+            writerOps += 2;
+        }
+    });
+}
+
+void AtomSpaceBenchmark::stopWriterThread()
+{
+    if (not writer.joinable()) return;
+    stopWriter = true;
+    writer.join();
+}
+
 std::string
 AtomSpaceBenchmark::memoize_or_compile(std::string exp)
 {
@@ -601,13 +801,13 @@ clock_t AtomSpaceBenchmark::makeRandomNodes(const std::string& csi)
     case BENCH_TABLE: {
         clock_t t_begin = clock();
         for (unsigned int i=0; i<Nclock; i++)
-            atab->add(createNode(ta[i], nn[i]), false);
+            atab->add(createNode(ta[i], nn[i]), asyncAdd);
         return clock() - t_begin;
     }
     case BENCH_AS: {
         clock_t t_begin = clock();
         for (unsigned int i=0; i<Nclock; i++)
-            asp->add_node(ta[i], nn[i]);
+            asp->add_node(ta[i], nn[i], asyncAdd);
         return clock() - t_begin;
     }
 #if HAVE_GUILE
@@ -707,7 +907,7 @@ clock_t AtomSpaceBenchmark::makeRandomLinks()
 
         HandleSeq outgoing;
         for (size_t j=0; j < arity; j++) {
-            Handle h(getRandomHandle());
+            Handle h(getLinkTarget());
             outgoing.push_back(h);
         }
         og[i] = outgoing;
@@ -775,7 +975,7 @@ clock_t AtomSpaceBenchmark::makeRandomLinks()
 
                 outgoing.clear();
                 for (size_t j=0; j < arity; j++) {
-                    outgoing.push_back(getRandomHandle());
+                    outgoing.push_back(getLinkTarget());
                 }
             }
             std::string gs = memoize_or_compile(ss.str());
@@ -791,13 +991,13 @@ clock_t AtomSpaceBenchmark::makeRandomLinks()
     case BENCH_TABLE: {
         clock_t tAddLinkStart = clock();
         for (unsigned int i=0; i<Nclock; i++)
-            atab->add(createLink(og[i], ta[i]), false);
+            atab->add(createLink(og[i], ta[i]), asyncAdd);
         return clock() - tAddLinkStart;
     }
     case BENCH_AS: {
         clock_t tAddLinkStart = clock();
         for (unsigned int i=0; i<Nclock; i++)
-            asp->add_link(ta[i], og[i]);
+            asp->add_link(ta[i], og[i], asyncAdd);
         return clock() - tAddLinkStart;
     }}
     return 0;
@@ -834,6 +1034,13 @@ void AtomSpaceBenchmark::buildAtomSpace(long atomspaceSize,
         if (display && i % diff == 0) cerr << "." << flush;
     }
 
+    // The indexes must be complete before we go looking in them.
+    if (asyncAdd)
+    {
+        if (BENCH_TABLE == testKind) atab->barrier();
+        else asp->barrier();
+    }
+
     /* Place all the atoms in the TLB too, so that we can later
      * pick some, randomly, just by picking a random int. */
     HandleSeq alln;
@@ -859,6 +1066,12 @@ void AtomSpaceBenchmark::buildAtomSpace(long atomspaceSize,
         cout << DIVIDER_LINE << endl;
     }
 
+    if (asyncAdd)
+    {
+        if (BENCH_TABLE == testKind) atab->barrier();
+        else asp->barrier();
+    }
+
     /* Place all the links into the TLB */
     HandleSeq alli;
     asp->get_all_links(alli);
@@ -1003,6 +1216,26 @@ Handle AtomSpaceBenchmark::getRandomHandle()
     return h;
 }
 
+// Pick an atom to place in the outgoing set of a new link.  With the
+// power-law option, the chance of picking the k'th atom falls off as
+// 1/k, so that a few hub atoms end up with very large incoming sets,
+// as in real-world knowledge graphs.
+Handle AtomSpaceBenchmark::getLinkTarget()
+{
+    if (not powerLaw) return getRandomHandle();
+
+    double range = UUID_end - UUID_begin;
+    UUID ranu = UUID_begin +
+        (UUID) (pow(range, randomGenerator->randdouble())) - 1;
+    Handle h(tlbuf.getAtom(ranu));
+    while (NULL == h.operator->()) {
+        ranu = UUID_begin +
+            (UUID) (pow(range, randomGenerator->randdouble())) - 1;
+        h = tlbuf.getAtom(ranu);
+    }
+    return h;
+}
+
 timepair_t AtomSpaceBenchmark::bm_getType()
 {
     Handle hs[Nclock];
@@ -1064,6 +1297,27 @@ timepair_t AtomSpaceBenchmark::bm_getType()
     return timepair_t(0,0);
 }
 
+timepair_t AtomSpaceBenchmark::bm_isA()
+{
+    Type sub[Nclock];
+    Type super[Nclock];
+    for (unsigned int i=0; i<Nclock; i++)
+    {
+        sub[i] = randomGenerator->randint(numberOfTypes);
+        super[i] = randomGenerator->randint(numberOfTypes);
+    }
+
+    // summing prevents the optimizer from optimizing away.
+    int sum = 0;
+    ClassServer& cs = classserver();
+    clock_t t_begin = clock();
+    for (unsigned int i=0; i<Nclock; i++)
+        sum += cs.isA(sub[i], super[i]);
+    clock_t time_taken = clock() - t_begin;
+    global += sum;
+    return timepair_t(time_taken,0);
+}
+
 timepair_t AtomSpaceBenchmark::bm_getTruthValue()
 {
     Handle hs[Nclock];
@@ -1197,6 +1451,48 @@ timepair_t AtomSpaceBenchmark::bm_setTruthValue()
     return timepair_t(0,0);
 }
 
+// The key used by the getValue benchmarks. Keys are compared by
+// content, so it does not need to be in the atomspace.
+static const Handle& bench_value_key(void)
+{
+    static Handle key(createNode(PREDICATE_NODE, "*-bench-value-key-*"));
+    return key;
+}
+
+timepair_t AtomSpaceBenchmark::bm_getValue()
+{
+    Handle hs[Nclock];
+    for (unsigned int i=0; i<Nclock; i++)
+    {
+        hs[i] = getRandomHandle();
+        hs[i]->setValue(bench_value_key(),
+                        createFloatValue(randomGenerator->randfloat()));
+    }
+
+    switch (testKind) {
+#if HAVE_CYTHON
+    case BENCH_PYTHON: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_CYTHON */
+#if HAVE_GUILE
+    case BENCH_SCM: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_GUILE */
+    case BENCH_AS:
+    case BENCH_TABLE: {
+        const Handle& key = bench_value_key();
+        clock_t t_begin = clock();
+        for (unsigned int i=0; i<Nclock; i++)
+            hs[i]->getValue(key);
+        clock_t time_taken = clock() - t_begin;
+        return timepair_t(time_taken,0);
+    }
+    }
+    return timepair_t(0,0);
+}
+
 timepair_t AtomSpaceBenchmark::bm_getIncomingSet()
 {
     Handle hs[Nclock];
@@ -1250,6 +1546,35 @@ timepair_t AtomSpaceBenchmark::bm_getIncomingSet()
     return timepair_t(0,0);
 }
 
+timepair_t AtomSpaceBenchmark::bm_getIncomingSetByType()
+{
+    Handle hs[Nclock];
+    for (unsigned int i=0; i<Nclock; i++)
+        hs[i] = getRandomHandle();
+
+    switch (testKind) {
+#if HAVE_CYTHON
+    case BENCH_PYTHON: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_CYTHON */
+#if HAVE_GUILE
+    case BENCH_SCM: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_GUILE */
+    case BENCH_AS:
+    case BENCH_TABLE: {
+        clock_t t_begin = clock();
+        for (unsigned int i=0; i<Nclock; i++)
+            hs[i]->getIncomingSetByType(defaultLinkType);
+        clock_t time_taken = clock() - t_begin;
+        return timepair_t(time_taken,0);
+    }
+    }
+    return timepair_t(0,0);
+}
+
 // How long does it take to cast?
 timepair_t AtomSpaceBenchmark::bm_pointerCast()
 {
@@ -1393,6 +1718,373 @@ timepair_t AtomSpaceBenchmark::bm_getHandlesByType()
     return timepair_t(0,0);
 }
 
+timepair_t AtomSpaceBenchmark::bm_foreachHandleByType()
+{
+    switch (testKind) {
+#if HAVE_CYTHON
+    case BENCH_PYTHON:
+#endif /* HAVE_CYTHON */
+#if HAVE_GUILE
+    case BENCH_SCM:
+#endif /* HAVE_GUILE */
+    case BENCH_AS: {
+        // Only the AtomTable offers a callback scan; the other APIs
+        // copy out the handles, which getHandlesByType measures.
+        return timepair_t(0,0);
+    }
+    case BENCH_TABLE: {
+        // summing prevents the optimizer from optimizing away.
+        size_t n = 0;
+        int sum = 0;
+        clock_t t_begin = clock();
+        atab->foreachHandleByType(
+            [&](const Handle& h)->void {
+                sum += h->get_type();
+                n++;
+            }, ATOM, true);
+        clock_t time_taken = clock() - t_begin;
+        global += sum;
+        scannedAtoms += n;
+        return timepair_t(time_taken,0);
+    }}
+    return timepair_t(0,0);
+}
+
+timepair_t AtomSpaceBenchmark::bm_foreachParallelByType()
+{
+    switch (testKind) {
+#if HAVE_CYTHON
+    case BENCH_PYTHON:
+#endif /* HAVE_CYTHON */
+#if HAVE_GUILE
+    case BENCH_SCM:
+#endif /* HAVE_GUILE */
+    case BENCH_AS: {
+        return timepair_t(0,0);
+    }
+    case BENCH_TABLE: {
+        // Summing into one shared counter would measure contention on
+        // the counter, so just count the atoms there were to visit.
+        size_t n = atab->getSize();
+        timeval tim;
+        gettimeofday(&tim, NULL);
+        double t_begin = tim.tv_sec + (tim.tv_usec/1000000.0);
+        atab->foreachParallelByType(
+            [&](const Handle& h)->void { h->get_type(); }, ATOM, true);
+        gettimeofday(&tim, NULL);
+        double t_end = tim.tv_sec + (tim.tv_usec/1000000.0);
+        scannedAtoms += n;
+
+        // clock() adds up the CPU time of all threads; report the
+        // wall-clock time instead.
+        return timepair_t((clock_t) ((t_end - t_begin) * CLOCKS_PER_SEC), 0);
+    }}
+    return timepair_t(0,0);
+}
+
+timepair_t AtomSpaceBenchmark::bm_getHandle()
+{
+    Handle hs[Nclock];
+    for (unsigned int i=0; i<Nclock; i++)
+        hs[i] = getRandomHandle();
+
+    switch (testKind) {
+#if HAVE_CYTHON
+    case BENCH_PYTHON: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_CYTHON */
+#if HAVE_GUILE
+    case BENCH_SCM: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_GUILE */
+    case BENCH_TABLE: {
+        clock_t t_begin = clock();
+        for (unsigned int i=0; i<Nclock; i++)
+        {
+            if (hs[i]->is_node())
+                atab->getHandle(hs[i]->get_type(), hs[i]->get_name());
+            else
+                atab->getHandle(hs[i]->get_type(), hs[i]->getOutgoingSet());
+        }
+        clock_t time_taken = clock() - t_begin;
+        return timepair_t(time_taken,0);
+    }
+    case BENCH_AS: {
+        clock_t t_begin = clock();
+        for (unsigned int i=0; i<Nclock; i++)
+        {
+            if (hs[i]->is_node())
+                asp->get_handle(hs[i]->get_type(), hs[i]->get_name());
+            else
+                asp->get_handle(hs[i]->get_type(), hs[i]->getOutgoingSet());
+        }
+        clock_t time_taken = clock() - t_begin;
+        return timepair_t(time_taken,0);
+    }}
+    return timepair_t(0,0);
+}
+
+// Add fresh copies of atoms that are already in the atomspace. Each
+// add is a pure de-duplication: hash the new atom, find the existing
+// one, and compare them. This is dominated by the content hash, and
+// by the number of hash collisions.
+timepair_t AtomSpaceBenchmark::bm_reAdd()
+{
+    Handle hs[Nclock];
+    for (unsigned int i=0; i<Nclock; i++)
+    {
+        Handle h = getRandomHandle();
+        if (h->is_node())
+            hs[i] = createNode(h->get_type(), h->get_name());
+        else
+            hs[i] = createLink(h->getOutgoingSet(), h->get_type());
+    }
+
+    switch (testKind) {
+#if HAVE_CYTHON
+    case BENCH_PYTHON: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_CYTHON */
+#if HAVE_GUILE
+    case BENCH_SCM: {
+        return timepair_t(0,0);
+    }
+#endif /* HAVE_GUILE */
+    case BENCH_TABLE: {
+        clock_t t_begin = clock();
+        for (unsigned int i=0; i<Nclock; i++)
+            atab->add(hs[i], false);
+        clock_t time_taken = clock() - t_begin;
+        return timepair_t(time_taken,0);
+    }
+    case BENCH_AS: {
+        clock_t t_begin = clock();
+        for (unsigned int i=0; i<Nclock; i++)
+            asp->add_atom(hs[i]);
+        clock_t time_taken = clock() - t_begin;
+        return timepair_t(time_taken,0);
+    }}
+    return timepair_t(0,0);
+}
+
+// ================================================================
+// Multi-threaded scaling benchmarks.
+//
+// All of the random data is generated up front, single-threaded,
+// because neither the random generator nor the TLB are thread-safe.
+// The returned work function then touches only the atomspace.
+
+// Results are summed here, so that the optimizer cannot drop the work.
+static std::atomic<int> thread_sink(0);
+
+AtomSpaceBenchmark::WorkFn
+AtomSpaceBenchmark::prepThreadWork(const std::string& methodName,
+                                   size_t nops)
+{
+    if (methodName == "addNode")
+    {
+        std::vector<std::string> names;
+        for (size_t i=0; i<nops; i++)
+        {
+            counter++;
+            names.push_back("node " + std::to_string(counter));
+        }
+        if (BENCH_TABLE == testKind)
+            return [this, names]() {
+                for (const std::string& n : names)
+                    atab->add(createNode(CONCEPT_NODE, n), asyncAdd);
+            };
+        return [this, names]() {
+            for (const std::string& n : names)
+                asp->add_node(CONCEPT_NODE, n, asyncAdd);
+        };
+    }
+
+    if (methodName == "addLink")
+    {
+        std::vector<HandleSeq> oset;
+        for (size_t i=0; i<nops; i++)
+        {
+            size_t arity = (*poissonDistribution)(*randomGenerator);
+            if (arity == 0) { ++arity; };
+            HandleSeq outgoing;
+            for (size_t j=0; j < arity; j++)
+                outgoing.push_back(getRandomHandle());
+            oset.push_back(outgoing);
+        }
+        if (BENCH_TABLE == testKind)
+            return [this, oset]() {
+                for (const HandleSeq& o : oset)
+                    atab->add(createLink(o, defaultLinkType), asyncAdd);
+            };
+        return [this, oset]() {
+            for (const HandleSeq& o : oset)
+                asp->add_link(defaultLinkType, o, asyncAdd);
+        };
+    }
+
+    if (methodName == "getHandle")
+    {
+        HandleSeq hs;
+        for (size_t i=0; i<nops; i++)
+            hs.push_back(getRandomHandle());
+        if (BENCH_TABLE == testKind)
+            return [this, hs]() {
+                for (const Handle& h : hs)
+                {
+                    if (h->is_node())
+                        atab->getHandle(h->get_type(), h->get_name());
+                    else
+                        atab->getHandle(h->get_type(), h->getOutgoingSet());
+                }
+            };
+        return [this, hs]() {
+            for (const Handle& h : hs)
+            {
+                if (h->is_node())
+                    asp->get_handle(h->get_type(), h->get_name());
+                else
+                    asp->get_handle(h->get_type(), h->getOutgoingSet());
+            }
+        };
+    }
+
+    // The type hierarchy is shared by all threads and atomspaces.
+    if (methodName == "isA")
+    {
+        std::vector<Type> sub, super;
+        for (size_t i=0; i<nops; i++)
+        {
+            sub.push_back(randomGenerator->randint(numberOfTypes));
+            super.push_back(randomGenerator->randint(numberOfTypes));
+        }
+        return [this, sub, super]() {
+            ClassServer& cs = classserver();
+            int sum = 0;
+            for (size_t i=0; i<sub.size(); i++)
+                sum += cs.isA(sub[i], super[i]);
+            thread_sink += sum;
+        };
+    }
+
+    // The value benchmarks do not care if it is the table or the
+    // atomspace; they touch only the atoms.
+    if (methodName == "getTruthValue")
+    {
+        HandleSeq hs;
+        for (size_t i=0; i<nops; i++)
+            hs.push_back(getRandomHandle());
+        return [hs]() {
+            for (const Handle& h : hs)
+                h->getTruthValue();
+        };
+    }
+
+    if (methodName == "setTruthValue")
+    {
+        HandleSeq hs;
+        std::vector<TruthValuePtr> tvs;
+        for (size_t i=0; i<nops; i++)
+        {
+            hs.push_back(getRandomHandle());
+            tvs.push_back(SimpleTruthValue::createTV(
+                randomGenerator->randfloat(), randomGenerator->randfloat()));
+        }
+        return [hs, tvs]() {
+            for (size_t i=0; i<hs.size(); i++)
+                hs[i]->setTruthValue(tvs[i]);
+        };
+    }
+
+    if (methodName == "getValue")
+    {
+        HandleSeq hs;
+        for (size_t i=0; i<nops; i++)
+        {
+            hs.push_back(getRandomHandle());
+            hs.back()->setValue(bench_value_key(),
+                createFloatValue(randomGenerator->randfloat()));
+        }
+        return [hs]() {
+            const Handle& key = bench_value_key();
+            for (const Handle& h : hs)
+                h->getValue(key);
+        };
+    }
+
+    return WorkFn();
+}
+
+void AtomSpaceBenchmark::doThreadedBenchmark(const std::string& methodName)
+{
+    if (BENCH_AS != testKind and BENCH_TABLE != testKind)
+    {
+        cerr << "Error: threaded benchmarks only support the "
+             << "AtomSpace and AtomTable APIs" << endl;
+        return;
+    }
+    if (not prepThreadWork(methodName, 0))
+    {
+        cerr << "Error: method " << methodName
+             << " does not have a threaded benchmark" << endl;
+        return;
+    }
+
+    // 1, 2, 4, ... up to and including maxThreads.
+    std::vector<unsigned int> nthreads;
+    for (unsigned int n = 1; n < maxThreads; n *= 2)
+        nthreads.push_back(n);
+    nthreads.push_back(maxThreads);
+
+    cout << "Threaded scaling of " << (asyncAdd ? "async " : "")
+         << methodName << ", "
+         << baseNreps << " operations split over the threads" << endl;
+    cout << "threads\tseconds\tops/sec\tspeedup" << endl;
+
+    double base_rate = 0.0;
+    for (unsigned int nthr : nthreads)
+    {
+        size_t nops = baseNreps / nthr;
+        std::vector<WorkFn> work;
+        for (unsigned int t=0; t<nthr; t++)
+            work.push_back(prepThreadWork(methodName, nops));
+
+        // Spin until all threads are up, so that thread creation
+        // is not part of the measurement.
+        std::atomic<unsigned int> ready(0);
+        std::atomic<bool> go(false);
+        std::vector<std::thread> pool;
+        for (unsigned int t=0; t<nthr; t++)
+            pool.push_back(std::thread([&, t]() {
+                ready++;
+                while (not go) std::this_thread::yield();
+                work[t]();
+            }));
+        while (ready < nthr) std::this_thread::yield();
+
+        timeval tim;
+        gettimeofday(&tim, NULL);
+        double t1 = tim.tv_sec + (tim.tv_usec/1000000.0);
+        go = true;
+        for (std::thread& th : pool) th.join();
+
+        // Async adds are not done until the barrier returns.
+        if (BENCH_TABLE == testKind) atab->barrier();
+        else asp->barrier();
+        gettimeofday(&tim, NULL);
+        double t2 = tim.tv_sec + (tim.tv_usec/1000000.0);
+
+        double rate = (nops * nthr) / (t2-t1);
+        if (1 == nthr) base_rate = rate;
+        printf("%u\t%.6lf\t%.2f\t%.2f\n", nthr, t2-t1, rate,
+               rate / base_rate);
+    }
+    cout << DIVIDER_LINE << endl;
+}
+
 // ================================================================
 // ================================================================
 // ================================================================
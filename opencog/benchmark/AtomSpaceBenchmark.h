@@ -1,7 +1,10 @@
 #ifndef _OPENCOG_AS_BENCHMARK_H
 #define _OPENCOG_AS_BENCHMARK_H
 
+#include <atomic>
+#include <functional>
 #include <random>
+#include <thread>
 #include <boost/tuple/tuple.hpp>
 
 #include <opencog/util/mt19937ar.h>
@@ -84,6 +87,7 @@ class AtomSpaceBenchmark
     unsigned int Nreps;
     unsigned int Nloops;
     int global;
+    size_t scannedAtoms;
 
 public:
     unsigned int baseNclock;
@@ -116,9 +120,11 @@ public:
     std::vector< BMFn > methodsToTest;
 
     float percentLinks;
+    bool powerLaw; //! pick link targets with a power-law distribution
     long atomCount; //! number of nodes to build atomspace with before testing
 
     bool showTypeSizes;
+    bool showHashStats; //! print content-hash collision stats
     void printTypeSizes();
     size_t estimateOfAtomSize(Handle h);
 
@@ -130,18 +136,44 @@ public:
     void startBenchmark(int numThreads=1);
     void doBenchmark(const std::string& methodName, BMFn methodToCall);
 
+    // Multi-threaded scaling runs. If maxThreads is non-zero, then
+    // each method is run with 1, 2, 4 ... maxThreads threads, instead
+    // of the single-threaded benchmark.
+    unsigned int maxThreads;
+    bool asyncAdd;   //! add atoms with the async flag set
+    unsigned int numListeners; //! no-op slots on the add/remove/TV signals
+    typedef std::function<void(void)> WorkFn;
+    WorkFn prepThreadWork(const std::string& methodName, size_t nops);
+    void doThreadedBenchmark(const std::string& methodName);
+
+    std::vector<SignalConnection> listeners;
+    void connectListeners();
+    void disconnectListeners();
+
+    // Background thread that adds and removes atoms while the
+    // benchmark runs, to see whether the measured method blocks it.
+    bool concurrentWriter;
+    std::atomic<bool> stopWriter;
+    std::atomic<size_t> writerOps;
+    std::thread writer;
+    void startWriter();
+    void stopWriterThread();
+
     void buildAtomSpace(long atomspaceSize=(1 << 16), float percentLinks = 0.1, 
                         bool display = true);
     Handle getRandomHandle();
+    Handle getLinkTarget();
     void setTestAllMethods() { setMethod("all"); }
 
     timepair_t bm_noop();
 
     timepair_t bm_getType();
+    timepair_t bm_isA();
     // Get and set TV and AV
     float chanceUseDefaultTV; // if set, this will use default TV for new atoms and bm_setTruthValue
     timepair_t bm_getTruthValue();
     timepair_t bm_setTruthValue();
+    timepair_t bm_getValue();
 
 #ifdef ZMQ_EXPERIMENT
     timepair_t bm_getTruthValueZmq();
@@ -149,8 +181,13 @@ public:
 
     timepair_t bm_pointerCast();
     timepair_t bm_getIncomingSet();
+    timepair_t bm_getIncomingSetByType();
     timepair_t bm_getOutgoingSet();
     timepair_t bm_getHandlesByType();
+    timepair_t bm_foreachHandleByType();
+    timepair_t bm_foreachParallelByType();
+    timepair_t bm_getHandle();
+    timepair_t bm_reAdd();
 
     timepair_t bm_addNode();
     timepair_t bm_addLink();
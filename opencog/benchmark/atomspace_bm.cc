@@ -4,6 +4,7 @@
 #include <unistd.h>
 
 #include <cstdlib>
+#include <thread>
 
 #include "AtomSpaceBenchmark.h"
 
@@ -14,6 +15,7 @@ int main(int argc, char** argv)
     const char* benchmark_desc = "Benchmark tool OpenCog AtomSpace\n"
      "Usage: atomspace_bm [-m <method>] [options]\n"
      "-t        \tPrint information on type sizes\n"
+     "-H        \tPrint content-hash collision statistics for the test data\n"
      "-A        \tBenchmark all methods\n"
      "-X        \tTest the AtomTable API\n"
      "          \t(by default the AtomSpace API is tested)\n"
@@ -34,10 +36,22 @@ int main(int argc, char** argv)
      "          \t(default: time(NULL))\n"
      "-S <int>  \tHow many random atoms to add after each measurement\n"
      "          \t(default: 0)\n"
+     "-T <int>  \tMeasure thread scaling, with 1, 2, 4 ... <int> threads\n"
+     "          \t(0 means the number of cores; supports addNode,\n"
+     "          \taddLink, getHandle, getTruthValue, setTruthValue,\n"
+     "          \tgetValue and isA)\n"
+     "-a        \tAdd atoms asynchronously (for addNode, addLink);\n"
+     "          \tthe timing includes the final barrier()\n"
+     "-L <int>  \tConnect <int> no-op listeners to the atom add, remove\n"
+     "          \tand TV-changed signals (default: 0)\n"
+     "-w        \tRun a writer thread that adds and removes atoms\n"
+     "          \tduring the measurement, and report its throughput\n"
      "-- Build test data --\n"
      "-p <float> \tSet the connection probability or coordination number\n"
      "         \t(default: 0.2)\n"
      "         \t(-p impact behaviour of -S too)\n"
+     "-P       \tPick link targets with a power-law distribution, so that\n"
+     "         \ta few hub atoms get very large incoming sets\n"
      "-s <int> \tSet how many atoms are created (default: 256K)\n"
      "-d <float> \tChance of using default truth value (default: 0.8)\n"
      "-- Saving data --\n"
@@ -56,12 +70,15 @@ int main(int argc, char** argv)
     opterr = 0;
     benchmarker.testKind = opencog::AtomSpaceBenchmark::BENCH_AS;
 
-    while ((c = getopt (argc, argv, "tAXgMCcm:ln:r:u:h:R:S:p:s:d:kfi:")) != -1) {
+    while ((c = getopt (argc, argv, "tHAXgMCcm:ln:r:u:h:R:S:T:aL:wp:Ps:d:kfi:")) != -1) {
        switch (c)
        {
            case 't':
              benchmarker.showTypeSizes = true;
              break;
+           case 'H':
+             benchmarker.showHashStats = true;
+             break;
            case 'A':
              benchmarker.buildTestData = true;
              benchmarker.setTestAllMethods();
@@ -119,9 +136,26 @@ int main(int argc, char** argv)
            case 'S':
              benchmarker.sizeIncrease = atoi(optarg);
              break;
+           case 'T':
+             benchmarker.maxThreads = (unsigned int) atoi(optarg);
+             if (0 == benchmarker.maxThreads)
+                 benchmarker.maxThreads = std::thread::hardware_concurrency();
+             break;
+           case 'a':
+             benchmarker.asyncAdd = true;
+             break;
+           case 'L':
+             benchmarker.numListeners = (unsigned int) atoi(optarg);
+             break;
+           case 'w':
+             benchmarker.concurrentWriter = true;
+             break;
            case 'p':
              benchmarker.percentLinks = atof(optarg);
              break;
+           case 'P':
+             benchmarker.powerLaw = true;
+             break;
            case 's':
              benchmarker.atomCount = (long) atof(optarg);
              break;
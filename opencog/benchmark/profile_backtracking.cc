@@ -0,0 +1,153 @@
+/*
+ * benchmark/profile_backtracking.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+
+using namespace opencog;
+
+// Queries that backtrack a lot: unordered links, whose permutations
+// are tried one after another, and globs, which are tried with every
+// possible length. Every step back restores the groundings found so
+// far, so the cost of that shows most on patterns with many terms.
+
+AtomSpace *as;
+
+Handle concept(size_t i)
+{
+    return as->add_node(CONCEPT_NODE, "thing-" + std::to_string(i));
+}
+
+// Boxes holding four things each, in SetLinks; and a chain of
+// InheritanceLinks between the things.
+void load_data(size_t size)
+{
+    Handle inside = as->add_node(PREDICATE_NODE, "inside");
+    Handle row = as->add_node(PREDICATE_NODE, "row");
+    for (size_t i = 0; i < size; i++)
+    {
+        Handle box = as->add_node(CONCEPT_NODE, "box-" + std::to_string(i));
+        as->add_link(EVALUATION_LINK, inside,
+            as->add_link(LIST_LINK, box,
+                as->add_link(SET_LINK, concept(i), concept(i + 1),
+                                       concept(i + 2), concept(i + 3))));
+        as->add_link(INHERITANCE_LINK, concept(i), concept(i + 1));
+
+        HandleSeq things;
+        for (size_t j = 0; j < 8; j++)
+            things.push_back(concept((i + j) % size));
+        as->add_link(EVALUATION_LINK, row, as->add_link(LIST_LINK, things));
+    }
+}
+
+// Two boxes, holding a chain of eight things between them. This has
+// many terms to keep groundings for, and a SetLink in each box.
+Handle get_unordered_query(void)
+{
+    HandleSeq v;
+    for (size_t i = 0; i < 8; i++)
+        v.push_back(as->add_node(VARIABLE_NODE, "$v" + std::to_string(i)));
+
+    Handle inside = as->add_node(PREDICATE_NODE, "inside");
+    HandleSeq clauses;
+    for (size_t i = 0; i < 7; i++)
+        clauses.push_back(as->add_link(INHERITANCE_LINK, v[i], v[i+1]));
+    clauses.push_back(as->add_link(EVALUATION_LINK, inside,
+        as->add_link(LIST_LINK, as->add_node(VARIABLE_NODE, "$b"),
+            as->add_link(SET_LINK, v[0], v[1], v[2], v[3]))));
+    clauses.push_back(as->add_link(EVALUATION_LINK, inside,
+        as->add_link(LIST_LINK, as->add_node(VARIABLE_NODE, "$c"),
+            as->add_link(SET_LINK, v[4], v[5], v[6], v[7]))));
+
+    return as->add_link(GET_LINK, as->add_link(AND_LINK, clauses));
+}
+
+// Rows in which one thing comes two places after another that it
+// inherits from.
+Handle get_glob_query(void)
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    Handle y = as->add_node(VARIABLE_NODE, "$y");
+    Handle v = as->add_node(VARIABLE_NODE, "$v");
+    return as->add_link(GET_LINK,
+        as->add_link(VARIABLE_LIST, x, y, v,
+            as->add_node(GLOB_NODE, "$head"),
+            as->add_node(GLOB_NODE, "$tail")),
+        as->add_link(AND_LINK,
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "row"),
+                as->add_link(LIST_LINK,
+                    as->add_node(GLOB_NODE, "$head"), x, v, y,
+                    as->add_node(GLOB_NODE, "$tail"))),
+            as->add_link(INHERITANCE_LINK, x, v),
+            as->add_link(INHERITANCE_LINK, v, y)));
+}
+
+void run(const char* name, const Handle& query, size_t reps)
+{
+    Handle result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reps; i++)
+        result = satisfying_set(as, query);
+    auto stop = std::chrono::steady_clock::now();
+
+    double msecs = std::chrono::duration<double, std::milli>(stop - start).count();
+    std::cout << name << " " << msecs / reps << " msec/query, "
+              << result->get_arity() << " results" << std::endl;
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n size] [-r repeats]\n"
+        "  -n size     Number of boxes and rows (default 1000).\n"
+        "  -r repeats  Number of times each query is run (default 5).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = 1000;
+    size_t reps = 5;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:r:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': size = std::stoul(optarg); break;
+            case 'r': reps = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    load_data(size);
+
+    run("unordered:", get_unordered_query(), reps);
+    run("glob:     ", get_glob_query(), reps);
+
+    return 0;
+}
@@ -20,7 +20,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <chrono>
 #include <iostream>
+#include <string>
+#include <unistd.h>
+
 #include <opencog/guile/SchemeEval.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atomspace/AtomSpace.h>
@@ -73,8 +77,54 @@ Handle get_animals(Handle& animals_query)
     return animals;
 }
 
-int main(void)
+// Add many more animals, so that the query has a very wide starting
+// point (the incoming set of "animal"), for timing the parallel search.
+void add_herd(size_t herd_size)
+{
+    Handle animal = atomspace->add_node(CONCEPT_NODE, "animal");
+    for (size_t i = 0; i < herd_size; i++)
+    {
+        Handle beast = atomspace->add_node(CONCEPT_NODE,
+                                           "beast-" + std::to_string(i));
+        atomspace->add_link(INHERITANCE_LINK, beast, animal);
+    }
+}
+
+// Time one query of the whole herd, in seconds.
+double time_herd(Handle& animals_query, unsigned nthreads, size_t& found)
 {
+    auto start = std::chrono::steady_clock::now();
+    Handle animals = bindlink(atomspace, animals_query, SIZE_MAX, nthreads);
+    auto stop = std::chrono::steady_clock::now();
+    found = animals->getOutgoingSet().size();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-t threads] [-n herd-size]\n"
+        "  -n herd-size  Also time one query over a herd of this many\n"
+        "                extra animals, serially and in parallel.\n"
+        "  -t threads    Number of threads for the parallel herd query\n"
+        "                (default 4).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned nthreads = 4;
+    size_t herd_size = 0;
+
+    int c;
+    while ((c = getopt(argc, argv, "t:n:h")) != -1)
+    {
+        switch (c)
+        {
+            case 't': nthreads = std::stoul(optarg); break;
+            case 'n': herd_size = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
     // Create the atomspace and scheme evaluator.
     atomspace = new AtomSpace();
     scheme = new SchemeEval(atomspace);
@@ -93,5 +143,21 @@ int main(void)
         std::cout << "total animals = " << total_animals << std::endl;
     }
 
+    // Compare the serial and the parallel search of a wide query.
+    if (0 < herd_size)
+    {
+        add_herd(herd_size);
+
+        size_t serial_found, parallel_found;
+        double serial = time_herd(animals_query, 1, serial_found);
+        double parallel = time_herd(animals_query, nthreads, parallel_found);
+
+        std::cout << "herd of " << serial_found << " animals:" << std::endl;
+        std::cout << "  1 thread:   " << serial << " secs" << std::endl;
+        std::cout << "  " << nthreads << " threads:  " << parallel
+                  << " secs (found " << parallel_found << ", speedup "
+                  << serial / parallel << "x)" << std::endl;
+    }
+
     return 0;
 }
@@ -0,0 +1,161 @@
+/*
+ * benchmark/profile_numeric_filter.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+#include <opencog/query/NumericClause.h>
+
+using namespace opencog;
+
+// Queries that filter their groundings by comparing numbers, timed
+// with the comparisons compiled into arithmetic on doubles, and with
+// the older evaluation, which instantiates each grounded comparison
+// in a scratch atomspace.
+//
+// Every item has a price, and every box has a weight. The first query
+// asks for the items that cost more than some amount; the comparison
+// is made during the search, for one grounding at a time. The second
+// asks for the items and boxes whose price and weight add up to more
+// than some amount; item and box are not connected, so every item is
+// tried with every box, and the comparison is made for all the boxes
+// at once.
+
+AtomSpace *as;
+
+void load_data(size_t nitems, size_t nboxes)
+{
+    Handle price = as->add_node(PREDICATE_NODE, "price");
+    for (size_t i = 0; i < nitems; i++)
+        as->add_link(EVALUATION_LINK, price,
+            as->add_link(LIST_LINK,
+                as->add_node(CONCEPT_NODE, "item-" + std::to_string(i)),
+                as->add_node(NUMBER_NODE, std::to_string((i * 7919) % 1000))));
+
+    Handle weight = as->add_node(PREDICATE_NODE, "weight");
+    for (size_t i = 0; i < nboxes; i++)
+        as->add_link(EVALUATION_LINK, weight,
+            as->add_link(LIST_LINK,
+                as->add_node(CONCEPT_NODE, "box-" + std::to_string(i)),
+                as->add_node(NUMBER_NODE, std::to_string((i * 104729) % 100))));
+}
+
+Handle price_of(const Handle& item, const Handle& p)
+{
+    return as->add_link(EVALUATION_LINK,
+        as->add_node(PREDICATE_NODE, "price"),
+        as->add_link(LIST_LINK, item, p));
+}
+
+// The items that cost more than 900.
+Handle get_filter_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    Handle p = as->add_node(VARIABLE_NODE, "$p");
+    return as->add_link(GET_LINK,
+        as->add_link(VARIABLE_LIST, x, p),
+        as->add_link(AND_LINK,
+            price_of(x, p),
+            as->add_link(GREATER_THAN_LINK, p,
+                as->add_node(NUMBER_NODE, "900"))));
+}
+
+// The items and boxes that weigh in at more than 1080, all told.
+Handle get_join_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    Handle p = as->add_node(VARIABLE_NODE, "$p");
+    Handle b = as->add_node(VARIABLE_NODE, "$b");
+    Handle w = as->add_node(VARIABLE_NODE, "$w");
+    return as->add_link(GET_LINK,
+        as->add_link(VARIABLE_LIST, x, p, b, w),
+        as->add_link(AND_LINK,
+            price_of(x, p),
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "weight"),
+                as->add_link(LIST_LINK, b, w)),
+            as->add_link(GREATER_THAN_LINK,
+                as->add_link(PLUS_LINK, p, w),
+                as->add_node(NUMBER_NODE, "1080"))));
+}
+
+void run(const char* name, const Handle& query, size_t reps, bool compiled)
+{
+    NumericClause::set_enabled(compiled);
+
+    Handle result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reps; i++)
+        result = satisfying_set(as, query);
+    auto stop = std::chrono::steady_clock::now();
+
+    double msecs = std::chrono::duration<double, std::milli>(stop - start).count();
+    std::cout << name << (compiled ? " compiled: " : " scratch:  ")
+              << msecs / reps << " msec/query, "
+              << result->get_arity() << " results" << std::endl;
+
+    NumericClause::set_enabled(true);
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n items] [-b boxes] [-r repeats]\n"
+        "  -n items    Number of items (default 2000).\n"
+        "  -b boxes    Number of boxes (default 50).\n"
+        "  -r repeats  Number of times each query is run (default 2).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t nitems = 2000;
+    size_t nboxes = 50;
+    size_t reps = 2;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:b:r:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': nitems = std::stoul(optarg); break;
+            case 'b': nboxes = std::stoul(optarg); break;
+            case 'r': reps = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    load_data(nitems, nboxes);
+
+    Handle filter = get_filter_query();
+    Handle join = get_join_query();
+
+    run("filter", filter, reps, false);
+    run("filter", filter, reps, true);
+    run("join  ", join, reps, false);
+    run("join  ", join, reps, true);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * benchmark/profile_pattern_cache.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+#include <opencog/query/PatternCache.h>
+
+using namespace opencog;
+
+// Time many repeats of small queries, the kind that rule engines issue
+// over and over, with and without the compiled-pattern cache.
+
+AtomSpace *as;
+
+void load_data(size_t herd_size)
+{
+    Handle animal = as->add_node(CONCEPT_NODE, "animal");
+    Handle pet = as->add_node(CONCEPT_NODE, "pet");
+    for (size_t i = 0; i < herd_size; i++)
+    {
+        Handle beast = as->add_node(CONCEPT_NODE, "beast-" + std::to_string(i));
+        as->add_link(INHERITANCE_LINK, beast, animal);
+        if (0 == i % 100)
+            as->add_link(MEMBER_LINK, beast, pet);
+    }
+}
+
+// A plain query: the pets that are animals.
+Handle get_plain_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    return as->add_link(BIND_LINK,
+        as->add_link(AND_LINK,
+            as->add_link(MEMBER_LINK, x, as->add_node(CONCEPT_NODE, "pet")),
+            as->add_link(INHERITANCE_LINK, x,
+                as->add_node(CONCEPT_NODE, "animal"))),
+        as->add_link(LIST_LINK, x));
+}
+
+// The same query, spelled with DefinedPredicates; these have to be
+// expanded before every search, unless the expansion is cached.
+Handle get_defined_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    Handle is_pet = as->add_node(DEFINED_PREDICATE_NODE, "is-pet");
+    Handle is_animal = as->add_node(DEFINED_PREDICATE_NODE, "is-animal");
+    as->add_link(DEFINE_LINK, is_pet,
+        as->add_link(MEMBER_LINK, x, as->add_node(CONCEPT_NODE, "pet")));
+    as->add_link(DEFINE_LINK, is_animal,
+        as->add_link(INHERITANCE_LINK, x,
+            as->add_node(CONCEPT_NODE, "animal")));
+    return as->add_link(GET_LINK, as->add_link(AND_LINK, is_pet, is_animal));
+}
+
+void run(const char* name, const Handle& query, size_t reps, bool cached)
+{
+    PatternCache& cache = pattern_cache();
+    cache.clear();
+    cache.reset_stats();
+    size_t capacity = cache.get_capacity();
+    if (not cached) cache.set_capacity(0);
+
+    Handle result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reps; i++)
+        result = satisfying_set(as, query);
+    auto stop = std::chrono::steady_clock::now();
+
+    double usecs = std::chrono::duration<double, std::micro>(stop - start).count();
+    std::cout << name << (cached ? " cached:   " : " uncached: ")
+              << usecs / reps << " usec/query, "
+              << result->get_arity() << " results";
+
+    if (cached)
+    {
+        PatternCache::Stats st = cache.get_stats();
+        size_t lookups = st.hits + st.misses;
+        std::cout << ", hit rate " << (100.0 * st.hits) / lookups << "% ("
+                  << st.hits << " hits, " << st.misses << " misses, "
+                  << st.stale << " stale)";
+    }
+    std::cout << std::endl;
+
+    cache.set_capacity(capacity);
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n herd-size] [-r repeats]\n"
+        "  -n herd-size  Number of animals (default 10000).\n"
+        "  -r repeats    Number of times each query is run (default 20000).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t herd_size = 10000;
+    size_t reps = 20000;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:r:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': herd_size = std::stoul(optarg); break;
+            case 'r': reps = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    load_data(herd_size);
+
+    Handle plain = get_plain_query();
+    Handle defined = get_defined_query();
+
+    run("plain  ", plain, reps, false);
+    run("plain  ", plain, reps, true);
+    run("defined", defined, reps, false);
+    run("defined", defined, reps, true);
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * benchmark/profile_query_planner.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+#include <opencog/query/PatternCache.h>
+#include <opencog/query/QueryPlanner.h>
+
+using namespace opencog;
+
+// Multi-clause queries on which the incoming-set-size heuristic picks
+// a poor place to start, timed with and without the query planner.
+//
+// Every beast is a pet, and has a dozen or so attributes; one in a
+// hundred is green. "green" itself has a huge incoming set, but
+// almost all of it is InheritanceLinks, which cannot hold the
+// (ListLink $x green) that the query asks for. Going by incoming set
+// size, the search starts at "pet", and tries every beast.
+
+AtomSpace *as;
+
+void load_data(size_t herd_size, size_t nattrs)
+{
+    Handle pet = as->add_node(CONCEPT_NODE, "pet");
+    Handle color = as->add_node(PREDICATE_NODE, "color");
+    Handle green = as->add_node(CONCEPT_NODE, "green");
+    Handle red = as->add_node(CONCEPT_NODE, "red");
+    Handle owner = as->add_node(PREDICATE_NODE, "owner");
+    Handle alice = as->add_node(CONCEPT_NODE, "alice");
+
+    for (size_t i = 0; i < 2 * herd_size; i++)
+        as->add_link(INHERITANCE_LINK,
+            as->add_node(CONCEPT_NODE, "shade-" + std::to_string(i)), green);
+
+    for (size_t i = 0; i < herd_size; i++)
+    {
+        Handle beast = as->add_node(CONCEPT_NODE, "beast-" + std::to_string(i));
+        as->add_link(MEMBER_LINK, beast, pet);
+        as->add_link(EVALUATION_LINK, color,
+            as->add_link(LIST_LINK, beast, 0 == i % 100 ? green : red));
+        if (0 == i % 3)
+            as->add_link(EVALUATION_LINK, owner,
+                as->add_link(LIST_LINK, beast, alice));
+        for (size_t j = 0; j < nattrs; j++)
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "attr-" + std::to_string(j)),
+                as->add_link(LIST_LINK, beast,
+                    as->add_node(CONCEPT_NODE,
+                        "value-" + std::to_string((i + j) % 97))));
+    }
+}
+
+// The green pets.
+Handle get_two_clause_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    return as->add_link(GET_LINK,
+        as->add_link(AND_LINK,
+            as->add_link(MEMBER_LINK, x, as->add_node(CONCEPT_NODE, "pet")),
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "color"),
+                as->add_link(LIST_LINK, x,
+                    as->add_node(CONCEPT_NODE, "green")))));
+}
+
+// The green pets that alice owns, and their other attributes.
+Handle get_three_clause_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    Handle y = as->add_node(VARIABLE_NODE, "$y");
+    return as->add_link(GET_LINK,
+        as->add_link(VARIABLE_LIST, x, y),
+        as->add_link(AND_LINK,
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "owner"),
+                as->add_link(LIST_LINK, x,
+                    as->add_node(CONCEPT_NODE, "alice"))),
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "attr-0"),
+                as->add_link(LIST_LINK, x, y)),
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "color"),
+                as->add_link(LIST_LINK, x,
+                    as->add_node(CONCEPT_NODE, "green")))));
+}
+
+void run(const char* name, const Handle& query, size_t reps, bool planned)
+{
+    QueryPlanner::set_enabled(planned);
+
+    // Plan anew on every run, so that planning time is included.
+    size_t capacity = pattern_cache().get_capacity();
+    pattern_cache().set_capacity(0);
+
+    Handle result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reps; i++)
+        result = satisfying_set(as, query);
+    auto stop = std::chrono::steady_clock::now();
+
+    double usecs = std::chrono::duration<double, std::micro>(stop - start).count();
+    std::cout << name << (planned ? " planner:   " : " heuristic: ")
+              << usecs / reps << " usec/query, "
+              << result->get_arity() << " results" << std::endl;
+
+    pattern_cache().set_capacity(capacity);
+    QueryPlanner::set_enabled(true);
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n herd-size] [-a attrs] [-r repeats] [-e]\n"
+        "  -n herd-size  Number of animals (default 10000).\n"
+        "  -a attrs      Number of attributes per animal (default 12).\n"
+        "  -r repeats    Number of times each query is run (default 20).\n"
+        "  -e            Print the query plans.\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t herd_size = 10000;
+    size_t nattrs = 12;
+    size_t reps = 20;
+    bool explain = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:a:r:eh")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': herd_size = std::stoul(optarg); break;
+            case 'a': nattrs = std::stoul(optarg); break;
+            case 'r': reps = std::stoul(optarg); break;
+            case 'e': explain = true; break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    load_data(herd_size, nattrs);
+
+    Handle two = get_two_clause_query();
+    Handle three = get_three_clause_query();
+
+    if (explain)
+    {
+        std::cout << explain_query(as, two) << std::endl;
+        std::cout << explain_query(as, three) << std::endl;
+    }
+
+    run("two clauses  ", two, reps, false);
+    run("two clauses  ", two, reps, true);
+    run("three clauses", three, reps, false);
+    run("three clauses", three, reps, true);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/*
+ * benchmark/profile_small_queries.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+
+using namespace opencog;
+
+// Many threads, each running many small queries, each of which finds
+// only a few groundings. The cost of such queries is mostly in setting
+// up the search (the engine, the callbacks and their scratch
+// atomspaces), rather than in the search itself. This prints the
+// number of queries per second, for a growing number of threads.
+
+AtomSpace *as;
+
+void load_data(size_t size)
+{
+    Handle color = as->add_node(PREDICATE_NODE, "color");
+    Handle weight = as->add_node(PREDICATE_NODE, "weight");
+    for (size_t i = 0; i < size; i++)
+    {
+        Handle beast = as->add_node(CONCEPT_NODE, "beast-" + std::to_string(i));
+        as->add_link(EVALUATION_LINK, color,
+            as->add_link(LIST_LINK, beast,
+                as->add_node(CONCEPT_NODE, 0 == i % 2 ? "green" : "red")));
+        as->add_link(EVALUATION_LINK, weight,
+            as->add_link(LIST_LINK, beast,
+                as->add_node(NUMBER_NODE, std::to_string(i % 50))));
+    }
+}
+
+// What color is the beast, and is it heavier than 25? The
+// GreaterThanLink is evaluated in a scratch atomspace.
+Handle get_query(size_t i)
+{
+    Handle beast = as->add_node(CONCEPT_NODE, "beast-" + std::to_string(i));
+    Handle c = as->add_node(VARIABLE_NODE, "$c");
+    Handle w = as->add_node(VARIABLE_NODE, "$w");
+    return as->add_link(GET_LINK,
+        as->add_link(VARIABLE_LIST, c, w),
+        as->add_link(AND_LINK,
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "color"),
+                as->add_link(LIST_LINK, beast, c)),
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "weight"),
+                as->add_link(LIST_LINK, beast, w)),
+            as->add_link(GREATER_THAN_LINK, w,
+                as->add_node(NUMBER_NODE, "25"))));
+}
+
+void run(size_t nthreads, const HandleSeq& queries, size_t reps)
+{
+    auto worker = [&](size_t t)
+    {
+        for (size_t r = 0; r < reps; r++)
+            for (size_t i = t; i < queries.size(); i += nthreads)
+                satisfying_set(as, queries[i]);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nthreads; t++)
+        threads.emplace_back(worker, t);
+    for (std::thread& th : threads) th.join();
+    auto stop = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(stop - start).count();
+    std::cout << nthreads << " threads: "
+              << (queries.size() * reps) / secs << " queries/sec" << std::endl;
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n size] [-r repeats] [-t max-threads]\n"
+        "  -n size         Number of beasts, and of queries (default 2000).\n"
+        "  -r repeats      Number of times each query is run (default 10).\n"
+        "  -t max-threads  Largest number of threads (default 8).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = 2000;
+    size_t reps = 10;
+    size_t max_threads = 8;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:r:t:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': size = std::stoul(optarg); break;
+            case 'r': reps = std::stoul(optarg); break;
+            case 't': max_threads = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    load_data(size);
+
+    HandleSeq queries;
+    for (size_t i = 0; i < size; i++)
+        queries.push_back(get_query(i));
+
+    for (size_t n = 1; n <= max_threads; n *= 2)
+        run(n, queries, reps);
+
+    return 0;
+}
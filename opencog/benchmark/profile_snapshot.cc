@@ -0,0 +1,185 @@
+/*
+ * benchmark/profile_snapshot.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atoms/base/FloatValue.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/snapshot/AtomSpaceSnapshot.h>
+#include <opencog/truthvalue/SimpleTruthValue.h>
+
+#ifdef HAVE_GUILE
+#include <opencog/guile/SchemeEval.h>
+#endif
+#ifdef HAVE_SQL_STORAGE
+#include <opencog/persist/sql/multi-driver/SQLAtomStorage.h>
+#endif
+
+using namespace opencog;
+
+// Startup time: how long it takes to fill an empty atomspace with the
+// same atoms, from a snapshot, from a scheme file, and from a SQL
+// database. Only the loading is timed, not the writing.
+
+typedef std::chrono::steady_clock Clock;
+
+void make_atoms(AtomSpace& as, size_t natoms)
+{
+    Handle key = createNode(PREDICATE_NODE, "snapshot-bench-key");
+    Handle pred = as.add_node(PREDICATE_NODE, "snapshot-bench-pred");
+    HandleSeq nodes;
+    for (size_t i = 0; i < natoms; i++)
+    {
+        Handle h = as.add_node(CONCEPT_NODE, "snapshot-bench-" + std::to_string(i));
+        h->setTruthValue(SimpleTruthValue::createTV(0.5, (i % 100) / 100.0));
+        h->setValue(key, createFloatValue(std::vector<double>({1.0 * i, 2.0})));
+        nodes.push_back(h);
+    }
+    for (size_t i = 0; i < natoms; i++)
+    {
+        Handle h = as.add_link(LIST_LINK, nodes[i], nodes[(i + 1) % natoms]);
+        h = as.add_link(EVALUATION_LINK, pred, h);
+        h->setTruthValue(SimpleTruthValue::createTV(0.25, (i % 100) / 100.0));
+    }
+}
+
+double report(const char* what, size_t n, Clock::time_point start)
+{
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << what << n << " atoms in " << secs << " secs, "
+              << n / secs << " atoms/sec" << std::endl;
+    return secs;
+}
+
+double snapshot(AtomSpace& as, const std::string& path)
+{
+    auto start = Clock::now();
+    save_snapshot(as, path);
+    report("snapshot save: ", as.get_size(), start);
+
+    AtomSpace fresh;
+    start = Clock::now();
+    load_snapshot(fresh, path);
+    return report("snapshot load: ", fresh.get_size(), start);
+}
+
+#ifdef HAVE_GUILE
+void scheme(AtomSpace& as, const std::string& path, double snap_secs)
+{
+    std::string scm_path = path + ".scm";
+    {
+        std::ofstream f(scm_path);
+        HandleSeq all;
+        as.get_handles_by_type(all, ATOM, true);
+        for (const Handle& h : all)
+            if (h->getIncomingSetSize() == 0)
+                f << h->to_short_string();
+    }
+
+    AtomSpace fresh;
+    SchemeEval* ev = SchemeEval::get_evaluator(&fresh);
+    auto start = Clock::now();
+    ev->eval("(primitive-load \"" + scm_path + "\")");
+    double secs = report(".scm load:     ", fresh.get_size(), start);
+    std::cout << "snapshot is " << secs / snap_secs
+              << " times faster than .scm" << std::endl;
+    std::remove(scm_path.c_str());
+}
+#endif // HAVE_GUILE
+
+#ifdef HAVE_SQL_STORAGE
+void sql(AtomSpace& as, const std::string& uri, double snap_secs)
+{
+    SQLAtomStorage storage(uri);
+    if (not storage.connected())
+    {
+        std::cerr << "Cannot connect to " << uri << std::endl;
+        return;
+    }
+    storage.kill_data();
+    storage.storeAtomSpace(&as);
+    storage.clear_cache();
+
+    AtomSpace fresh;
+    auto start = Clock::now();
+    storage.loadAtomSpace(&fresh);
+    double secs = report("sql load:      ", fresh.get_size(), start);
+    std::cout << "snapshot is " << secs / snap_secs
+              << " times faster than sql" << std::endl;
+}
+#endif // HAVE_SQL_STORAGE
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " -f file [-n atoms] [-u uri]\n"
+        "  -f file   Snapshot file to write and read back.\n"
+        "  -n atoms  Number of nodes, and of links of each kind (default 100000).\n"
+        "  -u uri    Also load from this SQL database; its contents are erased!\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::string path;
+    std::string uri;
+    size_t natoms = 100000;
+
+    int c;
+    while ((c = getopt(argc, argv, "f:n:u:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'f': path = optarg; break;
+            case 'n': natoms = std::stoul(optarg); break;
+            case 'u': uri = optarg; break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (path.empty()) { print_usage(argv[0]); return 1; }
+
+    AtomSpace as;
+    make_atoms(as, natoms);
+
+    double snap_secs = snapshot(as, path);
+
+#ifdef HAVE_GUILE
+    scheme(as, path, snap_secs);
+#endif
+
+    if (not uri.empty())
+    {
+#ifdef HAVE_SQL_STORAGE
+        sql(as, uri, snap_secs);
+#else
+        std::cerr << "Not built with SQL storage; -u is ignored" << std::endl;
+#endif
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
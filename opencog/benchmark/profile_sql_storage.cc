@@ -0,0 +1,154 @@
+/*
+ * benchmark/profile_sql_storage.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/persist/sql/multi-driver/SQLAtomStorage.h>
+#include <opencog/persist/sql/SQLBackingStore.h>
+#include <opencog/truthvalue/SimpleTruthValue.h>
+
+using namespace opencog;
+
+// Store and fetch throughput of the SQL backend. Stores some number of
+// nodes with truth values, and as many links between pairs of them,
+// one atom at a time; then forgets everything it knew about the
+// database and fetches them all back, again one at a time, by name
+// and by outgoing set, and finally by incoming set.
+
+typedef std::chrono::steady_clock Clock;
+
+HandleSeq nodes;
+HandleSeq links;
+
+void make_atoms(AtomSpace* as, size_t natoms)
+{
+    for (size_t i = 0; i < natoms; i++)
+    {
+        Handle h = as->add_node(CONCEPT_NODE, "sql-bench-" + std::to_string(i));
+        h->setTruthValue(SimpleTruthValue::createTV(0.5, (i % 100) / 100.0));
+        nodes.push_back(h);
+    }
+    for (size_t i = 0; i < natoms; i++)
+    {
+        Handle h = as->add_link(LIST_LINK, nodes[i], nodes[(i + 1) % natoms]);
+        h->setTruthValue(SimpleTruthValue::createTV(0.25, (i % 100) / 100.0));
+        links.push_back(h);
+    }
+}
+
+void report(const char* what, size_t n, Clock::time_point start)
+{
+    double secs = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << what << n << " atoms in " << secs << " secs, "
+              << n / secs << " atoms/sec" << std::endl;
+}
+
+void store(SQLAtomStorage& store, bool synchronous)
+{
+    auto start = Clock::now();
+    for (const Handle& h : nodes) store.storeAtom(h, synchronous);
+    for (const Handle& h : links) store.storeAtom(h, synchronous);
+    store.flushStoreQueue();
+    report(synchronous ? "store (sync):  " : "store (async): ",
+           nodes.size() + links.size(), start);
+}
+
+void fetch(SQLAtomStorage& store)
+{
+    store.clear_cache();
+
+    auto start = Clock::now();
+    size_t found = 0;
+    for (const Handle& h : nodes)
+        if (store.getNode(h->get_type(), h->get_name().c_str())) found++;
+    for (const Handle& h : links)
+        if (store.getLink(h->get_type(), h->getOutgoingSet())) found++;
+    report("fetch:         ", found, start);
+
+    // Fetching incoming sets goes through the atomspace, and so the
+    // store has to be attached to it as its backing store.
+    AtomSpace scratch;
+    SQLBackingStore backing;
+    backing.set_store(&store);
+    backing.registerWith(&scratch);
+    start = Clock::now();
+    for (const Handle& h : nodes)
+        scratch.fetch_incoming_set(scratch.add_atom(h));
+    report("incoming:      ", nodes.size(), start);
+    backing.unregisterWith(&scratch);
+    backing.set_store(NULL);
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " -u uri [-n atoms] [-k] [-s]\n"
+        "  -u uri    Database to use, e.g. postgres:///opencog_test?user=opencog_tester\n"
+        "  -n atoms  Number of nodes, and of links, to store (default 10000).\n"
+        "  -k        Erase the database first. Use a scratch database!\n"
+        "  -s        Print the storage statistics at the end.\n";
+}
+
+int main(int argc, char* argv[])
+{
+    std::string uri;
+    size_t natoms = 10000;
+    bool kill = false;
+    bool stats = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "u:n:ksh")) != -1)
+    {
+        switch (c)
+        {
+            case 'u': uri = optarg; break;
+            case 'n': natoms = std::stoul(optarg); break;
+            case 'k': kill = true; break;
+            case 's': stats = true; break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+    if (uri.empty()) { print_usage(argv[0]); return 1; }
+
+    SQLAtomStorage storage(uri);
+    if (not storage.connected())
+    {
+        std::cerr << "Cannot connect to " << uri << std::endl;
+        return 1;
+    }
+    if (kill) storage.kill_data();
+
+    AtomSpace as;
+    make_atoms(&as, natoms);
+
+    store(storage, true);
+    store(storage, false);
+    fetch(storage);
+
+    if (stats) storage.print_stats();
+    return 0;
+}
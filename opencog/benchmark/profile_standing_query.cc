@@ -0,0 +1,167 @@
+/*
+ * benchmark/profile_standing_query.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+#include <opencog/query/StandingQuery.h>
+
+using namespace opencog;
+
+// A few new atoms arrive between looks at the results of a query.
+// This times finding out what changed by running the query again in
+// full each time, as a poller would, against keeping it as a standing
+// query, which only searches around the new atoms.
+
+AtomSpace *as;
+size_t nbeasts = 0;
+
+void add_beasts(size_t n)
+{
+    Handle pet = as->add_node(CONCEPT_NODE, "pet");
+    Handle color = as->add_node(PREDICATE_NODE, "color");
+    Handle green = as->add_node(CONCEPT_NODE, "green");
+    Handle red = as->add_node(CONCEPT_NODE, "red");
+
+    for (size_t i = 0; i < n; i++, nbeasts++)
+    {
+        Handle beast = as->add_node(CONCEPT_NODE,
+            "beast-" + std::to_string(nbeasts));
+        as->add_link(MEMBER_LINK, beast, pet);
+        as->add_link(EVALUATION_LINK, color,
+            as->add_link(LIST_LINK, beast, 0 == nbeasts % 10 ? green : red));
+    }
+}
+
+// The green pets.
+Handle get_query()
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    return as->add_link(GET_LINK,
+        as->add_link(AND_LINK,
+            as->add_link(MEMBER_LINK, x, as->add_node(CONCEPT_NODE, "pet")),
+            as->add_link(EVALUATION_LINK,
+                as->add_node(PREDICATE_NODE, "color"),
+                as->add_link(LIST_LINK, x,
+                    as->add_node(CONCEPT_NODE, "green")))));
+}
+
+double poll(const Handle& query, size_t rounds, size_t batch)
+{
+    double usecs = 0.0;
+    size_t found = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        add_beasts(batch);
+        auto start = std::chrono::steady_clock::now();
+        found = satisfying_set(as, query)->get_arity();
+        auto stop = std::chrono::steady_clock::now();
+        usecs += std::chrono::duration<double, std::micro>(stop - start).count();
+    }
+    std::cout << "polling:        " << usecs / rounds << " usec/round, "
+              << found << " results" << std::endl;
+    return usecs;
+}
+
+// The time spent adding atoms is counted here, as that is where the
+// standing query does its work.
+double standing(const Handle& query, size_t rounds, size_t batch)
+{
+    auto start = std::chrono::steady_clock::now();
+    StandingQueryPtr sq(StandingQuery::create(as, query));
+    auto stop = std::chrono::steady_clock::now();
+    double setup = std::chrono::duration<double, std::micro>(stop - start).count();
+
+    // The results found when it was set up do not count as added.
+    HandleSeq first, none;
+    sq->take_changes(first, none);
+
+    double usecs = 0.0;
+    double base = 0.0;
+    size_t added = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        HandleSeq add, rem;
+        start = std::chrono::steady_clock::now();
+        add_beasts(batch);
+        sq->take_changes(add, rem);
+        stop = std::chrono::steady_clock::now();
+        usecs += std::chrono::duration<double, std::micro>(stop - start).count();
+        added += add.size();
+    }
+
+    // The same adds, without a standing query, so that its own share
+    // of the time can be told apart.
+    sq->stop();
+    for (size_t r = 0; r < rounds; r++)
+    {
+        start = std::chrono::steady_clock::now();
+        add_beasts(batch);
+        stop = std::chrono::steady_clock::now();
+        base += std::chrono::duration<double, std::micro>(stop - start).count();
+    }
+
+    std::cout << "standing query: " << (usecs - base) / rounds
+              << " usec/round (set-up " << setup << " usec), "
+              << sq->size() << " results, " << added << " added" << std::endl;
+    return usecs - base;
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n size] [-b batch] [-r rounds]\n"
+        "  -n size    Number of pets to start with (default 100000).\n"
+        "  -b batch   Number of pets added per round (default 10).\n"
+        "  -r rounds  Number of rounds (default 50).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = 100000;
+    size_t batch = 10;
+    size_t rounds = 50;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:b:r:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': size = std::stoul(optarg); break;
+            case 'b': batch = std::stoul(optarg); break;
+            case 'r': rounds = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    add_beasts(size);
+    Handle query = get_query();
+
+    poll(query, rounds, batch);
+    standing(query, rounds, batch);
+
+    return 0;
+}
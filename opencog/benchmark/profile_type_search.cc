@@ -0,0 +1,158 @@
+/*
+ * benchmark/profile_type_search.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/query/BindLinkAPI.h>
+
+using namespace opencog;
+
+// Searches that have no constant to start from walk over every atom
+// of some type: link_type_search() over all links of the type of one
+// of the clauses, and variable_search() over all atoms of the type of
+// a variable. This times how long such a search takes to find its
+// first result, and to come up empty, and how much the peak resident
+// memory grows while doing so. For comparison, it also times copying
+// the whole type index, which is what these searches used to do
+// before looking at any candidates.
+
+AtomSpace *as;
+
+long peak_rss_kb(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+void load_data(size_t size)
+{
+    HandleSeq preds;
+    for (size_t i = 0; i < 100; i++)
+        preds.push_back(as->add_node(PREDICATE_NODE, "pred-" + std::to_string(i)));
+
+    Handle prev = as->add_node(CONCEPT_NODE, "thing-0");
+    for (size_t i = 1; i <= size; i++)
+    {
+        Handle next = as->add_node(CONCEPT_NODE, "thing-" + std::to_string(i));
+        as->add_link(EVALUATION_LINK, preds[i % 100],
+            as->add_link(LIST_LINK, prev, next));
+        prev = next;
+    }
+}
+
+// No constants at all; this starts with a link_type_search() over
+// all EvaluationLinks.
+Handle get_link_query(bool reflexive)
+{
+    Handle p = as->add_node(VARIABLE_NODE, "$p");
+    Handle a = as->add_node(VARIABLE_NODE, "$a");
+    Handle b = reflexive ? a : as->add_node(VARIABLE_NODE, "$b");
+    return as->add_link(GET_LINK,
+        reflexive ? as->add_link(VARIABLE_LIST, p, a)
+                  : as->add_link(VARIABLE_LIST, p, a, b),
+        as->add_link(EVALUATION_LINK, p, as->add_link(LIST_LINK, a, b)));
+}
+
+// A lone, typed variable; this is a variable_search() over all
+// ConceptNodes.
+Handle get_variable_query(void)
+{
+    Handle x = as->add_node(VARIABLE_NODE, "$x");
+    return as->add_link(GET_LINK,
+        as->add_link(TYPED_VARIABLE_LINK, x,
+            as->add_node(TYPE_NODE, "ConceptNode")),
+        x);
+}
+
+void run(const char* name, const Handle& query, size_t max_results)
+{
+    long rss = peak_rss_kb();
+    auto start = std::chrono::steady_clock::now();
+    Handle result = satisfying_set(as, query, max_results);
+    auto stop = std::chrono::steady_clock::now();
+
+    double usecs = std::chrono::duration<double, std::micro>(stop - start).count();
+    std::cout << name << " " << usecs << " usec, "
+              << result->get_arity() << " results, peak RSS +"
+              << peak_rss_kb() - rss << " kB" << std::endl;
+}
+
+void copy_index(const char* name, Type t, bool subclass)
+{
+    long rss = peak_rss_kb();
+    auto start = std::chrono::steady_clock::now();
+    {
+        HandleSeq handle_set;
+        as->get_handles_by_type(handle_set, t, subclass);
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double usecs = std::chrono::duration<double, std::micro>(stop - start).count();
+    std::cout << name << " " << usecs << " usec, peak RSS +"
+              << peak_rss_kb() - rss << " kB" << std::endl;
+}
+
+void print_usage(const char* prog)
+{
+    std::cout << "Usage: " << prog << " [-n size]\n"
+        "  -n size  Number of EvaluationLinks to create (default 1000000).\n";
+}
+
+int main(int argc, char* argv[])
+{
+    size_t size = 1000000;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'n': size = std::stoul(optarg); break;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    as = new AtomSpace();
+    load_data(size);
+    std::cout << "Loaded " << as->get_size() << " atoms, peak RSS "
+              << peak_rss_kb() << " kB" << std::endl;
+
+    Handle links = get_link_query(false);
+    Handle none = get_link_query(true);
+    Handle nodes = get_variable_query();
+
+    // The ones that grow the peak memory least go first, so that the
+    // growth of each can be seen.
+    run("link search, first result:    ", links, 1);
+    run("variable search, first result:", nodes, 1);
+    run("link search, no results:      ", none, SIZE_MAX);
+    copy_index("EvaluationLink index copy:    ", EVALUATION_LINK, false);
+    copy_index("ConceptNode index copy:       ", CONCEPT_NODE, false);
+
+    return 0;
+}
@@ -22,5 +22,12 @@ cdef extern from "opencog/query/BindLinkAPI.h" namespace "opencog":
     cdef tv_ptr c_satisfaction_link "satisfaction_link" (cAtomSpace*, cHandle)
     cdef cHandle c_satisfying_set "satisfying_set" (cAtomSpace*, cHandle, cSize)
 
+cdef extern from "opencog/query/ResultStream.h" namespace "opencog":
+    cdef cppclass cResultStream "opencog::ResultStream":
+        cResultStream(cAtomSpace*, cHandle, cSize) except +
+        bint next(cHandle&) nogil except +
+        void close() nogil
+        cSize count()
+
 cdef extern from "opencog/atoms/execution/EvaluationLink.h" namespace "opencog":
     tv_ptr c_evaluate_atom "opencog::EvaluationLink::do_evaluate"(cAtomSpace*, cHandle)
@@ -74,6 +74,49 @@ def first_n_satisfying_set(AtomSpace atomspace, Atom atom, max_results):
     cdef Atom result = Atom(void_from_candle(c_result), atomspace)
     return result
 
+cdef class ResultStream:
+    """
+    Iterate over the results of a BindLink or a GetLink, as they are
+    found, instead of waiting for all of them in one big SetLink. The
+    search runs no more than 'buffer' results ahead of the reader, and
+    stops when close() is called, or when the stream goes away.
+    """
+    cdef cResultStream* c_stream
+    cdef AtomSpace atomspace
+
+    def __cinit__(self, AtomSpace atomspace, Atom atom, buffer=64):
+        if atom == None: raise ValueError("ResultStream atom is: None")
+        self.atomspace = atomspace
+        self.c_stream = new cResultStream(atomspace.atomspace,
+                                          deref(atom.handle), buffer)
+
+    def __dealloc__(self):
+        # Nothing to free if __cinit__ raised before making the stream.
+        if self.c_stream != NULL:
+            # The search may be running python code; let it finish.
+            with nogil:
+                self.c_stream.close()
+            del self.c_stream
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        cdef cHandle c_result
+        cdef bint found
+        with nogil:
+            found = self.c_stream.next(c_result)
+        if not found:
+            raise StopIteration
+        return Atom(void_from_candle(c_result), self.atomspace)
+
+    def close(self):
+        with nogil:
+            self.c_stream.close()
+
+    property count:
+        def __get__(self): return self.c_stream.count()
+
 def execute_atom(AtomSpace atomspace, Atom atom):
     if atom == None: raise ValueError("execute_atom atom is: None")
     cdef cHandle c_result = c_execute_atom(atomspace.atomspace,
@@ -1,4 +1,4 @@
-from opencog.atomspace cimport cAtomSpace
+from opencog.atomspace cimport cAtomSpace, string
 
 cdef extern from "opencog/cython/opencog/Utilities.h" namespace "opencog":
     # C++: 
@@ -10,3 +10,12 @@ cdef extern from "opencog/cython/opencog/Utilities.h" namespace "opencog":
     cdef void c_initialize_opencog "opencog::initialize_opencog" (cAtomSpace*, char*)
     cdef void c_finalize_opencog "opencog::finalize_opencog" ()
     cdef void c_configuration_load "opencog::configuration_load" (char*)
+
+cdef extern from "opencog/persist/snapshot/AtomSpaceSnapshot.h" namespace "opencog":
+    # C++:
+    #
+    #   void save_snapshot(const AtomSpace&, const std::string& path);
+    #   size_t load_snapshot(AtomSpace&, const std::string& path);
+    #
+    cdef void c_save_snapshot "opencog::save_snapshot" (cAtomSpace&, string&) except +
+    cdef size_t c_load_snapshot "opencog::load_snapshot" (cAtomSpace&, string&) except +
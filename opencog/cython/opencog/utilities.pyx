@@ -1,4 +1,5 @@
-from opencog.atomspace cimport AtomSpace
+from cython.operator cimport dereference as deref
+from opencog.atomspace cimport AtomSpace, string
 from opencog.type_constructors import set_type_ctor_atomspace
 
 cdef extern from "Python.h":
@@ -34,3 +35,15 @@ def finalize_opencog():
 def configuration_load(object config):
     cdef char *configFileString = PyString_AsString(config)
     c_configuration_load(configFileString)
+
+def save_snapshot(AtomSpace atomspace, object path):
+    """Write all of the atoms in the atomspace, and their values, to a
+    snapshot file that load_snapshot() can read back quickly."""
+    cdef string c_path = path.encode('UTF-8')
+    c_save_snapshot(deref(atomspace.atomspace), c_path)
+
+def load_snapshot(AtomSpace atomspace, object path):
+    """Add all of the atoms in the snapshot file to the atomspace.
+    Returns the number of atoms added."""
+    cdef string c_path = path.encode('UTF-8')
+    return c_load_snapshot(deref(atomspace.atomspace), c_path)
@@ -0,0 +1,1269 @@
+/*
+ * FUNCTION:
+ * Persistent Atom storage, in a local file.
+ *
+ * Atoms and Values are saved to, and restored from, a single file,
+ * without any database server. The file is a log of key-value records,
+ * which is only ever appended to; the last record written for a key
+ * wins. When the file is opened, the log is read from start to end,
+ * to rebuild an ordered index of all of the keys in RAM. The records
+ * themselves stay on disk, and are read when they are needed.
+ *
+ * As in the SQL backend, atoms are identified by means of unique ID's
+ * (UUID's), which are correlated with specific in-RAM atoms via the
+ * TLB.
+ *
+ * Copyright (c) 2017 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <opencog/util/Logger.h>
+
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/base/FloatValue.h>
+#include <opencog/atoms/base/LinkValue.h>
+#include <opencog/atoms/base/StringValue.h>
+#include <opencog/truthvalue/TruthValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspaceutils/TLB.h>
+
+#include "LocalAtomStorage.h"
+
+using namespace opencog;
+
+/* ================================================================ */
+/*
+ * File layout.
+ *
+ * The file starts with an eight-byte magic string. After that come the
+ * records, each of which is
+ *
+ *    op (1 byte)  'P' for a put, 'D' for a delete
+ *    key length (4 bytes), data length (4 bytes)
+ *    key, data
+ *    checksum of all of the above (4 bytes)
+ *
+ * All integers are big-endian, so that the keys sort by number. A
+ * record that is cut short, or has a bad checksum, ends the log; it
+ * is what is left of a write that did not finish, and is cut off.
+ *
+ * The keys, by their first byte:
+ *
+ *    a uuid            the atom: its type name, then its name, or the
+ *                      uuids of its outgoing set
+ *    v atom key        the value of the atom at the key
+ *
+ * These are the only keys written to the file. The rest are derived
+ * from them, and kept in RAM only:
+ *
+ *    h hash uuid       atoms by a hash of the record of the atom
+ *    i atom type uuid  the incoming set of the atom, by link type
+ *    t type uuid       atoms by type
+ *    k key atom        the atoms that have a value at the key
+ *
+ * Type names are written out, and not type numbers, as the numbers
+ * change when types are added.
+ */
+
+#define MAGIC "OCATOMS1"
+#define MAGIC_LEN 8
+#define RECORD_OVERHEAD 13
+
+#define PUT_RECORD 'P'
+#define DELETE_RECORD 'D'
+
+#define ATOM_KEY 'a'
+#define VALUE_KEY 'v'
+#define HASH_KEY 'h'
+#define INCOMING_KEY 'i'
+#define TYPE_KEY 't'
+#define KEYED_KEY 'k'
+
+#define NODE_RECORD 'n'
+#define LINK_RECORD 'l'
+
+// Records are written out once this many bytes of them are pending.
+#define WRITE_BUFFER_SIZE (1 << 20)
+
+// The file is read this many bytes at a time, when opening it.
+#define READ_CHUNK (1 << 22)
+
+// The file is compacted on opening, if it is at least this large, and
+// more than half of it is overwritten or deleted records.
+#define COMPACT_MIN_BYTES (1 << 24)
+
+static void put_u32(std::string& buf, uint32_t v)
+{
+	for (int sh = 24; 0 <= sh; sh -= 8)
+		buf.push_back((char) (v >> sh));
+}
+
+static void put_u64(std::string& buf, uint64_t v)
+{
+	for (int sh = 56; 0 <= sh; sh -= 8)
+		buf.push_back((char) (v >> sh));
+}
+
+static void put_str(std::string& buf, const std::string& str)
+{
+	put_u32(buf, str.size());
+	buf += str;
+}
+
+static uint32_t get_u32(const char* p)
+{
+	uint32_t v = 0;
+	for (int i = 0; i < 4; i++)
+		v = (v << 8) | (unsigned char) p[i];
+	return v;
+}
+
+static uint64_t get_u64(const char* p)
+{
+	uint64_t v = 0;
+	for (int i = 0; i < 8; i++)
+		v = (v << 8) | (unsigned char) p[i];
+	return v;
+}
+
+/// FNV-1a. It has to be the same in every build, so that the derived
+/// keys come out the same every time the file is opened.
+static uint64_t hash64(const std::string& str)
+{
+	uint64_t h = 14695981039346656037UL;
+	for (unsigned char c : str)
+	{
+		h ^= c;
+		h *= 1099511628211UL;
+	}
+	return h;
+}
+
+static uint32_t hash32(const char* p, size_t len, uint32_t h = 2166136261U)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		h ^= (unsigned char) p[i];
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/// Walk through the fields of a record.
+class Reader
+{
+	private:
+		const std::string& _buf;
+		size_t _pos;
+
+		const char* need(size_t n)
+		{
+			if (_buf.size() - _pos < n)
+				throw IOException(TRACE_INFO,
+					"LocalAtomStorage: Corrupt record");
+			const char* p = _buf.data() + _pos;
+			_pos += n;
+			return p;
+		}
+
+	public:
+		Reader(const std::string& buf) : _buf(buf), _pos(0) {}
+
+		char byte(void) { return *need(1); }
+		uint32_t u32(void) { return get_u32(need(4)); }
+		uint64_t u64(void) { return get_u64(need(8)); }
+		double dbl(void)
+		{
+			uint64_t bits = u64();
+			double d;
+			memcpy(&d, &bits, sizeof(d));
+			return d;
+		}
+		std::string str(void)
+		{
+			uint32_t len = u32();
+			return std::string(need(len), len);
+		}
+		Type type(void)
+		{
+			std::string tname(str());
+			Type t = classserver().getType(tname);
+			if (NOTYPE == t)
+				throw IOException(TRACE_INFO,
+					"LocalAtomStorage: Unknown type %s", tname.c_str());
+			return t;
+		}
+};
+
+static std::string atom_key(UUID uuid)
+{
+	std::string key(1, ATOM_KEY);
+	put_u64(key, uuid);
+	return key;
+}
+
+static std::string value_prefix(UUID atom)
+{
+	std::string key(1, VALUE_KEY);
+	put_u64(key, atom);
+	return key;
+}
+
+static std::string value_key(UUID atom, UUID kuid)
+{
+	std::string key(value_prefix(atom));
+	put_u64(key, kuid);
+	return key;
+}
+
+static std::string hash_prefix(const std::string& rec)
+{
+	std::string key(1, HASH_KEY);
+	put_u64(key, hash64(rec));
+	return key;
+}
+
+static std::string incoming_prefix(UUID atom)
+{
+	std::string key(1, INCOMING_KEY);
+	put_u64(key, atom);
+	return key;
+}
+
+static std::string type_prefix(const std::string& tname)
+{
+	std::string key(1, TYPE_KEY);
+	key += tname;
+	key.push_back('\0');
+	return key;
+}
+
+static std::string keyed_prefix(UUID kuid)
+{
+	std::string key(1, KEYED_KEY);
+	put_u64(key, kuid);
+	return key;
+}
+
+/// The uuid at the end of a key.
+static UUID key_uuid(const std::string& key)
+{
+	return get_u64(key.data() + key.size() - 8);
+}
+
+static std::string node_record(Type t, const std::string& name)
+{
+	std::string rec;
+	put_str(rec, classserver().getTypeName(t));
+	rec.push_back(NODE_RECORD);
+	put_str(rec, name);
+	return rec;
+}
+
+static std::string link_record(Type t, const std::vector<UUID>& oset)
+{
+	std::string rec;
+	put_str(rec, classserver().getTypeName(t));
+	rec.push_back(LINK_RECORD);
+	put_u32(rec, oset.size());
+	for (UUID uuid : oset)
+		put_u64(rec, uuid);
+	return rec;
+}
+
+static void value_record(std::string& rec, const ProtoAtomPtr& pap)
+{
+	Type vtype = pap->get_type();
+	put_str(rec, classserver().getTypeName(vtype));
+
+	if (classserver().isA(vtype, FLOAT_VALUE))
+	{
+		const std::vector<double>& fltarr = FloatValueCast(pap)->value();
+		put_u32(rec, fltarr.size());
+		for (double d : fltarr)
+		{
+			uint64_t bits;
+			memcpy(&bits, &d, sizeof(bits));
+			put_u64(rec, bits);
+		}
+	}
+	else if (classserver().isA(vtype, STRING_VALUE))
+	{
+		const std::vector<std::string>& strarr = StringValueCast(pap)->value();
+		put_u32(rec, strarr.size());
+		for (const std::string& s : strarr)
+			put_str(rec, s);
+	}
+	else if (classserver().isA(vtype, LINK_VALUE))
+	{
+		const std::vector<ProtoAtomPtr>& lnkarr = LinkValueCast(pap)->value();
+		put_u32(rec, lnkarr.size());
+		for (const ProtoAtomPtr& v : lnkarr)
+			value_record(rec, v);
+	}
+	else
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: Unsupported value type %s",
+			classserver().getTypeName(vtype).c_str());
+}
+
+static ProtoAtomPtr make_value(Reader& rd)
+{
+	Type vtype = rd.type();
+
+	if (vtype == STRING_VALUE)
+	{
+		std::vector<std::string> strarr(rd.u32());
+		for (std::string& s : strarr) s = rd.str();
+		return createStringValue(strarr);
+	}
+
+	if (vtype == FLOAT_VALUE or classserver().isA(vtype, TRUTH_VALUE))
+	{
+		std::vector<double> fltarr(rd.u32());
+		for (double& d : fltarr) d = rd.dbl();
+		if (vtype == FLOAT_VALUE)
+			return createFloatValue(fltarr);
+		return ProtoAtomCast(TruthValue::factory(vtype, fltarr));
+	}
+
+	if (vtype == LINK_VALUE)
+	{
+		std::vector<ProtoAtomPtr> lnkarr(rd.u32());
+		for (ProtoAtomPtr& v : lnkarr) v = make_value(rd);
+		return createLinkValue(lnkarr);
+	}
+
+	throw IOException(TRACE_INFO,
+		"LocalAtomStorage: Unexpected value type %s",
+		classserver().getTypeName(vtype).c_str());
+	return nullptr;
+}
+
+/// pread(2) and pwrite(2) may do only part of the job.
+static void read_fully(int fd, char* buf, size_t len, uint64_t off)
+{
+	while (0 < len)
+	{
+		ssize_t n = pread(fd, buf, len, off);
+		if (n <= 0)
+			throw IOException(TRACE_INFO,
+				"LocalAtomStorage: Cannot read: %s",
+				0 == n ? "unexpected end of file" : strerror(errno));
+		buf += n; len -= n; off += n;
+	}
+}
+
+static void write_fully(int fd, const char* buf, size_t len, uint64_t off)
+{
+	while (0 < len)
+	{
+		ssize_t n = pwrite(fd, buf, len, off);
+		if (n < 0)
+			throw IOException(TRACE_INFO,
+				"LocalAtomStorage: Cannot write: %s", strerror(errno));
+		buf += n; len -= n; off += n;
+	}
+}
+
+/* ================================================================ */
+// Constructors
+
+LocalAtomStorage::LocalAtomStorage(std::string path)
+	: _path(path), _fd(-1)
+{
+	_wbuf_off = MAGIC_LEN;
+	_live_bytes = 0;
+	_dead_bytes = 0;
+
+	clear_stats();
+	open_log();
+
+	tvpred = createNode(PREDICATE_NODE, "*-TruthValueKey-*");
+}
+
+LocalAtomStorage::~LocalAtomStorage()
+{
+	if (0 > _fd) return;
+
+	// Throwing out of a destructor would terminate the process.
+	try
+	{
+		flushStoreQueue();
+	}
+	catch (const std::exception& ex)
+	{
+		logger().warn("LocalAtomStorage: Cannot flush %s: %s",
+			_path.c_str(), ex.what());
+	}
+	close(_fd);
+}
+
+bool LocalAtomStorage::connected(void)
+{
+	return 0 <= _fd;
+}
+
+void LocalAtomStorage::registerWith(AtomSpace* as)
+{
+	_tlbuf.set_resolver(&as->get_atomtable());
+}
+
+void LocalAtomStorage::unregisterWith(AtomSpace* as)
+{
+	flushStoreQueue();
+	_tlbuf.clear_resolver(&as->get_atomtable());
+}
+
+/* ================================================================ */
+// The log and its index.
+
+/// Open the file, creating it if need be, and read the log.
+void LocalAtomStorage::open_log(void)
+{
+	_fd = open(_path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (0 > _fd)
+	{
+		logger().warn("LocalAtomStorage: Cannot open %s: %s",
+			_path.c_str(), strerror(errno));
+		return;
+	}
+
+	// The index is private to this process; a second writer would
+	// not see the records of the first.
+	if (flock(_fd, LOCK_EX | LOCK_NB))
+	{
+		logger().warn("LocalAtomStorage: %s is in use by another process",
+			_path.c_str());
+		close(_fd);
+		_fd = -1;
+		return;
+	}
+
+	struct stat st;
+	fstat(_fd, &st);
+	if (0 == st.st_size)
+	{
+		write_fully(_fd, MAGIC, MAGIC_LEN, 0);
+		return;
+	}
+
+	char magic[MAGIC_LEN];
+	if (MAGIC_LEN > st.st_size or
+	    MAGIC_LEN != pread(_fd, magic, MAGIC_LEN, 0) or
+	    memcmp(magic, MAGIC, MAGIC_LEN))
+	{
+		close(_fd);
+		_fd = -1;
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: %s is not an atomspace file", _path.c_str());
+	}
+
+	replay();
+	reserve();
+
+	if (COMPACT_MIN_BYTES < _dead_bytes and _live_bytes < _dead_bytes)
+		compact();
+}
+
+/// Read the entire log, to rebuild the index.
+void LocalAtomStorage::replay(void)
+{
+	struct stat st;
+	fstat(_fd, &st);
+	uint64_t fsize = st.st_size;
+
+	// Everything is on disk, while the log is read.
+	_wbuf_off = fsize;
+
+	std::string buf;
+	size_t pos = 0;
+	uint64_t rdoff = MAGIC_LEN;  // offset of the next byte to read
+	uint64_t off = MAGIC_LEN;    // offset of the record at buf[pos]
+
+	while (true)
+	{
+		// Read more, if there is not a whole record in the buffer.
+		size_t have = buf.size() - pos;
+		size_t rlen = RECORD_OVERHEAD;
+		if (9 <= have)
+			rlen += get_u32(&buf[pos+1]) + (uint64_t) get_u32(&buf[pos+5]);
+		if (have < rlen)
+		{
+			if (fsize - off < rlen or rdoff >= fsize) break;
+
+			buf.erase(0, pos);
+			pos = 0;
+			size_t old = buf.size();
+			size_t n = std::min<uint64_t>(std::max<size_t>(READ_CHUNK,
+			                                               rlen - old),
+			                              fsize - rdoff);
+			buf.resize(old + n);
+			read_fully(_fd, &buf[old], n, rdoff);
+			rdoff += n;
+			continue;
+		}
+
+		const char* rec = &buf[pos];
+		char op = rec[0];
+		uint32_t klen = get_u32(rec+1);
+		uint32_t dlen = get_u32(rec+5);
+		if ((PUT_RECORD != op and DELETE_RECORD != op) or
+		    get_u32(rec + rlen - 4) != hash32(rec, rlen - 4))
+			break;
+
+		std::string key(rec + 9, klen);
+		if (PUT_RECORD == op)
+		{
+			Loc loc = {off + 9 + klen, dlen};
+			index_put(key, std::string(rec + 9 + klen, dlen), loc);
+		}
+		else
+		{
+			index_del(key);
+			_dead_bytes += rlen;
+		}
+
+		pos += rlen;
+		off += rlen;
+	}
+
+	if (off < fsize)
+	{
+		logger().warn("LocalAtomStorage: %s: dropping %lu bytes of "
+			"incomplete or damaged records at offset %lu",
+			_path.c_str(), fsize - off, off);
+		if (ftruncate(_fd, off))
+			throw IOException(TRACE_INFO,
+				"LocalAtomStorage: Cannot truncate: %s", strerror(errno));
+	}
+	_wbuf_off = off;
+}
+
+/// Write out the pending records. The caller must hold _mtx.
+void LocalAtomStorage::write_buffer(void)
+{
+	if (_wbuf.empty()) return;
+	write_fully(_fd, _wbuf.data(), _wbuf.size(), _wbuf_off);
+	_wbuf_off += _wbuf.size();
+	_wbuf.clear();
+}
+
+/// Read the data of a record. The caller must hold _mtx.
+std::string LocalAtomStorage::read_data(const Loc& loc)
+{
+	if (_wbuf_off <= loc.off)
+		return _wbuf.substr(loc.off - _wbuf_off, loc.len);
+
+	std::string data(loc.len, '\0');
+	read_fully(_fd, &data[0], loc.len, loc.off);
+	_num_reads++;
+	return data;
+}
+
+/// Add a record to the log. The caller must hold _mtx.
+LocalAtomStorage::Loc LocalAtomStorage::append(char op,
+                                               const std::string& key,
+                                               const std::string& data)
+{
+	size_t start = _wbuf.size();
+	_wbuf.push_back(op);
+	put_u32(_wbuf, key.size());
+	put_u32(_wbuf, data.size());
+	_wbuf += key;
+	_wbuf += data;
+	put_u32(_wbuf, hash32(&_wbuf[start], _wbuf.size() - start));
+
+	Loc loc = {_wbuf_off + start + 9 + key.size(), (uint32_t) data.size()};
+	if (WRITE_BUFFER_SIZE < _wbuf.size())
+		write_buffer();
+	_num_writes++;
+	return loc;
+}
+
+/// The keys derived from a record.
+void LocalAtomStorage::derived_keys(const std::string& key,
+                                    const std::string& data,
+                                    std::vector<std::string>& keys)
+{
+	if (VALUE_KEY == key[0])
+	{
+		std::string kkey(keyed_prefix(get_u64(&key[9])));
+		put_u64(kkey, get_u64(&key[1]));
+		keys.emplace_back(kkey);
+		return;
+	}
+
+	UUID uuid = key_uuid(key);
+	Reader rd(data);
+	std::string tname(rd.str());
+
+	std::string hkey(hash_prefix(data));
+	put_u64(hkey, uuid);
+	keys.emplace_back(hkey);
+
+	std::string tkey(type_prefix(tname));
+	put_u64(tkey, uuid);
+	keys.emplace_back(tkey);
+
+	if (LINK_RECORD != rd.byte()) return;
+	uint32_t arity = rd.u32();
+	for (uint32_t i = 0; i < arity; i++)
+	{
+		std::string ikey(incoming_prefix(rd.u64()));
+		ikey += tname;
+		ikey.push_back('\0');
+		put_u64(ikey, uuid);
+		keys.emplace_back(ikey);
+	}
+}
+
+/// Point the key at its newest record. The caller must hold _mtx.
+void LocalAtomStorage::index_put(const std::string& key,
+                                 const std::string& data, const Loc& loc)
+{
+	index_del(key);
+
+	std::vector<std::string> keys;
+	derived_keys(key, data, keys);
+	for (const std::string& k : keys)
+		_secondary.insert(k);
+
+	_primary[key] = loc;
+	_live_bytes += RECORD_OVERHEAD + key.size() + loc.len;
+}
+
+/// Drop the key. The caller must hold _mtx.
+void LocalAtomStorage::index_del(const std::string& key)
+{
+	auto it = _primary.find(key);
+	if (_primary.end() == it) return;
+
+	std::vector<std::string> keys;
+	derived_keys(key, ATOM_KEY == key[0] ? read_data(it->second) : "", keys);
+	for (const std::string& k : keys)
+		_secondary.erase(k);
+
+	uint64_t rlen = RECORD_OVERHEAD + key.size() + it->second.len;
+	_live_bytes -= rlen;
+	_dead_bytes += rlen;
+	_primary.erase(it);
+}
+
+bool LocalAtomStorage::get(const std::string& key, std::string& data)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	auto it = _primary.find(key);
+	if (_primary.end() == it) return false;
+	data = read_data(it->second);
+	return true;
+}
+
+void LocalAtomStorage::put(const std::string& key, const std::string& data)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	Loc loc = append(PUT_RECORD, key, data);
+	index_put(key, data, loc);
+}
+
+void LocalAtomStorage::del(const std::string& key)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (_primary.end() == _primary.find(key)) return;
+	append(DELETE_RECORD, key, "");
+	index_del(key);
+	_dead_bytes += RECORD_OVERHEAD + key.size();
+}
+
+/// All of the keys that start with the prefix, in order. Either the
+/// keys written to the file, or the keys derived from them.
+std::vector<std::string> LocalAtomStorage::scan(const std::string& prefix,
+                                                bool derived)
+{
+	std::vector<std::string> keys;
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (derived)
+	{
+		for (auto it = _secondary.lower_bound(prefix);
+		     it != _secondary.end() and 0 == it->compare(0, prefix.size(), prefix);
+		     it++)
+			keys.emplace_back(*it);
+	}
+	else
+	{
+		for (auto it = _primary.lower_bound(prefix);
+		     it != _primary.end() and 0 == it->first.compare(0, prefix.size(), prefix);
+		     it++)
+			keys.emplace_back(it->first);
+	}
+	return keys;
+}
+
+/// Rewrite the file, with only the newest record for each key.
+/// The new file is written next to the old one, and then renamed
+/// over it, so that a crash leaves one or the other.
+void LocalAtomStorage::compact(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	write_buffer();
+
+	std::string tmp(_path + ".compact");
+	int fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (0 > fd)
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: Cannot open %s: %s", tmp.c_str(), strerror(errno));
+
+	// The new file takes the place of the old one, and so must be
+	// locked before anyone else can open it by that name.
+	if (flock(fd, LOCK_EX | LOCK_NB))
+	{
+		int err = errno;
+		close(fd);
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: Cannot lock %s: %s", tmp.c_str(), strerror(err));
+	}
+
+	std::map<std::string, Loc> moved;
+	std::string buf(MAGIC);
+	uint64_t off = 0;
+	try
+	{
+		for (const auto& pr : _primary)
+		{
+			const std::string& key = pr.first;
+			std::string data(read_data(pr.second));
+			size_t start = buf.size();
+			buf.push_back(PUT_RECORD);
+			put_u32(buf, key.size());
+			put_u32(buf, data.size());
+			buf += key;
+			buf += data;
+			put_u32(buf, hash32(&buf[start], buf.size() - start));
+
+			Loc loc = {off + start + 9 + key.size(), pr.second.len};
+			moved.emplace_hint(moved.end(), key, loc);
+
+			if (WRITE_BUFFER_SIZE < buf.size())
+			{
+				write_fully(fd, buf.data(), buf.size(), off);
+				off += buf.size();
+				buf.clear();
+			}
+		}
+		write_fully(fd, buf.data(), buf.size(), off);
+		off += buf.size();
+
+		if (fsync(fd) or rename(tmp.c_str(), _path.c_str()))
+			throw IOException(TRACE_INFO,
+				"LocalAtomStorage: Cannot replace %s: %s",
+				_path.c_str(), strerror(errno));
+	}
+	catch (...)
+	{
+		close(fd);
+		unlink(tmp.c_str());
+		throw;
+	}
+
+	close(_fd);
+	_fd = fd;
+	_primary.swap(moved);
+	_wbuf_off = off;
+	_live_bytes = off - MAGIC_LEN;
+	_dead_bytes = 0;
+}
+
+/* ================================================================ */
+// Atoms
+
+/// The uuid of the atom with this record, if it is in the file.
+UUID LocalAtomStorage::lookup(const std::string& rec)
+{
+	for (const std::string& hkey : scan(hash_prefix(rec), true))
+	{
+		UUID uuid = key_uuid(hkey);
+		std::string other;
+		if (get(atom_key(uuid), other) and other == rec)
+			return uuid;
+	}
+	return TLB::INVALID_UUID;
+}
+
+/// The uuid of the atom, if it is in the file.
+UUID LocalAtomStorage::find_uuid(const Handle& h)
+{
+	UUID uuid = _tlbuf.getUUID(h);
+	if (TLB::INVALID_UUID != uuid) return uuid;
+
+	std::string rec;
+	if (h->is_node())
+		rec = node_record(h->get_type(), h->get_name());
+	else
+	{
+		std::vector<UUID> oset;
+		for (const Handle& ho : h->getOutgoingSet())
+		{
+			UUID ouid = find_uuid(ho);
+			if (TLB::INVALID_UUID == ouid) return ouid;
+			oset.emplace_back(ouid);
+		}
+		rec = link_record(h->get_type(), oset);
+	}
+
+	uuid = lookup(rec);
+	if (TLB::INVALID_UUID != uuid)
+		_tlbuf.addAtom(h, uuid);
+	return uuid;
+}
+
+/// Store the atom and its outgoing set, recursively, unless they are
+/// already in the file. The caller must hold _store_mutex.
+UUID LocalAtomStorage::do_store_atom(const Handle& h)
+{
+	UUID uuid = _tlbuf.getUUID(h);
+	if (TLB::INVALID_UUID != uuid) return uuid;
+
+	std::string rec;
+	if (h->is_node())
+		rec = node_record(h->get_type(), h->get_name());
+	else
+	{
+		std::vector<UUID> oset;
+		for (const Handle& ho : h->getOutgoingSet())
+			oset.emplace_back(do_store_atom(ho));
+		rec = link_record(h->get_type(), oset);
+	}
+
+	uuid = lookup(rec);
+	if (TLB::INVALID_UUID != uuid)
+		return _tlbuf.addAtom(h, uuid);
+
+	uuid = _tlbuf.addAtom(h, TLB::INVALID_UUID);
+	put(atom_key(uuid), rec);
+	_num_atom_stores++;
+	return uuid;
+}
+
+/// The atom with the uuid, and its outgoing set, recursively.
+/// Note that this does NOT fetch any values!
+Handle LocalAtomStorage::get_atom(UUID uuid)
+{
+	Handle h(_tlbuf.getAtom(uuid));
+	if (h) return h;
+
+	std::string rec;
+	if (not get(atom_key(uuid), rec))
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: Corrupt file; no atom for uuid=%lu", uuid);
+
+	Reader rd(rec);
+	Type t = rd.type();
+	if (NODE_RECORD == rd.byte())
+		h = createNode(t, rd.str());
+	else
+	{
+		HandleSeq oset(rd.u32());
+		for (Handle& ho : oset)
+			ho = get_atom(rd.u64());
+		h = createLink(oset, t);
+	}
+
+	_tlbuf.addAtom(h, uuid);
+	return _tlbuf.getAtom(uuid);
+}
+
+/// Put the atom with the uuid into the table, with all of its values.
+Handle LocalAtomStorage::add_atom(AtomTable& table, UUID uuid)
+{
+	Handle h(table.add(get_atom(uuid), false));
+
+	// Force resolution in TLB, so that later removes work.
+	_tlbuf.addAtom(h, uuid);
+
+	// Get the values only after TLB insertion!!
+	get_atom_values(h, uuid);
+	return h;
+}
+
+/// Remove the atom and its values; if recursive, its incoming set too.
+/// The caller must hold _store_mutex.
+void LocalAtomStorage::remove_atom(UUID uuid, bool recursive)
+{
+	std::vector<std::string> iset(scan(incoming_prefix(uuid), true));
+	if (not recursive and 0 < iset.size()) return;
+	for (const std::string& ikey : iset)
+		remove_atom(key_uuid(ikey), true);
+
+	for (const std::string& vkey : scan(value_prefix(uuid), false))
+		del(vkey);
+
+	// If the atom is a key, its values on other atoms go, too.
+	for (const std::string& kkey : scan(keyed_prefix(uuid), true))
+		del(value_key(key_uuid(kkey), uuid));
+
+	del(atom_key(uuid));
+	_tlbuf.removeAtom(uuid);
+}
+
+/// Make sure that the TLB will not issue the uuids of atoms that are
+/// in the file.
+void LocalAtomStorage::reserve(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	auto it = _primary.lower_bound(std::string(1, ATOM_KEY + 1));
+	if (_primary.begin() == it) return;
+	it--;
+	if (ATOM_KEY != it->first[0]) return;
+	_tlbuf.reserve_upto(key_uuid(it->first));
+}
+
+/* ================================================================ */
+// Values
+
+/// Store ALL of the values associated with the atom.
+void LocalAtomStorage::store_atom_values(const Handle& atom, UUID uuid)
+{
+	HandleSet keys = atom->getKeys();
+	for (const Handle& key: keys)
+	{
+		ProtoAtomPtr pap = atom->getValue(key);
+		if (nullptr == pap) continue;
+
+		std::string rec;
+		value_record(rec, pap);
+		put(value_key(uuid, do_store_atom(key)), rec);
+		_num_value_stores++;
+	}
+
+	// Special-case for TruthValues. Can we get rid of this someday?
+	// Delete default TV's, else storage will get clogged with them.
+	TruthValuePtr tv(atom->getTruthValue());
+	if (tv->isDefaultTV())
+	{
+		UUID tuid = find_uuid(tvpred);
+		if (TLB::INVALID_UUID != tuid)
+			del(value_key(uuid, tuid));
+	}
+}
+
+/// Get ALL of the values associated with an atom.
+void LocalAtomStorage::get_atom_values(const Handle& atom, UUID uuid)
+{
+	for (const std::string& vkey : scan(value_prefix(uuid), false))
+	{
+		std::string rec;
+		if (not get(vkey, rec)) continue;
+
+		Handle key(get_atom(key_uuid(vkey)));
+		Reader rd(rec);
+		atom->setValue(key, make_value(rd));
+	}
+}
+
+/* ================================================================ */
+// AtomStorage interface
+
+/**
+ * Fetch the Node with the indicated type and name.
+ * If there is no such node, NULL is returned.
+ */
+Handle LocalAtomStorage::getNode(Type t, const char * str)
+{
+	_num_get_nodes++;
+	UUID uuid = find_uuid(createNode(t, str));
+	if (TLB::INVALID_UUID == uuid) return Handle();
+	_num_got_nodes++;
+
+	Handle h(_tlbuf.getAtom(uuid));
+	get_atom_values(h, uuid);
+	return h;
+}
+
+/**
+ * Fetch the Link with given type and outgoing set.
+ * If there is no such link, NULL is returned.
+ */
+Handle LocalAtomStorage::getLink(Type t, const HandleSeq& hs)
+{
+	_num_get_links++;
+	UUID uuid = find_uuid(createLink(hs, t));
+	if (TLB::INVALID_UUID == uuid) return Handle();
+	_num_got_links++;
+
+	Handle h(_tlbuf.getAtom(uuid));
+	get_atom_values(h, uuid);
+	return h;
+}
+
+/**
+ * Retreive the entire incoming set of the indicated atom.
+ */
+void LocalAtomStorage::getIncomingSet(AtomTable& table, const Handle& h)
+{
+	UUID uuid = find_uuid(h);
+	if (TLB::INVALID_UUID == uuid) return;
+
+	_num_get_insets++;
+	for (const std::string& ikey : scan(incoming_prefix(uuid), true))
+	{
+		add_atom(table, key_uuid(ikey));
+		_num_get_inlinks++;
+	}
+}
+
+/**
+ * Retreive the incoming set of the indicated atom, but only those atoms
+ * of type t.
+ */
+void LocalAtomStorage::getIncomingByType(AtomTable& table, const Handle& h,
+                                         Type t)
+{
+	UUID uuid = find_uuid(h);
+	if (TLB::INVALID_UUID == uuid) return;
+
+	std::string prefix(incoming_prefix(uuid));
+	prefix += classserver().getTypeName(t);
+	prefix.push_back('\0');
+
+	_num_get_insets++;
+	for (const std::string& ikey : scan(prefix, true))
+	{
+		add_atom(table, key_uuid(ikey));
+		_num_get_inlinks++;
+	}
+}
+
+void LocalAtomStorage::getValuations(AtomTable& table,
+                                     const Handle& key, bool get_all_values)
+{
+	// If the key is not in the file, then there are no values.
+	UUID kuid = find_uuid(key);
+	if (TLB::INVALID_UUID == kuid) return;
+
+	for (const std::string& kkey : scan(keyed_prefix(kuid), true))
+	{
+		UUID uuid = key_uuid(kkey);
+		if (get_all_values)
+		{
+			add_atom(table, uuid);
+			continue;
+		}
+
+		std::string rec;
+		if (not get(value_key(uuid, kuid), rec)) continue;
+
+		Handle h(table.add(get_atom(uuid), false));
+		_tlbuf.addAtom(h, uuid);
+		Reader rd(rec);
+		h->setValue(key, make_value(rd));
+	}
+}
+
+/**
+ * Store the indicated atom and all of the values attached to it, and
+ * its outgoing set, recursively.
+ *
+ * Unlike the SQL backend, the store is always done in the calling
+ * thread; writing to the local file is cheap enough that there is
+ * nothing to be gained by queueing. The synchronous flag is ignored.
+ * The records are written to the file in batches; flushStoreQueue()
+ * writes out any that are pending, and waits for them to reach disk.
+ */
+void LocalAtomStorage::storeAtom(const Handle& h, bool synchronous)
+{
+	std::lock_guard<std::mutex> lck(_store_mutex);
+	UUID uuid = do_store_atom(h);
+	store_atom_values(h, uuid);
+}
+
+/// Remove an atom, and all of it's associated values from the file.
+/// If the atom has a non-empty incoming set, then it is NOT removed
+/// unless the recursive flag is set. If the recursive flag is set, then
+/// the atom, and everything in its incoming set is removed.
+void LocalAtomStorage::removeAtom(const Handle& h, bool recursive)
+{
+	std::lock_guard<std::mutex> lck(_store_mutex);
+	UUID uuid = find_uuid(h);
+	if (TLB::INVALID_UUID == uuid) return;
+
+	remove_atom(uuid, recursive);
+	_num_atom_removes++;
+}
+
+void LocalAtomStorage::loadType(AtomTable& table, Type atom_type)
+{
+	std::string prefix(type_prefix(classserver().getTypeName(atom_type)));
+	for (const std::string& tkey : scan(prefix, true))
+		add_atom(table, key_uuid(tkey));
+
+	// Synchronize!
+	table.barrier();
+}
+
+void LocalAtomStorage::flushStoreQueue()
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	write_buffer();
+	if (fdatasync(_fd))
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: Cannot sync %s: %s",
+			_path.c_str(), strerror(errno));
+}
+
+/* ================================================================ */
+
+void LocalAtomStorage::load(AtomTable& table)
+{
+	time_t start = time(0);
+	size_t count = 0;
+
+	for (const std::string& akey : scan(std::string(1, ATOM_KEY), false))
+	{
+		// Skip atoms of types that are not defined in this atomspace,
+		// just as the SQL backend does.
+		try
+		{
+			add_atom(table, key_uuid(akey));
+			count++;
+		}
+		catch (const IOException& ex) {}
+	}
+
+	time_t secs = time(0) - start;
+	printf("Finished loading %lu atoms in total in %d seconds\n",
+		count, (int) secs);
+
+	// synchrnonize!
+	table.barrier();
+}
+
+/// Store all of the atoms in the atom table.
+void LocalAtomStorage::store(const AtomTable& table)
+{
+	time_t start = time(0);
+	size_t count = _num_atom_stores;
+
+	table.foreachHandleByType(
+		[&](const Handle& h)->void { storeAtom(h); },
+		NODE, true);
+
+	table.foreachHandleByType(
+		[&](const Handle& h)->void { storeAtom(h); },
+		LINK, true);
+
+	flushStoreQueue();
+
+	time_t secs = time(0) - start;
+	printf("\tFinished storing %lu atoms total, in %d seconds\n",
+		(unsigned long) (_num_atom_stores - count), (int) secs);
+}
+
+/* ================================================================ */
+
+void LocalAtomStorage::kill_data(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_primary.clear();
+	_secondary.clear();
+	_wbuf.clear();
+	_wbuf_off = MAGIC_LEN;
+	_live_bytes = 0;
+	_dead_bytes = 0;
+	_tlbuf.clear();
+
+	if (ftruncate(_fd, MAGIC_LEN))
+		throw IOException(TRACE_INFO,
+			"LocalAtomStorage: Cannot truncate: %s", strerror(errno));
+}
+
+void LocalAtomStorage::clear_cache(void)
+{
+	_tlbuf.clear();
+	reserve();
+}
+
+void LocalAtomStorage::clear_stats(void)
+{
+	_num_get_nodes = 0;
+	_num_got_nodes = 0;
+	_num_get_links = 0;
+	_num_got_links = 0;
+	_num_get_insets = 0;
+	_num_get_inlinks = 0;
+	_num_atom_stores = 0;
+	_num_value_stores = 0;
+	_num_atom_removes = 0;
+	_num_reads = 0;
+	_num_writes = 0;
+}
+
+void LocalAtomStorage::print_stats(void)
+{
+	size_t nkeys, nderived;
+	uint64_t live, dead;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		nkeys = _primary.size();
+		nderived = _secondary.size();
+		live = _live_bytes;
+		dead = _dead_bytes;
+	}
+
+	printf("local-stats: Currently open file: %s\n", _path.c_str());
+	printf("local-stats: keys = %lu derived keys = %lu\n", nkeys, nderived);
+	double frac = 100.0 * dead / ((double) (live + dead));
+	printf("local-stats: live bytes = %lu dead bytes = %lu (%f pct)\n",
+	       live, dead, frac);
+	printf("local-stats: record reads = %lu record writes = %lu\n",
+	       (size_t) _num_reads, (size_t) _num_writes);
+	printf("local-stats: atom stores = %lu value stores = %lu removes = %lu\n",
+	       (size_t) _num_atom_stores, (size_t) _num_value_stores,
+	       (size_t) _num_atom_removes);
+
+	size_t num_get_nodes = _num_get_nodes;
+	size_t num_got_nodes = _num_got_nodes;
+	size_t num_get_links = _num_get_links;
+	size_t num_got_links = _num_got_links;
+	size_t num_get_insets = _num_get_insets;
+	size_t num_get_inlinks = _num_get_inlinks;
+
+	frac = 100.0 * num_got_nodes / ((double) num_get_nodes);
+	printf("num_get_nodes=%lu num_got_nodes=%lu (%f pct)\n",
+	       num_get_nodes, num_got_nodes, frac);
+
+	frac = 100.0 * num_got_links / ((double) num_get_links);
+	printf("num_get_links=%lu num_got_links=%lu (%f pct)\n",
+	       num_get_links, num_got_links, frac);
+
+	frac = num_get_inlinks / ((double) num_get_insets);
+	printf("num_get_incoming_sets=%lu set total=%lu avg set size=%f\n",
+	       num_get_insets, num_get_inlinks, frac);
+}
@@ -0,0 +1,177 @@
+/*
+ * FUNCTION:
+ * Persistent Atom storage, in a local file.
+ *
+ * Copyright (c) 2017 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_LOCAL_ATOM_STORAGE_H
+#define _OPENCOG_LOCAL_ATOM_STORAGE_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/base/types.h>
+
+#include <opencog/atomspace/AtomTable.h>
+#include <opencog/atomspaceutils/TLB.h>
+#include <opencog/persist/sql/AtomStorage.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/// Embedded, serverless storage: atoms and values are kept in a single
+/// local file, with no database server. The file is an append-only log
+/// of key-value records; an ordered index of the keys is rebuilt in RAM
+/// when the file is opened. Atoms are found by a hash of their content,
+/// and incoming sets by prefix scans over (atom, link type, link) keys.
+///
+/// Like SQLAtomStorage, one instance may be shared by many threads.
+class LocalAtomStorage : public AtomStorage
+{
+	private:
+		std::string _path;
+		int _fd;
+
+		// --------------------------
+		// The log and its index.
+		//
+		// Only the records that hold data are in the log: atoms, by
+		// uuid, and values, by atom and key. The keys for finding
+		// atoms by content, by type and by incoming set, and values
+		// by key, are derived from these as they are indexed, and
+		// are never written.
+		struct Loc
+		{
+			uint64_t off;   // file offset of the record data
+			uint32_t len;   // length of the record data
+		};
+		std::map<std::string, Loc> _primary;
+		std::set<std::string> _secondary;
+		std::mutex _mtx;
+
+		// Records not yet written to the file; _wbuf_off is the file
+		// offset that the first of them will be written to.
+		std::string _wbuf;
+		uint64_t _wbuf_off;
+
+		// Bytes of records in the file that are still in use, and
+		// that have been overwritten or deleted.
+		uint64_t _live_bytes;
+		uint64_t _dead_bytes;
+
+		void open_log(void);
+		void replay(void);
+		void write_buffer(void);
+		std::string read_data(const Loc&);
+
+		Loc append(char, const std::string&, const std::string&);
+		void index_put(const std::string&, const std::string&, const Loc&);
+		void index_del(const std::string&);
+		void derived_keys(const std::string&, const std::string&,
+		                  std::vector<std::string>&);
+
+		bool get(const std::string&, std::string&);
+		void put(const std::string&, const std::string&);
+		void del(const std::string&);
+		std::vector<std::string> scan(const std::string&, bool);
+
+		// --------------------------
+		// Atoms
+		TLB _tlbuf;
+		std::mutex _store_mutex;
+
+		UUID lookup(const std::string&);
+		UUID find_uuid(const Handle&);
+		UUID do_store_atom(const Handle&);
+		Handle get_atom(UUID);
+		Handle add_atom(AtomTable&, UUID);
+		void remove_atom(UUID, bool);
+		void reserve(void);
+
+		// --------------------------
+		// Values
+		void store_atom_values(const Handle&, UUID);
+		void get_atom_values(const Handle&, UUID);
+
+		Handle tvpred; // the key to a very special valuation.
+
+		// --------------------------
+		// Performance statistics
+		std::atomic<size_t> _num_get_nodes;
+		std::atomic<size_t> _num_got_nodes;
+		std::atomic<size_t> _num_get_links;
+		std::atomic<size_t> _num_got_links;
+		std::atomic<size_t> _num_get_insets;
+		std::atomic<size_t> _num_get_inlinks;
+		std::atomic<size_t> _num_atom_stores;
+		std::atomic<size_t> _num_value_stores;
+		std::atomic<size_t> _num_atom_removes;
+		std::atomic<size_t> _num_reads;
+		std::atomic<size_t> _num_writes;
+
+	public:
+		LocalAtomStorage(std::string path);
+		LocalAtomStorage(const LocalAtomStorage&) = delete; // disable copying
+		LocalAtomStorage& operator=(const LocalAtomStorage&) = delete; // disable assignment
+		virtual ~LocalAtomStorage();
+		bool connected(void); // the file is open
+
+		void kill_data(void); // destroy file contents
+		void clear_cache(void); // clear out the TLB.
+		void compact(void); // rewrite the file, dropping dead records
+
+		void registerWith(AtomSpace*);
+		void unregisterWith(AtomSpace*);
+
+		// AtomStorage interface
+		Handle getNode(Type, const char *);
+		Handle getLink(Type, const HandleSeq&);
+		void getIncomingSet(AtomTable&, const Handle&);
+		void getIncomingByType(AtomTable&, const Handle&, Type t);
+		void getValuations(AtomTable&, const Handle&, bool get_all);
+		void storeAtom(const Handle&, bool synchronous = false);
+		void removeAtom(const Handle&, bool recursive);
+		void loadType(AtomTable&, Type);
+		void flushStoreQueue();
+
+		// Large-scale loads and saves
+		void load(AtomTable &); // Load entire contents of the file
+		void store(const AtomTable &); // Store entire contents of AtomTable
+
+		// Debugging and performance monitoring
+		void print_stats(void);
+		void clear_stats(void); // reset stats counters.
+};
+
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_LOCAL_ATOM_STORAGE_H
@@ -0,0 +1,178 @@
+/*
+ * opencog/persist/local/LocalPersistSCM.cc
+ *
+ * Copyright (c) 2017 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_GUILE
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atomspace/BackingStore.h>
+#include <opencog/guile/SchemePrimitive.h>
+#include <opencog/persist/sql/SQLBackingStore.h>
+
+#include "LocalAtomStorage.h"
+#include "LocalPersistSCM.h"
+
+using namespace opencog;
+
+
+// =================================================================
+
+LocalPersistSCM::LocalPersistSCM(AtomSpace *as)
+{
+    _as = as;
+    _store = NULL;
+    _backing = new SQLBackingStore();
+
+    static bool is_init = false;
+    if (is_init) return;
+    is_init = true;
+    scm_with_guile(init_in_guile, this);
+}
+
+void* LocalPersistSCM::init_in_guile(void* self)
+{
+    scm_c_define_module("opencog persist-local", init_in_module, self);
+    scm_c_use_module("opencog persist-local");
+    return NULL;
+}
+
+void LocalPersistSCM::init_in_module(void* data)
+{
+   LocalPersistSCM* self = (LocalPersistSCM*) data;
+   self->init();
+}
+
+void LocalPersistSCM::init(void)
+{
+    define_scheme_primitive("local-open", &LocalPersistSCM::do_open, this, "persist-local");
+    define_scheme_primitive("local-close", &LocalPersistSCM::do_close, this, "persist-local");
+    define_scheme_primitive("local-load", &LocalPersistSCM::do_load, this, "persist-local");
+    define_scheme_primitive("local-store", &LocalPersistSCM::do_store, this, "persist-local");
+    define_scheme_primitive("local-stats", &LocalPersistSCM::do_stats, this, "persist-local");
+    define_scheme_primitive("local-clear-cache", &LocalPersistSCM::do_clear_cache, this, "persist-local");
+    define_scheme_primitive("local-compact", &LocalPersistSCM::do_compact, this, "persist-local");
+}
+
+LocalPersistSCM::~LocalPersistSCM()
+{
+    delete _backing;
+}
+
+void LocalPersistSCM::do_open(const std::string& path)
+{
+    // Unconditionally use the current atomspace, until the next close.
+    AtomSpace *as = SchemeSmob::ss_get_env_as("local-open");
+    if (nullptr != as) _as = as;
+
+    if (nullptr == _as)
+        throw RuntimeException(TRACE_INFO,
+             "local-open: Error: No atomspace specified!");
+
+    // Allow only one connection at a time.
+    if (_as->isAttachedToBackingStore())
+        throw RuntimeException(TRACE_INFO,
+             "local-open: Error: Atomspace already connected to a storage backend!");
+
+    _store = new LocalAtomStorage(path);
+    if (!_store->connected())
+    {
+        delete _store;
+        _store = NULL;
+        throw RuntimeException(TRACE_INFO,
+            "local-open: Error: Unable to open the file %s", path.c_str());
+    }
+
+    // The SQL wrapper is just a wrapper; it works for any AtomStorage.
+    _backing->set_store(_store);
+    _backing->registerWith(_as);
+}
+
+void LocalPersistSCM::do_close(void)
+{
+    if (_store == NULL)
+        throw RuntimeException(TRACE_INFO,
+             "local-close: Error: File not open");
+
+    LocalAtomStorage *sto = _store;
+    _store = NULL;
+
+    _backing->unregisterWith(_as);
+    _backing->set_store(NULL);
+
+    delete sto;
+}
+
+void LocalPersistSCM::do_load(void)
+{
+    if (_store == NULL)
+        throw RuntimeException(TRACE_INFO,
+            "local-load: Error: File not open");
+
+    _store->loadAtomSpace(_as);
+}
+
+
+void LocalPersistSCM::do_store(void)
+{
+    if (_store == NULL)
+        throw RuntimeException(TRACE_INFO,
+            "local-store: Error: File not open");
+
+    _store->storeAtomSpace(_as);
+}
+
+void LocalPersistSCM::do_stats(void)
+{
+    if (_store == NULL) {
+        printf("local-stats: File not open\n");
+        return;
+    }
+
+    AtomSpace* as = SchemeSmob::ss_get_env_as("local-stats");
+    printf("local-stats: Atomspace holds %lu atoms\n", as->get_size());
+
+    _store->print_stats();
+}
+
+void LocalPersistSCM::do_clear_cache(void)
+{
+    if (_store == NULL) {
+        printf("local-clear-cache: File not open\n");
+        return;
+    }
+
+    _store->clear_cache();
+}
+
+void LocalPersistSCM::do_compact(void)
+{
+    if (_store == NULL)
+        throw RuntimeException(TRACE_INFO,
+            "local-compact: Error: File not open");
+
+    _store->compact();
+}
+
+void opencog_persist_local_init(void)
+{
+    static LocalPersistSCM patty(NULL);
+}
+#endif // HAVE_GUILE
@@ -0,0 +1,755 @@
+/*
+ * FUNCTION:
+ * Binary snapshots of the AtomSpace, for fast startup.
+ *
+ * Copyright (c) 2017 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/util/Logger.h>
+#include <opencog/util/oc_omp.h>
+
+#include <opencog/atoms/base/Atom.h>
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/base/Link.h>
+#include <opencog/atoms/base/Node.h>
+#include <opencog/atoms/base/FloatValue.h>
+#include <opencog/atoms/base/LinkValue.h>
+#include <opencog/atoms/base/StringValue.h>
+#include <opencog/truthvalue/TruthValue.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "AtomSpaceSnapshot.h"
+
+using namespace opencog;
+
+/* ================================================================ */
+/*
+ * File layout.
+ *
+ * The file starts with a fixed-size header, giving the size and the
+ * file offset of each of the sections that follow it. Every section
+ * is an array of fixed-size entries, starting on an eight-byte
+ * boundary, so that it can be used in place once the file is mapped
+ * into memory.
+ *
+ *    types       string index of the name of each type
+ *    strings     offset of each string in chars; one extra at the end
+ *    chars       the text of all of the strings
+ *    levels      index of the first atom of each height; one extra
+ *    atoms       SnapAtom, sorted by height
+ *    outgoing    atom index of each member of each outgoing set
+ *    values      SnapValue; a LinkValue comes after its members
+ *    valuations  SnapValuation
+ *    floats      the contents of the float values and truth values
+ *    refs        string indexes of string values, and value indexes
+ *                of the members of link values
+ */
+
+#define MAGIC "OCSNAP01"
+#define MAGIC_LEN 8
+#define BYTE_ORDER_MARK 0x01020304
+#define SNAPSHOT_VERSION 1
+
+// The atom is in the atomspace. Otherwise, it is only the key of a
+// value, or in the outgoing set of such a key.
+#define IN_ATOMSPACE 0x1
+
+// Atoms of the same height are built this many at a time, by each
+// thread; values likewise.
+#define BUILD_BATCH 10000
+#define NUM_OMP_THREADS 8
+
+namespace {
+
+struct Header
+{
+	char magic[MAGIC_LEN];
+	uint32_t byte_order;
+	uint32_t version;
+
+	// Number of entries in each section.
+	uint64_t ntypes;
+	uint64_t nstrings;
+	uint64_t nchars;
+	uint64_t nlevels;
+	uint64_t natoms;
+	uint64_t nout;
+	uint64_t nvalues;
+	uint64_t nvaluations;
+	uint64_t nfloats;
+	uint64_t nrefs;
+
+	// File offset of each section.
+	uint64_t types_off;
+	uint64_t strings_off;
+	uint64_t chars_off;
+	uint64_t levels_off;
+	uint64_t atoms_off;
+	uint64_t out_off;
+	uint64_t values_off;
+	uint64_t valuations_off;
+	uint64_t floats_off;
+	uint64_t refs_off;
+
+	uint64_t file_size;
+};
+
+struct SnapAtom
+{
+	uint32_t type;    // index into the type table
+	uint32_t flags;
+	uint64_t data;    // node: string index; link: index into outgoing
+	uint64_t arity;
+};
+
+struct SnapValue
+{
+	uint32_t type;    // index into the type table
+	uint32_t pad;
+	uint64_t data;    // index into floats, or into refs
+	uint64_t count;
+};
+
+struct SnapValuation
+{
+	uint64_t atom;
+	uint64_t key;
+	uint64_t value;
+};
+
+static size_t get_height(const Handle& h)
+{
+	if (not h->is_link()) return 0;
+
+	size_t maxd = 0;
+	for (const Handle& ho : h->getOutgoingSet())
+	{
+		size_t d = get_height(ho);
+		if (maxd < d) maxd = d;
+	}
+	return maxd + 1;
+}
+
+/* ================================================================ */
+// Writing
+
+/// The sections of a snapshot, as they are built up in RAM.
+struct Writer
+{
+	std::vector<uint64_t> types;
+	std::vector<uint64_t> strings;
+	std::string chars;
+	std::vector<uint64_t> levels;
+	std::vector<SnapAtom> atoms;
+	std::vector<uint64_t> out;
+	std::vector<SnapValue> values;
+	std::vector<SnapValuation> valuations;
+	std::vector<double> floats;
+	std::vector<uint64_t> refs;
+
+	std::unordered_map<std::string, uint64_t> string_ids;
+	std::unordered_map<Type, uint32_t> type_ids;
+	std::unordered_map<Handle, uint64_t> atom_ids;
+
+	Writer(void) : strings(1, 0), levels(1, 0) {}
+
+	uint64_t string_id(const std::string&);
+	uint32_t type_id(Type);
+	void add_atom(const Handle&, bool);
+	uint64_t add_value(const ProtoAtomPtr&);
+};
+
+uint64_t Writer::string_id(const std::string& str)
+{
+	auto it = string_ids.find(str);
+	if (it != string_ids.end()) return it->second;
+
+	uint64_t id = strings.size() - 1;
+	chars += str;
+	strings.push_back(chars.size());
+	string_ids.emplace(str, id);
+	return id;
+}
+
+uint32_t Writer::type_id(Type t)
+{
+	auto it = type_ids.find(t);
+	if (it != type_ids.end()) return it->second;
+
+	uint32_t id = types.size();
+	types.push_back(string_id(classserver().getTypeName(t)));
+	type_ids.emplace(t, id);
+	return id;
+}
+
+/// The outgoing set must have been added already.
+void Writer::add_atom(const Handle& h, bool in_space)
+{
+	SnapAtom sa;
+	sa.type = type_id(h->get_type());
+	sa.flags = in_space ? IN_ATOMSPACE : 0;
+	if (h->is_node())
+	{
+		sa.data = string_id(h->get_name());
+		sa.arity = 0;
+	}
+	else
+	{
+		sa.data = out.size();
+		sa.arity = h->get_arity();
+		for (const Handle& ho : h->getOutgoingSet())
+			out.push_back(atom_ids.at(ho));
+	}
+	atom_ids.emplace(h, atoms.size());
+	atoms.push_back(sa);
+}
+
+uint64_t Writer::add_value(const ProtoAtomPtr& pap)
+{
+	Type vtype = pap->get_type();
+	SnapValue sv;
+	sv.type = type_id(vtype);
+	sv.pad = 0;
+
+	if (classserver().isA(vtype, FLOAT_VALUE))
+	{
+		const std::vector<double>& fltarr = FloatValueCast(pap)->value();
+		sv.data = floats.size();
+		sv.count = fltarr.size();
+		floats.insert(floats.end(), fltarr.begin(), fltarr.end());
+	}
+	else if (classserver().isA(vtype, STRING_VALUE))
+	{
+		const std::vector<std::string>& strarr = StringValueCast(pap)->value();
+		sv.data = refs.size();
+		sv.count = strarr.size();
+		for (const std::string& s : strarr)
+			refs.push_back(string_id(s));
+	}
+	else if (classserver().isA(vtype, LINK_VALUE))
+	{
+		// The members go first, so that they have their indexes.
+		std::vector<uint64_t> members;
+		for (const ProtoAtomPtr& v : LinkValueCast(pap)->value())
+			members.push_back(add_value(v));
+		sv.data = refs.size();
+		sv.count = members.size();
+		refs.insert(refs.end(), members.begin(), members.end());
+	}
+	else
+		throw IOException(TRACE_INFO,
+			"save_snapshot: Unsupported value type %s",
+			classserver().getTypeName(vtype).c_str());
+
+	values.push_back(sv);
+	return values.size() - 1;
+}
+
+/// Write a section, padded out to an eight-byte boundary.
+static void write_section(FILE* fh, const std::string& path,
+                          const void* data, size_t len, uint64_t& off)
+{
+	static const char zeros[8] = {0};
+	size_t pad = (8 - len % 8) % 8;
+	if ((len and fwrite(data, len, 1, fh) != 1) or
+	    (pad and fwrite(zeros, pad, 1, fh) != 1))
+		throw IOException(TRACE_INFO,
+			"save_snapshot: Cannot write %s: %s", path.c_str(), strerror(errno));
+	off += len + pad;
+}
+
+template<typename T>
+static size_t bytes(const std::vector<T>& vec)
+{
+	return vec.size() * sizeof(T);
+}
+
+static uint64_t padded(uint64_t len)
+{
+	return (len + 7) & ~((uint64_t) 7);
+}
+
+} // anonymous namespace
+
+void opencog::save_snapshot(const AtomSpace& as, const std::string& path)
+{
+	HandleSeq all;
+	as.get_handles_by_type(all, ATOM, true);
+
+	// Keys that are not in the atomspace are written out as well,
+	// together with any of their outgoing sets that are not, since the
+	// values cannot be set without them.
+	HandleSet extra;
+	std::function<void(const Handle&)> add_extra =
+		[&](const Handle& h)->void
+	{
+		if (nullptr != as.get_atom(h) or extra.count(h)) return;
+		extra.insert(h);
+		if (h->is_link())
+			for (const Handle& ho : h->getOutgoingSet())
+				add_extra(ho);
+	};
+	for (const Handle& h : all)
+		for (const Handle& key : h->getKeys())
+			add_extra(key);
+
+	// Sort by height, so that the outgoing set of a link always comes
+	// before it.
+	std::vector<HandleSeq> levels;
+	auto add_level = [&](const Handle& h)->void
+	{
+		size_t height = get_height(h);
+		if (levels.size() <= height) levels.resize(height+1);
+		levels[height].push_back(h);
+	};
+	for (const Handle& h : all) add_level(h);
+	for (const Handle& h : extra) add_level(h);
+
+	Writer w;
+	for (HandleSeq& level : levels)
+	{
+		for (const Handle& h : level)
+			w.add_atom(h, 0 == extra.count(h));
+		w.levels.push_back(w.atoms.size());
+		level.clear();
+	}
+
+	// Default TV's have no key, and so are not written.
+	for (const Handle& h : all)
+	{
+		for (const Handle& key : h->getKeys())
+		{
+			ProtoAtomPtr pap(h->getValue(key));
+			if (nullptr == pap) continue;
+
+			SnapValuation sv;
+			sv.atom = w.atom_ids.at(h);
+			sv.key = w.atom_ids.at(key);
+			sv.value = w.add_value(pap);
+			w.valuations.push_back(sv);
+		}
+	}
+
+	Header hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, MAGIC, MAGIC_LEN);
+	hdr.byte_order = BYTE_ORDER_MARK;
+	hdr.version = SNAPSHOT_VERSION;
+	hdr.ntypes = w.types.size();
+	hdr.nstrings = w.strings.size() - 1;
+	hdr.nchars = w.chars.size();
+	hdr.nlevels = w.levels.size() - 1;
+	hdr.natoms = w.atoms.size();
+	hdr.nout = w.out.size();
+	hdr.nvalues = w.values.size();
+	hdr.nvaluations = w.valuations.size();
+	hdr.nfloats = w.floats.size();
+	hdr.nrefs = w.refs.size();
+
+	uint64_t off = padded(sizeof(Header));
+	hdr.types_off = off;       off += padded(bytes(w.types));
+	hdr.strings_off = off;     off += padded(bytes(w.strings));
+	hdr.chars_off = off;       off += padded(w.chars.size());
+	hdr.levels_off = off;      off += padded(bytes(w.levels));
+	hdr.atoms_off = off;       off += padded(bytes(w.atoms));
+	hdr.out_off = off;         off += padded(bytes(w.out));
+	hdr.values_off = off;      off += padded(bytes(w.values));
+	hdr.valuations_off = off;  off += padded(bytes(w.valuations));
+	hdr.floats_off = off;      off += padded(bytes(w.floats));
+	hdr.refs_off = off;        off += padded(bytes(w.refs));
+	hdr.file_size = off;
+
+	// The new file is written next to the old one, and then renamed
+	// over it, so that a crash leaves one or the other.
+	std::string tmp(path + ".tmp");
+	FILE* fh = fopen(tmp.c_str(), "wb");
+	if (nullptr == fh)
+		throw IOException(TRACE_INFO,
+			"save_snapshot: Cannot open %s: %s", tmp.c_str(), strerror(errno));
+
+	try
+	{
+		off = 0;
+		write_section(fh, tmp, &hdr, sizeof(hdr), off);
+		write_section(fh, tmp, w.types.data(), bytes(w.types), off);
+		write_section(fh, tmp, w.strings.data(), bytes(w.strings), off);
+		write_section(fh, tmp, w.chars.data(), w.chars.size(), off);
+		write_section(fh, tmp, w.levels.data(), bytes(w.levels), off);
+		write_section(fh, tmp, w.atoms.data(), bytes(w.atoms), off);
+		write_section(fh, tmp, w.out.data(), bytes(w.out), off);
+		write_section(fh, tmp, w.values.data(), bytes(w.values), off);
+		write_section(fh, tmp, w.valuations.data(), bytes(w.valuations), off);
+		write_section(fh, tmp, w.floats.data(), bytes(w.floats), off);
+		write_section(fh, tmp, w.refs.data(), bytes(w.refs), off);
+
+		if (fflush(fh) or fsync(fileno(fh)))
+			throw IOException(TRACE_INFO,
+				"save_snapshot: Cannot write %s: %s", tmp.c_str(), strerror(errno));
+	}
+	catch (...)
+	{
+		fclose(fh);
+		unlink(tmp.c_str());
+		throw;
+	}
+
+	if (fclose(fh) or rename(tmp.c_str(), path.c_str()))
+	{
+		int err = errno;
+		unlink(tmp.c_str());
+		throw IOException(TRACE_INFO,
+			"save_snapshot: Cannot replace %s: %s", path.c_str(), strerror(err));
+	}
+}
+
+/* ================================================================ */
+// Reading
+
+namespace {
+
+/// The whole file, mapped read-only into memory.
+class Mapping
+{
+	public:
+		const char* base;
+		size_t size;
+
+		Mapping(const std::string& path)
+		{
+			int fd = open(path.c_str(), O_RDONLY);
+			if (0 > fd)
+				throw IOException(TRACE_INFO,
+					"load_snapshot: Cannot open %s: %s",
+					path.c_str(), strerror(errno));
+
+			struct stat st;
+			if (fstat(fd, &st))
+			{
+				int err = errno;
+				close(fd);
+				throw IOException(TRACE_INFO,
+					"load_snapshot: Cannot stat %s: %s",
+					path.c_str(), strerror(err));
+			}
+			size = st.st_size;
+			if (size < sizeof(Header))
+			{
+				close(fd);
+				throw IOException(TRACE_INFO,
+					"load_snapshot: %s is not a snapshot", path.c_str());
+			}
+
+			void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			int err = errno;
+			close(fd);
+			if (MAP_FAILED == addr)
+				throw IOException(TRACE_INFO,
+					"load_snapshot: Cannot map %s: %s",
+					path.c_str(), strerror(err));
+
+			// All of it is about to be read.
+			madvise(addr, size, MADV_WILLNEED);
+			base = (const char*) addr;
+		}
+
+		~Mapping()
+		{
+			munmap((void*) base, size);
+		}
+
+		/// The section of n entries at off, if it fits in the file.
+		template<typename T>
+		const T* section(uint64_t off, uint64_t n) const
+		{
+			if (off % 8 or size < off or (size - off) / sizeof(T) < n)
+				throw IOException(TRACE_INFO,
+					"load_snapshot: Damaged snapshot; section out of bounds");
+			return (const T*) (base + off);
+		}
+};
+
+/// The sections of a mapped snapshot.
+struct Reader
+{
+	const Header* hdr;
+	const uint64_t* types;
+	const uint64_t* strings;
+	const char* chars;
+	const uint64_t* levels;
+	const SnapAtom* atoms;
+	const uint64_t* out;
+	const SnapValue* values;
+	const SnapValuation* valuations;
+	const double* floats;
+	const uint64_t* refs;
+
+	// The type table, as types of this process.
+	std::vector<Type> typemap;
+
+	Reader(const Mapping&, const std::string&);
+	void check(void);
+
+	std::string str(uint64_t i) const
+	{
+		return std::string(chars + strings[i], strings[i+1] - strings[i]);
+	}
+
+	ProtoAtomPtr value(uint64_t) const;
+};
+
+Reader::Reader(const Mapping& map, const std::string& path)
+{
+	hdr = (const Header*) map.base;
+	if (memcmp(hdr->magic, MAGIC, MAGIC_LEN))
+		throw IOException(TRACE_INFO,
+			"load_snapshot: %s is not a snapshot", path.c_str());
+	if (BYTE_ORDER_MARK != hdr->byte_order)
+		throw IOException(TRACE_INFO,
+			"load_snapshot: %s was written on a machine of another byte order",
+			path.c_str());
+	if (SNAPSHOT_VERSION != hdr->version)
+		throw IOException(TRACE_INFO,
+			"load_snapshot: %s has unsupported version %u",
+			path.c_str(), hdr->version);
+	if (map.size != hdr->file_size)
+		throw IOException(TRACE_INFO,
+			"load_snapshot: %s is truncated", path.c_str());
+
+	types = map.section<uint64_t>(hdr->types_off, hdr->ntypes);
+	strings = map.section<uint64_t>(hdr->strings_off, hdr->nstrings + 1);
+	chars = map.section<char>(hdr->chars_off, hdr->nchars);
+	levels = map.section<uint64_t>(hdr->levels_off, hdr->nlevels + 1);
+	atoms = map.section<SnapAtom>(hdr->atoms_off, hdr->natoms);
+	out = map.section<uint64_t>(hdr->out_off, hdr->nout);
+	values = map.section<SnapValue>(hdr->values_off, hdr->nvalues);
+	valuations = map.section<SnapValuation>(hdr->valuations_off,
+	                                        hdr->nvaluations);
+	floats = map.section<double>(hdr->floats_off, hdr->nfloats);
+	refs = map.section<uint64_t>(hdr->refs_off, hdr->nrefs);
+
+	check();
+}
+
+#define DAMAGED(WHAT) \
+	throw IOException(TRACE_INFO, "load_snapshot: Damaged snapshot; bad " WHAT)
+
+/// Check every index in the file, once, so that the atoms and values
+/// can then be built without any checks, in parallel.
+void Reader::check(void)
+{
+	if (0 != strings[0]) DAMAGED("string pool");
+	for (uint64_t i = 0; i < hdr->nstrings; i++)
+		if (strings[i+1] < strings[i]) DAMAGED("string pool");
+	if (hdr->nchars < strings[hdr->nstrings]) DAMAGED("string pool");
+
+	for (uint64_t i = 0; i < hdr->ntypes; i++)
+	{
+		if (hdr->nstrings <= types[i]) DAMAGED("type table");
+		std::string tname(str(types[i]));
+		Type t = classserver().getType(tname);
+		if (NOTYPE == t)
+			throw IOException(TRACE_INFO,
+				"load_snapshot: Unknown type %s; load the module "
+				"that defines it first", tname.c_str());
+		typemap.push_back(t);
+	}
+
+	if (0 != levels[0] or hdr->natoms != levels[hdr->nlevels])
+		DAMAGED("atom heights");
+	for (uint64_t lvl = 0; lvl < hdr->nlevels; lvl++)
+	{
+		if (levels[lvl+1] < levels[lvl]) DAMAGED("atom heights");
+		for (uint64_t i = levels[lvl]; i < levels[lvl+1]; i++)
+		{
+			const SnapAtom& sa = atoms[i];
+			if (hdr->ntypes <= sa.type) DAMAGED("atom");
+			Type t = typemap[sa.type];
+			if (classserver().isA(t, NODE))
+			{
+				if (hdr->nstrings <= sa.data) DAMAGED("node");
+				continue;
+			}
+			if (not classserver().isA(t, LINK) or hdr->nout < sa.data or
+			    hdr->nout - sa.data < sa.arity)
+				DAMAGED("link");
+
+			// The outgoing set must be of lower height.
+			for (uint64_t j = 0; j < sa.arity; j++)
+				if (levels[lvl] <= out[sa.data + j]) DAMAGED("link");
+		}
+	}
+
+	for (uint64_t i = 0; i < hdr->nvalues; i++)
+	{
+		const SnapValue& sv = values[i];
+		if (hdr->ntypes <= sv.type) DAMAGED("value");
+		Type vtype = typemap[sv.type];
+		if (vtype == FLOAT_VALUE or classserver().isA(vtype, TRUTH_VALUE))
+		{
+			if (hdr->nfloats < sv.data or hdr->nfloats - sv.data < sv.count)
+				DAMAGED("value");
+			continue;
+		}
+		if (vtype != STRING_VALUE and vtype != LINK_VALUE)
+			DAMAGED("value");
+		if (hdr->nrefs < sv.data or hdr->nrefs - sv.data < sv.count)
+			DAMAGED("value");
+
+		// The members of a link value come before it.
+		uint64_t limit = (vtype == STRING_VALUE) ? hdr->nstrings : i;
+		for (uint64_t j = 0; j < sv.count; j++)
+			if (limit <= refs[sv.data + j]) DAMAGED("value");
+	}
+
+	for (uint64_t i = 0; i < hdr->nvaluations; i++)
+	{
+		const SnapValuation& sv = valuations[i];
+		if (hdr->natoms <= sv.atom or hdr->natoms <= sv.key or
+		    hdr->nvalues <= sv.value)
+			DAMAGED("valuation");
+	}
+}
+
+ProtoAtomPtr Reader::value(uint64_t i) const
+{
+	const SnapValue& sv = values[i];
+	Type vtype = typemap[sv.type];
+
+	if (vtype == STRING_VALUE)
+	{
+		std::vector<std::string> strarr;
+		for (uint64_t j = 0; j < sv.count; j++)
+			strarr.push_back(str(refs[sv.data + j]));
+		return createStringValue(strarr);
+	}
+
+	if (vtype == LINK_VALUE)
+	{
+		std::vector<ProtoAtomPtr> lnkarr;
+		for (uint64_t j = 0; j < sv.count; j++)
+			lnkarr.push_back(value(refs[sv.data + j]));
+		return createLinkValue(lnkarr);
+	}
+
+	std::vector<double> fltarr(floats + sv.data, floats + sv.data + sv.count);
+	if (vtype == FLOAT_VALUE)
+		return createFloatValue(fltarr);
+	return ProtoAtomCast(TruthValue::factory(vtype, fltarr));
+}
+
+/// Run the callback on each index in [lo, hi), a batch per thread.
+/// The first exception thrown is passed on, once all are done.
+template<class F>
+static void for_range(uint64_t lo, uint64_t hi, F cb)
+{
+	std::vector<uint64_t> starts;
+	for (uint64_t st = lo; st < hi; st += BUILD_BATCH)
+		starts.push_back(st);
+
+	std::mutex mtx;
+	std::exception_ptr err;
+	OMP_ALGO::for_each(starts.begin(), starts.end(),
+		[&](uint64_t st)
+	{
+		try
+		{
+			uint64_t end = std::min(st + BUILD_BATCH, hi);
+			for (uint64_t i = st; i < end; i++) cb(i);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(mtx);
+			if (nullptr == err) err = std::current_exception();
+		}
+	});
+	if (err) std::rethrow_exception(err);
+}
+
+} // anonymous namespace
+
+size_t opencog::load_snapshot(AtomSpace& as, const std::string& path)
+{
+	time_t start = time(0);
+	Mapping map(path);
+	Reader rd(map, path);
+
+	opencog::setting_omp(NUM_OMP_THREADS, NUM_OMP_THREADS);
+
+	// Each height is built in parallel; the outgoing sets are all of
+	// lower height, and so are built already.
+	std::vector<Handle> handles(rd.hdr->natoms);
+	std::atomic<size_t> count(0);
+	for (uint64_t lvl = 0; lvl < rd.hdr->nlevels; lvl++)
+	{
+		for_range(rd.levels[lvl], rd.levels[lvl+1], [&](uint64_t i)
+		{
+			const SnapAtom& sa = rd.atoms[i];
+			Type t = rd.typemap[sa.type];
+			Handle h;
+			if (classserver().isA(t, NODE))
+				h = createNode(t, rd.str(sa.data));
+			else
+			{
+				HandleSeq oset;
+				oset.reserve(sa.arity);
+				for (uint64_t j = 0; j < sa.arity; j++)
+					oset.push_back(handles[rd.out[sa.data + j]]);
+				h = createLink(oset, t);
+			}
+
+			if (sa.flags & IN_ATOMSPACE)
+			{
+				h = as.add_atom(h);
+				count++;
+			}
+			handles[i] = h;
+		});
+	}
+
+	for_range(0, rd.hdr->nvaluations, [&](uint64_t i)
+	{
+		const SnapValuation& sv = rd.valuations[i];
+		handles[sv.atom]->setValue(handles[sv.key], rd.value(sv.value));
+	});
+
+	as.barrier();
+
+	logger().info("load_snapshot: Loaded %zu atoms from %s in %d seconds",
+		(size_t) count, path.c_str(), (int) (time(0) - start));
+	return count;
+}
@@ -0,0 +1,67 @@
+/*
+ * FUNCTION:
+ * Binary snapshots of the AtomSpace, for fast startup.
+ *
+ * Copyright (c) 2017 OpenCog Foundation
+ *
+ * LICENSE:
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_ATOMSPACE_SNAPSHOT_H
+#define _OPENCOG_ATOMSPACE_SNAPSHOT_H
+
+#include <string>
+
+#include <opencog/atomspace/AtomSpace.h>
+
+namespace opencog
+{
+/** \addtogroup grp_persist
+ *  @{
+ */
+
+/// A snapshot is a single file holding all of the atoms in an
+/// atomspace, and all of their values, laid out as flat arrays that
+/// can be mapped into memory and used as they are:
+///
+///  * a type table, giving the name of each type used in the file,
+///    so that the type numbers need not match between runs;
+///  * a string pool, holding type names, node names and string values;
+///  * the atoms, sorted by height, each with its type and either the
+///    name of the node or the index of the outgoing set of the link;
+///  * the outgoing sets, as indexes into the atoms;
+///  * the values, and the (atom, key, value) valuations.
+///
+/// Unlike the SQL and local-file backends, a snapshot is written and
+/// read as a whole; it cannot be updated in place. Integers are in
+/// the byte order of the machine that wrote the file.
+
+/// Write all of the atoms in the atomspace, and their values, to the
+/// file at path. The file is replaced only once the new one is
+/// complete. Throws an IOException on failure.
+void save_snapshot(const AtomSpace&, const std::string& path);
+
+/// Add all of the atoms in the snapshot at path to the atomspace, and
+/// set their values. Atoms of the same height are built in parallel.
+/// Returns the number of atoms added. Throws an IOException if the
+/// file cannot be read, or is damaged.
+size_t load_snapshot(AtomSpace&, const std::string& path);
+
+/** @}*/
+} // namespace opencog
+
+#endif // _OPENCOG_ATOMSPACE_SNAPSHOT_H
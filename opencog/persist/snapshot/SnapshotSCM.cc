@@ -0,0 +1,91 @@
+/*
+ * opencog/persist/snapshot/SnapshotSCM.cc
+ *
+ * Copyright (c) 2017 by OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifdef HAVE_GUILE
+
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/guile/SchemePrimitive.h>
+
+#include "AtomSpaceSnapshot.h"
+#include "SnapshotSCM.h"
+
+using namespace opencog;
+
+
+// =================================================================
+
+SnapshotSCM::SnapshotSCM(AtomSpace *as)
+{
+    _as = as;
+
+    static bool is_init = false;
+    if (is_init) return;
+    is_init = true;
+    scm_with_guile(init_in_guile, this);
+}
+
+void* SnapshotSCM::init_in_guile(void* self)
+{
+    scm_c_define_module("opencog persist-snapshot", init_in_module, self);
+    scm_c_use_module("opencog persist-snapshot");
+    return NULL;
+}
+
+void SnapshotSCM::init_in_module(void* data)
+{
+   SnapshotSCM* self = (SnapshotSCM*) data;
+   self->init();
+}
+
+void SnapshotSCM::init(void)
+{
+    define_scheme_primitive("save-snapshot", &SnapshotSCM::do_save, this, "persist-snapshot");
+    define_scheme_primitive("load-snapshot", &SnapshotSCM::do_load, this, "persist-snapshot");
+}
+
+/// The current atomspace, if there is one.
+AtomSpace* SnapshotSCM::get_as(const char* fname)
+{
+    AtomSpace *as = SchemeSmob::ss_get_env_as(fname);
+    if (nullptr != as) return as;
+
+    if (nullptr == _as)
+        throw RuntimeException(TRACE_INFO,
+             "%s: Error: No atomspace specified!", fname);
+    return _as;
+}
+
+void SnapshotSCM::do_save(const std::string& path)
+{
+    save_snapshot(*get_as("save-snapshot"), path);
+}
+
+void SnapshotSCM::do_load(const std::string& path)
+{
+    load_snapshot(*get_as("load-snapshot"), path);
+}
+
+void opencog_persist_snapshot_init(void)
+{
+    static SnapshotSCM patty(NULL);
+}
+#endif // HAVE_GUILE
@@ -34,9 +34,11 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <thread>
+#include <unordered_map>
 
 #include <opencog/util/oc_assert.h>
 #include <opencog/util/oc_omp.h>
@@ -124,6 +126,20 @@ class SQLAtomStorage::Response
 			rs = _conn->exec(buff);
 		}
 
+		void exec(const LLStatement& stmt, const LLParams& params)
+		{
+			if (rs) rs->release();
+			if (nullptr == _conn) _conn = _pool.pop();
+			rs = _conn->exec_prepared(stmt, params);
+		}
+
+		// The connection itself, for COPY.
+		LLConnection* conn(void)
+		{
+			if (nullptr == _conn) _conn = _pool.pop();
+			return _conn;
+		}
+
 		// Fetching of atoms -----------------------------------------
 		bool create_atom_column_cb(const char *colname, const char * colvalue)
 		{
@@ -340,41 +356,64 @@ class SQLAtomStorage::Response
 			return false;
 		}
 
-		// Valuations --------------------------------------------
-		// Get the values first, and then get the atom they are attached
-		// to. This is backwards from everything up above.
-		Handle katom;
-		bool get_all_values;
-		bool get_valuations_cb(void)
+		// The values of many atoms at once; the atom each row belongs
+		// to is looked up by its uuid.
+		std::unordered_map<UUID, Handle> *amap;
+		bool get_batch_values_cb(void)
 		{
 			rs->foreach_column(&Response::get_value_column_cb, this);
 
-			// Do we know this atom yet? If not, go get it.
-			// Note: it is very likely we do NOT yet have this atom!
-			Handle h(store->_tlbuf.getAtom(uuid));
-			if (nullptr == h)
-			{
-				PseudoPtr pu(store->petAtom(uuid));
-				h = store->get_recursive_if_not_exists(pu);
-				h = table->add(h, false);
-				store->_tlbuf.addAtom(h, uuid);
-			}
+			auto it = amap->find(uuid);
+			if (amap->end() == it) return false;
 
-			// If user wanted all the values, then go get them.
-			if (get_all_values)
+			Handle hkey(store->_tlbuf.getAtom(key));
+			if (nullptr == hkey)
 			{
-				store->get_atom_values(h);
-				return false;
+				PseudoPtr pu(store->petAtom(key));
+				hkey = store->get_recursive_if_not_exists(pu);
 			}
 
-			// Otherwise, just get this one and only value.
 			ProtoAtomPtr pap = store->doUnpackValue(*this);
-			h->setValue(katom, pap);
+			it->second->setValue(hkey, pap);
+			return false;
+		}
 
+		// Valuations --------------------------------------------
+		// Get the values first, and then get the atom they are attached
+		// to. This is backwards from everything up above. It is very
+		// likely that we do NOT yet have the atoms; they are fetched
+		// all at once, after all of the rows have been seen.
+		bool get_all_values;
+		std::vector<std::pair<UUID, ProtoAtomPtr>> *vvec;
+		bool get_valuations_cb(void)
+		{
+			rs->foreach_column(&Response::get_value_column_cb, this);
+
+			// If the user wants all the values, they are fetched later;
+			// otherwise, just keep this one and only value.
+			ProtoAtomPtr pap;
+			if (not get_all_values)
+				pap = store->doUnpackValue(*this);
+
+			vvec->emplace_back(uuid, pap);
 			return false;
 		}
 
 		// Generic things --------------------------------------------
+		// Get all of the columns of all of the rows, as strings.
+		std::vector<std::string> *svec;
+		bool strings_cb(void)
+		{
+			rs->foreach_column(&Response::strings_column_cb, this);
+			return false;
+		}
+
+		bool strings_column_cb(const char *colname, const char * colvalue)
+		{
+			svec->emplace_back(colvalue ? colvalue : "");
+			return false;
+		}
+
 		// Get generic positive integer values
 		unsigned long intval;
 		bool intval_cb(void)
@@ -577,6 +616,51 @@ void SQLAtomStorage::extract_callback(const AtomPtr& atom)
 /* AtomTable UUID stuff */
 #define BUFSZ 250
 
+// Prepared statements for the most frequent queries. These are parsed
+// and planned once per connection, and their parameters are sent in
+// binary, instead of being printed into the SQL text.
+static const LLStatement get_atom_stmt = {"get_atom",
+	"SELECT * FROM Atoms WHERE uuid = $1;"};
+static const LLStatement get_node_stmt = {"get_node",
+	"SELECT * FROM Atoms WHERE type = $1 AND name = $2;"};
+static const LLStatement get_link_stmt = {"get_link",
+	"SELECT * FROM Atoms WHERE type = $1 AND outgoing = $2;"};
+static const LLStatement insert_node_stmt = {"insert_node",
+	"INSERT INTO Atoms (uuid, space, type, height, name) "
+	"VALUES ($1, $2, $3, $4, $5);"};
+static const LLStatement insert_link_stmt = {"insert_link",
+	"INSERT INTO Atoms (uuid, space, type, height, outgoing) "
+	"VALUES ($1, $2, $3, $4, $5);"};
+static const LLStatement get_valuation_stmt = {"get_valuation",
+	"SELECT * FROM Valuations WHERE key = $1 AND atom = $2;"};
+static const LLStatement delete_valuation_stmt = {"delete_valuation",
+	"DELETE FROM Valuations WHERE key = $1 AND atom = $2;"};
+static const LLStatement insert_valuation_stmt = {"insert_valuation",
+	"INSERT INTO Valuations "
+	"(key, atom, type, floatvalue, stringvalue, linkvalue) "
+	"VALUES ($1, $2, $3, $4, $5, $6);"};
+static const LLStatement get_atom_values_stmt = {"get_atom_values",
+	"SELECT * FROM Valuations WHERE atom = $1;"};
+
+// The most uuids asked for in one query, when fetching many atoms or
+// values at once. Keeps the query string to a few tens of KBytes.
+#define FETCH_BATCH 1000
+
+/// The uuids from lo up to (not including) hi, as an SQL array.
+static std::string uuid_array(const std::vector<UUID>& uuids,
+                              size_t lo, size_t hi)
+{
+	hi = std::min(hi, uuids.size());
+	std::string str = "CAST('{";
+	for (size_t i = lo; i < hi; i++)
+	{
+		if (lo < i) str += ",";
+		str += std::to_string(uuids[i]);
+	}
+	str += "}' AS BIGINT[])";
+	return str;
+}
+
 void SQLAtomStorage::store_atomtable_id(const AtomTable& at)
 {
 	UUID tab_id = at.get_uuid();
@@ -636,13 +720,12 @@ void SQLAtomStorage::deleteValuation(const Handle& key, const Handle& atom)
 
 void SQLAtomStorage::deleteValuation(Response& rp, UUID key_uid, UUID atom_uid)
 {
-	char buff[BUFSZ];
-	snprintf(buff, BUFSZ,
-		"SELECT * FROM Valuations WHERE key = %lu AND atom = %lu;",
-		key_uid, atom_uid);
+	LLParams params;
+	params.add_bigint(key_uid);
+	params.add_bigint(atom_uid);
 
 	rp.vtype = 0;
-	rp.exec(buff);
+	rp.exec(get_valuation_stmt, params);
 	rp.rs->foreach_row(&Response::get_value_cb, &rp);
 
 	if (LINK_VALUE == rp.vtype)
@@ -660,13 +743,7 @@ void SQLAtomStorage::deleteValuation(Response& rp, UUID key_uid, UUID atom_uid)
 	}
 
 	if (0 != rp.vtype)
-	{
-		snprintf(buff, BUFSZ,
-			"DELETE FROM Valuations WHERE key = %lu AND atom = %lu;",
-			key_uid, atom_uid);
-
-		rp.exec(buff);
-	}
+		rp.exec(delete_valuation_stmt, params);
 }
 
 /**
@@ -682,11 +759,6 @@ void SQLAtomStorage::storeValuation(const Handle& key,
                                     const Handle& atom,
                                     const ProtoAtomPtr& pap)
 {
-	bool notfirst = false;
-	std::string cols;
-	std::string vals;
-	std::string coda;
-
 	// Get UUID from the TLB.
 	UUID kuid;
 	{
@@ -703,47 +775,14 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 			kuid = get_uuid(key);
 		}
 	}
-
-	char kidbuff[BUFSZ];
-	snprintf(kidbuff, BUFSZ, "%lu", kuid);
-
-	char aidbuff[BUFSZ];
 	UUID auid = get_uuid(atom);
-	snprintf(aidbuff, BUFSZ, "%lu", auid);
 
 	// The prior valuation, if any, will be deleted first,
 	// and so an INSERT is sufficient to cover everything.
-	cols = "INSERT INTO Valuations (";
-	vals = ") VALUES (";
-	coda = ");";
-	STMT("key", kidbuff);
-	STMT("atom", aidbuff);
-
-	Type vtype = pap->get_type();
-	STMTI("type", storing_typemap[vtype]);
-
-	if (classserver().isA(vtype, FLOAT_VALUE))
-	{
-		FloatValuePtr fvp = FloatValueCast(pap);
-		std::string fstr = float_to_string(fvp);
-		STMT("floatvalue", fstr);
-	}
-	else
-	if (classserver().isA(vtype, STRING_VALUE))
-	{
-		StringValuePtr fvp = StringValueCast(pap);
-		std::string sstr = string_to_string(fvp);
-		STMT("stringvalue", sstr);
-	}
-	else
-	if (classserver().isA(vtype, LINK_VALUE))
-	{
-		LinkValuePtr fvp = LinkValueCast(pap);
-		std::string lstr = link_to_string(fvp);
-		STMT("linkvalue", lstr);
-	}
-
-	std::string insert = cols + vals + coda;
+	LLParams params;
+	params.add_bigint(kuid);
+	params.add_bigint(auid);
+	value_params(params, pap);
 
 	std::lock_guard<std::mutex> lck(_value_mutex[auid%NUMVMUT]);
 	// Use a transaction, so that other threads/users see the
@@ -757,12 +796,44 @@ void SQLAtomStorage::storeValuation(const Handle& key,
 	// If there's an existing valuation, delete it.
 	deleteValuation(rp, kuid, auid);
 
-	rp.exec(insert.c_str());
+	rp.exec(insert_valuation_stmt, params);
 	rp.exec("COMMIT;");
 
 	_valuation_stores++;
 }
 
+/// Add the type and the three value columns of a Valuation. Only one
+/// of the three arrays is set; the others are NULL. The elements of a
+/// LinkValue are stored in the Values table; or, if a COPY buffer is
+/// given, they are added to it as rows of the Values table.
+void SQLAtomStorage::value_params(LLParams& params, const ProtoAtomPtr& pap,
+                                  std::string* values)
+{
+	Type vtype = pap->get_type();
+	params.add_smallint(storing_typemap[vtype]);
+
+	if (classserver().isA(vtype, FLOAT_VALUE))
+		params.add_double_array(FloatValueCast(pap)->value());
+	else
+		params.add_null(LLParams::DOUBLE_ARRAY);
+
+	if (classserver().isA(vtype, STRING_VALUE))
+		params.add_text_array(StringValueCast(pap)->value());
+	else
+		params.add_null(LLParams::TEXT_ARRAY);
+
+	if (classserver().isA(vtype, LINK_VALUE))
+	{
+		std::vector<unsigned long> vuids;
+		for (const ProtoAtomPtr& v : LinkValueCast(pap)->value())
+			vuids.emplace_back(values ? copy_value_row(*values, v)
+			                          : storeValue(v));
+		params.add_bigint_array(vuids);
+	}
+	else
+		params.add_null(LLParams::BIGINT_ARRAY);
+}
+
 // Almost a cut-n-passte of the above, but different.
 SQLAtomStorage::VUID SQLAtomStorage::storeValue(const ProtoAtomPtr& pap)
 {
@@ -853,13 +924,15 @@ ProtoAtomPtr SQLAtomStorage::doUnpackValue(Response& rp)
 {
 	// Convert from databasse type to C++ runtime type
 	Type vtype = loading_typemap[rp.vtype];
+	std::vector<std::string> strarr;
+	std::vector<double> fltarr;
+	std::vector<VUID> lnkarr;
 
 	// We expect rp.strval to be of the form
 	// {aaa,"bb bb bb","ccc ccc ccc"}
 	// Split it along the commas.
 	if (vtype == STRING_VALUE)
 	{
-		std::vector<std::string> strarr;
 		char *s = strdup(rp.strval);
 		char *p = s;
 		if (p and *p == '{') p++;
@@ -881,7 +954,6 @@ ProtoAtomPtr SQLAtomStorage::doUnpackValue(Response& rp)
 			p++;
 		}
 		free(s);
-		return createStringValue(strarr);
 	}
 
 	// We expect rp.fltval to be of the form
@@ -889,7 +961,6 @@ ProtoAtomPtr SQLAtomStorage::doUnpackValue(Response& rp)
 	if ((vtype == FLOAT_VALUE)
 	    or classserver().isA(vtype, TRUTH_VALUE))
 	{
-		std::vector<double> fltarr;
 		char *p = (char *) rp.fltval;
 		if (p and *p == '{') p++;
 		while (p)
@@ -899,32 +970,53 @@ ProtoAtomPtr SQLAtomStorage::doUnpackValue(Response& rp)
 			fltarr.emplace_back(flt);
 			p++; // skip over  comma
 		}
-		if (vtype == FLOAT_VALUE)
-			return createFloatValue(fltarr);
-		else
-			return ProtoAtomCast(TruthValue::factory(vtype, fltarr));
 	}
 
 	// We expect rp.lnkval to be a comma-separated list of
 	// vuid's, which we then fetch recursively.
 	if (vtype == LINK_VALUE)
 	{
-		std::vector<ProtoAtomPtr> lnkarr;
 		const char *p = rp.lnkval;
 		if (p and *p == '{') p++;
 		while (p)
 		{
 			if (*p == '}' or *p == '\0') break;
-			VUID vu = atol(p);
-			ProtoAtomPtr pap = getValue(vu);
-			lnkarr.emplace_back(pap);
+			lnkarr.emplace_back(atol(p));
 			p = strchr(p, ',');
 			if (p) p++;
 		}
-		return createLinkValue(lnkarr);
 	}
 
-	throw IOException(TRACE_INFO, "Unexpected value type=%d", rp.vtype);
+	return makeValue(rp.vtype, fltarr, strarr, lnkarr);
+}
+
+/// Build a value of the given database type from its columns. The
+/// elements of a LinkValue are fetched from the Values table.
+ProtoAtomPtr SQLAtomStorage::makeValue(int dbtype,
+                                       const std::vector<double>& fltarr,
+                                       const std::vector<std::string>& strarr,
+                                       const std::vector<VUID>& lnkarr)
+{
+	Type vtype = loading_typemap[dbtype];
+
+	if (vtype == STRING_VALUE)
+		return createStringValue(strarr);
+
+	if (vtype == FLOAT_VALUE)
+		return createFloatValue(fltarr);
+
+	if (classserver().isA(vtype, TRUTH_VALUE))
+		return ProtoAtomCast(TruthValue::factory(vtype, fltarr));
+
+	if (vtype == LINK_VALUE)
+	{
+		std::vector<ProtoAtomPtr> vals;
+		for (VUID vu : lnkarr)
+			vals.emplace_back(getValue(vu));
+		return createLinkValue(vals);
+	}
+
+	throw IOException(TRACE_INFO, "Unexpected value type=%d", dbtype);
 	return nullptr;
 }
 
@@ -979,13 +1071,14 @@ void SQLAtomStorage::get_atom_values(Handle& atom)
 {
 	if (nullptr == atom) return;
 
-	char buff[BUFSZ];
-	snprintf(buff, BUFSZ,
-		"SELECT * FROM Valuations WHERE atom = %lu;",
-		get_uuid(atom));
+	LLParams params;
+	params.add_bigint(get_uuid(atom));
 
 	Response rp(conn_pool);
-	rp.exec(buff);
+	rp.exec(get_atom_values_stmt, params);
+#ifdef STORAGE_DEBUG
+	_num_value_fetches++;
+#endif // STORAGE_DEBUG
 
 	rp.store = this;
 	rp.atom = atom;
@@ -993,6 +1086,38 @@ void SQLAtomStorage::get_atom_values(Handle& atom)
 	rp.atom = nullptr;
 }
 
+/// Get ALL of the values associated with each of the atoms, in a few
+/// round-trips, instead of one per atom.
+void SQLAtomStorage::get_atoms_values(const HandleSeq& atoms)
+{
+	std::unordered_map<UUID, Handle> amap;
+	std::vector<UUID> uuids;
+	for (const Handle& h : atoms)
+	{
+		if (nullptr == h) continue;
+		UUID uuid = check_uuid(h);
+		if (TLB::INVALID_UUID == uuid) continue;
+		if (amap.emplace(uuid, h).second)
+			uuids.emplace_back(uuid);
+	}
+
+	Response rp(conn_pool);
+	rp.store = this;
+	rp.amap = &amap;
+	for (size_t lo = 0; lo < uuids.size(); lo += FETCH_BATCH)
+	{
+		std::string qstr = "SELECT * FROM Valuations WHERE atom = ANY(";
+		qstr += uuid_array(uuids, lo, lo + FETCH_BATCH);
+		qstr += ");";
+		rp.exec(qstr.c_str());
+#ifdef STORAGE_DEBUG
+		_num_value_batches++;
+#endif // STORAGE_DEBUG
+		rp.rs->foreach_row(&Response::get_batch_values_cb, &rp);
+	}
+	rp.amap = nullptr;
+}
+
 /* ================================================================== */
 
 /**
@@ -1062,18 +1187,12 @@ UUID SQLAtomStorage::get_uuid(const Handle& h)
 	return TLB::INVALID_UUID;
 }
 
-std::string SQLAtomStorage::oset_to_string(const HandleSeq& out)
+std::vector<unsigned long> SQLAtomStorage::oset_to_uuids(const HandleSeq& out)
 {
-	bool not_first = false;
-	std::string str = "\'{";
+	std::vector<unsigned long> uuids;
 	for (const Handle& h : out)
-	{
-		if (not_first) str += ", ";
-		not_first = true;
-		str += std::to_string(get_uuid(h));
-	}
-	str += "}\'";
-	return str;
+		uuids.emplace_back(get_uuid(h));
+	return uuids;
 }
 
 std::string SQLAtomStorage::float_to_string(const FloatValuePtr& fvle)
@@ -1341,18 +1460,8 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 	// If it was not found, then issue a brand-spankin new UUID.
 	uuid = _tlbuf.addAtom(h, TLB::INVALID_UUID);
 
-	std::string uuidbuff = std::to_string(uuid);
-
-	bool notfirst = false;
-	std::string cols;
-	std::string vals;
-	std::string coda;
-
-	cols = "INSERT INTO Atoms (";
-	vals = ") VALUES (";
-	coda = ");";
-
-	STMT("uuid", uuidbuff);
+	LLParams params;
+	params.add_bigint(uuid);
 
 #ifdef STORAGE_DEBUG
 	if (0 == aheight) {
@@ -1365,28 +1474,19 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 	// Store the atomspace UUID
 	AtomTable * at = getAtomTable(h);
 	// We allow storage of atoms that don't belong to an atomspace.
-	if (at) uuidbuff = std::to_string(at->get_uuid());
-	else uuidbuff = "0";
-
 	// XXX FIXME -- right now, multiple space support is incomplete,
 	// the below hacks around some testing issues.
-	if (at) uuidbuff = "1";
-	STMT("space", uuidbuff);
+	params.add_bigint(at ? 1 : 0);
 
 	// Store the atom UUID
 	Type t = h->get_type();
 	int dbtype = storing_typemap[t];
-	STMTI("type", dbtype);
+	params.add_smallint(dbtype);
 
 	// Store the node name, if its a node
+	const LLStatement* insert = &insert_link_stmt;
 	if (0 == aheight)
 	{
-		// Use postgres $-quoting to make unicode strings
-		// easier to deal with.
-		std::string qname = " $ocp$";
-		qname += h->get_name();
-		qname += "$ocp$ ";
-
 		// The Atoms table has a UNIQUE constraint on the
 		// node name.  If a node name is too long, a postgres
 		// error is generated:
@@ -1396,20 +1496,22 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 		// a redesign of the table format, in some way. Maybe
 		// we could hash the long node names, store the hash,
 		// and make sure that is unique.
-		if (2700 < qname.size())
+		const std::string& name = h->get_name();
+		if (2700 < name.size())
 		{
 			throw IOException(TRACE_INFO,
 				"Error: do_store_single_atom: Maxiumum Node name size is 2700.\n");
 		}
-		STMT("name", qname);
 
 		// Nodes have a height of zero by definition.
-		STMTI("height", 0);
+		params.add_smallint(0);
+		params.add_text(name);
+		insert = &insert_node_stmt;
 	}
 	else
 	{
 		if (max_height < aheight) max_height = aheight;
-		STMTI("height", aheight);
+		params.add_smallint(aheight);
 
 		if (h->is_link())
 		{
@@ -1429,19 +1531,18 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 					"Atom was: %s\n", h->to_string().c_str());
 			}
 
-			cols += ", outgoing";
-			vals += ", ";
-			vals += oset_to_string(h->getOutgoingSet());
+			params.add_bigint_array(oset_to_uuids(h->getOutgoingSet()));
 		}
+		else
+			params.add_null(LLParams::BIGINT_ARRAY);
 	}
 
 	// We may have to store the atom table UUID and try again...
 	// We waste CPU cycles to store the atomtable, only if it failed.
 	bool try_again = false;
-	std::string qry = cols + vals + coda;
 	{
 		Response rp(conn_pool);
-		rp.exec(qry.c_str());
+		rp.exec(*insert, params);
 		if (NULL == rp.rs) try_again = true;
 	}
 
@@ -1451,7 +1552,7 @@ void SQLAtomStorage::do_store_single_atom(const Handle& h, int aheight)
 		if (at) store_atomtable_id(*at);
 
 		Response rp(conn_pool);
-		rp.exec(qry.c_str());
+		rp.exec(*insert, params);
 	}
 
 	_store_count ++;
@@ -1583,14 +1684,16 @@ void SQLAtomStorage::set_typemap(int dbval, const char * tname)
 
 /**
  * One-size-fits-all atom fetcher.
- * Given an SQL query string, this will return a single atom.
+ * Given an SQL query, this will return a single atom.
  * It does NOT fetch values.
  */
-SQLAtomStorage::PseudoPtr SQLAtomStorage::getAtom(const char * query, int height)
+SQLAtomStorage::PseudoPtr SQLAtomStorage::getAtom(const LLStatement& stmt,
+                                                  const LLParams& params,
+                                                  int height)
 {
 	Response rp(conn_pool);
 	rp.uuid = TLB::INVALID_UUID;
-	rp.exec(query);
+	rp.exec(stmt, params);
 	rp.rs->foreach_row(&Response::create_atom_cb, &rp);
 
 	// Did we actually find anything?
@@ -1605,10 +1708,101 @@ SQLAtomStorage::PseudoPtr SQLAtomStorage::getAtom(const char * query, int height
 SQLAtomStorage::PseudoPtr SQLAtomStorage::petAtom(UUID uuid)
 {
 	setup_typemap();
-	char buff[BUFSZ];
-	snprintf(buff, BUFSZ, "SELECT * FROM Atoms WHERE uuid = %lu;", uuid);
+	LLParams params;
+	params.add_bigint(uuid);
+
+#ifdef STORAGE_DEBUG
+	_num_atom_fetches++;
+#endif // STORAGE_DEBUG
+	return getAtom(get_atom_stmt, params, -1);
+}
+
+/// Fetch all of the atoms with the given uuids, FETCH_BATCH of them
+/// per round-trip. Atoms that are not in the database are skipped.
+/// It does NOT fetch values.
+std::vector<SQLAtomStorage::PseudoPtr>
+SQLAtomStorage::petAtoms(const std::vector<UUID>& uuids)
+{
+	setup_typemap();
+	std::vector<PseudoPtr> pset;
+	Response rp(conn_pool);
+	rp.store = this;
+	rp.height = -1;
+	rp.pvec = &pset;
+	for (size_t lo = 0; lo < uuids.size(); lo += FETCH_BATCH)
+	{
+		std::string qstr = "SELECT * FROM Atoms WHERE uuid = ANY(";
+		qstr += uuid_array(uuids, lo, lo + FETCH_BATCH);
+		qstr += ");";
+		rp.exec(qstr.c_str());
+		rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
+#ifdef STORAGE_DEBUG
+		_num_atom_batches++;
+#endif // STORAGE_DEBUG
+	}
+#ifdef STORAGE_DEBUG
+	_num_batched_atoms += pset.size();
+#endif // STORAGE_DEBUG
+	return pset;
+}
+
+/// Fetch everything under the given atoms that is not yet in the TLB,
+/// one level of the outgoing sets at a time: the number of round-trips
+/// grows with the height of the atoms, and not with their number.
+/// The fetched atoms are placed in `fetched`, for use by
+/// get_recursive_if_not_exists(). A uuid that is not in the database
+/// is mapped to null.
+void SQLAtomStorage::get_missing_outgoing(const std::vector<PseudoPtr>& pset,
+                                          PseudoMap& fetched)
+{
+	std::vector<PseudoPtr> level(pset);
+	while (not level.empty())
+	{
+		std::vector<UUID> missing;
+		for (const PseudoPtr& p : level)
+		{
+			for (UUID idu : p->oset)
+			{
+				if (fetched.find(idu) != fetched.end()) continue;
+				if (_tlbuf.getAtom(idu)) continue;
+				fetched.emplace(idu, nullptr);
+				missing.emplace_back(idu);
+			}
+		}
+		if (missing.empty()) break;
 
-	return getAtom(buff, -1);
+		level = petAtoms(missing);
+		for (const PseudoPtr& p : level)
+			fetched[p->uuid] = p;
+	}
+}
+
+/// Return the atoms with the given uuids, fetching the ones that are
+/// not yet known, and adding them to the table. The result holds one
+/// handle per uuid; it is null if there is no such atom.
+/// It does NOT fetch values.
+HandleSeq SQLAtomStorage::get_atoms_if_not_exists(AtomTable& table,
+                                                  const std::vector<UUID>& uuids)
+{
+	std::vector<UUID> missing;
+	for (UUID uuid : uuids)
+		if (nullptr == _tlbuf.getAtom(uuid))
+			missing.emplace_back(uuid);
+
+	std::vector<PseudoPtr> pset(petAtoms(missing));
+	PseudoMap fetched;
+	get_missing_outgoing(pset, fetched);
+	for (const PseudoPtr& p : pset)
+	{
+		Handle h(get_recursive_if_not_exists(p, &fetched));
+		h = table.add(h, false);
+		_tlbuf.addAtom(h, p->uuid);
+	}
+
+	HandleSeq atoms;
+	for (UUID uuid : uuids)
+		atoms.emplace_back(_tlbuf.getAtom(uuid));
+	return atoms;
 }
 
 /// Get the full outgoing set, recursively.
@@ -1616,8 +1810,12 @@ SQLAtomStorage::PseudoPtr SQLAtomStorage::petAtom(UUID uuid)
 /// the outgoing set of the link has not yet been loaded.  In
 /// that case, we have to load the outgoing set first.
 ///
+/// Atoms already fetched by get_missing_outgoing() are taken from
+/// `fetched`, if given, instead of being fetched one at a time.
+///
 /// Note that this does NOT fetch any values!
-Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p)
+Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p,
+                                                   const PseudoMap* fetched)
 {
 	if (classserver().isA(p->type, NODE))
 	{
@@ -1638,7 +1836,12 @@ Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p)
 			resolved_oset.emplace_back(h);
 			continue;
 		}
-		PseudoPtr po(petAtom(idu));
+		PseudoPtr po;
+		PseudoMap::const_iterator it;
+		if (fetched and fetched->end() != (it = fetched->find(idu)))
+			po = it->second;
+		else
+			po = petAtom(idu);
 
 		// Corrupted databases can have outoging sets that refer
 		// to non-existent atoms. This is rare, but has happened.
@@ -1648,7 +1851,7 @@ Handle SQLAtomStorage::get_recursive_if_not_exists(PseudoPtr p)
 				"SQLAtomStorage::get_recursive_if_not_exists: "
 				"Corrupt database; no atom for uuid=%lu", idu);
 
-		Handle ha(get_recursive_if_not_exists(po));
+		Handle ha(get_recursive_if_not_exists(po, fetched));
 		resolved_oset.emplace_back(ha);
 	}
 	Handle link(createLink(resolved_oset, p->type));
@@ -1670,6 +1873,11 @@ void SQLAtomStorage::getIncoming(AtomTable& table, const char *buff)
 	rp.exec(buff);
 	rp.rs->foreach_row(&Response::fetch_incoming_set_cb, &rp);
 
+	// Get everything under the incoming set that we don't have yet,
+	// a level at a time, instead of one atom at a time.
+	PseudoMap fetched;
+	get_missing_outgoing(pset, fetched);
+
 	HandleSeq iset;
 	std::mutex iset_mutex;
 
@@ -1681,14 +1889,16 @@ void SQLAtomStorage::getIncoming(AtomTable& table, const char *buff)
 	OMP_ALGO::for_each(pset.begin(), pset.end(),
 		[&] (const PseudoPtr& p)
 	{
-		Handle hi(get_recursive_if_not_exists(p));
+		Handle hi(get_recursive_if_not_exists(p, &fetched));
 		hi = table.add(hi, false);
 		_tlbuf.addAtom(hi, p->uuid);
-		get_atom_values(hi);
 		std::lock_guard<std::mutex> lck(iset_mutex);
 		iset.emplace_back(hi);
 	});
 
+	// Get the values only after TLB insertion!!
+	get_atoms_values(iset);
+
 #ifdef STORAGE_DEBUG
 	_num_get_insets++;
 	_num_get_inlinks += iset.size();
@@ -1753,14 +1963,30 @@ void SQLAtomStorage::getValuations(AtomTable& table,
 	snprintf(buff, BUFSZ,
 		"SELECT * FROM Valuations WHERE key=%lu;", kuid);
 
-	Response rp(conn_pool);
-	rp.store = this;
-	rp.table = &table;
-	rp.katom = key;
-	rp.get_all_values = get_all_values;
-	rp.exec(buff);
-	rp.rs->foreach_row(&Response::get_valuations_cb, &rp);
-	rp.katom = nullptr;
+	std::vector<std::pair<UUID, ProtoAtomPtr>> vals;
+	{
+		Response rp(conn_pool);
+		rp.store = this;
+		rp.get_all_values = get_all_values;
+		rp.vvec = &vals;
+		rp.exec(buff);
+		rp.rs->foreach_row(&Response::get_valuations_cb, &rp);
+	}
+
+	std::vector<UUID> uuids;
+	for (const auto& v : vals)
+		uuids.emplace_back(v.first);
+	HandleSeq atoms(get_atoms_if_not_exists(table, uuids));
+
+	// If user wanted all the values, then go get them.
+	if (get_all_values)
+	{
+		get_atoms_values(atoms);
+		return;
+	}
+
+	for (size_t i = 0; i < atoms.size(); i++)
+		if (atoms[i]) atoms[i]->setValue(key, vals[i].second);
 }
 
 /**
@@ -1777,25 +2003,15 @@ Handle SQLAtomStorage::doGetNode(Type t, const char * str)
 
 	// If we don't know it, then go get it's UUID.
 	setup_typemap();
-	char buff[4*BUFSZ];
+	LLParams params;
+	params.add_smallint(storing_typemap[t]);
+	params.add_text(str);
 
-	// Use postgres $-quoting to make unicode strings easier to deal with.
-	int nc = snprintf(buff, 4*BUFSZ, "SELECT * FROM Atoms WHERE "
-		"type = %hu AND name = $ocp$%s$ocp$ ;", storing_typemap[t], str);
-
-	if (4*BUFSZ-1 <= nc)
-	{
-		buff[4*BUFSZ-1] = 0x0;
-		throw IOException(TRACE_INFO,
-			"SQLAtomStorage::getNode: buffer overflow!\n"
-			"\tnc=%d buffer=>>%s<<\n", nc, buff);
-		return Handle();
-	}
 #ifdef STORAGE_DEBUG
 	_num_get_nodes++;
 #endif // STORAGE_DEBUG
 
-	PseudoPtr p(getAtom(buff, 0));
+	PseudoPtr p(getAtom(get_node_stmt, params, 0));
 	if (NULL == p) return Handle();
 
 #ifdef STORAGE_DEBUG
@@ -1826,10 +2042,10 @@ Handle SQLAtomStorage::doGetLink(Type t, const HandleSeq& hseq)
 
 	// If the outgoing set is not yet known, then the link
 	// itself cannot possibly be known.
-	std::string ostr;
+	std::vector<unsigned long> oset;
 	try
 	{
-		ostr = oset_to_string(hseq);
+		oset = oset_to_uuids(hseq);
 	}
 	catch (const NotFoundException& ex)
 	{
@@ -1838,20 +2054,14 @@ Handle SQLAtomStorage::doGetLink(Type t, const HandleSeq& hseq)
 
 	// If we don't know it, then go get it's UUID.
 	setup_typemap();
-
-	char buff[BUFSZ];
-	snprintf(buff, BUFSZ,
-		"SELECT * FROM Atoms WHERE type = %hu AND outgoing = ",
-		storing_typemap[t]);
-
-	std::string qstr = buff;
-	qstr += ostr;
-	qstr += ";";
+	LLParams params;
+	params.add_smallint(storing_typemap[t]);
+	params.add_bigint_array(oset);
 
 #ifdef STORAGE_DEBUG
 	_num_get_links++;
 #endif // STORAGE_DEBUG
-	PseudoPtr p = getAtom(qstr.c_str(), 1);
+	PseudoPtr p = getAtom(get_link_stmt, params, 1);
 	if (nullptr == p) return Handle();
 
 #ifdef STORAGE_DEBUG
@@ -1874,15 +2084,7 @@ Handle SQLAtomStorage::getLink(Type t, const HandleSeq& hs)
 SQLAtomStorage::PseudoPtr SQLAtomStorage::makeAtom(Response &rp, UUID uuid)
 {
 	// Now that we know everything about an atom, actually construct one.
-	Type realtype = loading_typemap[rp.itype];
-
-	if (NOTYPE == realtype)
-	{
-		throw IOException(TRACE_INFO,
-			"Fatal Error: OpenCog does not have a type called %s\n",
-			db_typename[rp.itype]);
-		return NULL;
-	}
+	Type realtype = load_type(rp.itype);
 
 	PseudoPtr atom(createPseudo());
 
@@ -1911,23 +2113,48 @@ SQLAtomStorage::PseudoPtr SQLAtomStorage::makeAtom(Response &rp, UUID uuid)
 	atom->type = realtype;
 	atom->uuid = uuid;
 
-	_load_count ++;
-	if (bulk_load and _load_count%100000 == 0)
+	count_load();
+	return atom;
+}
+
+/// The opencog type of a database type; throws if there is none.
+Type SQLAtomStorage::load_type(int dbtype)
+{
+	Type realtype = loading_typemap[dbtype];
+
+	if (NOTYPE == realtype)
+	{
+		throw IOException(TRACE_INFO,
+			"Fatal Error: OpenCog does not have a type called %s\n",
+			db_typename[dbtype]);
+	}
+	return realtype;
+}
+
+/// Count one more loaded atom, and report progress on bulk loads.
+void SQLAtomStorage::count_load(void)
+{
+	size_t count = ++_load_count;
+	if (bulk_load and count%100000 == 0)
 	{
 		time_t secs = time(0) - bulk_start;
-		double rate = ((double) _load_count) / secs;
-		unsigned long kays = ((unsigned long) _load_count) / 1000;
+		double rate = ((double) count) / secs;
+		unsigned long kays = ((unsigned long) count) / 1000;
 		printf("\tLoaded %luK atoms in %d seconds (%d per second).\n",
 			kays, (int) secs, (int) rate);
 	}
-
-	return atom;
 }
 
 /* ================================================================ */
 
 void SQLAtomStorage::load(AtomTable &table)
 {
+	if (can_copy())
+	{
+		copy_load(table);
+		return;
+	}
+
 	unsigned long max_nrec = getMaxObservedUUID();
 	_tlbuf.reserve_upto(max_nrec);
 	printf("Max observed UUID is %lu\n", max_nrec);
@@ -2071,14 +2298,23 @@ void SQLAtomStorage::store(const AtomTable &table)
 
 	bulk_start = time(0);
 
-	// Try to knock out the nodes first, then the links.
-	table.foreachHandleByType(
-		[&](const Handle& h)->void { storeAtom(h); },
-		NODE, true);
-
-	table.foreachHandleByType(
-		[&](const Handle& h)->void { storeAtom(h); },
-		LINK, true);
+	// An empty database can be filled with COPY; otherwise, each
+	// atom is checked for, and stored if need be.
+	if (bulk_store and can_copy())
+	{
+		copy_store(table);
+	}
+	else
+	{
+		// Try to knock out the nodes first, then the links.
+		table.foreachHandleByType(
+			[&](const Handle& h)->void { storeAtom(h); },
+			NODE, true);
+
+		table.foreachHandleByType(
+			[&](const Handle& h)->void { storeAtom(h); },
+			LINK, true);
+	}
 
 	flushStoreQueue();
 	bulk_store = false;
@@ -2089,6 +2325,465 @@ void SQLAtomStorage::store(const AtomTable &table)
 		(unsigned long) _store_count, (int) secs, (int) rate);
 }
 
+/* ================================================================ */
+// Bulk store and load, with COPY.
+//
+// Instead of one INSERT or SELECT per atom, whole tables are sent
+// and received in the binary COPY format. Atoms are sent in order of
+// height, so that the uuids of the outgoing set are always known, and
+// the constraints and indexes are built once, after all of the rows
+// are in. On loading, a few streams are read at once, each decoded in
+// its own thread.
+
+// Each thread encodes this many atoms at a time.
+#define COPY_BATCH 10000
+
+// Each height is loaded as this many streams, in parallel.
+#define COPY_STREAMS NUM_OMP_THREADS
+
+bool SQLAtomStorage::can_copy(void)
+{
+	Response rp(conn_pool);
+	return rp.conn()->can_copy();
+}
+
+/// Drop the constraints and the indexes of a table, so that a COPY
+/// does not have to update them row by row. The SQL to put them back
+/// is appended to restore.
+void SQLAtomStorage::drop_indexes(Response& rp, const char * tabname,
+                                  std::vector<std::string>& restore)
+{
+	char buff[BUFSZ*2];
+	std::vector<std::string> rows;
+	rp.svec = &rows;
+
+	// The primary key, unique and foreign key constraints. The
+	// indexes behind them go away with them.
+	snprintf(buff, sizeof(buff),
+		"SELECT conname, pg_get_constraintdef(oid) FROM pg_constraint "
+		"WHERE conrelid = '%s'::regclass AND contype IN ('p','u','f');",
+		tabname);
+	rp.exec(buff);
+	rp.rs->foreach_row(&Response::strings_cb, &rp);
+	for (size_t i = 0; i+1 < rows.size(); i += 2)
+	{
+		restore.emplace_back(std::string("ALTER TABLE ") + tabname +
+			" ADD CONSTRAINT \"" + rows[i] + "\" " + rows[i+1] + ";");
+		std::string drop = std::string("ALTER TABLE ") + tabname +
+			" DROP CONSTRAINT \"" + rows[i] + "\";";
+		rp.exec(drop.c_str());
+	}
+
+	// All of the other indexes.
+	rows.clear();
+	snprintf(buff, sizeof(buff),
+		"SELECT i.relname, pg_get_indexdef(i.oid) "
+		"FROM pg_index x JOIN pg_class i ON i.oid = x.indexrelid "
+		"WHERE x.indrelid = '%s'::regclass AND NOT EXISTS "
+		"(SELECT 1 FROM pg_constraint c WHERE c.conindid = x.indexrelid);",
+		tabname);
+	rp.exec(buff);
+	rp.rs->foreach_row(&Response::strings_cb, &rp);
+	for (size_t i = 0; i+1 < rows.size(); i += 2)
+	{
+		restore.emplace_back(rows[i+1] + ";");
+		std::string drop = "DROP INDEX \"" + rows[i] + "\";";
+		rp.exec(drop.c_str());
+	}
+	rp.svec = nullptr;
+}
+
+/// One row of the Atoms table.
+void SQLAtomStorage::copy_atom_row(std::string& buf, const Handle& h,
+                                   int height)
+{
+	LLParams row(false);
+	row.add_bigint(_tlbuf.getUUID(h));
+	row.add_bigint(getAtomTable(h) ? 1 : 0);
+	row.add_smallint(storing_typemap[h->get_type()]);
+	row.add_smallint(height);
+	if (h->is_node())
+	{
+		row.add_text(h->get_name());
+		row.add_null(LLParams::BIGINT_ARRAY);
+	}
+	else
+	{
+		row.add_null(LLParams::TEXT);
+		std::vector<unsigned long> oset;
+		for (const Handle& ho : h->getOutgoingSet())
+			oset.emplace_back(_tlbuf.getUUID(ho));
+		row.add_bigint_array(oset);
+	}
+	LLCopy::add_row(buf, row);
+}
+
+/// The rows of the Valuations table for all of the values on an atom.
+/// The elements of LinkValues go into a separate buffer, as rows of
+/// the Values table.
+void SQLAtomStorage::copy_valuation_rows(std::string& buf,
+                                         std::string& values,
+                                         const Handle& h)
+{
+	UUID auid = _tlbuf.getUUID(h);
+
+	// Default TV's have no key, and so are not stored, just as in
+	// store_atom_values().
+	for (const Handle& key : h->getKeys())
+	{
+		ProtoAtomPtr pap(h->getValue(key));
+		if (nullptr == pap) continue;
+
+		LLParams row(false);
+		row.add_bigint(_tlbuf.getUUID(key));
+		row.add_bigint(auid);
+		value_params(row, pap, &values);
+		LLCopy::add_row(buf, row);
+		_valuation_stores++;
+	}
+}
+
+/// One row of the Values table, after the rows of its elements, if it
+/// is a LinkValue. Returns the new vuid.
+SQLAtomStorage::VUID SQLAtomStorage::copy_value_row(std::string& values,
+                                                    const ProtoAtomPtr& pap)
+{
+	VUID vuid = _next_valid++;
+	LLParams row(false);
+	row.add_bigint(vuid);
+	value_params(row, pap, &values);
+	LLCopy::add_row(values, row);
+	_value_stores++;
+	return vuid;
+}
+
+/// Send the rows for the atoms, encoded by several threads at once,
+/// a batch each, but sent in order. If a buffer for the Values table
+/// is given, the rows are those of the Valuations table, and the rows
+/// for the elements of LinkValues are added to that buffer.
+void SQLAtomStorage::copy_in(Response& rp, const char * sql,
+                             const HandleSeq& atoms,
+                             const std::vector<int>& heights,
+                             std::string* values)
+{
+	LLConnection* conn = rp.conn();
+	conn->copy_in_begin(sql);
+	conn->copy_in_put(LLCopy::header());
+
+	size_t group = COPY_BATCH * NUM_OMP_THREADS;
+	try
+	{
+		for (size_t lo = 0; lo < atoms.size(); lo += group)
+		{
+			std::vector<size_t> starts;
+			for (size_t st = lo; st < std::min(lo + group, atoms.size());
+			     st += COPY_BATCH)
+				starts.push_back(st);
+
+			std::vector<std::string> bufs(starts.size());
+			std::vector<std::string> vbufs(starts.size());
+			OMP_ALGO::for_each(starts.begin(), starts.end(),
+				[&](size_t st)
+			{
+				std::string& buf = bufs[(st - lo) / COPY_BATCH];
+				std::string& vbuf = vbufs[(st - lo) / COPY_BATCH];
+				size_t hi = std::min(st + COPY_BATCH, atoms.size());
+				for (size_t i = st; i < hi; i++)
+				{
+					if (values)
+						copy_valuation_rows(buf, vbuf, atoms[i]);
+					else
+						copy_atom_row(buf, atoms[i], heights[i]);
+				}
+			});
+
+			for (const std::string& buf : bufs)
+				conn->copy_in_put(buf);
+
+			if (values)
+			{
+				for (const std::string& vbuf : vbufs)
+					values->append(vbuf);
+				continue;
+			}
+			_store_count += std::min(lo + group, atoms.size()) - lo;
+			time_t secs = time(0) - bulk_start;
+			double rate = ((double) _store_count) / (secs ? secs : 1);
+			unsigned long kays = ((unsigned long) _store_count) / 1000;
+			printf("\tStored %luK atoms in %d seconds (%d per second)\n",
+				kays, (int) secs, (int) rate);
+		}
+	}
+	catch (...)
+	{
+		// Leave the connection fit for the ROLLBACK.
+		try { conn->copy_in_end("copy_in failed"); } catch (...) {}
+		throw;
+	}
+
+	conn->copy_in_put(LLCopy::trailer());
+	conn->copy_in_end();
+}
+
+/// Send rows that have already been encoded.
+void SQLAtomStorage::copy_in(Response& rp, const char * sql,
+                             const std::string& rows)
+{
+	LLConnection* conn = rp.conn();
+	conn->copy_in_begin(sql);
+	try
+	{
+		conn->copy_in_put(LLCopy::header());
+		conn->copy_in_put(rows);
+	}
+	catch (...)
+	{
+		try { conn->copy_in_end("copy_in failed"); } catch (...) {}
+		throw;
+	}
+	conn->copy_in_put(LLCopy::trailer());
+	conn->copy_in_end();
+}
+
+/// Store all of the atoms in the atom table, and their values, into
+/// an empty database.
+void SQLAtomStorage::copy_store(const AtomTable& table)
+{
+	// Sort the atoms by height; the uuids are issued in that order.
+	// Keys that are not in the table are stored the ordinary way,
+	// before the tables are locked up.
+	std::vector<HandleSeq> levels;
+	HandleSet keys;
+	table.foreachHandleByType(
+		[&](const Handle& h)->void
+		{
+			if (TLB::INVALID_UUID != _tlbuf.getUUID(h)) return;
+
+			if (h->is_node() and 2700 < h->get_name().size())
+				throw IOException(TRACE_INFO,
+					"Error: copy_store: Maxiumum Node name size is 2700.\n");
+			if (h->is_link() and 330 < h->get_arity())
+				throw IOException(TRACE_INFO,
+					"Error: copy_store: Maxiumum Link size is 330. "
+					"Atom was: %s\n", h->to_string().c_str());
+
+			size_t height = get_height(h);
+			if (levels.size() <= height) levels.resize(height+1);
+			levels[height].push_back(h);
+
+			for (const Handle& key : h->getKeys())
+				keys.insert(key);
+		},
+		ATOM, true);
+
+	for (const Handle& key : keys)
+		if (nullptr == table.getHandle(key) and
+		    TLB::INVALID_UUID == _tlbuf.getUUID(key))
+			do_store_atom(key);
+
+	HandleSeq atoms;
+	std::vector<int> heights;
+	for (size_t hei = 0; hei < levels.size(); hei++)
+	{
+		for (const Handle& h : levels[hei])
+		{
+			_tlbuf.addAtom(h, TLB::INVALID_UUID);
+			atoms.push_back(h);
+			heights.push_back(hei);
+		}
+		levels[hei].clear();
+		if (max_height < (int) hei) max_height = hei;
+	}
+	printf("Storing %zu atoms, with COPY; Max Height is %d\n",
+		atoms.size(), max_height);
+
+	// Everything happens in one transaction, so that a failure
+	// leaves neither half the data, nor a table without its indexes.
+	Response rp(conn_pool);
+	try
+	{
+		rp.exec("BEGIN;");
+
+		std::vector<std::string> restore_atoms, restore_valuations;
+		drop_indexes(rp, "Valuations", restore_valuations);
+		drop_indexes(rp, "Atoms", restore_atoms);
+
+		// The elements of LinkValues are collected while the
+		// Valuations are sent, and sent last; all on the one
+		// connection, so that they are part of the transaction.
+		std::string values;
+		copy_in(rp, "COPY Atoms (uuid, space, type, height, name, outgoing) "
+			"FROM STDIN WITH (FORMAT binary);", atoms, heights, nullptr);
+		copy_in(rp, "COPY Valuations "
+			"(key, atom, type, floatvalue, stringvalue, linkvalue) "
+			"FROM STDIN WITH (FORMAT binary);", atoms, heights, &values);
+		if (not values.empty())
+			copy_in(rp, "COPY Values "
+				"(vuid, type, floatvalue, stringvalue, linkvalue) "
+				"FROM STDIN WITH (FORMAT binary);", values);
+
+		time_t secs = time(0) - bulk_start;
+		printf("\tRebuilding the indexes after %d seconds\n", (int) secs);
+		for (const std::string& sql : restore_atoms)
+			rp.exec(sql.c_str());
+		for (const std::string& sql : restore_valuations)
+			rp.exec(sql.c_str());
+
+		rp.exec("COMMIT;");
+	}
+	catch (...)
+	{
+		// None of the new uuids made it to the database.
+		try { rp.exec("ROLLBACK;"); } catch (...) {}
+		clear_cache();
+		throw;
+	}
+}
+
+/// Read one COPY ... TO STDOUT, handing each row to the callback.
+/// If the callback throws, the rest of the data is read and thrown
+/// away, before the connection goes back to the pool.
+template<class F>
+static void copy_out(LLConnection* conn, const char * sql, F row_cb)
+{
+	conn->copy_out_begin(sql);
+	LLCopyReader rd;
+	std::string piece;
+	try
+	{
+		while (conn->copy_out_get(piece))
+		{
+			rd.feed(piece);
+			while (rd.next_row()) row_cb(rd);
+		}
+	}
+	catch (...)
+	{
+		try { while (conn->copy_out_get(piece)) {} } catch (...) {}
+		throw;
+	}
+}
+
+/// Load all of the atoms, and then all of the values.
+void SQLAtomStorage::copy_load(AtomTable& table)
+{
+	unsigned long max_nrec = getMaxObservedUUID();
+	_tlbuf.reserve_upto(max_nrec);
+	printf("Max observed UUID is %lu\n", max_nrec);
+	_load_count = 0;
+	max_height = getMaxObservedHeight();
+	printf("Max Height is %d\n", max_height);
+	bulk_load = true;
+	bulk_start = time(0);
+
+	setup_typemap();
+
+	std::vector<unsigned long> steps;
+	unsigned long stepsize = 1 + max_nrec/COPY_STREAMS;
+	for (unsigned long rec = 0; rec <= max_nrec; rec += stepsize)
+		steps.push_back(rec);
+
+	printf("Loading all atoms, with COPY: "
+		"Max Height is %d stepsize=%lu streams=%lu\n",
+		 max_height, stepsize, steps.size());
+
+	// Parallelize always.
+	opencog::setting_omp(NUM_OMP_THREADS, NUM_OMP_THREADS);
+
+	for (int hei=0; hei<=max_height; hei++)
+	{
+		unsigned long cur = _load_count;
+
+		OMP_ALGO::for_each(steps.begin(), steps.end(),
+			[&](unsigned long rec)
+		{
+			Response rp(conn_pool);
+			char buff[BUFSZ];
+			snprintf(buff, BUFSZ, "COPY (SELECT uuid, type, name, outgoing "
+			         "FROM Atoms WHERE height = %d AND uuid > %lu AND "
+			         "uuid <= %lu) TO STDOUT WITH (FORMAT binary);",
+			         hei, rec, rec+stepsize);
+			copy_out(rp.conn(), buff, [&](const LLCopyReader& rd)
+			{
+				// As in load_all_atoms_cb, atoms of unknown types,
+				// and atoms with missing outgoing sets, are skipped.
+				try
+				{
+					PseudoPtr p(createPseudo());
+					p->uuid = rd.get_bigint(0);
+					p->type = load_type(rd.get_smallint(1));
+					if (not rd.is_null(2))
+						p->name = rd.get_text(2);
+					else if (not rd.is_null(3))
+						for (unsigned long u : rd.get_bigint_array(3))
+							p->oset.emplace_back(u);
+					count_load();
+
+					Handle atom(get_recursive_if_not_exists(p));
+					Handle h(table.add(atom, false));
+					_tlbuf.addAtom(h, p->uuid);
+				}
+				catch (const IOException& ex) {}
+			});
+		});
+		printf("Loaded %lu atoms at height %d\n", _load_count - cur, hei);
+	}
+
+	// The values, now that all of the atoms are known.
+	std::atomic<size_t> nvalues(0);
+	OMP_ALGO::for_each(steps.begin(), steps.end(),
+		[&](unsigned long rec)
+	{
+		Response rp(conn_pool);
+		char buff[BUFSZ];
+		snprintf(buff, BUFSZ, "COPY (SELECT key, atom, type, floatvalue, "
+		         "stringvalue, linkvalue FROM Valuations WHERE "
+		         "atom > %lu AND atom <= %lu) TO STDOUT WITH (FORMAT binary);",
+		         rec, rec+stepsize);
+		copy_out(rp.conn(), buff, [&](const LLCopyReader& rd)
+		{
+			Handle atom(_tlbuf.getAtom(rd.get_bigint(1)));
+			if (nullptr == atom) return;
+			try
+			{
+				UUID key = rd.get_bigint(0);
+				Handle hkey(_tlbuf.getAtom(key));
+				if (nullptr == hkey)
+				{
+					PseudoPtr pu(petAtom(key));
+					if (nullptr == pu) return;
+					hkey = get_recursive_if_not_exists(pu);
+				}
+
+				std::vector<double> fltarr;
+				std::vector<std::string> strarr;
+				std::vector<VUID> lnkarr;
+				if (not rd.is_null(3)) fltarr = rd.get_double_array(3);
+				if (not rd.is_null(4)) strarr = rd.get_text_array(4);
+				if (not rd.is_null(5))
+					for (unsigned long vu : rd.get_bigint_array(5))
+						lnkarr.emplace_back(vu);
+
+				atom->setValue(hkey,
+					makeValue(rd.get_smallint(2), fltarr, strarr, lnkarr));
+				nvalues++;
+			}
+			catch (const IOException& ex) {}
+		});
+	});
+
+	time_t secs = time(0) - bulk_start;
+	double rate = ((double) _load_count) / (secs ? secs : 1);
+	printf("Finished loading %lu atoms and %lu values in total "
+		"in %d seconds (%d per second)\n",
+		(unsigned long) _load_count, (unsigned long) nvalues,
+		(int) secs, (int) rate);
+	bulk_load = false;
+
+	// synchrnonize!
+	table.barrier();
+}
+
 /* ================================================================ */
 
 void SQLAtomStorage::rename_tables(void)
@@ -2252,6 +2947,11 @@ void SQLAtomStorage::clear_stats(void)
 	_num_link_inserts = 0;
 	_num_atom_removes = 0;
 	_num_atom_deletes = 0;
+	_num_atom_fetches = 0;
+	_num_atom_batches = 0;
+	_num_batched_atoms = 0;
+	_num_value_fetches = 0;
+	_num_value_batches = 0;
 #endif // STORAGE_DEBUG
 }
 
@@ -2304,6 +3004,18 @@ void SQLAtomStorage::print_stats(void)
 	printf("num_get_incoming_sets=%lu set total=%lu avg set size=%f\n",
 	       num_get_insets, num_get_inlinks, frac);
 
+	// Round-trips to the database, when fetching atoms and values.
+	size_t num_atom_fetches = _num_atom_fetches;
+	size_t num_atom_batches = _num_atom_batches;
+	size_t num_batched_atoms = _num_batched_atoms;
+	size_t num_value_fetches = _num_value_fetches;
+	size_t num_value_batches = _num_value_batches;
+	frac = num_batched_atoms / ((double) num_atom_batches);
+	printf("atom fetches: single=%lu batched=%lu (%lu atoms, avg %f per batch)\n",
+	       num_atom_fetches, num_atom_batches, num_batched_atoms, frac);
+	printf("value fetches: single=%lu batched=%lu\n",
+	       num_value_fetches, num_value_batches);
+
 	unsigned long tot_node = num_node_inserts;
 	unsigned long tot_link = num_link_inserts;
 	frac = tot_link / ((double) tot_node);
@@ -29,6 +29,7 @@
 #include <mutex>
 #include <set>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 // #include <opencog/util/async_method_caller.h>
@@ -90,10 +91,19 @@ class SQLAtomStorage : public AtomStorage
 		typedef std::shared_ptr<PseudoAtom> PseudoPtr;
 		#define createPseudo std::make_shared<PseudoAtom>
 		PseudoPtr makeAtom(Response&, UUID);
-		PseudoPtr getAtom(const char *, int);
+		Type load_type(int);
+		void count_load(void);
+		PseudoPtr getAtom(const LLStatement&, const LLParams&, int);
 		PseudoPtr petAtom(UUID);
 
-		Handle get_recursive_if_not_exists(PseudoPtr);
+		// Fetching many atoms at once, in a few round-trips.
+		typedef std::unordered_map<UUID, PseudoPtr> PseudoMap;
+		std::vector<PseudoPtr> petAtoms(const std::vector<UUID>&);
+		void get_missing_outgoing(const std::vector<PseudoPtr>&, PseudoMap&);
+		HandleSeq get_atoms_if_not_exists(AtomTable&, const std::vector<UUID>&);
+
+		Handle get_recursive_if_not_exists(PseudoPtr,
+		                                   const PseudoMap* = nullptr);
 
 		Handle doGetNode(Type, const char *);
 		Handle doGetLink(Type, const HandleSeq&);
@@ -113,12 +123,24 @@ class SQLAtomStorage : public AtomStorage
 		bool not_yet_stored(const Handle&);
 		UUID check_uuid(const Handle&);
 		UUID get_uuid(const Handle&);
-		std::string oset_to_string(const HandleSeq&);
+		std::vector<unsigned long> oset_to_uuids(const HandleSeq&);
 
 		bool bulk_load;
 		bool bulk_store;
 		time_t bulk_start;
 
+		// --------------------------
+		// Bulk store and load, with COPY.
+		bool can_copy(void);
+		void drop_indexes(Response&, const char *, std::vector<std::string>&);
+		void copy_atom_row(std::string&, const Handle&, int);
+		void copy_valuation_rows(std::string&, std::string&, const Handle&);
+		void copy_in(Response&, const char *, const HandleSeq&,
+		             const std::vector<int>&, std::string*);
+		void copy_in(Response&, const char *, const std::string&);
+		void copy_store(const AtomTable&);
+		void copy_load(AtomTable&);
+
 		// --------------------------
 		// Atom removal
 		void removeAtom(Response&, UUID, bool recursive);
@@ -141,13 +163,20 @@ class SQLAtomStorage : public AtomStorage
 		std::mutex _value_mutex[NUMVMUT];
 		void store_atom_values(const Handle &);
 		void get_atom_values(Handle &);
+		void get_atoms_values(const HandleSeq &);
 
 		typedef unsigned long VUID;
 
 		ProtoAtomPtr doUnpackValue(Response&);
+		ProtoAtomPtr makeValue(int, const std::vector<double>&,
+		                       const std::vector<std::string>&,
+		                       const std::vector<VUID>&);
+		void value_params(LLParams&, const ProtoAtomPtr&,
+		                  std::string* values = nullptr);
 		ProtoAtomPtr doGetValue(const char *);
 
 		VUID storeValue(const ProtoAtomPtr&);
+		VUID copy_value_row(std::string&, const ProtoAtomPtr&);
 		ProtoAtomPtr getValue(VUID);
 		void deleteValue(VUID);
 
@@ -183,6 +212,11 @@ class SQLAtomStorage : public AtomStorage
 		std::atomic<size_t> _num_link_inserts;
 		std::atomic<size_t> _num_atom_removes;
 		std::atomic<size_t> _num_atom_deletes;
+		std::atomic<size_t> _num_atom_fetches;
+		std::atomic<size_t> _num_atom_batches;
+		std::atomic<size_t> _num_batched_atoms;
+		std::atomic<size_t> _num_value_fetches;
+		std::atomic<size_t> _num_value_batches;
 		std::atomic<size_t> _load_count;
 		std::atomic<size_t> _store_count;
 		std::atomic<size_t> _valuation_stores;
@@ -227,7 +261,7 @@ class SQLAtomStorage : public AtomStorage
 		void registerWith(AtomSpace*);
 		void unregisterWith(AtomSpace*);
 		void extract_callback(const AtomPtr&);
-		boost::signals2::connection _extract_sig;
+		SignalConnection _extract_sig;
 
 		// AtomStorage interface
 		Handle getNode(Type, const char *);
@@ -31,6 +31,8 @@
 
 #ifdef HAVE_PGSQL_STORAGE
 
+#include <vector>
+
 #include <libpq-fe.h>
 
 #include <opencog/util/exceptions.h>
@@ -100,7 +102,17 @@ LLPGConnection::exec(const char * buff)
 	LLPGRecordSet* rs = get_record_set();
 
 	rs->_result = PQexec(_pgconn, buff);
+	check_result(rs, buff);
 
+	/* Use numbr of columns to indicate that the query hasn't
+	 * given results yet. */
+	rs->ncols = -1;
+	return rs;
+}
+
+void
+LLPGConnection::check_result(LLPGRecordSet* rs, const char * buff)
+{
 	ExecStatusType rest = PQresultStatus(rs->_result);
 	if (rest != PGRES_COMMAND_OK and
 	    rest != PGRES_EMPTY_QUERY and
@@ -112,15 +124,163 @@ LLPGConnection::exec(const char * buff)
 		rs->release();
 		PERR("Failed to execute!");
 	}
+}
+
+/* =========================================================== */
+
+/**
+ * Run a prepared statement, preparing it first, if this is the first
+ * time it is used on this connection. The parameters are sent in the
+ * binary format; the results come back as text, just like those of
+ * exec(), so that the same code can read them.
+ */
+LLRecordSet *
+LLPGConnection::exec_prepared(const LLStatement& stmt, const LLParams& params)
+{
+	if (!is_connected) return NULL;
+
+	int nparams = params.size();
+	if (_prepared.find(stmt.name) == _prepared.end())
+	{
+		PGresult* res = PQprepare(_pgconn, stmt.name, stmt.sql,
+		                          nparams, params.types.data());
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+		{
+			opencog::logger().warn("PQprepare message: %s",
+			               PQresultErrorMessage(res));
+			opencog::logger().warn("PQ statement was: %s", stmt.sql);
+			PQclear(res);
+			PERR("Failed to prepare!");
+		}
+		PQclear(res);
+		_prepared.insert(stmt.name);
+	}
+
+	std::vector<const char*> values(nparams);
+	std::vector<int> lengths(nparams);
+	std::vector<int> formats(nparams, 1);
+	for (int i = 0; i < nparams; i++)
+	{
+		if (params.is_null[i]) continue;
+		values[i] = params.binary[i].data();
+		lengths[i] = params.binary[i].size();
+	}
+
+	LLPGRecordSet* rs = get_record_set();
+	rs->_result = PQexecPrepared(_pgconn, stmt.name, nparams,
+	                             values.data(), lengths.data(),
+	                             formats.data(), 0);
+	check_result(rs, stmt.sql);
 
-	/* Use numbr of columns to indicate that the query hasn't
-	 * given results yet. */
 	rs->ncols = -1;
 	return rs;
 }
 
 /* =========================================================== */
 
+/**
+ * Start a COPY ... FROM STDIN or a COPY ... TO STDOUT; the server
+ * must answer by waiting for the data, or by sending it.
+ */
+static void copy_begin(PGconn* pgconn, const char * sql,
+                       ExecStatusType expect)
+{
+	PGresult* res = PQexec(pgconn, sql);
+	if (PQresultStatus(res) != expect)
+	{
+		opencog::logger().warn("PQresult message: %s",
+		               PQresultErrorMessage(res));
+		opencog::logger().warn("PQ query was: %s", sql);
+		PQclear(res);
+		PERR("Failed to start COPY!");
+	}
+	PQclear(res);
+}
+
+/// Collect the outcome of a finished COPY.
+static void copy_finish(PGconn* pgconn)
+{
+	std::string msg;
+	PGresult* res;
+	while ((res = PQgetResult(pgconn)))
+	{
+		if (PQresultStatus(res) != PGRES_COMMAND_OK)
+			msg = PQresultErrorMessage(res);
+		PQclear(res);
+	}
+	if (not msg.empty())
+	{
+		opencog::logger().warn("PQresult message: %s", msg.c_str());
+		PERR("Failed to COPY!");
+	}
+}
+
+void
+LLPGConnection::copy_in_begin(const char * sql)
+{
+	copy_begin(_pgconn, sql, PGRES_COPY_IN);
+}
+
+void
+LLPGConnection::copy_in_put(const std::string& data)
+{
+	if (1 != PQputCopyData(_pgconn, data.data(), data.size()))
+		PERR("Failed to send COPY data: %s", PQerrorMessage(_pgconn));
+}
+
+void
+LLPGConnection::copy_in_end(const char * errmsg)
+{
+	if (1 != PQputCopyEnd(_pgconn, errmsg))
+		PERR("Failed to end COPY: %s", PQerrorMessage(_pgconn));
+
+	// An abandoned COPY fails, as it should; that is no news.
+	if (errmsg)
+	{
+		PGresult* res;
+		while ((res = PQgetResult(_pgconn))) PQclear(res);
+		return;
+	}
+	copy_finish(_pgconn);
+}
+
+void
+LLPGConnection::copy_out_begin(const char * sql)
+{
+	copy_begin(_pgconn, sql, PGRES_COPY_OUT);
+}
+
+/**
+ * Get the next piece of a COPY ... TO STDOUT; this is a row at a time.
+ * Return false when there are no more.
+ */
+bool
+LLPGConnection::copy_out_get(std::string& data)
+{
+	char * buf = NULL;
+	int len = PQgetCopyData(_pgconn, &buf, 0);
+	if (0 < len)
+	{
+		data.assign(buf, len);
+		PQfreemem(buf);
+		return true;
+	}
+	if (-2 == len)
+	{
+		// Collect the failed COPY, so that the connection can be
+		// used again.
+		std::string msg(PQerrorMessage(_pgconn));
+		PGresult* res;
+		while ((res = PQgetResult(_pgconn))) PQclear(res);
+		PERR("Failed to receive COPY data: %s", msg.c_str());
+	}
+
+	copy_finish(_pgconn);
+	return false;
+}
+
+/* =========================================================== */
+
 void
 LLPGRecordSet::setup_cols(int new_ncols)
 {
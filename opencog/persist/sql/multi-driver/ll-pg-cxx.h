@@ -27,6 +27,9 @@
 
 #ifdef HAVE_PGSQL_STORAGE
 
+#include <set>
+#include <string>
+
 #include <libpq-fe.h>
 
 #include "llapi.h"
@@ -43,12 +46,24 @@ class LLPGConnection : public LLConnection
 	private:
 		PGconn* _pgconn;
 		LLPGRecordSet* get_record_set(void);
+		void check_result(LLPGRecordSet*, const char *);
+
+		// Names of the statements prepared on this connection.
+		std::set<std::string> _prepared;
 
 	public:
 		LLPGConnection(const char * uri);
 		~LLPGConnection();
 
 		LLRecordSet *exec(const char *);
+		LLRecordSet *exec_prepared(const LLStatement&, const LLParams&);
+
+		bool can_copy(void) const { return true; }
+		void copy_in_begin(const char *);
+		void copy_in_put(const std::string&);
+		void copy_in_end(const char * errmsg = NULL);
+		void copy_out_begin(const char *);
+		bool copy_out_get(std::string&);
 };
 
 class LLPGRecordSet : public LLRecordSet
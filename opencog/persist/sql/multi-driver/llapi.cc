@@ -37,7 +37,11 @@
 #include <stack>
 #include <string>
 
+#include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <opencog/util/exceptions.h>
 #include <opencog/util/Logger.h>
@@ -67,6 +71,418 @@ LLConnection::~LLConnection()
     }
 }
 
+/* =========================================================== */
+
+/**
+ * Substitute the parameters into the SQL text, and run that.
+ */
+LLRecordSet *
+LLConnection::exec_prepared(const LLStatement& stmt, const LLParams& params)
+{
+    std::string qry;
+    const char * p = stmt.sql;
+    while (*p)
+    {
+        if ('$' != *p or not isdigit(p[1]))
+        {
+            qry += *p++;
+            continue;
+        }
+        char * end;
+        size_t idx = strtoul(p+1, &end, 10);
+        if (0 == idx or params.size() < idx)
+            PERR("Statement %s has no parameter %zu", stmt.name, idx);
+        qry += params.literal[idx-1];
+        p = end;
+    }
+    return exec(qry.c_str());
+}
+
+/* =========================================================== */
+/* Parameters, in the postgres binary format, big-endian. */
+
+static void put_int32(std::string& buf, uint32_t v)
+{
+    for (int shift = 24; 0 <= shift; shift -= 8)
+        buf += (char) ((v >> shift) & 0xff);
+}
+
+static void put_int64(std::string& buf, uint64_t v)
+{
+    for (int shift = 56; 0 <= shift; shift -= 8)
+        buf += (char) ((v >> shift) & 0xff);
+}
+
+/// A one-dimensional array: ndim, no nulls, the element type, the
+/// length and the lower bound; then each element, prefixed by its
+/// size. The empty array has no dimensions.
+static std::string array_header(unsigned int elemtype, size_t len)
+{
+    std::string buf;
+    put_int32(buf, 0 < len ? 1 : 0);
+    put_int32(buf, 0);
+    put_int32(buf, elemtype);
+    if (0 < len)
+    {
+        put_int32(buf, len);
+        put_int32(buf, 1);
+    }
+    return buf;
+}
+
+static std::string quote_string(const std::string& str)
+{
+    std::string lit(str);
+    escape_single_quotes(lit);
+    return "'" + lit + "'";
+}
+
+void LLParams::add(unsigned int type, const std::string& bin,
+                   const std::string& lit)
+{
+    types.push_back(type);
+    binary.push_back(bin);
+    is_null.push_back(false);
+    literal.push_back(_literals ? lit : std::string());
+}
+
+void LLParams::add_smallint(int v)
+{
+    std::string buf;
+    buf += (char) ((v >> 8) & 0xff);
+    buf += (char) (v & 0xff);
+    add(SMALLINT, buf, _literals ? std::to_string(v) : "");
+}
+
+void LLParams::add_bigint(unsigned long v)
+{
+    std::string buf;
+    put_int64(buf, v);
+    add(BIGINT, buf, _literals ? std::to_string(v) : "");
+}
+
+void LLParams::add_text(const std::string& str)
+{
+    add(TEXT, str, _literals ? quote_string(str) : "");
+}
+
+void LLParams::add_text_array(const std::vector<std::string>& arr)
+{
+    std::string buf(array_header(TEXT, arr.size()));
+    std::string lit = "{";
+    for (const std::string& str : arr)
+    {
+        put_int32(buf, str.size());
+        buf += str;
+
+        if (not _literals) continue;
+        if (1 < lit.size()) lit += ",";
+        lit += '"';
+        for (char c : str)
+        {
+            if ('"' == c or '\\' == c) lit += '\\';
+            lit += c;
+        }
+        lit += '"';
+    }
+    lit += "}";
+    add(TEXT_ARRAY, buf, quote_string(lit));
+}
+
+void LLParams::add_bigint_array(const std::vector<unsigned long>& arr)
+{
+    std::string buf(array_header(BIGINT, arr.size()));
+    std::string lit = "'{";
+    for (unsigned long v : arr)
+    {
+        put_int32(buf, 8);
+        put_int64(buf, v);
+
+        if (not _literals) continue;
+        if (2 < lit.size()) lit += ",";
+        lit += std::to_string(v);
+    }
+    lit += "}'";
+    add(BIGINT_ARRAY, buf, lit);
+}
+
+void LLParams::add_double_array(const std::vector<double>& arr)
+{
+    const unsigned int FLOAT8 = 701;
+    std::string buf(array_header(FLOAT8, arr.size()));
+    std::string lit = "'{";
+    for (double v : arr)
+    {
+        uint64_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        put_int32(buf, 8);
+        put_int64(buf, bits);
+
+        // Only drivers without binary parameters print the numbers.
+        if (not _literals) continue;
+        char num[40];
+        snprintf(num, 40, "%.17g", v);
+        if (2 < lit.size()) lit += ",";
+        lit += num;
+    }
+    lit += "}'";
+    add(DOUBLE_ARRAY, buf, lit);
+}
+
+void LLParams::add_null(unsigned int type)
+{
+    types.push_back(type);
+    binary.push_back("");
+    is_null.push_back(true);
+    literal.push_back("NULL");
+}
+
+void LLParams::clear(void)
+{
+    types.clear();
+    binary.clear();
+    is_null.clear();
+    literal.clear();
+}
+
+/* =========================================================== */
+/* Bulk transfer, in the postgres binary COPY format. */
+
+static const char copy_signature[] = "PGCOPY\n\377\r\n";
+#define SIGNATURE_SIZE 11
+
+/// The signature, no flags, and no header extension.
+std::string LLCopy::header(void)
+{
+    std::string buf(copy_signature, SIGNATURE_SIZE);
+    put_int32(buf, 0);
+    put_int32(buf, 0);
+    return buf;
+}
+
+/// A row with -1 fields ends the data.
+std::string LLCopy::trailer(void)
+{
+    return std::string("\377\377", 2);
+}
+
+void LLCopy::add_row(std::string& buf, const LLParams& row)
+{
+    size_t nfields = row.size();
+    buf += (char) ((nfields >> 8) & 0xff);
+    buf += (char) (nfields & 0xff);
+    for (size_t i = 0; i < nfields; i++)
+    {
+        if (row.is_null[i])
+        {
+            put_int32(buf, (uint32_t) -1);
+            continue;
+        }
+        put_int32(buf, row.binary[i].size());
+        buf += row.binary[i];
+    }
+}
+
+static uint32_t get_int32(const char * p)
+{
+    const unsigned char * u = (const unsigned char *) p;
+    return ((uint32_t) u[0] << 24) | ((uint32_t) u[1] << 16) |
+           ((uint32_t) u[2] << 8) | (uint32_t) u[3];
+}
+
+static uint64_t get_int64(const char * p)
+{
+    return ((uint64_t) get_int32(p) << 32) | get_int32(p+4);
+}
+
+LLCopyReader::LLCopyReader(void)
+{
+    _pos = 0;
+    _header = false;
+    _end = false;
+}
+
+void LLCopyReader::feed(const std::string& data)
+{
+    // Drop what was read already; the rows are short, compared to
+    // the pieces that they arrive in.
+    _buf.erase(0, _pos);
+    _pos = 0;
+    _fields.clear();
+    _buf += data;
+}
+
+bool LLCopyReader::next_row(void)
+{
+    _fields.clear();
+    if (_end) return false;
+
+    if (not _header)
+    {
+        if (_buf.size() < SIGNATURE_SIZE + 8) return false;
+        if (_buf.compare(0, SIGNATURE_SIZE, copy_signature, SIGNATURE_SIZE))
+            PERR("Not a binary COPY stream");
+        size_t extlen = get_int32(_buf.data() + SIGNATURE_SIZE + 4);
+        if (_buf.size() < SIGNATURE_SIZE + 8 + extlen) return false;
+        _pos = SIGNATURE_SIZE + 8 + extlen;
+        _header = true;
+    }
+
+    // Find all of the fields first; the row is used only if it has
+    // arrived whole.
+    const char * base = _buf.data();
+    size_t pos = _pos;
+    if (_buf.size() < pos + 2) return false;
+    const unsigned char * u = (const unsigned char *) base + pos;
+    int16_t nfields = (int16_t) ((u[0] << 8) | u[1]);
+    pos += 2;
+    if (-1 == nfields)
+    {
+        _pos = pos;
+        _end = true;
+        return false;
+    }
+
+    for (int i = 0; i < nfields; i++)
+    {
+        if (_buf.size() < pos + 4) { _fields.clear(); return false; }
+        int len = (int32_t) get_int32(base + pos);
+        pos += 4;
+        _fields.emplace_back(pos, len);
+        if (0 < len) pos += len;
+    }
+    if (_buf.size() < pos) { _fields.clear(); return false; }
+
+    _pos = pos;
+    return true;
+}
+
+/// The field, which must be there, and be this size, if a size is
+/// given.
+const char * LLCopyReader::field(int i, int size) const
+{
+    if (i < 0 or (int) _fields.size() <= i or _fields[i].second < 0)
+        PERR("No value in column %d", i);
+    if (0 <= size and size != _fields[i].second)
+        PERR("Column %d has size %d, expected %d", i,
+             _fields[i].second, size);
+    return _buf.data() + _fields[i].first;
+}
+
+bool LLCopyReader::is_null(int i) const
+{
+    return (int) _fields.size() <= i or _fields[i].second < 0;
+}
+
+long LLCopyReader::get_bigint(int i) const
+{
+    return get_int64(field(i, 8));
+}
+
+int LLCopyReader::get_smallint(int i) const
+{
+    const unsigned char * u = (const unsigned char *) field(i, 2);
+    return (int16_t) ((u[0] << 8) | u[1]);
+}
+
+std::string LLCopyReader::get_text(int i) const
+{
+    return std::string(field(i, -1), _fields[i].second);
+}
+
+/// The number of elements of a one-dimensional array; p is left
+/// pointing at the first one.
+size_t LLCopyReader::array_size(int i, const char *& p) const
+{
+    p = field(i, -1);
+    uint32_t ndim = get_int32(p);
+    if (0 == ndim) return 0;
+    if (1 != ndim) PERR("Column %d is not a one-dimensional array", i);
+    size_t len = get_int32(p + 12);
+    p += 20;
+    return len;
+}
+
+std::vector<unsigned long> LLCopyReader::get_bigint_array(int i) const
+{
+    const char * p;
+    size_t len = array_size(i, p);
+    std::vector<unsigned long> arr;
+    arr.reserve(len);
+    for (size_t j = 0; j < len; j++)
+    {
+        int32_t sz = get_int32(p);
+        arr.push_back(0 < sz ? get_int64(p+4) : 0);
+        p += 4 + (0 < sz ? sz : 0);
+    }
+    return arr;
+}
+
+std::vector<double> LLCopyReader::get_double_array(int i) const
+{
+    const char * p;
+    size_t len = array_size(i, p);
+    std::vector<double> arr;
+    arr.reserve(len);
+    for (size_t j = 0; j < len; j++)
+    {
+        int32_t sz = get_int32(p);
+        double v = 0.0;
+        if (0 < sz)
+        {
+            uint64_t bits = get_int64(p+4);
+            memcpy(&v, &bits, sizeof(v));
+        }
+        arr.push_back(v);
+        p += 4 + (0 < sz ? sz : 0);
+    }
+    return arr;
+}
+
+std::vector<std::string> LLCopyReader::get_text_array(int i) const
+{
+    const char * p;
+    size_t len = array_size(i, p);
+    std::vector<std::string> arr;
+    arr.reserve(len);
+    for (size_t j = 0; j < len; j++)
+    {
+        int32_t sz = get_int32(p);
+        arr.emplace_back(p+4, 0 < sz ? sz : 0);
+        p += 4 + (0 < sz ? sz : 0);
+    }
+    return arr;
+}
+
+/* =========================================================== */
+/* Drivers that have no COPY. */
+
+void LLConnection::copy_in_begin(const char * sql)
+{
+    PERR("This driver cannot COPY");
+}
+
+void LLConnection::copy_in_put(const std::string& data)
+{
+    PERR("This driver cannot COPY");
+}
+
+void LLConnection::copy_in_end(const char * errmsg)
+{
+    PERR("This driver cannot COPY");
+}
+
+void LLConnection::copy_out_begin(const char * sql)
+{
+    PERR("This driver cannot COPY");
+}
+
+bool LLConnection::copy_out_get(std::string& data)
+{
+    PERR("This driver cannot COPY");
+    return false;
+}
+
 /* =========================================================== */
 /* pseudo-private routine */
 
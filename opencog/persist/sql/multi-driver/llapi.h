@@ -30,6 +30,8 @@
 
 #include <stack>
 #include <string>
+#include <utility>
+#include <vector>
 
 /** \addtogroup grp_persist
  *  @{
@@ -37,6 +39,115 @@
 
 class LLRecordSet;
 
+/**
+ * An SQL statement to be prepared once and run many times. The name
+ * identifies it on each connection; the parameters in the SQL are
+ * written $1, $2, and so on.
+ */
+struct LLStatement
+{
+    const char * name;
+    const char * sql;
+};
+
+/**
+ * The parameters of a prepared statement: the first one added is $1,
+ * the next $2, and so on. Each one is kept in the postgres binary
+ * format, so that no number has to be printed and parsed again, and
+ * also as an SQL literal, for drivers that cannot bind parameters.
+ */
+class LLParams
+{
+    public:
+        // The postgres type OIDs of the supported types.
+        enum
+        {
+            BIGINT = 20,
+            SMALLINT = 21,
+            TEXT = 25,
+            TEXT_ARRAY = 1009,
+            BIGINT_ARRAY = 1016,
+            DOUBLE_ARRAY = 1022
+        };
+
+        void add_smallint(int);
+        void add_bigint(unsigned long);
+        void add_text(const std::string&);
+        void add_text_array(const std::vector<std::string>&);
+        void add_bigint_array(const std::vector<unsigned long>&);
+        void add_double_array(const std::vector<double>&);
+        void add_null(unsigned int oid);
+        void clear(void);
+
+        // Without literals, only the binary format is kept; that is
+        // all that COPY needs, and it is cheaper to make.
+        LLParams(bool literals = true) : _literals(literals) {}
+
+        size_t size(void) const { return types.size(); }
+
+        std::vector<unsigned int> types;
+        std::vector<std::string> binary;
+        std::vector<bool> is_null;
+        std::vector<std::string> literal;
+
+    private:
+        bool _literals;
+        void add(unsigned int, const std::string&, const std::string&);
+};
+
+/**
+ * The postgres binary COPY format: a header, then each row, as the
+ * number of fields followed by each field, prefixed by its size, in
+ * the same binary format as the parameters above; then a trailer.
+ */
+struct LLCopy
+{
+    static std::string header(void);
+    static std::string trailer(void);
+    static void add_row(std::string&, const LLParams&);
+};
+
+/**
+ * Decodes the rows of a binary COPY, as it arrives. The stream can be
+ * fed in pieces of any size; the fields of the current row stay valid
+ * until the next call to feed().
+ */
+class LLCopyReader
+{
+    public:
+        LLCopyReader(void);
+
+        // Append more of the stream.
+        void feed(const std::string&);
+
+        // Move to the next row. Return false if the rest of the row
+        // has not been fed yet, or if the end of the data was reached.
+        bool next_row(void);
+        bool at_end(void) const { return _end; }
+
+        int get_column_count(void) const { return _fields.size(); }
+        bool is_null(int) const;
+        long get_bigint(int) const;
+        int get_smallint(int) const;
+        std::string get_text(int) const;
+        std::vector<unsigned long> get_bigint_array(int) const;
+        std::vector<double> get_double_array(int) const;
+        std::vector<std::string> get_text_array(int) const;
+
+    private:
+        std::string _buf;
+        size_t _pos;
+        bool _header;
+        bool _end;
+
+        // Offset and size of each field of the current row; the size
+        // of a NULL is -1.
+        std::vector<std::pair<size_t, int>> _fields;
+
+        const char * field(int, int) const;
+        size_t array_size(int, const char *&) const;
+};
+
 class LLConnection
 {
     friend class LLRecordSet;
@@ -52,6 +163,25 @@ class LLConnection
         bool connected(void) const { return is_connected; }
 
         virtual LLRecordSet *exec(const char *) = 0;
+
+        // Run a prepared statement. By default, the parameters are
+        // spelled out in the SQL text, which is then run with exec();
+        // drivers that can prepare statements should do so instead.
+        virtual LLRecordSet *exec_prepared(const LLStatement&,
+                                           const LLParams&);
+
+        // Bulk transfer with COPY, in the binary format. Start a
+        // COPY ... FROM STDIN, hand it the data in pieces of any size,
+        // then finish it; or start a COPY ... TO STDOUT, and get the
+        // data a piece at a time, until there is none left. Ending a
+        // COPY ... FROM STDIN with an error message abandons it. Drivers
+        // that cannot do this say so with can_copy(), and throw.
+        virtual bool can_copy(void) const { return false; }
+        virtual void copy_in_begin(const char *);
+        virtual void copy_in_put(const std::string&);
+        virtual void copy_in_end(const char * errmsg = NULL);
+        virtual void copy_out_begin(const char *);
+        virtual bool copy_out_get(std::string&);
 };
 
 class LLRecordSet
@@ -28,11 +28,18 @@
 namespace opencog {
 
 class AtomSpace;
+class SearchBudget;
 
-Handle bindlink(AtomSpace*, const Handle&, size_t max_results=SIZE_MAX);
+Handle bindlink(AtomSpace*, const Handle&, size_t max_results=SIZE_MAX,
+                unsigned nthreads=1);
+Handle bindlink(AtomSpace*, const Handle&, SearchBudget&,
+                size_t max_results=SIZE_MAX, unsigned nthreads=1);
 Handle af_bindlink(AtomSpace*, const Handle&);
 TruthValuePtr satisfaction_link(AtomSpace*, const Handle&);
-Handle satisfying_set(AtomSpace*, const Handle&, size_t max_results=SIZE_MAX);
+Handle satisfying_set(AtomSpace*, const Handle&, size_t max_results=SIZE_MAX,
+                      unsigned nthreads=1);
+Handle satisfying_set(AtomSpace*, const Handle&, SearchBudget&,
+                      size_t max_results=SIZE_MAX, unsigned nthreads=1);
 Handle recognize(AtomSpace*, const Handle&);
 
 } // namespace opencog
@@ -66,6 +66,23 @@ class DefaultImplicator:
 		InitiateSearchCB::set_pattern(vars, pat);
 		DefaultPatternMatchCB::set_pattern(vars, pat);
 	}
+
+protected:
+	// Each thread of a parallel search gets one of these.
+	virtual InitiateSearchCB* clone_for_thread(void)
+	{
+		DefaultImplicator* impl = new DefaultImplicator(InitiateSearchCB::_as);
+		impl->implicand = implicand;
+		impl->max_results = max_results;
+		impl->_sink = this;
+		return impl;
+	}
+
+	virtual void join_thread(InitiateSearchCB* cb)
+	{
+		DefaultImplicator* impl = dynamic_cast<DefaultImplicator*>(cb);
+		if (impl->_optionals_present) _optionals_present = true;
+	}
 };
 
 
@@ -21,6 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 #include <opencog/util/Logger.h>
 
 #include <opencog/atoms/core/StateLink.h>
@@ -50,70 +54,98 @@ using namespace opencog;
 // cheaper to just have a cache of empty atomspaces, hanging around,
 // and ready to go. The code in this section implements this.
 
+//
+// Each thread keeps a few of its own, so that small queries running
+// in many threads at once do not contend for a lock. Beyond that,
+// there is a shared cache, which also takes in the spaces of threads
+// that exit.
+
 const bool TRANSIENT_SPACE = true;
-const int MAX_CACHED_TRANSIENTS = 8;
+const size_t MAX_CACHED_TRANSIENTS = 8;
+const size_t MAX_THREAD_TRANSIENTS = 4;
+
+static std::mutex s_transient_cache_mutex;
+static std::vector<AtomSpace*> s_transient_cache;
+
+namespace {
+
+struct TransientCache
+{
+	std::vector<AtomSpace*> spaces;
+	~TransientCache();
+};
+
+// Set once this thread's cache has been destroyed; spaces released
+// after that (e.g. by other thread_local destructors) go straight
+// to the shared cache.
+static thread_local bool transients_gone = false;
+static thread_local TransientCache thread_transients;
+
+} // anonymous namespace
+
+// Give a cleared transient to the shared cache, or delete it, if
+// the cache is full.
+static void share_transient(AtomSpace* atomspace)
+{
+	{
+		std::lock_guard<std::mutex> cache_lock(s_transient_cache_mutex);
+		if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
+		{
+			s_transient_cache.push_back(atomspace);
+			return;
+		}
+	}
+	delete atomspace;
+}
 
-// Allocated storage for the transient atomspace cache static variables.
-std::mutex DefaultPatternMatchCB::s_transient_cache_mutex;
-std::vector<AtomSpace*> DefaultPatternMatchCB::s_transient_cache;
+TransientCache::~TransientCache()
+{
+	transients_gone = true;
+	for (AtomSpace* atomspace : spaces)
+		share_transient(atomspace);
+}
 
 AtomSpace* DefaultPatternMatchCB::grab_transient_atomspace(AtomSpace* parent)
 {
 	AtomSpace* transient_atomspace = NULL;
 
-	// See if the cache has one...
-	if (s_transient_cache.size() > 0)
+	// This thread's own cache needs no lock.
+	if (not transients_gone and not thread_transients.spaces.empty())
 	{
-		// Grab the mutex lock.
-		std::unique_lock<std::mutex> cache_lock(s_transient_cache_mutex);
-
-		// Check to make sure the cache still has one now that we have
-		// the mutex.
-		if (s_transient_cache.size() > 0)
+		transient_atomspace = thread_transients.spaces.back();
+		thread_transients.spaces.pop_back();
+	}
+	else
+	{
+		std::lock_guard<std::mutex> cache_lock(s_transient_cache_mutex);
+		if (not s_transient_cache.empty())
 		{
-			// Pop the last transient atomspace off the cache stack.
 			transient_atomspace = s_transient_cache.back();
 			s_transient_cache.pop_back();
-
-			// Ready it for the new parent atomspace.
-			transient_atomspace->ready_transient(parent);
 		}
 	}
 
-	// If we didn't get one from the cache, then create a new one.
+	// If we didn't get one from a cache, then create a new one.
 	if (!transient_atomspace)
-		transient_atomspace = new AtomSpace(parent, TRANSIENT_SPACE);
+		return new AtomSpace(parent, TRANSIENT_SPACE);
 
+	// Ready it for the new parent atomspace.
+	transient_atomspace->ready_transient(parent);
 	return transient_atomspace;
 }
 
 void DefaultPatternMatchCB::release_transient_atomspace(AtomSpace* atomspace)
 {
-	bool atomspace_cached = false;
+	// Clear this transient atomspace, before anyone else sees it.
+	atomspace->clear_transient();
 
-	// If the cache is not full...
-	if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
+	if (not transients_gone and
+	    thread_transients.spaces.size() < MAX_THREAD_TRANSIENTS)
 	{
-		// Grab the mutex lock.
-		std::unique_lock<std::mutex> cache_lock(s_transient_cache_mutex);
-
-		// Check it again since we only now have the mutex locked.
-		if (s_transient_cache.size() < MAX_CACHED_TRANSIENTS)
-		{
-			// Clear this transient atomspace.
-			atomspace->clear_transient();
-
-			// Place this transient into the cache.
-			s_transient_cache.push_back(atomspace);
-
-			// The atomspace has been cached.
-			atomspace_cached = true;
-		}
+		thread_transients.spaces.push_back(atomspace);
+		return;
 	}
-
-	// If we didn't cache the atomspace, then delete it.
-	if (!atomspace_cached)
-		delete atomspace;
+	share_transient(atomspace);
 }
 
 /* ======================================================== */
@@ -185,6 +217,7 @@ void DefaultPatternMatchCB::set_pattern(const Variables& vars,
 	_have_variables = ! vars.varseq.empty();
 	_pattern_body = pat.body;
 	_globs = &pat.globby_terms;
+	_numeric.clear();
 }
 
 /* ======================================================== */
@@ -566,9 +599,24 @@ IncomingSet DefaultPatternMatchCB::get_incoming_set(const Handle& h)
 
 /* ======================================================== */
 
+const NumericClausePtr& DefaultPatternMatchCB::get_numeric(const Handle& virt)
+{
+	auto it = _numeric.find(virt);
+	if (_numeric.end() != it) return it->second;
+	return _numeric[virt] = NumericClause::compile(virt, _vars->varset);
+}
+
 bool DefaultPatternMatchCB::eval_term(const Handle& virt,
                                       const HandleMap& gnds)
 {
+	// Arithmetic comparisons of numbers need no atoms at all.
+	if (NumericClause::is_enabled())
+	{
+		const NumericClausePtr& nc(get_numeric(virt));
+		bool holds;
+		if (nc and nc->evaluate(gnds, holds)) return holds;
+	}
+
 	// Evaluation of the link requires working with an atomspace
 	// of some sort, so that the atoms can be communicated to scheme or
 	// python for the actual evaluation. We don't want to put the
@@ -662,6 +710,71 @@ bool DefaultPatternMatchCB::eval_term(const Handle& virt,
 	return relation_holds;
 }
 
+/**
+ * Evaluate a numeric term for many candidate groundings. The values of
+ * the variables are gathered into columns, one per variable, and the
+ * term is evaluated over the columns. A candidate with a variable that
+ * is not grounded by a number goes the usual way, on its own.
+ */
+bool DefaultPatternMatchCB::evaluate_batch(const Handle& virt,
+                                           const HandleMap& fixed,
+                                           const HandleMapSeq& rows,
+                                           std::vector<char>& keep)
+{
+	if (not NumericClause::is_enabled()) return false;
+	const NumericClausePtr& nc(get_numeric(virt));
+	if (nullptr == nc) return false;
+
+	const HandleSeq& vars = nc->get_variables();
+	size_t n = rows.size();
+	std::vector<std::vector<double>> cols(vars.size(),
+	                                      std::vector<double>(n, 0.0));
+
+	// Variables grounded in another component are the same for all
+	// rows. If one of those is not a number, then decline, before
+	// keep is touched; the caller then evaluates the rows one at a
+	// time.
+	std::vector<char> is_fixed(vars.size(), false);
+	for (size_t k = 0; k < vars.size(); k++)
+	{
+		auto fit = fixed.find(vars[k]);
+		if (fixed.end() == fit) continue;
+
+		double value;
+		if (not NumericClause::get_number(fit->second, value))
+			return false;
+		std::fill(cols[k].begin(), cols[k].end(), value);
+		is_fixed[k] = true;
+	}
+
+	std::vector<size_t> odd;
+	for (size_t k = 0; k < vars.size(); k++)
+	{
+		if (is_fixed[k]) continue;
+		for (size_t i = 0; i < n; i++)
+		{
+			if (not keep[i]) continue;
+			auto it = rows[i].find(vars[k]);
+			if (rows[i].end() == it or
+			    not NumericClause::get_number(it->second, cols[k][i]))
+			{
+				odd.push_back(i);
+				keep[i] = false;
+			}
+		}
+	}
+
+	nc->evaluate(cols, keep);
+
+	for (size_t i : odd)
+	{
+		HandleMap gnds(fixed);
+		gnds.insert(rows[i].begin(), rows[i].end());
+		keep[i] = eval_sentence(virt, gnds);
+	}
+	return true;
+}
+
 /* ======================================================== */
 
 /**
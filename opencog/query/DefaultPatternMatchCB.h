@@ -25,12 +25,15 @@
 #ifndef _OPENCOG_DEFAULT_PATTERN_MATCH_H
 #define _OPENCOG_DEFAULT_PATTERN_MATCH_H
 
+#include <unordered_map>
+
 #include <opencog/atoms/base/types.h>
 #include <opencog/atoms/core/Quotation.h>
 #include <opencog/atoms/execution/Instantiator.h>
 #include <opencog/atomspace/AtomSpace.h>
 #include <opencog/query/PatternMatchCallback.h>
 #include <opencog/query/PatternMatchEngine.h>
+#include <opencog/query/NumericClause.h>
 
 namespace opencog {
 
@@ -85,6 +88,15 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		virtual bool evaluate_sentence(const Handle& pat, const HandleMap& gnds)
 		{ return eval_sentence(pat, gnds); }
 
+		/**
+		 * Purely numeric terms (see NumericClause) are evaluated over
+		 * all of the candidates at once; others are declined.
+		 */
+		virtual bool evaluate_batch(const Handle& pat,
+		                            const HandleMap& fixed,
+		                            const HandleMapSeq& rows,
+		                            std::vector<char>& keep);
+
 		virtual const std::set<Type>& get_connectives(void)
 		{
 			return _connectives;
@@ -121,8 +133,6 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		// avoid the overhead of constantly creating/deleting
 		// the temp atomspaces above. So instead, just keep a
 		// cache of empty ones, ready to go.
-		static std::mutex s_transient_cache_mutex;
-		static std::vector<AtomSpace*> s_transient_cache;
 		static AtomSpace* grab_transient_atomspace(AtomSpace* parent);
 		static void release_transient_atomspace(AtomSpace* atomspace);
 
@@ -135,6 +145,11 @@ class DefaultPatternMatchCB : public virtual PatternMatchCallback
 		bool eval_term(const Handle& pat, const HandleMap& gnds);
 		bool eval_sentence(const Handle& pat, const HandleMap& gnds);
 
+		// Evaluatable terms compiled to arithmetic, or null, if they
+		// cannot be; filled in as they are first met.
+		std::unordered_map<Handle, NumericClausePtr> _numeric;
+		const NumericClausePtr& get_numeric(const Handle& pat);
+
 		bool _optionals_present = false;
 		AtomSpace* _as;
 };
@@ -27,6 +27,7 @@
 #include "BindLinkAPI.h"
 #include "DefaultImplicator.h"
 #include "PatternMatch.h"
+#include "SearchBudget.h"
 
 using namespace opencog;
 
@@ -45,9 +46,16 @@ bool Implicator::grounding(const HandleMap &var_soln,
 {
 	// PatternMatchEngine::print_solution(term_soln,var_soln);
 
+	// Results from a thread doing a parallel search go to the
+	// original implicator.
+	Implicator* sink = _sink ? _sink : this;
+
 	// Do not accept new solution if maximum number has been already reached
-	if (_result_set.size() >= max_results)
-		return true;
+	{
+		std::lock_guard<std::mutex> lck(sink->_result_mtx);
+		if (sink->_result_set.size() >= max_results)
+			return true;
+	}
 
 	// Ignore the case where the URE creates ill-formed links (due to
 	// rules producing nothing). Ideally this should be treated as a
@@ -55,13 +63,18 @@ bool Implicator::grounding(const HandleMap &var_soln,
 	// to prevent them from producing nothing.  In practice it is
 	// difficult to insure so meanwhile this try-catch is used. See
 	// issue #950 and pull req #962. XXX FIXME later.
+	Handle h;
 	try {
-		Handle h = inst.instantiate(implicand, var_soln, true);
-		insert_result(h);
+		h = inst.instantiate(implicand, var_soln, true);
 	} catch(...) {}
 
+	// Another thread may have filled up the result set in the meantime.
+	std::lock_guard<std::mutex> lck(sink->_result_mtx);
+	if (sink->_result_set.size() < max_results)
+		sink->insert_result(h);
+
 	// If we found as many as we want, then stop looking for more.
-	return (_result_set.size() >= max_results);
+	return (sink->_result_set.size() >= max_results);
 }
 
 void Implicator::insert_result(const Handle& h)
@@ -131,11 +144,16 @@ static Handle do_imply(AtomSpace* as,
 	// Theoretical background: the atomspace can be thought of as a
 	// Kripke frame: it holds everything we know "right now". The
 	// AbsentLink is a check for what we don't know, right now.
+	//
+	// A search that was cut short was not exhaustive; it proves
+	// nothing about absence.
 	const Pattern& pat = bl->get_pattern();
 	DefaultPatternMatchCB* intu =
 		dynamic_cast<DefaultPatternMatchCB*>(&impl);
+	SearchBudget* budget = intu->get_budget();
 	if (0 == pat.mandatory.size() and 0 < pat.optionals.size()
-	    and not intu->optionals_present())
+	    and not intu->optionals_present()
+	    and not (budget and budget->exhausted()))
 	{
 		Handle h = impl.inst.execute(impl.implicand, true);
 		impl.insert_result(h);
@@ -155,6 +173,34 @@ static Handle do_imply(AtomSpace* as,
 	return rewr;
 }
 
+static Handle do_bindlink(AtomSpace* as, const Handle& hbindlink,
+                          size_t max_results, unsigned nthreads,
+                          SearchBudget* budget)
+{
+#ifdef CACHED_IMPLICATOR
+	CachedDefaultImplicator cachedImpl(as);
+	Implicator& impl = cachedImpl;
+	InitiateSearchCB& search = dynamic_cast<InitiateSearchCB&>(impl);
+#else
+	DefaultImplicator impl(as);
+	InitiateSearchCB& search = impl;
+#endif
+	impl.max_results = max_results;
+	search.set_search_threads(nthreads);
+	search.set_budget(budget);
+
+	// Skip the analysis, if this pattern was seen before.
+	CompiledPatternPtr cp = pattern_cache().get(hbindlink);
+	search.set_compiled(cp);
+
+	// Now perform the search.
+	Handle rewr = do_imply(as, hbindlink, impl);
+
+	// Null, unless there is a new or revised analysis to keep.
+	pattern_cache().put(hbindlink, search.get_compiled());
+	return rewr;
+}
+
 /**
  * Evaluate a pattern and rewrite rule embedded in a BindLink
  *
@@ -163,19 +209,26 @@ static Handle do_imply(AtomSpace* as,
  * atoms that could be a ground are found in the atomspace, then they
  * will be reported.
  *
+ * If `nthreads` is more than one, then the search over the starting
+ * points is split over that many threads.
+ *
  * See the do_imply function documentation for details.
  */
-Handle bindlink(AtomSpace* as, const Handle& hbindlink, size_t max_results)
+Handle bindlink(AtomSpace* as, const Handle& hbindlink, size_t max_results,
+                unsigned nthreads)
 {
-#ifdef CACHED_IMPLICATOR
-	CachedDefaultImplicator cachedImpl(as);
-	Implicator& impl = cachedImpl;
-#else
-	DefaultImplicator impl(as);
-#endif
-	impl.max_results = max_results;
-	// Now perform the search.
-	return do_imply(as, hbindlink, impl);
+	return do_bindlink(as, hbindlink, max_results, nthreads, nullptr);
+}
+
+/**
+ * As above, but give up when the budget runs out, returning the
+ * results found until then. Check budget.get_status() to find out
+ * whether the results are complete.
+ */
+Handle bindlink(AtomSpace* as, const Handle& hbindlink,
+                SearchBudget& budget, size_t max_results, unsigned nthreads)
+{
+	return do_bindlink(as, hbindlink, max_results, nthreads, &budget);
 }
 
 /**
@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_IMPLICATOR_H
 #define _OPENCOG_IMPLICATOR_H
 
+#include <mutex>
 #include <vector>
 
 #include <opencog/atomspace/AtomSpace.h>
@@ -50,6 +51,10 @@ namespace opencog {
  * grounding.  A set of grounded expressions is created in 'result_set'.
  * Note that the callback may be called many times reporting the same
  * results. In that case the 'result_set' will contain unique solutions.
+ *
+ * For a parallel search, each thread gets its own copy of the
+ * implicator; the copies point '_sink' at the original, and place
+ * their results into its 'result_set', under a lock.
  */
 class Implicator :
 	public virtual PatternMatchCallback
@@ -58,8 +63,12 @@ class Implicator :
 		UnorderedHandleSet _result_set;
 		HandleSeq _result_list;
 
+		Implicator* _sink;
+		std::mutex _result_mtx;
+
 	public:
-		Implicator(AtomSpace* as) : inst(as), max_results(SIZE_MAX) {}
+		Implicator(AtomSpace* as) :
+			_sink(nullptr), inst(as), max_results(SIZE_MAX) {}
 		Instantiator inst;
 		Handle implicand;
 		size_t max_results;
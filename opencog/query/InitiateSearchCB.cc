@@ -21,6 +21,12 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+
 #include <opencog/atomspace/AtomSpace.h>
 
 #include <opencog/atoms/core/DefineLink.h>
@@ -32,6 +38,7 @@
 
 #include "InitiateSearchCB.h"
 #include "PatternMatchEngine.h"
+#include "QueryPlanner.h"
 
 using namespace opencog;
 
@@ -45,7 +52,9 @@ using namespace opencog;
 /* ======================================================== */
 
 InitiateSearchCB::InitiateSearchCB(AtomSpace* as) :
-	_classserver(classserver())
+	_classserver(classserver()),
+	_nthreads(1),
+	_budget(nullptr)
 {
 #ifdef CACHED_IMPLICATOR
 	InitiateSearchCB::clear();
@@ -84,8 +93,12 @@ void InitiateSearchCB::clear()
 
 	_curr_clause = 0;
 	_choices.clear();
+	_clause_costs.clear();
  	_search_fail = false;
 	_as = NULL;
+
+	_compiled = nullptr;
+	_compiling = nullptr;
 }
 #endif
 
@@ -99,6 +112,37 @@ void InitiateSearchCB::set_pattern(const Variables& vars,
 	_dynamic = &pat.evaluatable_terms;
 }
 
+void InitiateSearchCB::set_compiled(const CompiledPatternPtr& cp)
+{
+	_compiled = cp;
+	_compiling = nullptr;
+	if (nullptr == cp)
+	{
+		// Note the generation before expanding any definitions; if they
+		// change while we work, the result will be (correctly) stale.
+		_compiling = std::make_shared<CompiledPattern>();
+		_compiling->generation = DefineLink::get_generation();
+	}
+}
+
+CompiledPatternPtr InitiateSearchCB::get_compiled(void) const
+{
+	// Nothing worth keeping was found.
+	if (nullptr == _compiling or
+	    (not _compiling->have_starts and nullptr == _compiling->jit))
+		return nullptr;
+	return _compiling;
+}
+
+/// Return true if the engine reports directly to this callback.  It
+/// does not, when the engine is driven by some other callback, e.g.
+/// the PMCGroundings wrapper used for multi-component patterns;
+/// in that case, the search is for just one of the components.
+bool InitiateSearchCB::is_top_level(PatternMatchEngine *pme)
+{
+	return &pme->get_callback() == static_cast<PatternMatchCallback*>(this);
+}
+
 
 /* ======================================================== */
 
@@ -284,6 +328,41 @@ Handle InitiateSearchCB::find_thinnest(const HandleSeq& clauses,
 	return best_start;
 }
 
+/* ======================================================== */
+/**
+ * Replace the start picked by find_thinnest() with the one that the
+ * query planner thinks is cheapest, and note the planner's estimates
+ * for the clauses, so that the engine can order them.
+ */
+void InitiateSearchCB::plan_start(const HandleSeq& clauses, Choice& ch)
+{
+	QueryPlanner planner(_as, *_pattern);
+	if (not planner.plan(clauses)) return;
+
+	const QueryPlanner::Estimate& best = planner.best();
+	ch.clause = best.clause;
+	ch.best_start = best.start;
+	ch.start_term = best.term;
+	_clause_costs = planner.clause_costs();
+
+	DO_LOG({LAZY_LOG_FINE << "Query plan:\n" << planner.explain();})
+}
+
+/// Note how many atoms there are of each type that the choice of
+/// start depends on, so that a later search can tell if it is stale.
+void InitiateSearchCB::count_types(CompiledPattern& cp)
+{
+	std::set<Type> types;
+	for (const Handle& cl : _pattern->clauses)
+		types.insert(cl->get_type());
+	for (const Choice& ch : _choices)
+		if (ch.start_term) types.insert(ch.start_term->get_type());
+
+	cp.type_counts.clear();
+	for (Type t : types)
+		cp.type_counts.emplace_back(t, _as->get_num_atoms_of_type(t));
+}
+
 /* ======================================================== */
 /**
  * Given a set of clauses, find a neighborhood to search, and perform
@@ -313,23 +392,9 @@ bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
 		return false;
 	}
 
-	// Sometimes, the number of mandatory clauses can be zero...
-	// or they might all be evaluatable.  In this case, its OK to
-	// start searching with an optional clause. But if there ARE
-	// mandatories, we must NOT start search on an optional, since,
-	// after all, it might be absent!
-	bool try_all = true;
-	for (const Handle& m : _pattern->mandatory)
-	{
-		if (0 == _pattern->evaluatable_holders.count(m))
-		{
-			try_all = false;
-			break;
-		}
-	}
-
-	const HandleSeq& clauses =
-		try_all ?  _pattern->cnf_clauses :  _pattern->mandatory;
+	// Never start with an optional clause, if there are mandatory
+	// ones; it might be absent.
+	const HandleSeq& clauses = QueryPlanner::start_clauses(*_pattern);
 
 	// In principle, we could start our search at some node, any node,
 	// that is not a variable. In practice, the search begins by
@@ -344,34 +409,65 @@ bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
 	// no constants in them at all.  In this case, the search is
 	// performed by looping over all links of the given types.
 	size_t bestclause;
-	Handle best_start = find_thinnest(clauses, _pattern->evaluatable_holders,
-	                                  _starter_term, bestclause);
+	Handle best_start;
+	bool top = is_top_level(pme);
+	if (top and _compiled and _compiled->have_starts
+	    and not _compiled->drifted(_as))
+	{
+		// Already worked out, the last time around.
+		_choices = _compiled->starts;
+		pme->set_clause_costs(&_compiled->clause_costs);
+	}
+	else
+	{
+		// The atomspace has changed a lot since the starts were
+		// worked out; work them out again, and revise a copy of
+		// the cached analysis, for the caller to put back.
+		if (top and _compiled and nullptr == _compiling)
+			_compiling = std::make_shared<CompiledPattern>(*_compiled);
+
+		best_start = find_thinnest(clauses, _pattern->evaluatable_holders,
+		                           _starter_term, bestclause);
+
+		// If only a single choice, fake it for the loop below.
+		// (If there are no choices at all, that's handled below.)
+		_clause_costs.clear();
+		if (nullptr != best_start and 0 == _choices.size())
+		{
+			Choice ch;
+			ch.clause = bestclause;
+			ch.best_start = best_start;
+			ch.start_term = _starter_term;
+			if (QueryPlanner::is_enabled())
+				plan_start(clauses, ch);
+			_choices.push_back(ch);
+		}
+		else
+		{
+			// TODO -- weed out duplicates!
+		}
+		pme->set_clause_costs(&_clause_costs);
+
+		if (top and _compiling)
+		{
+			_compiling->have_starts = true;
+			_compiling->starts = _choices;
+			_compiling->clause_costs = _clause_costs;
+			count_types(*_compiling);
+		}
+	}
 
 	// Cannot find a starting point! This can happen if:
 	// 1) all of the clauses contain nothing but variables,
 	// 2) all of the clauses are evaluatable(!),
 	// Somewhat unusual, but it can happen.  For this, we need
 	// some other, alternative search strategy.
-	if (nullptr == best_start and 0 == _choices.size())
+	if (0 == _choices.size())
 	{
 		_search_fail = true;
 		return false;
 	}
 
-	// If only a single choice, fake it for the loop below.
-	if (0 == _choices.size())
-	{
-		Choice ch;
-		ch.clause = bestclause;
-		ch.best_start = best_start;
-		ch.start_term = _starter_term;
-		_choices.push_back(ch);
-	}
-	else
-	{
-		// TODO -- weed out duplicates!
-	}
-
 	for (const Choice& ch : _choices)
 	{
 		bestclause = ch.clause;
@@ -390,6 +486,12 @@ bool InitiateSearchCB::neighbor_search(PatternMatchEngine *pme)
 		// focus in the AttentionalFocusCB class...
 		IncomingSet iset = get_incoming_set(best_start);
 		size_t sz = iset.size();
+		if (use_threads(pme, sz))
+		{
+			HandleSeq cands(iset.begin(), iset.end());
+			if (parallel_search(pme, cands)) return true;
+			continue;
+		}
 		for (size_t i = 0; i < sz; i++)
 		{
 			Handle h(iset[i]);
@@ -625,16 +727,25 @@ bool InitiateSearchCB::link_type_search(PatternMatchEngine *pme)
 	// Get type of the rarest link
 	Type ptype = _starter_term->get_type();
 
-	HandleSeq handle_set;
-	_as->get_handles_by_type(handle_set, ptype);
+	if (use_threads(pme, _as->get_num_atoms_of_type(ptype)))
+	{
+		HandleSeq handle_set;
+		_as->get_handles_by_type(handle_set, ptype);
+		return parallel_search(pme, handle_set);
+	}
 
+	// There may be tens of millions of links of this type, and the
+	// first few might be enough; so walk the type index a chunk at a
+	// time, rather than copying all of it first.
+	AtomTable::TypeCursor cur(_as->get_type_cursor(ptype));
+	Handle h;
 #ifdef DEBUG
-	size_t i = 0, hsz = handle_set.size();
+	size_t i = 0;
 #endif
-	for (const Handle& h : handle_set)
+	while (cur.next(h))
 	{
 		DO_LOG({LAZY_LOG_FINE << "yyyyyyyyyy link_type_search yyyyyyyyyy\n"
-		              << "Loop candidate (" << ++i << "/" << hsz << "):\n"
+		              << "Loop candidate (" << ++i << "):\n"
 		              << h->to_string();})
 		bool found = pme->explore_neighborhood(_root, _starter_term, h);
 		if (found) return true;
@@ -806,30 +917,151 @@ bool InitiateSearchCB::variable_search(PatternMatchEngine *pme)
 			_root = _starter_term = clauses[0];
 	}
 
-	HandleSeq handle_set;
-	if (ptypes.empty())
-		_as->get_handles_by_type(handle_set, ATOM, true);
-	else
-		for (Type ptype : ptypes)
-			_as->get_handles_by_type(handle_set, ptype);
+	// With no type restrictions, every atom is a candidate.
+	bool subclass = ptypes.empty();
+	if (subclass) ptypes.insert(ATOM);
+
+	size_t ncands = 0;
+	for (Type ptype : ptypes)
+		ncands += _as->get_num_atoms_of_type(ptype, subclass);
 
-	DO_LOG({LAZY_LOG_FINE << "Atomspace reported " << handle_set.size() << " atoms";})
+	DO_LOG({LAZY_LOG_FINE << "Atomspace reported " << ncands << " atoms";})
 
+	if (use_threads(pme, ncands))
+	{
+		HandleSeq handle_set;
+		for (Type ptype : ptypes)
+			_as->get_handles_by_type(handle_set, ptype, subclass);
+		return parallel_search(pme, handle_set);
+	}
+
+	// As in link_type_search(), don't copy the type index.
 #ifdef DEBUG
-	size_t i = 0, hsz = handle_set.size();
+	size_t i = 0;
 #endif
-	for (const Handle& h : handle_set)
+	for (Type ptype : ptypes)
 	{
-		DO_LOG({LAZY_LOG_FINE << "zzzzzzzzzzz variable_search zzzzzzzzzzz\n"
-		              << "Loop candidate (" << ++i << "/" << hsz << "):\n"
-		              << h->to_string();})
-		bool found = pme->explore_neighborhood(_root, _starter_term, h);
-		if (found) return true;
+		AtomTable::TypeCursor cur(_as->get_type_cursor(ptype, subclass));
+		Handle h;
+		while (cur.next(h))
+		{
+			DO_LOG({LAZY_LOG_FINE << "zzzzzzzzzzz variable_search zzzzzzzzzzz\n"
+			              << "Loop candidate (" << ++i << "/" << ncands << "):\n"
+			              << h->to_string();})
+			bool found = pme->explore_neighborhood(_root, _starter_term, h);
+			if (found) return true;
+		}
 	}
 
 	return false;
 }
 
+/* ======================================================== */
+
+// Don't bother starting threads for fewer candidates than this.
+#define MIN_PER_THREAD 64
+
+// Candidates are handed out to the threads this many at a time;
+// the cost of exploring a candidate varies wildly, so fixed slices
+// would leave some threads idle while others are still busy.
+#define CANDIDATE_CHUNK 16
+
+/**
+ * Return true if the candidates should be searched in parallel.
+ * Groundings have to be reported to this callback, so searches of
+ * the components of a multi-component pattern stay serial.
+ */
+bool InitiateSearchCB::use_threads(PatternMatchEngine *pme, size_t ncands)
+{
+	if (_nthreads <= 1 or ncands < 2 * MIN_PER_THREAD) return false;
+	return is_top_level(pme);
+}
+
+/**
+ * Explore the neighborhood of each of the candidates, using several
+ * threads. Each thread has its own engine and its own copy of this
+ * callback; the copies report their groundings to this callback.
+ *
+ * As with the serial loop, the search stops as soon as any one of
+ * the explorations reports that the search is satisfied.
+ */
+bool InitiateSearchCB::parallel_search(PatternMatchEngine *pme,
+                                       const HandleSeq& cands)
+{
+	size_t sz = cands.size();
+	size_t nthreads = std::min((size_t) _nthreads, sz / MIN_PER_THREAD);
+
+	std::vector<std::unique_ptr<InitiateSearchCB>> clones;
+	std::vector<std::unique_ptr<PooledEngine>> engines;
+	for (size_t t = 0; t < nthreads; t++)
+	{
+		InitiateSearchCB* cb = clone_for_thread();
+		if (nullptr == cb) break;
+		clones.emplace_back(cb);
+		cb->set_budget(_budget);
+		engines.emplace_back(new PooledEngine(*cb));
+		engines.back()->get()->set_pattern(*_variables, *_pattern);
+		engines.back()->get()->set_clause_costs(pme->get_clause_costs());
+		cb->set_pattern(*_variables, *_pattern);
+	}
+
+	// This callback cannot be copied; do it the old way.
+	if (clones.size() < 2)
+	{
+		for (const Handle& h : cands)
+			if (pme->explore_neighborhood(_root, _starter_term, h))
+				return true;
+		return false;
+	}
+
+	DO_LOG({LAZY_LOG_FINE << "Parallel search of " << sz
+	              << " candidates with " << clones.size() << " threads";})
+
+	std::atomic<size_t> next(0);
+	std::atomic<bool> found(false);
+	std::mutex err_mtx;
+	std::exception_ptr err;
+
+	auto worker = [&](PatternMatchEngine* wpme)
+	{
+		try
+		{
+			while (not found)
+			{
+				size_t lo = next.fetch_add(CANDIDATE_CHUNK);
+				if (sz <= lo) break;
+				size_t hi = std::min(sz, lo + CANDIDATE_CHUNK);
+				for (size_t i = lo; i < hi and not found; i++)
+				{
+					if (wpme->explore_neighborhood(_root, _starter_term,
+					                               cands[i]))
+						found = true;
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lck(err_mtx);
+			if (not err) err = std::current_exception();
+			found = true;
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < engines.size(); t++)
+		threads.emplace_back(worker, engines[t]->get());
+	worker(engines[0]->get());
+	for (std::thread& th : threads)
+		th.join();
+
+	for (const auto& cb : clones)
+		join_thread(cb.get());
+
+	if (err) std::rethrow_exception(err);
+
+	return found;
+}
+
 /* ======================================================== */
 /**
  * No search -- no variables, only constant, possibly evaluatable
@@ -866,6 +1098,21 @@ void InitiateSearchCB::jit_analyze(PatternMatchEngine* pme)
 	if (0 == _pattern->defined_terms.size())
 		return;
 
+	// Use the expansion made the last time around, if the definitions
+	// have not changed since. (The cache checks for that.)
+	bool top = is_top_level(pme);
+	if (top and _compiled and _compiled->jit)
+	{
+		_pl = _compiled->jit;
+		_variables = &_pl->get_variables();
+		_pattern = &_pl->get_pattern();
+		_dynamic = &_pattern->evaluatable_terms;
+
+		pme->set_pattern(*_variables, *_pattern);
+		set_pattern(*_variables, *_pattern);
+		return;
+	}
+
 	// Now is the time to look up the definitions!
 	// We loop here, so that all recursive definitions are expanded
 	// as well.  XXX Except that this is wrong, if any of the
@@ -921,6 +1168,9 @@ void InitiateSearchCB::jit_analyze(PatternMatchEngine* pme)
 
 	_dynamic = &_pattern->evaluatable_terms;
 
+	if (top and _compiling)
+		_compiling->jit = _pl;
+
 	pme->set_pattern(*_variables, *_pattern);
 	set_pattern(*_variables, *_pattern);
 	DO_LOG({logger().fine("JIT expanded!");
@@ -28,8 +28,10 @@
 #include <opencog/atoms/base/types.h>
 #include <opencog/atoms/core/Quotation.h>
 #include <opencog/atoms/pattern/PatternLink.h>
+#include <opencog/query/PatternCache.h>
 #include <opencog/query/PatternMatchCallback.h>
 #include <opencog/query/PatternMatchEngine.h>
+#include <opencog/query/SearchBudget.h>
 
 namespace opencog {
 
@@ -55,6 +57,34 @@ public:
 	virtual void set_pattern(const Variables&, const Pattern&);
 	virtual bool initiate_search(PatternMatchEngine *);
 
+	/**
+	 * Split the loop over the search starting points over this many
+	 * threads. Only callbacks that know how to copy themselves (by
+	 * overloading clone_for_thread()) are searched in parallel; all
+	 * others ignore this setting.
+	 */
+	void set_search_threads(unsigned n) { _nthreads = n; }
+
+	/**
+	 * Limit the time and the work that the search may take, and
+	 * allow it to be cancelled; see SearchBudget.h. The budget must
+	 * outlive the search. Null (the default) means no limits.
+	 */
+	void set_budget(SearchBudget* b) { _budget = b; }
+	virtual SearchBudget* get_budget(void) { return _budget; }
+
+	/**
+	 * Use a cached analysis of the pattern, if not null. Otherwise,
+	 * record the analysis as it is made, so that get_compiled() can
+	 * return it after the search. Only the top-level pattern is
+	 * cached; not the components of multi-component patterns.
+	 * If the cached start points turn out to be stale, they are
+	 * worked out again, and get_compiled() returns a revised copy;
+	 * otherwise, it returns null when a cached analysis was used.
+	 */
+	void set_compiled(const CompiledPatternPtr&);
+	CompiledPatternPtr get_compiled(void) const;
+
 protected:
 
 	ClassServer& _classserver;
@@ -69,12 +99,7 @@ protected:
 	Handle _root;
 	Handle _starter_term;
 
-	struct Choice
-	{
-		size_t clause;
-		Handle best_start;
-		Handle start_term;
-	};
+	typedef CompiledPattern::Start Choice;
 	size_t _curr_clause;
 	std::vector<Choice> _choices;
 
@@ -87,12 +112,34 @@ protected:
 	virtual void find_rarest(const Handle&, Handle&, size_t&,
 	                         Quotation quotation=Quotation());
 
+	// Cost-based choice of the start; see QueryPlanner.h
+	std::unordered_map<Handle, double> _clause_costs;
+	void plan_start(const HandleSeq&, Choice&);
+	void count_types(CompiledPattern&);
+
 	bool _search_fail;
 	virtual bool neighbor_search(PatternMatchEngine *);
 	virtual bool link_type_search(PatternMatchEngine *);
 	virtual bool variable_search(PatternMatchEngine *);
 	virtual bool no_search(PatternMatchEngine *);
 
+	// Parallel search support. Each thread gets its own engine, and
+	// its own copy of the callback, made by clone_for_thread(). The
+	// copy must report its groundings back to the original, in a
+	// thread-safe way. After the search, join_thread() is called
+	// on each copy, to gather up any other state.
+	unsigned _nthreads;
+	SearchBudget* _budget;
+	virtual InitiateSearchCB* clone_for_thread(void) { return nullptr; }
+	virtual void join_thread(InitiateSearchCB*) {}
+	bool is_top_level(PatternMatchEngine *);
+	bool use_threads(PatternMatchEngine *, size_t);
+	bool parallel_search(PatternMatchEngine *, const HandleSeq&);
+
+	// The cached analysis in use, or the one being made.
+	CompiledPatternPtr _compiled;
+	std::shared_ptr<CompiledPattern> _compiling;
+
 #ifdef CACHED_IMPLICATOR
 	virtual void ready(AtomSpace*);
 	virtual void clear();
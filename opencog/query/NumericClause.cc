@@ -0,0 +1,229 @@
+/*
+ * NumericClause.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/atoms/base/atom_types.h>
+#include <opencog/atoms/core/NumberNode.h>
+
+#include "NumericClause.h"
+
+using namespace opencog;
+
+std::atomic<bool> NumericClause::_enabled(true);
+
+NumericClausePtr NumericClause::compile(const Handle& clause,
+                                        const HandleSet& varset)
+{
+	NumericClausePtr nc(new NumericClause());
+	if (not nc->compile_bool(clause, varset)) return nullptr;
+	return nc;
+}
+
+/// Compile something that is true or false.
+bool NumericClause::compile_bool(const Handle& h, const HandleSet& varset)
+{
+	Type t = h->get_type();
+	if (GREATER_THAN_LINK == t)
+	{
+		if (2 != h->get_arity()) return false;
+		if (not compile_number(h->getOutgoingAtom(0), varset)) return false;
+		if (not compile_number(h->getOutgoingAtom(1), varset)) return false;
+		_prog.push_back({GREATER, 0.0, 2});
+		return true;
+	}
+
+	if (NOT_LINK == t)
+	{
+		if (1 != h->get_arity()) return false;
+		if (not compile_bool(h->getOutgoingAtom(0), varset)) return false;
+		_prog.push_back({NOT, 0.0, 1});
+		return true;
+	}
+
+	if (AND_LINK == t or OR_LINK == t)
+	{
+		if (0 == h->get_arity()) return false;
+		for (const Handle& arg : h->getOutgoingSet())
+			if (not compile_bool(arg, varset)) return false;
+		_prog.push_back({AND_LINK == t ? AND : OR, 0.0, h->get_arity()});
+		return true;
+	}
+
+	return false;
+}
+
+/// Compile something that has a numeric value.
+bool NumericClause::compile_number(const Handle& h, const HandleSet& varset)
+{
+	double value;
+	if (get_number(h, value))
+	{
+		_prog.push_back({CONST, value, 0});
+		return true;
+	}
+
+	if (varset.end() != varset.find(h))
+	{
+		size_t k = 0;
+		while (k < _vars.size() and _vars[k] != h) k++;
+		if (k == _vars.size()) _vars.push_back(h);
+		_prog.push_back({VAR, 0.0, k});
+		return true;
+	}
+
+	Type t = h->get_type();
+	size_t arity = h->is_link() ? h->get_arity() : 0;
+	if (PLUS_LINK == t or TIMES_LINK == t)
+	{
+		if (0 == arity) return false;
+		for (const Handle& arg : h->getOutgoingSet())
+			if (not compile_number(arg, varset)) return false;
+		_prog.push_back({PLUS_LINK == t ? ADD : MUL, 0.0, arity});
+		return true;
+	}
+
+	// One argument negates (inverts); two subtract (divide).
+	if (MINUS_LINK == t or DIVIDE_LINK == t)
+	{
+		if (0 == arity or 2 < arity) return false;
+		for (const Handle& arg : h->getOutgoingSet())
+			if (not compile_number(arg, varset)) return false;
+		if (MINUS_LINK == t)
+			_prog.push_back({1 == arity ? NEG : SUB, 0.0, arity});
+		else
+			_prog.push_back({1 == arity ? INV : DIV, 0.0, arity});
+		return true;
+	}
+
+	return false;
+}
+
+bool NumericClause::get_number(const Handle& h, double& value)
+{
+	if (NUMBER_NODE != h->get_type()) return false;
+	NumberNodePtr nn(NumberNodeCast(h));
+	if (nullptr == nn) return false;
+	value = nn->get_value();
+	return true;
+}
+
+/* ======================================================== */
+
+bool NumericClause::evaluate(const HandleMap& gnds, bool& holds) const
+{
+	std::vector<double> vals(_vars.size());
+	for (size_t k = 0; k < _vars.size(); k++)
+	{
+		auto it = gnds.find(_vars[k]);
+		if (gnds.end() == it) return false;
+		if (not get_number(it->second, vals[k])) return false;
+	}
+
+	// Booleans are kept on the stack as 1.0 and 0.0.
+	std::vector<double> stack;
+	stack.reserve(_prog.size());
+	for (const Op& op : _prog)
+	{
+		if (CONST == op.code) { stack.push_back(op.value); continue; }
+		if (VAR == op.code) { stack.push_back(vals[op.arg]); continue; }
+
+		double* a = &stack[stack.size() - op.arg];
+		double r = a[0];
+		switch (op.code)
+		{
+			case ADD: for (size_t j = 1; j < op.arg; j++) r += a[j]; break;
+			case MUL: for (size_t j = 1; j < op.arg; j++) r *= a[j]; break;
+			case SUB: r = a[0] - a[1]; break;
+			case DIV: r = a[0] / a[1]; break;
+			case NEG: r = - a[0]; break;
+			case INV: r = 1.0 / a[0]; break;
+			case GREATER: r = a[0] > a[1] ? 1.0 : 0.0; break;
+			case NOT: r = 1.0 - a[0]; break;
+			case AND: for (size_t j = 1; j < op.arg; j++) r = r * a[j]; break;
+			case OR: for (size_t j = 1; j < op.arg; j++) r = r + a[j] - r * a[j]; break;
+			default: break;
+		}
+		stack.resize(stack.size() - op.arg);
+		stack.push_back(r);
+	}
+
+	holds = 0.5 < stack.back();
+	return true;
+}
+
+/// Each step of the program works on whole columns. The loops below
+/// are kept simple enough for the compiler to vectorize.
+void NumericClause::evaluate(const std::vector<std::vector<double>>& cols,
+                             std::vector<char>& keep) const
+{
+	size_t n = keep.size();
+	std::vector<std::vector<double>> stack;
+	stack.reserve(_prog.size());
+	for (const Op& op : _prog)
+	{
+		if (CONST == op.code)
+		{
+			stack.emplace_back(n, op.value);
+			continue;
+		}
+		if (VAR == op.code)
+		{
+			stack.push_back(cols[op.arg]);
+			continue;
+		}
+
+		size_t base = stack.size() - op.arg;
+		double* r = stack[base].data();
+		for (size_t j = 1; j < op.arg; j++)
+		{
+			const double* b = stack[base + j].data();
+			switch (op.code)
+			{
+				case ADD: for (size_t i = 0; i < n; i++) r[i] += b[i]; break;
+				case MUL: for (size_t i = 0; i < n; i++) r[i] *= b[i]; break;
+				case SUB: for (size_t i = 0; i < n; i++) r[i] -= b[i]; break;
+				case DIV: for (size_t i = 0; i < n; i++) r[i] /= b[i]; break;
+				case GREATER:
+					for (size_t i = 0; i < n; i++) r[i] = r[i] > b[i] ? 1.0 : 0.0;
+					break;
+				case AND: for (size_t i = 0; i < n; i++) r[i] *= b[i]; break;
+				case OR:
+					for (size_t i = 0; i < n; i++) r[i] = r[i] + b[i] - r[i] * b[i];
+					break;
+				default: break;
+			}
+		}
+		switch (op.code)
+		{
+			case NEG: for (size_t i = 0; i < n; i++) r[i] = - r[i]; break;
+			case INV: for (size_t i = 0; i < n; i++) r[i] = 1.0 / r[i]; break;
+			case NOT: for (size_t i = 0; i < n; i++) r[i] = 1.0 - r[i]; break;
+			default: break;
+		}
+		stack.resize(base + 1);
+	}
+
+	const double* r = stack.back().data();
+	for (size_t i = 0; i < n; i++)
+		keep[i] = keep[i] and 0.5 < r[i];
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,109 @@
+/*
+ * NumericClause.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_NUMERIC_CLAUSE_H
+#define _OPENCOG_NUMERIC_CLAUSE_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+
+namespace opencog {
+
+class NumericClause;
+typedef std::shared_ptr<NumericClause> NumericClausePtr;
+
+/**
+ * An evaluatable clause that only does arithmetic on numbers, compiled
+ * so that it can be evaluated without creating any atoms.
+ *
+ * The clauses that can be compiled are GreaterThanLinks, and the
+ * NotLinks, AndLinks and OrLinks of those, whose arguments are built
+ * out of PlusLink, MinusLink, TimesLink and DivideLink, NumberNodes,
+ * and variables. Everything else (GroundedPredicateNodes, for example)
+ * is left to the usual evaluation, which instantiates the grounded
+ * clause in a scratch atomspace, and evaluates that.
+ *
+ * A compiled clause can be evaluated for one grounding, or for many at
+ * once: then, the values of each variable are given as a column, and
+ * each step of the arithmetic is done for the whole column in a tight
+ * loop. In either case, the variables have to be grounded by
+ * NumberNodes; if one is not, the caller has to fall back to the usual
+ * evaluation, which knows what to do with it (or how to complain).
+ */
+class NumericClause
+{
+public:
+	/// Compile the clause; return nullptr if it is not of the kind
+	/// described above. Only the atoms in varset are variables.
+	static NumericClausePtr compile(const Handle& clause,
+	                                const HandleSet& varset);
+
+	/// The variables of the clause, in column order.
+	const HandleSeq& get_variables(void) const { return _vars; }
+
+	/// The value of a NumberNode. Return false for any other atom.
+	static bool get_number(const Handle& h, double& value);
+
+	/// Evaluate the clause for the variable groundings in gnds, and
+	/// put the result in holds. Return false, without evaluating, if
+	/// some variable is not grounded by a NumberNode.
+	bool evaluate(const HandleMap& gnds, bool& holds) const;
+
+	/// Evaluate the clause for many groundings at once. cols[k][i] is
+	/// the value of variable k in grounding i; keep[i] is cleared for
+	/// the groundings for which the clause is false.
+	void evaluate(const std::vector<std::vector<double>>& cols,
+	              std::vector<char>& keep) const;
+
+	/// Turn compiled evaluation on or off, for all searches. On by
+	/// default; when off, every clause takes the usual path.
+	static void set_enabled(bool on) { _enabled = on; }
+	static bool is_enabled(void) { return _enabled; }
+
+private:
+	enum Code { CONST, VAR, ADD, SUB, NEG, MUL, DIV, INV,
+	            GREATER, NOT, AND, OR };
+
+	// The clause in postfix order; arg is the variable number for
+	// VAR, and the number of operands for ADD, MUL, AND and OR.
+	struct Op
+	{
+		Code code;
+		double value;
+		size_t arg;
+	};
+
+	std::vector<Op> _prog;
+	HandleSeq _vars;
+
+	static std::atomic<bool> _enabled;
+
+	bool compile_bool(const Handle&, const HandleSet&);
+	bool compile_number(const Handle&, const HandleSet&);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_NUMERIC_CLAUSE_H
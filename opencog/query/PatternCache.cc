@@ -0,0 +1,219 @@
+/*
+ * PatternCache.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include <opencog/atoms/core/DefineLink.h>
+#include <opencog/atomspace/AtomSpace.h>
+
+#include "PatternCache.h"
+
+using namespace opencog;
+
+// Small types come and go; do not re-plan for a few atoms more or less.
+#define DRIFT_SLACK 64
+
+bool CompiledPattern::drifted(const AtomSpace* as) const
+{
+	for (const auto& tc : type_counts)
+	{
+		size_t now = as->get_num_atoms_of_type(tc.first);
+		size_t lo = std::min(now, tc.second);
+		size_t hi = std::max(now, tc.second);
+		if (2 * lo + DRIFT_SLACK < hi) return true;
+	}
+	return false;
+}
+
+PatternCache::PatternCache(size_t capacity) :
+	_capacity(capacity),
+	_inserts(0)
+{
+	reset_stats();
+}
+
+/// The index entry for the key, or _index.end(). Entries with the
+/// same hash, whose key has gone away, are dropped on the way.
+/// Caller must hold the lock.
+PatternCache::Index::iterator PatternCache::find(const Handle& h)
+{
+	auto range = _index.equal_range(h->get_hash());
+	for (auto it = range.first; it != range.second; )
+	{
+		AtomPtr key(it->second->key.lock());
+		if (h == key.get()) return it;
+		if (nullptr != key) { it++; continue; }
+
+		_lru.erase(it->second);
+		it = _index.erase(it);
+		_stats.expired++;
+	}
+	return _index.end();
+}
+
+/// Remove the entry from the list and from the index.
+/// Caller must hold the lock.
+void PatternCache::erase(LRUList::iterator lit)
+{
+	auto range = _index.equal_range(lit->hash);
+	for (auto it = range.first; it != range.second; it++)
+	{
+		if (it->second != lit) continue;
+		_index.erase(it);
+		break;
+	}
+	_lru.erase(lit);
+}
+
+/// Drop the entries whose key has gone away.
+/// Caller must hold the lock.
+void PatternCache::drop_expired(void)
+{
+	for (auto lit = _lru.begin(); lit != _lru.end(); )
+	{
+		auto next = std::next(lit);
+		if (lit->key.expired())
+		{
+			erase(lit);
+			_stats.expired++;
+		}
+		lit = next;
+	}
+}
+
+CompiledPatternPtr PatternCache::get(const Handle& h)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (0 == _capacity) return nullptr;
+
+	auto it = find(h);
+	if (_index.end() == it)
+	{
+		_stats.misses++;
+		return nullptr;
+	}
+
+	// Only the expansions of defined terms can go stale. The start
+	// points are checked by the search; see CompiledPattern::drifted().
+	CompiledPatternPtr cp = it->second->cp;
+	if (cp->jit and cp->generation != DefineLink::get_generation())
+	{
+		erase(it->second);
+		_stats.stale++;
+		_stats.misses++;
+		return nullptr;
+	}
+
+	_lru.splice(_lru.begin(), _lru, it->second);
+	_stats.hits++;
+	return cp;
+}
+
+void PatternCache::put(const Handle& h, const CompiledPatternPtr& cp)
+{
+	if (nullptr == cp) return;
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	if (0 == _capacity) return;
+
+	// Another thread may have got here first; keep the newer one.
+	auto it = find(h);
+	if (_index.end() != it)
+	{
+		it->second->cp = cp;
+		_lru.splice(_lru.begin(), _lru, it->second);
+		return;
+	}
+
+	// Entries whose key went away are dropped when they are found,
+	// or when they reach the end of the list. The odd full sweep, once
+	// per `capacity` inserts, catches the rest, at a small cost per
+	// insert.
+	if (_capacity <= ++_inserts)
+	{
+		drop_expired();
+		_inserts = 0;
+	}
+
+	_lru.push_front({h->get_hash(), std::weak_ptr<Atom>(h), cp});
+	_index.emplace(h->get_hash(), _lru.begin());
+	evict();
+}
+
+/// Drop the least-recently used entries, until there is room.
+/// Caller must hold the lock.
+void PatternCache::evict(void)
+{
+	while (_capacity < _lru.size())
+	{
+		auto last = std::prev(_lru.end());
+		if (last->key.expired()) _stats.expired++;
+		else _stats.evictions++;
+		erase(last);
+	}
+}
+
+void PatternCache::set_capacity(size_t capacity)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_capacity = capacity;
+	evict();
+}
+
+size_t PatternCache::size(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _lru.size();
+}
+
+void PatternCache::clear(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_index.clear();
+	_lru.clear();
+	_inserts = 0;
+}
+
+PatternCache::Stats PatternCache::get_stats(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _stats;
+}
+
+void PatternCache::reset_stats(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.stale = 0;
+	_stats.evictions = 0;
+	_stats.expired = 0;
+}
+
+PatternCache& opencog::pattern_cache(void)
+{
+	static PatternCache cache;
+	return cache;
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,164 @@
+/*
+ * PatternCache.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_PATTERN_CACHE_H
+#define _OPENCOG_PATTERN_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/pattern/PatternLink.h>
+
+namespace opencog {
+
+class AtomSpace;
+
+/**
+ * The parts of a pattern search that depend only on the pattern, and
+ * not on the groundings: these are worked out anew on every search,
+ * unless a cached copy is available.
+ *
+ * Once placed into the cache, a CompiledPattern is never modified;
+ * several searches may be using it at the same time.
+ */
+struct CompiledPattern
+{
+	/// The value of DefineLink::get_generation() when this was made.
+	size_t generation;
+
+	/// The pattern, with all defined terms (DefinedPredicateNodes,
+	/// etc.) expanded. Null, if the pattern did not have any.
+	PatternLinkPtr jit;
+
+	/// Where the neighbor search starts. If have_starts is set, but
+	/// the list is empty, then the pattern has no usable constant,
+	/// and some other search must be used.
+	struct Start
+	{
+		size_t clause;
+		Handle best_start;
+		Handle start_term;
+	};
+	bool have_starts;
+	std::vector<Start> starts;
+
+	/// The planner's estimate of how many groundings each clause has.
+	/// Used only to break ties in the order in which clauses are
+	/// grounded; see PatternMatchEngine::get_next_thinnest_clause().
+	std::unordered_map<Handle, double> clause_costs;
+
+	/// The number of atoms of each type that the starts and costs
+	/// depend on (the types of the clauses and of the start terms),
+	/// at the time they were worked out.
+	std::vector<std::pair<Type, size_t>> type_counts;
+
+	/// True if any of type_counts has since more than doubled, or
+	/// dropped by more than half, in the given AtomSpace; the starts
+	/// and costs should then be worked out again.
+	bool drifted(const AtomSpace*) const;
+
+	CompiledPattern(void) : generation(0), have_starts(false) {}
+};
+
+typedef std::shared_ptr<const CompiledPattern> CompiledPatternPtr;
+
+/**
+ * Process-wide LRU cache of compiled patterns, keyed by the BindLink
+ * or GetLink that holds the pattern.  The key is held by its content
+ * hash and a weak pointer, so that the cache never keeps a BindLink
+ * alive. Entries whose BindLink has gone away are dropped when they
+ * are found, when they come up for eviction, and by a sweep of the
+ * whole cache, once every `capacity` insertions.
+ *
+ * Expansions of defined terms go stale when the definitions change;
+ * entries holding one are dropped the first time they are looked up
+ * after any DefineLink was added or removed.  The start points do not
+ * depend on the definitions, but on the number of atoms of a few
+ * types; a search that finds that these have drifted (see
+ * CompiledPattern::drifted()) picks new start points, and puts the
+ * revised entry back into the cache.
+ *
+ * A capacity of zero turns the cache off.
+ */
+class PatternCache
+{
+public:
+	struct Stats
+	{
+		size_t hits;
+		size_t misses;
+		size_t stale;        // dropped, because definitions changed
+		size_t evictions;    // dropped, to make room
+		size_t expired;      // dropped, because the key went away
+	};
+
+	PatternCache(size_t capacity = 1024);
+
+	CompiledPatternPtr get(const Handle&);
+	void put(const Handle&, const CompiledPatternPtr&);
+
+	void set_capacity(size_t);
+	size_t get_capacity(void) const { return _capacity; }
+	size_t size(void);
+	void clear(void);
+
+	Stats get_stats(void);
+	void reset_stats(void);
+
+private:
+	struct Entry
+	{
+		ContentHash hash;
+		std::weak_ptr<Atom> key;
+		CompiledPatternPtr cp;
+	};
+	typedef std::list<Entry> LRUList;
+	typedef std::unordered_multimap<ContentHash, LRUList::iterator> Index;
+
+	std::mutex _mtx;
+	size_t _capacity;
+
+	// Most recently used at the front.
+	LRUList _lru;
+	Index _index;
+
+	// Insertions since the last sweep for expired entries.
+	size_t _inserts;
+
+	Stats _stats;
+
+	Index::iterator find(const Handle&);
+	void erase(LRUList::iterator);
+	void drop_expired(void);
+	void evict(void);
+};
+
+/// The process-wide pattern cache.
+PatternCache& pattern_cache(void);
+
+} // namespace opencog
+
+#endif // _OPENCOG_PATTERN_CACHE_H
@@ -30,6 +30,7 @@
 
 #include "PatternMatch.h"
 #include "PatternMatchEngine.h"
+#include "SearchBudget.h"
 #include "DefaultPatternMatchCB.h"
 
 using namespace opencog;
@@ -72,6 +73,13 @@ class PMCGroundings : public PatternMatchCallback
 		{
 			return _cb.evaluate_sentence(link_h,gnds);
 		}
+		bool evaluate_batch(const Handle& link_h,
+		                    const HandleMap& fixed,
+		                    const HandleMapSeq& rows,
+		                    std::vector<char>& keep)
+		{
+			return _cb.evaluate_batch(link_h, fixed, rows, keep);
+		}
 		bool clause_match(const Handle& pattrn_link_h,
 		                  const Handle& grnd_link_h,
 		                  const HandleMap& term_gnds)
@@ -89,6 +97,7 @@ class PMCGroundings : public PatternMatchCallback
 		}
 		void push(void) { _cb.push(); }
 		void pop(void) { _cb.pop(); }
+		SearchBudget* get_budget(void) { return _cb.get_budget(); }
 		void set_pattern(const Variables& vars,
 		                 const Pattern& pat)
 		{
@@ -124,7 +133,8 @@ class PMCGroundings : public PatternMatchCallback
  * The virtual links are in 'virtuals', a partial set of groundings
  * are in 'var_gnds' and 'term_gnds', and a collection of possible
  * groundings for disconnected graph components are in 'comp_var_gnds'
- * and 'comp_term_gnds'.
+ * and 'comp_term_gnds'. Only the first 'ncomps' of these are still
+ * to be tacked on; the others are already in 'var_gnds', 'term_gnds'.
  *
  * Notes below explain the recursive step: how the various disconnected
  * components are brought together into a candidate grounding. That
@@ -132,8 +142,9 @@ class PMCGroundings : public PatternMatchCallback
  * accept the grounding, then the callback is called to make the final
  * determination.
  *
- * The recursion step terminates when comp_var_gnds, comp_term_gnds
- * are empty, at which point the actual unification is done.
+ * The recursion step terminates when there is just one component
+ * left; the candidates made with each of its groundings are then
+ * handed to batch_virtual(), below.
  *
  * Return false if no solution is found, true otherwise.
  */
@@ -142,83 +153,42 @@ bool PatternMatch::recursive_virtual(PatternMatchCallback& cb,
             const HandleSeq& negations, // currently ignored
             const HandleMap& var_gnds,
             const HandleMap& term_gnds,
-            // copies, NOT references!
-            std::vector<HandleMapSeq> comp_var_gnds,
-            std::vector<HandleMapSeq> comp_term_gnds)
+            const std::vector<HandleMapSeq>& comp_var_gnds,
+            const std::vector<HandleMapSeq>& comp_term_gnds,
+            size_t ncomps)
 {
-	// If we are done with the recursive step, then we have one of the
-	// many combinatoric possibilities in the var_gnds and term_gnds
-	// maps. Submit this grounding map to the virtual links, and see
-	// what they've got to say about it.
-	if (0 == comp_var_gnds.size())
-	{
-#ifdef DEBUG
-		if (logger().is_fine_enabled())
-		{
-			logger().fine("Explore one possible combinatoric grounding "
-			              "(var_gnds.size = %zu, term_gnds.size = %zu):",
-			              var_gnds.size(), term_gnds.size());
-			PatternMatchEngine::log_solution(var_gnds, term_gnds);
-		}
-#endif
+	// If there are no components at all, the one candidate is the
+	// one we've got.
+	if (0 == ncomps)
+		return batch_virtual(cb, virtuals, var_gnds, term_gnds,
+		                     HandleMapSeq(1), HandleMapSeq(1));
 
-		// Note, FYI, that if there are no virtual clauses at all,
-		// then this loop falls straight-through, and the grounding
-		// is reported as a match to the callback.  That is, the
-		// virtuals only serve to reject possibilities.
-		for (const Handle& virt : virtuals)
-		{
-			// At this time, we expect all virtual links to be in
-			// one of two forms: either EvaluationLink's or
-			// GreaterThanLink's. The EvaluationLinks should have
-			// the structure
-			//
-			//   EvaluationLink
-			//       GroundedPredicateNode "scm:blah"
-			//       ListLink
-			//           Arg1Atom
-			//           Arg2Atom
-			//
-			// The GreaterThanLink's should have the "obvious" structure
-			//
-			//   GreaterThanLink
-			//       Arg1Atom
-			//       Arg2Atom
-			//
-			// In either case, one or more VariableNodes should appear
-			// in the Arg atoms. So, we ground the args, and pass that
-			// to the callback.
-
-			bool match = cb.evaluate_sentence(virt, var_gnds);
-
-			if (not match) return false;
-		}
+	if (1 == ncomps)
+		return batch_virtual(cb, virtuals, var_gnds, term_gnds,
+		                     comp_var_gnds[0], comp_term_gnds[0]);
 
-		// Yay! We found one! We now have a fully and completely grounded
-		// pattern! See what the callback thinks of it.
-		return cb.grounding(var_gnds, term_gnds);
-	}
 #ifdef DEBUG
-	LAZY_LOG_FINE << "Component recursion: num comp=" << comp_var_gnds.size();
+	LAZY_LOG_FINE << "Component recursion: num comp=" << ncomps;
 #endif
 
 	// Recurse over all components. If component k has N_k groundings,
 	// and there are m components, then we have to explore all
 	// N_0 * N_1 * N_2 * ... N_m possible combinations of groundings.
-	// We do this recursively, by poping N_m off the back, and calling
+	// We do this recursively, by taking N_m off the back, and calling
 	// ourselves.
 	//
 	// vg and vp will be the collection of all of the different possible
 	// groundings for one of the components (well, its for component m,
 	// in the above notation.) So the loop below tries every possibility.
-	HandleMapSeq vg = comp_var_gnds.back();
-	comp_var_gnds.pop_back();
-	HandleMapSeq pg = comp_term_gnds.back();
-	comp_term_gnds.pop_back();
+	const HandleMapSeq& vg = comp_var_gnds[ncomps-1];
+	const HandleMapSeq& pg = comp_term_gnds[ncomps-1];
 
+	SearchBudget* budget = cb.get_budget();
 	size_t ngnds = vg.size();
 	for (size_t i=0; i<ngnds; i++)
 	{
+		if (budget and budget->exhausted()) return true;
+
 		// Given a set of groundings, tack on those for this component,
 		// and recurse, with one less component. We need to make a copy,
 		// of course.
@@ -231,7 +201,8 @@ bool PatternMatch::recursive_virtual(PatternMatchCallback& cb,
 		rpg.insert(cand_pg.begin(), cand_pg.end());
 
 		bool accept = recursive_virtual(cb, virtuals, negations, rvg, rpg,
-		                                comp_var_gnds, comp_term_gnds);
+		                                comp_var_gnds, comp_term_gnds,
+		                                ncomps-1);
 
 		// Halt recursion immediately if match is accepted.
 		if (accept) return true;
@@ -239,6 +210,98 @@ bool PatternMatch::recursive_virtual(PatternMatchCallback& cb,
 	return false;
 }
 
+/**
+ * The last step of the recursion: every grounding of the last
+ * component, together with 'var_gnds' and 'term_gnds', makes one of
+ * the many combinatoric possibilities. Submit these to the virtual
+ * links, and see what they've got to say about them.
+ *
+ * The callback is first offered each virtual link, together with all
+ * of the candidates at once, so that it can evaluate them in a batch
+ * (see PatternMatchCallback::evaluate_batch()). The virtual links it
+ * declines are evaluated one candidate at a time, as before; only the
+ * candidates that the batches kept get this far. Only the candidates
+ * that pass all of the virtual links are copied into full grounding
+ * maps.
+ */
+bool PatternMatch::batch_virtual(PatternMatchCallback& cb,
+            const HandleSeq& virtuals,
+            const HandleMap& var_gnds,
+            const HandleMap& term_gnds,
+            const HandleMapSeq& last_var_gnds,
+            const HandleMapSeq& last_term_gnds)
+{
+	// At this time, we expect all virtual links to be in
+	// one of two forms: either EvaluationLink's or
+	// GreaterThanLink's. The EvaluationLinks should have
+	// the structure
+	//
+	//   EvaluationLink
+	//       GroundedPredicateNode "scm:blah"
+	//       ListLink
+	//           Arg1Atom
+	//           Arg2Atom
+	//
+	// The GreaterThanLink's should have the "obvious" structure
+	//
+	//   GreaterThanLink
+	//       Arg1Atom
+	//       Arg2Atom
+	//
+	// In either case, one or more VariableNodes should appear
+	// in the Arg atoms. So, we ground the args, and pass that
+	// to the callback.
+	size_t ngnds = last_var_gnds.size();
+	std::vector<char> keep(ngnds, true);
+	HandleSeq one_by_one;
+	for (const Handle& virt : virtuals)
+	{
+		if (not cb.evaluate_batch(virt, var_gnds, last_var_gnds, keep))
+			one_by_one.push_back(virt);
+	}
+
+	SearchBudget* budget = cb.get_budget();
+	for (size_t i=0; i<ngnds; i++)
+	{
+		if (not keep[i]) continue;
+
+		// Each combination that gets this far is one step.
+		if (budget and budget->step()) return true;
+
+		HandleMap rvg(var_gnds);
+		HandleMap rpg(term_gnds);
+		rvg.insert(last_var_gnds[i].begin(), last_var_gnds[i].end());
+		rpg.insert(last_term_gnds[i].begin(), last_term_gnds[i].end());
+
+#ifdef DEBUG
+		if (logger().is_fine_enabled())
+		{
+			logger().fine("Explore one possible combinatoric grounding "
+			              "(var_gnds.size = %zu, term_gnds.size = %zu):",
+			              rvg.size(), rpg.size());
+			PatternMatchEngine::log_solution(rvg, rpg);
+		}
+#endif
+
+		// Note, FYI, that if there are no virtual clauses at all,
+		// then this loop falls straight-through, and the grounding
+		// is reported as a match to the callback.  That is, the
+		// virtuals only serve to reject possibilities.
+		bool match = true;
+		for (const Handle& virt : one_by_one)
+		{
+			match = cb.evaluate_sentence(virt, rvg);
+			if (not match) break;
+		}
+		if (not match) continue;
+
+		// Yay! We found one! We now have a fully and completely grounded
+		// pattern! See what the callback thinks of it.
+		if (cb.grounding(rvg, rpg)) return true;
+	}
+	return false;
+}
+
 /* ================================================================= */
 /**
  * Ground (solve) a pattern; perform unification. That is, find one
@@ -366,15 +429,15 @@ bool PatternLink::satisfy(PatternMatchCallback& pmcb) const
 	// in a direct fashion.
 	if (_num_comps <= 1)
 	{
-		PatternMatchEngine pme(pmcb);
+		PooledEngine pme(pmcb);
 
 #ifdef DEBUG
 		debug_log();
 #endif
 
-		pme.set_pattern(_varlist, _pat);
+		pme->set_pattern(_varlist, _pat);
 		pmcb.set_pattern(_varlist, _pat);
-		bool found = pmcb.initiate_search(&pme);
+		bool found = pmcb.initiate_search(pme.get());
 
 #ifdef DEBUG
 		logger().fine("================= Done with Search =================");
@@ -432,6 +495,11 @@ bool PatternLink::satisfy(PatternMatchCallback& pmcb) const
 		PMCGroundings gcb(pmcb);
 		clp->satisfy(gcb);
 
+		// Out of time or steps; the groundings of this component
+		// might be incomplete, so don't combine them.
+		SearchBudget* budget = pmcb.get_budget();
+		if (budget and budget->exhausted()) return true;
+
 		// Special handling for disconnected pure optionals -- Returns false to
 		// end the search if this disconnected pure optional is found
 		if (is_pure_optional)
@@ -470,7 +538,8 @@ bool PatternLink::satisfy(PatternMatchCallback& pmcb) const
 	pmcb.set_pattern(_varlist, _pat);
 	return PatternMatch::recursive_virtual(pmcb, _virtual, optionals,
 	                                       empty_vg, empty_pg,
-	                                       comp_var_gnds, comp_term_gnds);
+	                                       comp_var_gnds, comp_term_gnds,
+	                                       comp_var_gnds.size());
 }
 
 // For gdb, see
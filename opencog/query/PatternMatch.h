@@ -44,8 +44,16 @@ class PatternMatch
 		            const HandleSeq& negations,
 		            const HandleMap& var_gnds,
 		            const HandleMap& term_gnds,
-		            std::vector<HandleMapSeq> comp_var_gnds,
-		            std::vector<HandleMapSeq> comp_term_gnds);
+		            const std::vector<HandleMapSeq>& comp_var_gnds,
+		            const std::vector<HandleMapSeq>& comp_term_gnds,
+		            size_t ncomps);
+
+		static bool batch_virtual(PatternMatchCallback& cb,
+		            const HandleSeq& virtuals,
+		            const HandleMap& var_gnds,
+		            const HandleMap& term_gnds,
+		            const HandleMapSeq& last_var_gnds,
+		            const HandleMapSeq& last_term_gnds);
 };
 
 } // namespace opencog
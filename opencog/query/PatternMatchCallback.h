@@ -26,6 +26,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include <opencog/atoms/base/Handle.h>
 #include <opencog/atoms/base/Link.h>
 #include <opencog/atoms/core/VariableList.h> // for VariableTypeMap
@@ -34,6 +35,7 @@
 
 namespace opencog {
 class PatternMatchEngine;
+class SearchBudget;
 
 /**
  * Callback interface, used to implement specifics of hypergraph
@@ -212,6 +214,29 @@ class PatternMatchCallback
 		virtual bool evaluate_sentence(const Handle& eval,
 		                               const HandleMap& gnds) = 0;
 
+		/**
+		 * Invoked to confirm or deny many candidate groundings for an
+		 * evaluatable term at once, when piecing together the groundings
+		 * of several disconnected components. The candidates all share
+		 * the groundings in 'fixed', and differ in those in 'rows'. The
+		 * candidate 'i' is the union of 'fixed' and 'rows[i]'; if the
+		 * term is false for it, keep[i] should be cleared. Candidates
+		 * for which keep[i] is already clear can be skipped.
+		 *
+		 * Return false to decline; evaluate_sentence() will then be
+		 * called for each candidate that is still kept, one at a time,
+		 * just before it is reported. Only terms whose evaluation has no
+		 * side effects should be taken here, as they are evaluated for
+		 * every candidate, even if the search halts on an earlier one.
+		 */
+		virtual bool evaluate_batch(const Handle& eval,
+		                            const HandleMap& fixed,
+		                            const HandleMapSeq& rows,
+		                            std::vector<char>& keep)
+		{
+			return false;
+		}
+
 		/**
 		 * Called when a top-level clause has been fully grounded.
 		 * This is meant to be used for evaluating the truth value
@@ -303,6 +328,14 @@ class PatternMatchCallback
 		virtual const std::set<Type>& get_connectives(void)
 		{ static const std::set<Type> _empty; return _empty; }
 
+		/**
+		 * The limits on the search, or null, if there are none. This
+		 * is asked for when the engine is given the pattern; once the
+		 * budget is used up, the engine stops the search as if a
+		 * callback had returned true. See SearchBudget.h.
+		 */
+		virtual SearchBudget* get_budget(void) { return nullptr; }
+
 		/**
 		 * Called to initiate the search. This callback is responsible
 		 * for performing the top-most, outer loop of the search. That is,
@@ -84,12 +84,12 @@ static inline void log(const Handle& h) {}
    #define POPSTK(stack,soln) {         \
       OC_ASSERT(not stack.empty(),      \
            "Unbalanced stack " #stack); \
-      soln = stack.top();               \
+      soln = std::move(stack.top());    \
       stack.pop();                      \
    }
 #else
    #define POPSTK(stack,soln) {         \
-      soln = stack.top();               \
+      soln = std::move(stack.top());    \
       stack.pop();                      \
    }
 #endif
@@ -124,7 +124,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 	// The variable_match() callback may implement some tighter
 	// variable check, e.g. to make sure that the grounding is
 	// of some certain type.
-	if (not _pmc.variable_match(hp, hg)) return false;
+	if (not _pmc->variable_match(hp, hg)) return false;
 
 	// Make a record of it. Cannot record GlobNodes here; they're
 	// variadic.
@@ -133,7 +133,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 		DO_LOG({LAZY_LOG_FINE << "Found grounding of variable:";})
 		logmsg("$$ variable:", hp);
 		logmsg("$$ ground term:", hg);
-		var_grounding[hp] = hg;
+		var_grounding.set(hp, hg);
 	}
 	return true;
 }
@@ -149,7 +149,7 @@ bool PatternMatchEngine::variable_compare(const Handle& hp,
 bool PatternMatchEngine::self_compare(const PatternTermPtr& ptm)
 {
 	const Handle& hp = ptm->getHandle();
-	if (not ptm->isQuoted()) var_grounding[hp] = hp;
+	if (not ptm->isQuoted()) var_grounding.set(hp, hp);
 
 	logmsg("Compare atom to itself:", hp);
 	return true;
@@ -162,13 +162,13 @@ bool PatternMatchEngine::node_compare(const Handle& hp,
                                       const Handle& hg)
 {
 	// Call the callback to make the final determination.
-	bool match = _pmc.node_match(hp, hg);
+	bool match = _pmc->node_match(hp, hg);
 	if (match)
 	{
 		DO_LOG({LAZY_LOG_FINE << "Found matching nodes";})
 		logmsg("# pattern:", hp);
 		logmsg("# match:", hg);
-		if (hp != hg) var_grounding[hp] = hg;
+		if (hp != hg) var_grounding.set(hp, hg);
 	}
 	return match;
 }
@@ -211,7 +211,7 @@ bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
 		// If the arities are mis-matched, do a fuzzy compare instead.
 		if (osp_size != osg_size)
 		{
-			match = _pmc.fuzzy_match(ptm->getHandle(), hg);
+			match = _pmc->fuzzy_match(ptm->getHandle(), hg);
 		}
 		else
 		{
@@ -239,17 +239,17 @@ bool PatternMatchEngine::ordered_compare(const PatternTermPtr& ptm,
 	const Handle &hp = ptm->getHandle();
 	if (not match)
 	{
-		_pmc.post_link_mismatch(hp, hg);
+		_pmc->post_link_mismatch(hp, hg);
 		return false;
 	}
 
 	// If we've found a grounding, lets see if the
 	// post-match callback likes this grounding.
-	match = _pmc.post_link_match(hp, hg);
+	match = _pmc->post_link_match(hp, hg);
 	if (not match) return false;
 
 	// If we've found a grounding, record it.
-	if (hp != hg) var_grounding[hp] = hg;
+	if (hp != hg) var_grounding.set(hp, hg);
 
 	return true;
 }
@@ -301,22 +301,22 @@ bool PatternMatchEngine::choice_compare(const PatternTermPtr& ptm,
 		{
 			// If we've found a grounding, lets see if the
 			// post-match callback likes this grounding.
-			match = _pmc.post_link_match(hp, hg);
+			match = _pmc->post_link_match(hp, hg);
 			if (match)
 			{
 				// Even the stack, *without* erasing the discovered grounding.
 				solution_drop();
 
 				// If the grounding is accepted, record it.
-				if (hp != hg) var_grounding[hp] = hg;
+				if (hp != hg) var_grounding.set(hp, hg);
 
-				_choice_state[GndChoice(ptm, hg)] = icurr;
+				_choice_state.set(GndChoice(ptm, hg), icurr);
 				return true;
 			}
 		}
 		else
 		{
-			_pmc.post_link_mismatch(hp, hg);
+			_pmc->post_link_mismatch(hp, hg);
 		}
 		solution_pop();
 		choose_next = false; // we are taking a step, so clear the flag.
@@ -506,7 +506,7 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 	// They've got to be the same size, at the least!
 	// unless there are globs in the pattern
 	if (osg.size() != arity and not has_glob)
-		return _pmc.fuzzy_match(ptm->getHandle(), hg);
+		return _pmc->fuzzy_match(ptm->getHandle(), hg);
 
 	// Test for case A, described above.
 	OC_ASSERT (not (take_step and have_more),
@@ -580,14 +580,14 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 		{
 			// If we've found a grounding, lets see if the
 			// post-match callback likes this grounding.
-			match = _pmc.post_link_match(hp, hg);
+			match = _pmc->post_link_match(hp, hg);
 			if (match)
 			{
 				// Even the stack, *without* erasing the discovered grounding.
 				solution_drop();
 
 				// If the grounding is accepted, record it.
-				if (hp != hg) var_grounding[hp] = hg;
+				if (hp != hg) var_grounding.set(hp, hg);
 
 				// Handle case 5&7 of description above.
 				have_more = true;
@@ -595,13 +595,13 @@ bool PatternMatchEngine::unorder_compare(const PatternTermPtr& ptm,
 				              << perm_count[Unorder(ptm, hg)]
 				              << " for term=" << ptm->to_string()
 				              << " have_more=" << have_more;})
-				_perm_state[Unorder(ptm, hg)] = mutation;
+				_perm_state.set(Unorder(ptm, hg), mutation);
 				return true;
 			}
 		}
 		else
 		{
-			_pmc.post_link_mismatch(hp, hg);
+			_pmc->post_link_mismatch(hp, hg);
 		}
 		// If we are here, we are handling case 8.
 		DO_LOG({LAZY_LOG_FINE << "Above permuation " << perm_count[Unorder(ptm, hg)]
@@ -666,14 +666,14 @@ bool PatternMatchEngine::have_perm(const PatternTermPtr& ptm,
 
 void PatternMatchEngine::perm_push(void)
 {
-	perm_stack.push(_perm_state);
+	_perm_state.push();
 	if (logger().is_fine_enabled())
 		perm_count_stack.push(perm_count);
 }
 
 void PatternMatchEngine::perm_pop(void)
 {
-	POPSTK(perm_stack, _perm_state);
+	_perm_state.pop();
 	if (logger().is_fine_enabled())
 		POPSTK(perm_count_stack, perm_count);
 }
@@ -740,7 +740,7 @@ bool PatternMatchEngine::glob_compare(const PatternTermSeq& osp,
 		_glob_state[gp] = {glob_grd, glob_pos_stack};
 
 		Handle glp(createLink(glob_seq, LIST_LINK));
-		var_grounding[glob->getHandle()] = glp;
+		var_grounding.set(glob->getHandle(), glp);
 
 		DO_LOG({LAZY_LOG_FINE << "Found grounding of glob:";})
 		logmsg("$$ glob:", glob->getHandle());
@@ -1058,7 +1058,7 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 
 		// Report other variables that might be found.
 		if (VARIABLE_NODE == tp)
-			return _pmc.scope_match(hp, hg);
+			return _pmc->scope_match(hp, hg);
 	}
 
 	// If they're the same atom, then clearly they match.
@@ -1078,10 +1078,10 @@ bool PatternMatchEngine::tree_compare(const PatternTermPtr& ptm,
 		return node_compare(hp, hg);
 
 	// If they're not both links, then it is clearly a mismatch.
-	if (not (hp->is_link() and hg->is_link())) return _pmc.fuzzy_match(hp, hg);
+	if (not (hp->is_link() and hg->is_link())) return _pmc->fuzzy_match(hp, hg);
 
 	// Let the callback perform basic checking.
-	bool match = _pmc.link_match(ptm, hg);
+	bool match = _pmc->link_match(ptm, hg);
 	if (not match) return false;
 
 	DO_LOG({LAZY_LOG_FINE << "depth=" << depth;})
@@ -1196,7 +1196,7 @@ bool PatternMatchEngine::explore_up_branches(const PatternTermPtr& ptm,
                                              const Handle& clause_root)
 {
 	// Move up the solution graph, looking for a match.
-	IncomingSet iset = _pmc.get_incoming_set(hg);
+	IncomingSet iset = _pmc->get_incoming_set(hg);
 	size_t sz = iset.size();
 	DO_LOG({LAZY_LOG_FINE << "Looking upward for term=" << ptm->to_string()
 	              << " have " << sz << " branches";})
@@ -1318,9 +1318,9 @@ bool PatternMatchEngine::explore_choice_branches(const PatternTermPtr& ptm,
 		// should resemble the perm_push() used for unordered links.
 		// However, currently, no test case trips this up. so .. OK.
 		// Whatever. This still probably needs fixing.
-		if (_need_choice_push) choice_stack.push(_choice_state);
+		if (_need_choice_push) _choice_state.push();
 		bool match = explore_single_branch(ptm, hg, clause_root);
-		if (_need_choice_push) POPSTK(choice_stack, _choice_state);
+		if (_need_choice_push) _choice_state.pop();
 		_need_choice_push = false;
 
 		// If the pattern was satisfied, then we are done for good.
@@ -1358,6 +1358,11 @@ bool PatternMatchEngine::explore_single_branch(const PatternTermPtr& ptm,
                                                const Handle& hg,
                                                const Handle& clause_root)
 {
+	// Every branch of the search passes through here, so this is
+	// where the budget is counted. Once it is used up, halt, just as
+	// if a grounding had been accepted.
+	if (_budget and _budget->step()) return true;
+
 	solution_push();
 
 	DO_LOG({LAZY_LOG_FINE << "Checking pattern term=" << ptm->to_string()
@@ -1497,7 +1502,7 @@ bool PatternMatchEngine::do_term_up(const PatternTermPtr& ptm,
 			// the evaluation for the callback.
 // XXX TODO count the number of ungrounded vars !!! (make sure its zero)
 
-			bool found = _pmc.evaluate_sentence(clause_root, var_grounding);
+			bool found = _pmc->evaluate_sentence(clause_root, var_grounding);
 			DO_LOG({logger().fine("After evaluating clause, found = %d", found);})
 			if (found)
 				return clause_accept(clause_root, hg);
@@ -1560,19 +1565,19 @@ bool PatternMatchEngine::clause_accept(const Handle& clause_root,
 	if (is_optional(clause_root))
 	{
 		clause_accepted = true;
-		match = _pmc.optional_clause_match(clause_root, hg, var_grounding);
+		match = _pmc->optional_clause_match(clause_root, hg, var_grounding);
 		DO_LOG({logger().fine("optional clause match callback match=%d", match);})
 	}
 	else
 	{
-		match = _pmc.clause_match(clause_root, hg, var_grounding);
+		match = _pmc->clause_match(clause_root, hg, var_grounding);
 		DO_LOG({logger().fine("clause match callback match=%d", match);})
 	}
 	if (not match) return false;
 
 	if (not is_evaluatable(clause_root))
 	{
-		clause_grounding[clause_root] = hg;
+		clause_grounding.set(clause_root, hg);
 		logmsg("---------------------\nclause:", clause_root);
 		logmsg("ground:", hg);
 	}
@@ -1595,7 +1600,7 @@ bool PatternMatchEngine::do_next_clause(void)
 	bool found = false;
 	if (nullptr == curr_root)
 	{
-		found = _pmc.grounding(var_grounding, clause_grounding);
+		found = _pmc->grounding(var_grounding, clause_grounding);
 		DO_LOG(logger().fine("==================== FINITO! accepted=%d", found);)
 		DO_LOG(log_solution(var_grounding, clause_grounding);)
 
@@ -1615,7 +1620,7 @@ bool PatternMatchEngine::do_next_clause(void)
 		              << (is_evaluatable(curr_root)?
 		                  "dynamically evaluatable" : "non-dynamic");
 		logmsg("Joining variable is", joiner);
-		logmsg("Joining grounding is", var_grounding[joiner]); })
+		logmsg("Joining grounding is", var_grounding.get(joiner)); })
 
 		// Else, start solving the next unsolved clause. Note: this is
 		// a recursive call, and not a loop. Recursion is halted when
@@ -1627,7 +1632,7 @@ bool PatternMatchEngine::do_next_clause(void)
 		// else the join is a 'real' atom.
 
 		clause_accepted = false;
-		Handle hgnd(var_grounding[joiner]);
+		Handle hgnd(var_grounding.get(joiner));
 		OC_ASSERT(nullptr != hgnd, "Error: joining handle has not been grounded yet!");
 		found = explore_clause(joiner, hgnd, curr_root);
 
@@ -1647,7 +1652,7 @@ bool PatternMatchEngine::do_next_clause(void)
 		       (is_optional(curr_root)))
 		{
 			Handle undef(Handle::UNDEFINED);
-			bool match = _pmc.optional_clause_match(joiner, undef, var_grounding);
+			bool match = _pmc->optional_clause_match(joiner, undef, var_grounding);
 			DO_LOG({logger().fine("Exhausted search for optional clause, cb=%d", match);})
 			if (not match) {
 				clause_stacks_pop();
@@ -1655,7 +1660,7 @@ bool PatternMatchEngine::do_next_clause(void)
 			}
 
 			// XXX Maybe should push n pop here? No, maybe not ...
-			clause_grounding[curr_root] = Handle::UNDEFINED;
+			clause_grounding.set(curr_root, Handle::UNDEFINED);
 			get_next_untried_clause();
 			joiner = next_joint;
 			curr_root = next_clause;
@@ -1665,7 +1670,7 @@ bool PatternMatchEngine::do_next_clause(void)
 			{
 				DO_LOG({logger().fine("==================== FINITO BANDITO!");
 				log_solution(var_grounding, clause_grounding);})
-				found = _pmc.grounding(var_grounding, clause_grounding);
+				found = _pmc->grounding(var_grounding, clause_grounding);
 			}
 			else
 			{
@@ -1673,7 +1678,7 @@ bool PatternMatchEngine::do_next_clause(void)
 				// or not. If it does, we'll recurse. If it does not,
 				// we'll loop around back to here again.
 				clause_accepted = false;
-				Handle hgnd = var_grounding[joiner];
+				Handle hgnd = var_grounding.get(joiner);
 				found = explore_term_branches(joiner, hgnd, curr_root);
 			}
 		}
@@ -1795,6 +1800,16 @@ unsigned int PatternMatchEngine::thickness(const Handle& clause,
 	return count;
 }
 
+/// The planner's estimate of the number of groundings of the clause,
+/// or zero, if there is none.
+double PatternMatchEngine::clause_cost(const Handle& clause)
+{
+	if (nullptr == _clause_costs) return 0.0;
+	auto it = _clause_costs->find(clause);
+	if (_clause_costs->end() == it) return 0.0;
+	return it->second;
+}
+
 /// Same as above, but with three boolean flags:  if not set, then only
 /// those clauses satsifying the criterion are considered, else all
 /// clauses are considered.
@@ -1813,6 +1828,7 @@ bool PatternMatchEngine::get_next_thinnest_clause(bool search_virtual,
 	Handle unsolved_clause(Handle::UNDEFINED);
 	unsigned int thinnest_joint = UINT_MAX;
 	unsigned int thinnest_clause = UINT_MAX;
+	double cheapest = 0.0;
 	bool unsolved = false;
 
 	// Make a list of the as-yet ungrounded variables.
@@ -1839,6 +1855,11 @@ bool PatternMatchEngine::get_next_thinnest_clause(bool search_virtual,
 	// with smallest size of its incoming set. If there are many such
 	// atoms we choose one from clauses with minimal number of ungrounded
 	// yet variables.
+	//
+	// The query planner's cost estimates only break the remaining
+	// ties; they never override the two rules above. Those rules look
+	// at the actual groundings found so far, which is better
+	// information than estimates made before the search began.
 	for (auto tckvar : thick_vars)
 	{
 		std::size_t pursue_thickness = tckvar.first;
@@ -1857,9 +1878,13 @@ bool PatternMatchEngine::get_next_thinnest_clause(bool search_virtual,
 			        and (search_optionals or not is_optional(root)))
 			{
 				unsigned int root_thickness = thickness(root, ungrounded_vars);
-				if (root_thickness < thinnest_clause)
+				double cost = clause_cost(root);
+				if (root_thickness < thinnest_clause or
+				    (root_thickness == thinnest_clause and
+				     pursue_thickness == thinnest_joint and cost < cheapest))
 				{
 					thinnest_clause = root_thickness;
+					cheapest = cost;
 					thinnest_joint = pursue_thickness;
 					unsolved_clause = root;
 					joint = pursue;
@@ -1909,15 +1934,15 @@ void PatternMatchEngine::clause_stacks_push(void)
 	DO_LOG({logger().fine("--- That's it, now push to stack depth=%d",
 	              _clause_stack_depth);})
 
-	var_solutn_stack.push(var_grounding);
-	term_solutn_stack.push(clause_grounding);
+	var_grounding.push();
+	clause_grounding.push();
 
 	issued_stack.push(issued);
-	choice_stack.push(_choice_state);
+	_choice_state.push();
 
 	perm_push();
 
-	_pmc.push();
+	_pmc->push();
 }
 
 /**
@@ -1928,14 +1953,14 @@ void PatternMatchEngine::clause_stacks_push(void)
  */
 void PatternMatchEngine::clause_stacks_pop(void)
 {
-	_pmc.pop();
+	_pmc->pop();
 
 	// The grounding stacks are handled differently.
-	POPSTK(term_solutn_stack, clause_grounding);
-	POPSTK(var_solutn_stack, var_grounding);
+	clause_grounding.pop();
+	var_grounding.pop();
 	POPSTK(issued_stack, issued);
 
-	POPSTK(choice_stack, _choice_state);
+	_choice_state.pop();
 
 	perm_pop();
 
@@ -1955,36 +1980,36 @@ void PatternMatchEngine::clause_stacks_clear(void)
 {
 	_clause_stack_depth = 0;
 #if 0
-	OC_ASSERT(0 == term_solutn_stack.size());
-	OC_ASSERT(0 == var_solutn_stack.size());
+	OC_ASSERT(0 == clause_grounding.depth());
+	OC_ASSERT(0 == var_grounding.depth());
 	OC_ASSERT(0 == issued_stack.size());
-	OC_ASSERT(0 == choice_stack.size());
-	OC_ASSERT(0 == perm_stack.size());
+	OC_ASSERT(0 == _choice_state.depth());
+	OC_ASSERT(0 == _perm_state.depth());
 #else
-	while (!term_solutn_stack.empty()) term_solutn_stack.pop();
-	while (!var_solutn_stack.empty()) var_solutn_stack.pop();
+	clause_grounding.forget();
+	var_grounding.forget();
 	while (!issued_stack.empty()) issued_stack.pop();
-	while (!choice_stack.empty()) choice_stack.pop();
-	while (!perm_stack.empty()) perm_stack.pop();
+	_choice_state.forget();
+	_perm_state.forget();
 #endif
 }
 
 void PatternMatchEngine::solution_push(void)
 {
-	var_solutn_stack.push(var_grounding);
-	term_solutn_stack.push(clause_grounding);
+	var_grounding.push();
+	clause_grounding.push();
 }
 
 void PatternMatchEngine::solution_pop(void)
 {
-	POPSTK(var_solutn_stack, var_grounding);
-	POPSTK(term_solutn_stack, clause_grounding);
+	var_grounding.pop();
+	clause_grounding.pop();
 }
 
 void PatternMatchEngine::solution_drop(void)
 {
-	var_solutn_stack.pop();
-	term_solutn_stack.pop();
+	var_grounding.drop();
+	clause_grounding.drop();
 }
 
 /* ======================================================== */
@@ -2008,7 +2033,9 @@ void PatternMatchEngine::solution_drop(void)
  *            "starter" link, it must be a node, and it must not be
  *            a variable node.
  *
- * Returns true if one (or more) matches are found
+ * Returns true if one (or more) matches are found, or if the search
+ * budget (see SearchBudget.h) has run out; either way, the caller
+ * should stop looking at further candidates.
  *
  * This routine is meant to be invoked on every candidate atom taken
  * from the atom space. That atom is assumed to anchor some part of
@@ -2018,6 +2045,9 @@ bool PatternMatchEngine::explore_neighborhood(const Handle& do_clause,
                                               const Handle& term,
                                               const Handle& grnd)
 {
+	// Halt the caller's loop over the candidates, too.
+	if (_budget and _budget->exhausted()) return true;
+
 	clause_stacks_clear();
 	return explore_redex(term, grnd, do_clause);
 }
@@ -2080,7 +2110,7 @@ bool PatternMatchEngine::explore_clause(const Handle& term,
 
 	// If we are here, we have an evaluatable clause on our hands.
 	DO_LOG({logger().fine("Clause is evaluatable; start evaluating it");})
-	bool found = _pmc.evaluate_sentence(clause, var_grounding);
+	bool found = _pmc->evaluate_sentence(clause, var_grounding);
 	DO_LOG({logger().fine("Post evaluating clause, found = %d", found);})
 	if (found)
 		return clause_accept(clause, grnd);
@@ -2118,25 +2148,28 @@ bool PatternMatchEngine::explore_constant_evaluatables(const HandleSeq& clauses)
 	bool found = true;
 	for (const Handle& clause : clauses) {
 		if (is_in(clause, _pat->evaluatable_holders)) {
-			found = _pmc.evaluate_sentence(clause, HandleMap());
+			found = _pmc->evaluate_sentence(clause, HandleMap());
 			if (not found)
 				break;
 		}
 	}
 	if (found)
-		_pmc.grounding(HandleMap(), HandleMap());
+		_pmc->grounding(HandleMap(), HandleMap());
 
 	return found;
 }
 
 PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb)
-	: _pmc(pmcb),
+	: _pmc(&pmcb),
 	_classserver(classserver()),
+	_budget(NULL),
 	_varlist(NULL),
-	_pat(NULL)
+	_pat(NULL),
+	_clause_costs(NULL)
 {
 	// current state
 	depth = 0;
+	clause_accepted = false;
 
 	// graph state
 	_clause_stack_depth = 0;
@@ -2150,11 +2183,45 @@ PatternMatchEngine::PatternMatchEngine(PatternMatchCallback& pmcb)
 	take_step = true;
 }
 
+/**
+ * Get ready for a new search, reporting to pmcb. The stacks are
+ * emptied, but they keep the memory they already have, so that an
+ * engine that is reset is cheaper than a new one.
+ */
+void PatternMatchEngine::reset(PatternMatchCallback& pmcb)
+{
+	clear();
+	_pmc = &pmcb;
+}
+
+/// Drop all search state, and with it, the atoms it refers to.
+void PatternMatchEngine::clear(void)
+{
+	_varlist = NULL;
+	_pat = NULL;
+	_clause_costs = NULL;
+	_budget = NULL;
+
+	while (!_stack_variables.empty()) _stack_variables.pop();
+	while (!_stack_pattern.empty()) _stack_pattern.pop();
+	while (!perm_count_stack.empty()) perm_count_stack.pop();
+	perm_count.clear();
+	_glob_state.clear();
+
+	clause_stacks_clear();
+	clear_current_state();
+
+	next_clause = Handle::UNDEFINED;
+	next_joint = Handle::UNDEFINED;
+	clause_accepted = false;
+}
+
 void PatternMatchEngine::set_pattern(const Variables& v,
                                      const Pattern& p)
 {
 	_varlist = &v;
 	_pat = &p;
+	_budget = _pmc->get_budget();
 }
 
 /* ======================================================== */
@@ -2236,4 +2303,61 @@ void PatternMatchEngine::log_term(const HandleSet &vars,
                                   const HandleSeq &clauses) {}
 #endif
 
+/* ======================================================== */
+
+// Enough for searches nested a few deep; any more are deleted.
+#define MAX_POOLED_ENGINES 4
+
+namespace {
+
+struct EnginePool
+{
+	std::vector<PatternMatchEngine*> idle;
+	~EnginePool();
+};
+
+// Set once this thread's pool has been destroyed; engines given back
+// after that (e.g. by other thread_local destructors) are deleted.
+static thread_local bool engine_pool_gone = false;
+static thread_local EnginePool engine_pool;
+
+EnginePool::~EnginePool()
+{
+	engine_pool_gone = true;
+	for (PatternMatchEngine* pme : idle) delete pme;
+}
+
+} // anonymous namespace
+
+PooledEngine::PooledEngine(PatternMatchCallback& pmcb)
+{
+	if (engine_pool_gone or engine_pool.idle.empty())
+	{
+		_pme = new PatternMatchEngine(pmcb);
+		return;
+	}
+	_pme = engine_pool.idle.back();
+	engine_pool.idle.pop_back();
+	_pme->reset(pmcb);
+}
+
+PooledEngine::~PooledEngine()
+{
+	if (engine_pool_gone or MAX_POOLED_ENGINES <= engine_pool.idle.size())
+	{
+		delete _pme;
+		return;
+	}
+
+	// Idle engines should not keep atoms alive.
+	_pme->clear();
+	engine_pool.idle.push_back(_pme);
+}
+
+size_t PooledEngine::idle(void)
+{
+	if (engine_pool_gone) return 0;
+	return engine_pool.idle.size();
+}
+
 /* ===================== END OF FILE ===================== */
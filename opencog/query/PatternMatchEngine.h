@@ -33,6 +33,8 @@
 #include <opencog/atoms/base/ClassServer.h>
 #include <opencog/atoms/pattern/Pattern.h>
 #include <opencog/query/PatternMatchCallback.h>
+#include <opencog/query/SearchBudget.h>
+#include <opencog/query/TrailMap.h>
 
 namespace opencog {
 
@@ -40,11 +42,18 @@ class PatternMatchEngine
 {
 	// -------------------------------------------
 	// Callback to whom the results are reported.
-	PatternMatchCallback &_pmc;
+	PatternMatchCallback* _pmc;
 	ClassServer& _classserver;
 
+	// Limits on the search, from the callback; may be null.
+	SearchBudget* _budget;
+
 	// Private, locally scoped typedefs, not used outside of this class.
 
+	// Vectors, unlike the default deques, keep their memory when
+	// popped; see reset().
+	template<typename T> using Stack = std::stack<T, std::vector<T>>;
+
 private:
 	// -------------------------------------------
 	// The current set of clauses (redex context) being grounded.
@@ -73,8 +82,8 @@ private:
 	// -------------------------------------------
 	// Recursive redex support. These are stacks of the clauses
 	// above, that are being searched.
-	std::stack<const Variables*>  _stack_variables;
-	std::stack<const Pattern*>    _stack_pattern;
+	Stack<const Variables*>  _stack_variables;
+	Stack<const Pattern*>    _stack_pattern;
 
 	void push_redex(void);
 	void pop_redex(void);
@@ -89,16 +98,16 @@ private:
 	// Map of current groundings of variables to their grounds
 	// Also contains grounds of subclauses (not sure why, this seems
 	// to be needed)
-	HandleMap var_grounding;
+	TrailMap<Handle, Handle> var_grounding;
 	// Map of clauses to their current groundings
-	HandleMap clause_grounding;
+	TrailMap<Handle, Handle> clause_grounding;
 
 	void clear_current_state(void);  // clear the stuff above
 
 	// -------------------------------------------
 	// ChoiceLink state management
 	typedef std::pair<PatternTermPtr, Handle> GndChoice;
-	typedef std::map<GndChoice, size_t> ChoiceState;
+	typedef TrailMap<GndChoice, size_t> ChoiceState;
 
 	ChoiceState _choice_state;
 	bool _need_choice_push;
@@ -114,7 +123,7 @@ private:
 	// Unordered Link suppoprt
 	typedef std::pair<PatternTermPtr, Handle> Unorder; // Choice
 	typedef PatternTermSeq Permutation;
-	typedef std::map<Unorder, Permutation> PermState; // ChoiceState
+	typedef TrailMap<Unorder, Permutation> PermState; // ChoiceState
 
 	PermState _perm_state;
 	Permutation curr_perm(const PatternTermPtr&, const Handle&, bool&);
@@ -125,7 +134,7 @@ private:
 	bool take_step;
 	bool have_more;
 	std::map<Unorder, int> perm_count;
-	std::stack<std::map<Unorder, int>> perm_count_stack;
+	Stack<std::map<Unorder, int>> perm_count_stack;
 
 	// --------------------------------------------
 	// Glob state management
@@ -135,7 +144,7 @@ private:
 
 	// Record where the globs are (branchpoints)
 	typedef std::pair<PatternTermPtr, std::pair<size_t, size_t>> GlobPos;
-	typedef std::stack<GlobPos> GlobPosStack;
+	typedef Stack<GlobPos> GlobPosStack;
 
 	// Record how many atoms have been grounded to the globs
 	typedef std::map<PatternTermPtr, size_t> GlobGrd;
@@ -151,6 +160,8 @@ private:
 	void get_next_untried_clause(void);
 	bool get_next_thinnest_clause(bool, bool, bool);
 	unsigned int thickness(const Handle&, const HandleSet&);
+	const std::unordered_map<Handle, double>* _clause_costs;
+	double clause_cost(const Handle&);
 	Handle next_clause;
 	Handle next_joint;
 	// Set of clauses for which a grounding is currently being attempted.
@@ -158,24 +169,19 @@ private:
 	IssuedSet issued;     // stacked on issued_stack
 
 	// -------------------------------------------
-	// Stack used to store current traversal state for a single
+	// Save and restore the current traversal state for a single
 	// clause. These are pushed when a clause is fully grounded,
 	// and a new clause is about to be started. These are popped
 	// in order to get back to the original clause, and resume
 	// traversal of that clause, where it was last left off.
+	// The groundings, choices and permutations are TrailMaps, so
+	// only what changed since the push is undone by the pop.
 	void solution_push(void);
 	void solution_pop(void);
 	void solution_drop(void);
 
-	// Stacks containing partial groundings.
-	typedef HandleMap SolnMap;
-	std::stack<SolnMap> var_solutn_stack;
-	std::stack<SolnMap> term_solutn_stack;
+	Stack<IssuedSet> issued_stack;
 
-	std::stack<IssuedSet> issued_stack;
-	std::stack<ChoiceState> choice_stack;
-
-	std::stack<PermState> perm_stack;
 	void perm_push(void);
 	void perm_pop(void);
 
@@ -230,8 +236,20 @@ private:
 
 public:
 	PatternMatchEngine(PatternMatchCallback&);
+	void reset(PatternMatchCallback&);
+	void clear(void);
 	void set_pattern(const Variables&, const Pattern&);
 
+	// The callback that groundings are reported to.
+	PatternMatchCallback& get_callback(void) { return *_pmc; }
+
+	// Estimated number of groundings of each clause. Clauses that
+	// are otherwise equally good are grounded cheapest-first.
+	void set_clause_costs(const std::unordered_map<Handle, double>* c)
+	{ _clause_costs = c; }
+	const std::unordered_map<Handle, double>* get_clause_costs(void) const
+	{ return _clause_costs; }
+
 	// Examine the locally connected neighborhood for possible
 	// matches.
 	bool explore_neighborhood(const Handle&, const Handle&, const Handle&);
@@ -249,6 +267,32 @@ public:
 	                     const HandleSeq &clauses);
 };
 
+/**
+ * An engine taken from a small pool kept by each thread, and given
+ * back when this goes out of scope. Pooled engines are reset, rather
+ * than built anew, so that many small searches do not spend their
+ * time allocating stacks. Searches may nest (e.g. when a clause is
+ * evaluated by running another query), so a thread can have several
+ * engines out at once.
+ */
+class PooledEngine
+{
+	PatternMatchEngine* _pme;
+
+public:
+	PooledEngine(PatternMatchCallback&);
+	~PooledEngine();
+	PooledEngine(const PooledEngine&) = delete;
+	PooledEngine& operator=(const PooledEngine&) = delete;
+
+	PatternMatchEngine* get(void) { return _pme; }
+	PatternMatchEngine* operator->(void) { return _pme; }
+	PatternMatchEngine& operator*(void) { return *_pme; }
+
+	// The number of idle engines held by the calling thread.
+	static size_t idle(void);
+};
+
 } // namespace opencog
 
 #endif // _OPENCOG_PATTERN_MATCH_ENGINE_H
@@ -7,8 +7,14 @@
 
 #ifdef HAVE_GUILE
 
+#include <map>
+#include <mutex>
+
 #include <opencog/guile/SchemeModule.h>
 #include <opencog/atoms/pattern/PatternLink.h>
+#include <opencog/query/QueryPlanner.h>
+#include <opencog/query/ResultStream.h>
+#include <opencog/query/StandingQuery.h>
 
 namespace opencog {
 
@@ -21,6 +27,31 @@ class PatternSCM : public ModuleWrap
 		bool value_is_type(Handle, Handle);
 		bool type_match(Handle, Handle);
 		Handle type_compose(Handle, Handle);
+		Handle parallel_bind(Handle, size_t);
+		Handle parallel_satisfying_set(Handle, size_t);
+		SCM bounded_bind(Handle, double, size_t);
+		SCM bounded_satisfying_set(Handle, double, size_t);
+
+		// Open result streams, by number. Only so many are kept;
+		// each holds a thread and its pattern.
+		static const size_t MAX_OPEN_STREAMS = 256;
+		std::mutex _stream_mtx;
+		std::map<size_t, ResultStreamPtr> _streams;
+		size_t _next_stream;
+		size_t stream_open(Handle);
+		Handle stream_next(size_t);
+		void stream_close(size_t);
+		std::string explain(Handle);
+
+		// Registered standing queries, by number.
+		std::mutex _standing_mtx;
+		std::map<size_t, StandingQueryPtr> _standing;
+		size_t _next_standing;
+		StandingQueryPtr get_standing(size_t);
+		size_t standing_open(Handle);
+		HandleSeq standing_results(size_t);
+		HandleSeqSeq standing_changes(size_t);
+		void standing_stop(size_t);
 	public:
 		PatternSCM(void);
 		~PatternSCM();
@@ -37,6 +68,7 @@ class PatternSCM : public ModuleWrap
 
 #include "BindLinkAPI.h"
 #include "PatternMatch.h"
+#include "SearchBudget.h"
 
 using namespace opencog;
 
@@ -69,6 +101,162 @@ Handle PatternSCM::type_compose(Handle left, Handle right)
 	return opencog::type_compose(left, right);
 }
 
+Handle PatternSCM::parallel_bind(Handle hlink, size_t nthreads)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-bind-parallel");
+	return bindlink(as, hlink, SIZE_MAX, nthreads);
+}
+
+Handle PatternSCM::parallel_satisfying_set(Handle hlink, size_t nthreads)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-satisfying-set-parallel");
+	return satisfying_set(as, hlink, SIZE_MAX, nthreads);
+}
+
+/// A budget of `secs` seconds and `steps` steps; zero means no limit.
+static void set_limits(SearchBudget& budget, double secs, size_t steps)
+{
+	using namespace std::chrono;
+	if (0.0 < secs)
+		budget.set_timeout(duration_cast<SearchBudget::Clock::duration>(
+			duration<double>(secs)));
+	if (0 < steps)
+		budget.set_max_steps(steps);
+}
+
+/// A pair: the results, and a symbol saying whether they are complete.
+static SCM bounded_result(const Handle& h, const SearchBudget& budget)
+{
+	return scm_cons(SchemeSmob::handle_to_scm(h),
+		scm_from_utf8_symbol(SearchBudget::status_name(budget.get_status())));
+}
+
+SCM PatternSCM::bounded_bind(Handle hlink, double secs, size_t steps)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-bind-bounded");
+	SearchBudget budget;
+	set_limits(budget, secs, steps);
+	Handle h(bindlink(as, hlink, budget));
+	return bounded_result(h, budget);
+}
+
+SCM PatternSCM::bounded_satisfying_set(Handle hlink, double secs, size_t steps)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-satisfying-set-bounded");
+	SearchBudget budget;
+	set_limits(budget, secs, steps);
+	Handle h(satisfying_set(as, hlink, budget));
+	return bounded_result(h, budget);
+}
+
+size_t PatternSCM::stream_open(Handle hlink)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-stream-open");
+	ResultStreamPtr rs(std::make_shared<ResultStream>(as, hlink));
+
+	// Streams that were never closed would pile up; close the
+	// oldest one. It is closed outside of the lock.
+	ResultStreamPtr oldest;
+	size_t id;
+	{
+		std::lock_guard<std::mutex> lck(_stream_mtx);
+		if (MAX_OPEN_STREAMS <= _streams.size())
+		{
+			oldest = _streams.begin()->second;
+			_streams.erase(_streams.begin());
+		}
+		id = ++_next_stream;
+		_streams[id] = rs;
+	}
+	if (oldest) oldest->close();
+	return id;
+}
+
+/// Return the next result, or the empty list at the end. A stream
+/// that has run dry is forgotten.
+Handle PatternSCM::stream_next(size_t id)
+{
+	ResultStreamPtr rs;
+	{
+		std::lock_guard<std::mutex> lck(_stream_mtx);
+		auto it = _streams.find(id);
+		if (_streams.end() == it) return Handle::UNDEFINED;
+		rs = it->second;
+	}
+
+	// Do not hold the lock while waiting on the search.
+	Handle h(rs->next());
+	if (nullptr == h) stream_close(id);
+	return h;
+}
+
+void PatternSCM::stream_close(size_t id)
+{
+	ResultStreamPtr rs;
+	{
+		std::lock_guard<std::mutex> lck(_stream_mtx);
+		auto it = _streams.find(id);
+		if (_streams.end() == it) return;
+		rs = it->second;
+		_streams.erase(it);
+	}
+	rs->close();
+}
+
+std::string PatternSCM::explain(Handle hlink)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-explain");
+	return explain_query(as, hlink);
+}
+
+size_t PatternSCM::standing_open(Handle hlink)
+{
+	AtomSpace *as = SchemeSmob::ss_get_env_as("cog-standing-query");
+	StandingQueryPtr sq(StandingQuery::create(as, hlink));
+
+	std::lock_guard<std::mutex> lck(_standing_mtx);
+	_standing[++_next_standing] = sq;
+	return _next_standing;
+}
+
+StandingQueryPtr PatternSCM::get_standing(size_t id)
+{
+	std::lock_guard<std::mutex> lck(_standing_mtx);
+	auto it = _standing.find(id);
+	if (_standing.end() == it) return nullptr;
+	return it->second;
+}
+
+HandleSeq PatternSCM::standing_results(size_t id)
+{
+	StandingQueryPtr sq(get_standing(id));
+	if (nullptr == sq) return HandleSeq();
+	return sq->get_results();
+}
+
+/// A list of two lists: the results added, and those removed, since
+/// the last call.
+HandleSeqSeq PatternSCM::standing_changes(size_t id)
+{
+	HandleSeqSeq chg(2);
+	StandingQueryPtr sq(get_standing(id));
+	if (sq) sq->take_changes(chg[0], chg[1]);
+	return chg;
+}
+
+void PatternSCM::standing_stop(size_t id)
+{
+	StandingQueryPtr sq;
+	{
+		std::lock_guard<std::mutex> lck(_standing_mtx);
+		auto it = _standing.find(id);
+		if (_standing.end() == it) return;
+		sq = it->second;
+		_standing.erase(it);
+	}
+	sq->stop();
+}
+
 // ========================================================
 
 // XXX HACK ALERT This needs to be static, in order for python to
@@ -79,7 +267,9 @@ Handle PatternSCM::type_compose(Handle left, Handle right)
 std::vector<FunctionWrap*> PatternSCM::_binders;
 
 PatternSCM::PatternSCM(void) :
-	ModuleWrap("opencog query")
+	ModuleWrap("opencog query"),
+	_next_stream(0),
+	_next_standing(0)
 {}
 
 static TruthValuePtr do_satlink(AtomSpace* as, const Handle& hlink)
@@ -91,6 +281,18 @@ static TruthValuePtr do_satlink(AtomSpace* as, const Handle& hlink)
 	return satisfaction_link(as, plp);
 }
 
+// The FunctionWrap needs exactly this signature; the C++ API
+// has an extra, defaulted thread-count argument.
+static Handle do_bindlink(AtomSpace* as, const Handle& hlink, size_t n)
+{
+	return bindlink(as, hlink, n);
+}
+
+static Handle do_satisfying_set(AtomSpace* as, const Handle& hlink, size_t n)
+{
+	return satisfying_set(as, hlink, n);
+}
+
 /// This is called while (opencog query) is the current module.
 /// Thus, all the definitions below happen in that module.
 void PatternSCM::init(void)
@@ -98,7 +300,7 @@ void PatternSCM::init(void)
 	// Run implication, assuming that the first argument is a handle to a
 	// BindLink containing variables, a pattern and a rewrite rules.
 	// Returns the first N matches, assuming that N is the second argument.
-	_binders.push_back(new FunctionWrap(bindlink,
+	_binders.push_back(new FunctionWrap(do_bindlink,
 	                   "cog-bind-first-n", "query"));
 
 	// Attentional Focus function
@@ -112,13 +314,58 @@ void PatternSCM::init(void)
 	// Finds set of all variable groundings, assuming that the first
 	// argument is a handle to pattern. Returns the first N matches,
 	// assuming that N is the second argument.
-	_binders.push_back(new FunctionWrap(satisfying_set,
+	_binders.push_back(new FunctionWrap(do_satisfying_set,
 	                   "cog-satisfying-set-first-n", "query"));
 
 	// Rule recognition.
 	_binders.push_back(new FunctionWrap(recognize,
 	                   "cog-recognize", "query"));
 
+	// Same as cog-bind and cog-satisfying-set, but the search is
+	// split over N threads, N being the second argument.
+	define_scheme_primitive("cog-bind-parallel",
+		&PatternSCM::parallel_bind, this, "query");
+
+	define_scheme_primitive("cog-satisfying-set-parallel",
+		&PatternSCM::parallel_satisfying_set, this, "query");
+
+	// Same as cog-bind and cog-satisfying-set, but the search gives
+	// up after some seconds or some steps.
+	define_scheme_primitive("cog-bind-bounded",
+		&PatternSCM::bounded_bind, this, "query");
+
+	define_scheme_primitive("cog-satisfying-set-bounded",
+		&PatternSCM::bounded_satisfying_set, this, "query");
+
+	// Results of a BindLink or GetLink, one at a time. The
+	// cog-stream wrapper in query.scm is the nicer interface.
+	define_scheme_primitive("cog-stream-open",
+		&PatternSCM::stream_open, this, "query");
+
+	define_scheme_primitive("cog-stream-next",
+		&PatternSCM::stream_next, this, "query");
+
+	define_scheme_primitive("cog-stream-close",
+		&PatternSCM::stream_close, this, "query");
+
+	// BindLinks and GetLinks whose results are kept up to date as
+	// the atomspace changes.
+	define_scheme_primitive("cog-standing-query",
+		&PatternSCM::standing_open, this, "query");
+
+	define_scheme_primitive("cog-standing-results",
+		&PatternSCM::standing_results, this, "query");
+
+	define_scheme_primitive("cog-standing-changes",
+		&PatternSCM::standing_changes, this, "query");
+
+	define_scheme_primitive("cog-standing-stop",
+		&PatternSCM::standing_stop, this, "query");
+
+	// How the search for a BindLink or GetLink would be started.
+	define_scheme_primitive("cog-explain",
+		&PatternSCM::explain, this, "query");
+
 	// Fuzzy matching. XXX FIXME. This is not technically
 	// a query functon, and should probably be in some other
 	// module, maybe some utilities module?
@@ -0,0 +1,341 @@
+/*
+ * QueryPlanner.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <sstream>
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/core/Quotation.h>
+#include <opencog/atoms/pattern/PatternLink.h>
+
+#include "QueryPlanner.h"
+
+using namespace opencog;
+
+// No more than this many links are followed up, at each level, from
+// each sampled candidate; hubs would otherwise make sampling costly.
+#define MAX_WALK 64
+
+std::atomic<bool> QueryPlanner::_enabled(true);
+
+QueryPlanner::QueryPlanner(AtomSpace* as, const Pattern& pat,
+                           size_t sample_size) :
+	_as(as),
+	_pat(pat),
+	_classserver(classserver()),
+	_sample_size(0 < sample_size ? sample_size : 1),
+	_best(0),
+	_fan_sum(0.0),
+	_fan_n(0)
+{
+}
+
+const HandleSeq& QueryPlanner::start_clauses(const Pattern& pat)
+{
+	// Sometimes, the number of mandatory clauses can be zero...
+	// or they might all be evaluatable.  In this case, its OK to
+	// start searching with an optional clause. But if there ARE
+	// mandatories, we must NOT start search on an optional, since,
+	// after all, it might be absent!
+	for (const Handle& m : pat.mandatory)
+	{
+		if (0 == pat.evaluatable_holders.count(m))
+			return pat.mandatory;
+	}
+	return pat.cnf_clauses;
+}
+
+/* ======================================================== */
+
+bool QueryPlanner::plan(const HandleSeq& clauses)
+{
+	_clauses = clauses;
+	_estimates.clear();
+	_clause_cost.clear();
+
+	// Every clause gets a cost, for ordering, but only the ones we
+	// were given may be started at.
+	size_t nstarts = 0;
+	for (const Handle& cl : _pat.cnf_clauses)
+	{
+		if (0 < _pat.evaluatable_holders.count(cl)) continue;
+
+		size_t idx = SIZE_MAX;
+		for (size_t i = 0; i < clauses.size(); i++)
+			if (clauses[i] == cl) { idx = i; break; }
+
+		std::vector<Estimate> ests;
+		HandleSeq path;
+		if (not find_starts(idx, cl, path, ests)) return false;
+
+		// A clause is only as common as its rarest constant allows.
+		double cost = (double) _as->get_num_atoms_of_type(cl->get_type());
+		for (const Estimate& e : ests)
+			cost = std::min(cost, e.groundings);
+		_clause_cost[cl] = cost;
+
+		if (SIZE_MAX == idx) continue;
+		nstarts += ests.size();
+		_estimates.insert(_estimates.end(), ests.begin(), ests.end());
+	}
+	if (0 == nstarts) return false;
+
+	// Every grounding of the start clause has to be extended to the
+	// other clauses, by way of the variables it shares with them.
+	size_t others = clauses.size() - 1;
+	_best = 0;
+	for (size_t i = 0; i < _estimates.size(); i++)
+	{
+		Estimate& e = _estimates[i];
+		e.cost = e.candidates + e.groundings * e.fanout * others;
+
+		const Estimate& b = _estimates[_best];
+		if (e.cost < b.cost or
+		    (e.cost == b.cost and e.candidates < b.candidates))
+			_best = i;
+	}
+	return true;
+}
+
+/// Find the constants in the clause, and estimate each of them as a
+/// starting point. The path holds the links from the top of the
+/// clause down to (and including) h. Return false if the planner
+/// cannot handle this clause.
+bool QueryPlanner::find_starts(size_t clause, const Handle& h,
+                               HandleSeq& path, std::vector<Estimate>& ests)
+{
+	// Lone nodes are left to the other kinds of search.
+	if (not h->is_link()) return true;
+
+	// Groundings for these might not exist in the atomspace.
+	if (0 < _pat.evaluatable_terms.count(h)) return true;
+
+	// Each branch of a ChoiceLink needs a start of its own.
+	if (CHOICE_LINK == h->get_type()) return false;
+
+	path.push_back(h);
+	for (Handle hunt : h->getOutgoingSet())
+	{
+		// Blow past the QuoteLinks, since they just screw up the search start.
+		if (Quotation::is_quotation_type(hunt->get_type()))
+			hunt = hunt->getOutgoingAtom(0);
+
+		Type t = hunt->get_type();
+		if (hunt->is_link())
+		{
+			if (not find_starts(clause, hunt, path, ests)) return false;
+		}
+		else if (VARIABLE_NODE != t and GLOB_NODE != t)
+		{
+			Estimate e;
+			e.clause = clause;
+			e.start = hunt;
+			e.term = h;
+			estimate(e, path);
+			ests.push_back(e);
+		}
+	}
+	path.pop_back();
+	return true;
+}
+
+void QueryPlanner::estimate(Estimate& e, const HandleSeq& path)
+{
+	Type ttype = e.term->get_type();
+	e.candidates = e.start->getIncomingSetSizeByType(ttype);
+	e.sampled = 0;
+	e.examined = 0;
+	e.groundings = 0.0;
+	e.fanout = 1.0;
+	e.cost = 0.0;
+	if (0 == e.candidates) return;
+
+	// Only the sample is looked at; a hub can have millions of
+	// incoming links, and no more than their number is needed.
+	HandleSeq sample;
+	e.start->getIncomingSetByType(back_inserter(sample), ttype,
+	                              _sample_size);
+	e.examined = sample.size();
+
+	_fan_sum = 0.0;
+	_fan_n = 0;
+	size_t roots = 0;
+	for (const Handle& cand : sample)
+	{
+		e.sampled++;
+		if (not fits(e.term, cand, 1 == path.size())) continue;
+
+		// Walk up to the top of the clause, keeping only those
+		// parents that have the right shape.
+		HandleSeq level({cand});
+		for (size_t k = path.size() - 1; 0 < k and not level.empty(); k--)
+		{
+			const Handle& pat = path[k-1];
+			bool top = (1 == k);
+			HandleSeq parents;
+			for (const Handle& g : level)
+			{
+				if (MAX_WALK <= parents.size()) break;
+				g->getIncomingSetByType(back_inserter(parents),
+					pat->get_type(), MAX_WALK - parents.size());
+			}
+			e.examined += parents.size();
+
+			HandleSeq up;
+			for (const Handle& p : parents)
+				if (fits(pat, p, top)) up.push_back(p);
+			level.swap(up);
+		}
+		roots += level.size();
+	}
+
+	if (0 < e.sampled)
+		e.groundings = ((double) e.candidates * roots) / e.sampled;
+	if (0 < _fan_n)
+		e.fanout = std::max(1.0, _fan_sum / _fan_n);
+}
+
+/// A rough, quick version of the pattern match: does the grounding
+/// have the same shape as the pattern? Variables match anything (type
+/// restrictions are ignored), and so do the contents of unordered
+/// links, scope links and evaluatable terms; so this over-estimates.
+/// If `count` is set, the incoming-set sizes of whatever the variables
+/// match are added to the fan-out totals.
+bool QueryPlanner::fits(const Handle& pat, const Handle& gnd, bool count)
+{
+	Type pt = pat->get_type();
+	if (Quotation::is_quotation_type(pt))
+		return fits(pat->getOutgoingAtom(0), gnd, count);
+
+	if (VARIABLE_NODE == pt or GLOB_NODE == pt)
+	{
+		if (count)
+		{
+			_fan_sum += gnd->getIncomingSetSize();
+			_fan_n++;
+		}
+		return true;
+	}
+
+	if (0 < _pat.evaluatable_terms.count(pat)) return true;
+	if (not pat->is_link()) return pat == gnd;
+	if (CHOICE_LINK == pt) return true;
+	if (pt != gnd->get_type()) return false;
+	if (_classserver.isA(pt, SCOPE_LINK)) return true;
+
+	const HandleSeq& po = pat->getOutgoingSet();
+	const HandleSeq& go = gnd->getOutgoingSet();
+	if (po.size() != go.size())
+	{
+		for (const Handle& h : po)
+			if (GLOB_NODE == h->get_type()) return true;
+		return false;
+	}
+	if (_classserver.isA(pt, UNORDERED_LINK)) return true;
+
+	for (size_t i = 0; i < po.size(); i++)
+		if (not fits(po[i], go[i], count)) return false;
+	return true;
+}
+
+/* ======================================================== */
+
+// Print an atom on one line.
+static std::string oneline(const Handle& h)
+{
+	std::string s(h->to_short_string());
+	std::string out;
+	bool space = false;
+	for (char c : s)
+	{
+		if (' ' == c or '\n' == c or '\t' == c) { space = true; continue; }
+		if (space and not out.empty() and ')' != c) out += ' ';
+		space = false;
+		out += c;
+	}
+	return out;
+}
+
+std::string QueryPlanner::explain(void) const
+{
+	std::stringstream ss;
+	char buf[200];
+
+	for (const Handle& cl : _pat.cnf_clauses)
+	{
+		auto it = _clause_cost.find(cl);
+		if (_clause_cost.end() == it)
+			ss << "clause (evaluatable): ";
+		else
+		{
+			snprintf(buf, sizeof(buf), "clause (est. %.1f groundings): ",
+			         it->second);
+			ss << buf;
+		}
+		ss << oneline(cl) << std::endl;
+	}
+
+	if (_estimates.empty())
+	{
+		ss << "No place to start a neighbor search." << std::endl;
+		return ss.str();
+	}
+
+	for (size_t i = 0; i < _estimates.size(); i++)
+	{
+		const Estimate& e = _estimates[i];
+		ss << (i == _best ? "* " : "  ")
+		   << "start at " << oneline(e.start)
+		   << " in " << _classserver.getTypeName(e.term->get_type())
+		   << " of clause " << e.clause << ": ";
+		snprintf(buf, sizeof(buf),
+		         "%zu candidates, %zu sampled, est. %.1f groundings, "
+		         "fan-out %.1f, cost %.1f",
+		         e.candidates, e.sampled, e.groundings, e.fanout, e.cost);
+		ss << buf << std::endl;
+	}
+	return ss.str();
+}
+
+std::string opencog::explain_query(AtomSpace* as, const Handle& h)
+{
+	PatternLinkPtr pl(PatternLinkCast(h));
+	if (nullptr == pl)
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a BindLink or a GetLink, got %s",
+			h->to_string().c_str());
+
+	const Pattern& pat = pl->get_pattern();
+	QueryPlanner qp(as, pat);
+	if (not qp.plan(QueryPlanner::start_clauses(pat)))
+	{
+		std::string why = qp.explain();
+		return why + "The planner does not handle this pattern; "
+		             "the search will use its default strategy.\n";
+	}
+	return qp.explain();
+}
+
+/* ===================== END OF FILE ===================== */
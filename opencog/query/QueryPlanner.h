@@ -0,0 +1,135 @@
+/*
+ * QueryPlanner.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_QUERY_PLANNER_H
+#define _OPENCOG_QUERY_PLANNER_H
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atoms/base/ClassServer.h>
+#include <opencog/atoms/pattern/Pattern.h>
+
+namespace opencog {
+
+class AtomSpace;
+
+/**
+ * Pick the place to start a neighbor search, by estimating what each
+ * possible start will cost, instead of just looking at the size of
+ * the incoming set of the constants (as find_thinnest() does).
+ *
+ * For every constant in every clause, the planner counts the links
+ * that could hold it at that spot (the incoming links of the right
+ * type, not all incoming links), and then walks a few of them up to
+ * the top of the clause, to see how many really ground the clause,
+ * and how big the incoming sets of the variable groundings are. Each
+ * clause grounding found at the start has to be joined to all the
+ * other clauses; the cost estimate is
+ *
+ *    candidates + groundings * fanout * (other clauses)
+ *
+ * The per-clause grounding estimates are also handed to the pattern
+ * match engine. It uses them only as a tie-break, to order clauses
+ * that it otherwise considers equally good: the most selective goes
+ * first. They do not otherwise change the order of the clauses.
+ *
+ * The planner only looks at the AtomSpace; it never modifies it.
+ */
+class QueryPlanner
+{
+public:
+	/// The estimates for starting at one constant in one clause.
+	struct Estimate
+	{
+		size_t clause;
+		Handle start;        // the constant
+		Handle term;         // the link holding it
+		size_t candidates;   // links of the term's type, holding start
+		size_t sampled;      // how many of those were examined
+		size_t examined;     // incoming links looked at, in all
+		double groundings;   // of the whole clause, estimated
+		double fanout;       // mean incoming size of variable groundings
+		double cost;
+	};
+
+	QueryPlanner(AtomSpace*, const Pattern&, size_t sample_size=16);
+
+	/// The clauses that a search may start at: the mandatory ones,
+	/// unless all of those are evaluatable.
+	static const HandleSeq& start_clauses(const Pattern&);
+
+	/// Estimate every start in every one of the clauses, skipping the
+	/// evaluatable ones. Return false if there are no starts at all,
+	/// or if any clause needs more than one start (ChoiceLinks);
+	/// the planner does not handle those.
+	bool plan(const HandleSeq& clauses);
+
+	/// The cheapest start found by plan().
+	const Estimate& best(void) const { return _estimates[_best]; }
+	const std::vector<Estimate>& estimates(void) const
+	{ return _estimates; }
+
+	/// Estimated number of groundings of each clause, for ordering.
+	const std::unordered_map<Handle, double>& clause_costs(void) const
+	{ return _clause_cost; }
+
+	/// A human-readable account of the estimates, and the choice made.
+	std::string explain(void) const;
+
+	/// Turn the planner on or off, for all searches. On by default;
+	/// when off, the older incoming-set-size heuristic is used.
+	static void set_enabled(bool on) { _enabled = on; }
+	static bool is_enabled(void) { return _enabled; }
+
+private:
+	AtomSpace* _as;
+	const Pattern& _pat;
+	ClassServer& _classserver;
+	size_t _sample_size;
+
+	HandleSeq _clauses;
+	std::vector<Estimate> _estimates;
+	size_t _best;
+	std::unordered_map<Handle, double> _clause_cost;
+
+	static std::atomic<bool> _enabled;
+
+	// Running totals for the fan-out of the sample being examined.
+	double _fan_sum;
+	size_t _fan_n;
+
+	bool find_starts(size_t, const Handle&, HandleSeq&,
+	                 std::vector<Estimate>&);
+	void estimate(Estimate&, const HandleSeq&);
+	bool fits(const Handle&, const Handle&, bool);
+};
+
+/// Explain how a BindLink or GetLink would be searched.
+std::string explain_query(AtomSpace*, const Handle&);
+
+} // namespace opencog
+
+#endif // _OPENCOG_QUERY_PLANNER_H
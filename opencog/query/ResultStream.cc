@@ -0,0 +1,231 @@
+/*
+ * ResultStream.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/pattern/BindLink.h>
+
+#include "DefaultImplicator.h"
+#include "PatternCache.h"
+#include "ResultStream.h"
+#include "Satisfier.h"
+
+namespace opencog {
+
+/**
+ * Instead of collecting the grounded implicands, pass them on to
+ * the stream. The result set of the base class stays empty; only
+ * a record of what was already sent is kept.
+ */
+class StreamImplicator : public DefaultImplicator
+{
+	ResultStream* _stream;
+	UnorderedHandleSet _sent;
+
+public:
+	StreamImplicator(AtomSpace* as, ResultStream* rs) :
+		Implicator(as),
+		InitiateSearchCB(as),
+		DefaultPatternMatchCB(as),
+		DefaultImplicator(as),
+		_stream(rs) {}
+
+	virtual void insert_result(const Handle& h)
+	{
+		if (h and _sent.insert(h).second)
+			_stream->push(h);
+	}
+
+	virtual bool grounding(const HandleMap &var_soln,
+	                       const HandleMap &term_soln)
+	{
+		Implicator::grounding(var_soln, term_soln);
+		return _stream->is_closed();
+	}
+
+	bool found_any(void) const { return not _sent.empty(); }
+};
+
+class StreamSatisfyingSet : public SatisfyingSet
+{
+	ResultStream* _stream;
+	UnorderedHandleSet _sent;
+
+public:
+	StreamSatisfyingSet(AtomSpace* as, ResultStream* rs) :
+		InitiateSearchCB(as),
+		DefaultPatternMatchCB(as),
+		SatisfyingSet(as),
+		_stream(rs) {}
+
+	virtual bool grounding(const HandleMap &var_soln,
+	                       const HandleMap &term_soln)
+	{
+		Handle gnd(make_ground(var_soln));
+		if (_sent.insert(gnd).second)
+			_stream->push(InitiateSearchCB::_as->add_atom(gnd));
+		return _stream->is_closed();
+	}
+};
+
+} // namespace opencog
+
+using namespace opencog;
+
+ResultStream::ResultStream(AtomSpace* as, const Handle& h, size_t buffer) :
+	_buffer(0 < buffer ? buffer : 1),
+	_count(0),
+	_done(false),
+	_closed(false)
+{
+	Type t = h->get_type();
+	if (BIND_LINK != t and GET_LINK != t)
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a BindLink or a GetLink, got %s",
+			h->to_string().c_str());
+
+	_worker = std::thread(&ResultStream::run, this, as, h);
+}
+
+ResultStream::~ResultStream()
+{
+	close();
+}
+
+void ResultStream::run(AtomSpace* as, Handle h)
+{
+	try
+	{
+		if (BIND_LINK == h->get_type())
+			bind(as, h);
+		else
+			get(as, h);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_error = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lck(_mtx);
+	_done = true;
+	_not_empty.notify_all();
+}
+
+/// Same as bindlink(), including the handling of patterns that
+/// consist only of absent clauses. A cancelled search proves nothing
+/// about absence.
+void ResultStream::bind(AtomSpace* as, const Handle& h)
+{
+	BindLinkPtr bl(BindLinkCast(h));
+	StreamImplicator impl(as, this);
+	impl.implicand = bl->get_implicand();
+	impl.set_budget(&_budget);
+
+	CompiledPatternPtr cp = pattern_cache().get(h);
+	impl.set_compiled(cp);
+	bl->imply(impl, as, false);
+	pattern_cache().put(h, impl.get_compiled());
+
+	const Pattern& pat = bl->get_pattern();
+	if (not impl.found_any() and 0 == pat.mandatory.size()
+	    and 0 < pat.optionals.size() and not impl.optionals_present()
+	    and not _budget.exhausted())
+	{
+		impl.insert_result(impl.inst.execute(impl.implicand, true));
+	}
+}
+
+void ResultStream::get(AtomSpace* as, const Handle& h)
+{
+	PatternLinkPtr pl(PatternLinkCast(h));
+	StreamSatisfyingSet sater(as, this);
+	sater.set_budget(&_budget);
+
+	CompiledPatternPtr cp = pattern_cache().get(h);
+	sater.set_compiled(cp);
+	pl->satisfy(sater);
+	pattern_cache().put(h, sater.get_compiled());
+}
+
+/// Wait for room in the queue, unless the reader has gone away.
+void ResultStream::push(const Handle& h)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_not_full.wait(lck, [&] { return _queue.size() < _buffer or _closed; });
+	if (_closed) return;
+
+	_queue.push_back(h);
+	_not_empty.notify_one();
+}
+
+bool ResultStream::is_closed(void)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _closed;
+}
+
+bool ResultStream::next(Handle& h)
+{
+	std::unique_lock<std::mutex> lck(_mtx);
+	_not_empty.wait(lck, [&] {
+		return not _queue.empty() or _done or _closed; });
+
+	if (_queue.empty())
+	{
+		if (_error)
+		{
+			std::exception_ptr ex = _error;
+			_error = nullptr;
+			std::rethrow_exception(ex);
+		}
+		return false;
+	}
+
+	h = _queue.front();
+	_queue.pop_front();
+	_count++;
+	_not_full.notify_one();
+	return true;
+}
+
+Handle ResultStream::next(void)
+{
+	Handle h;
+	if (next(h)) return h;
+	return Handle::UNDEFINED;
+}
+
+void ResultStream::close(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_closed = true;
+		_budget.cancel();
+		_queue.clear();
+		_not_full.notify_all();
+		_not_empty.notify_all();
+	}
+	if (_worker.joinable()) _worker.join();
+}
+
+/* ===================== END OF FILE ===================== */
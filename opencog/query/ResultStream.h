@@ -0,0 +1,112 @@
+/*
+ * ResultStream.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_RESULT_STREAM_H
+#define _OPENCOG_RESULT_STREAM_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/query/SearchBudget.h>
+
+namespace opencog {
+
+class AtomSpace;
+
+/**
+ * Hand out the results of a BindLink or a GetLink one at a time, as
+ * they are found, instead of collecting all of them into a SetLink.
+ *
+ * The search runs in a thread of its own, and stops whenever 'buffer'
+ * results are waiting to be picked up; it resumes as next() takes them
+ * away. Thus, a search with a huge number of groundings holds only a
+ * few of them at any one time, and a caller who has seen enough can
+ * call close() (or just destroy the stream) without having to guess
+ * a suitable 'max_results' beforehand.
+ *
+ * For a BindLink, the results are the grounded implicands, just as
+ * bindlink() would place them in its SetLink; for a GetLink, they
+ * are the variable groundings, as for satisfying_set(). Repeated
+ * results are reported only once. The results are placed in the
+ * AtomSpace; the SetLink holding all of them is never made.
+ *
+ * Exceptions thrown during the search are rethrown by next().
+ */
+class ResultStream
+{
+	friend class StreamImplicator;
+	friend class StreamSatisfyingSet;
+
+	public:
+		ResultStream(AtomSpace*, const Handle&, size_t buffer=64);
+		~ResultStream();
+
+		/// Wait for the next result. Return false, once the search
+		/// has finished and every result has been handed out.
+		bool next(Handle&);
+
+		/// Same as above, but return Handle::UNDEFINED at the end.
+		Handle next(void);
+
+		/// Stop the search, and drop all results not yet picked up.
+		void close(void);
+
+		/// The number of results handed out so far.
+		size_t count(void) const { return _count; }
+
+	private:
+		size_t _buffer;
+		size_t _count;
+
+		std::mutex _mtx;
+		std::condition_variable _not_empty;
+		std::condition_variable _not_full;
+		std::deque<Handle> _queue;
+		bool _done;
+		bool _closed;
+		std::exception_ptr _error;
+
+		// Cancelled by close(), so that a long search that finds
+		// nothing does not keep close() waiting.
+		SearchBudget _budget;
+
+		std::thread _worker;
+
+		void run(AtomSpace*, Handle);
+		void bind(AtomSpace*, const Handle&);
+		void get(AtomSpace*, const Handle&);
+
+		// Called by the search thread.
+		void push(const Handle&);
+		bool is_closed(void);
+};
+
+typedef std::shared_ptr<ResultStream> ResultStreamPtr;
+
+} // namespace opencog
+
+#endif // _OPENCOG_RESULT_STREAM_H
@@ -26,6 +26,7 @@
 
 #include "BindLinkAPI.h"
 #include "Satisfier.h"
+#include "SearchBudget.h"
 
 using namespace opencog;
 
@@ -107,21 +108,16 @@ bool Satisfier::search_finished(bool done)
 
 // ===========================================================
 
-bool SatisfyingSet::grounding(const HandleMap &var_soln,
-                              const HandleMap &term_soln)
+/// The grounding of the variables, in the order they were declared:
+/// a single grounding, or else a ListLink holding all of them.
+Handle SatisfyingSet::make_ground(const HandleMap &var_soln)
 {
-	// PatternMatchEngine::log_solution(var_soln, term_soln);
-
-	// Do not accept new solution if maximum number has been already reached
-	if (_satisfying_set.size() >= max_results)
-		return true;
-
 	if (1 == _varseq.size())
 	{
 		// std::map::at() can throw. Rethrow for easier deubugging.
 		try
 		{
-			_satisfying_set.emplace(var_soln.at(_varseq[0]));
+			return var_soln.at(_varseq[0]);
 		}
 		catch (...)
 		{
@@ -129,22 +125,45 @@ bool SatisfyingSet::grounding(const HandleMap &var_soln,
 				"Internal error: ungrounded variable %s\n",
 				_varseq[0]->to_string().c_str());
 		}
-
-		// If we found as many as we want, then stop looking for more.
-		return (_satisfying_set.size() >= max_results);
 	}
+	else
+	{
+		// If more than one variable, encapsulate in sequential order,
+		// in a ListLink.
+		HandleSeq vargnds;
+		for (const Handle& hv : _varseq)
+		{
+			vargnds.push_back(var_soln.at(hv));
+		}
+		return createLink(vargnds, LIST_LINK);
+	}
+}
 
-	// If more than one variable, encapsulate in sequential order,
-	// in a ListLink.
-	HandleSeq vargnds;
-	for (const Handle& hv : _varseq)
+bool SatisfyingSet::grounding(const HandleMap &var_soln,
+                              const HandleMap &term_soln)
+{
+	// PatternMatchEngine::log_solution(var_soln, term_soln);
+
+	// Groundings found by a thread doing a parallel search go to the
+	// original SatisfyingSet.
+	SatisfyingSet* sink = _sink ? _sink : this;
+
+	// Do not accept new solution if maximum number has been already reached
 	{
-		vargnds.push_back(var_soln.at(hv));
+		std::lock_guard<std::mutex> lck(sink->_mtx);
+		if (sink->_satisfying_set.size() >= max_results)
+			return true;
 	}
-	_satisfying_set.emplace(createLink(vargnds, LIST_LINK));
+
+	Handle gnd(make_ground(var_soln));
+
+	// Another thread may have filled up the set in the meantime.
+	std::lock_guard<std::mutex> lck(sink->_mtx);
+	if (sink->_satisfying_set.size() < max_results)
+		sink->_satisfying_set.emplace(gnd);
 
 	// If we found as many as we want, then stop looking for more.
-	return (_satisfying_set.size() >= max_results);
+	return (sink->_satisfying_set.size() >= max_results);
 }
 
 TruthValuePtr opencog::satisfaction_link(AtomSpace* as, const Handle& hlink)
@@ -168,7 +187,9 @@ TruthValuePtr opencog::satisfaction_link(AtomSpace* as, const Handle& hlink)
 	return sater._result;
 }
 
-Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink, size_t max_results)
+static Handle do_satisfying_set(AtomSpace* as, const Handle& hlink,
+                                size_t max_results, unsigned nthreads,
+                                SearchBudget* budget)
 {
 	// Special case the BindLink. We probably shouldn't have to, and
 	// the C++ code for handling this case could maybe be refactored
@@ -177,7 +198,9 @@ Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink, size_t max_re
 	Type blt = hlink->get_type();
 	if (BIND_LINK == blt)
 	{
-		return bindlink(as, hlink, max_results);
+		if (budget)
+			return bindlink(as, hlink, *budget, max_results, nthreads);
+		return bindlink(as, hlink, max_results, nthreads);
 	}
 	if (DUAL_LINK == blt)
 	{
@@ -193,7 +216,13 @@ Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink, size_t max_re
 
 	SatisfyingSet sater(as);
 	sater.max_results = max_results;
+	sater.set_search_threads(nthreads);
+	sater.set_budget(budget);
+
+	CompiledPatternPtr cp = pattern_cache().get(hlink);
+	sater.set_compiled(cp);
 	bl->satisfy(sater);
+	pattern_cache().put(hlink, sater.get_compiled());
 
 	// Ugh. We used an std::set to avoid duplicates. But now, we need a
 	// vector.  Which means copying. Got a better idea?
@@ -216,4 +245,18 @@ Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink, size_t max_re
 	return satset;
 }
 
+Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink,
+                               size_t max_results, unsigned nthreads)
+{
+	return do_satisfying_set(as, hlink, max_results, nthreads, nullptr);
+}
+
+/// As above, but give up when the budget runs out; see SearchBudget.h
+Handle opencog::satisfying_set(AtomSpace* as, const Handle& hlink,
+                               SearchBudget& budget,
+                               size_t max_results, unsigned nthreads)
+{
+	return do_satisfying_set(as, hlink, max_results, nthreads, &budget);
+}
+
 /* ===================== END OF FILE ===================== */
@@ -24,6 +24,7 @@
 #ifndef _OPENCOG_SATISFIER_H
 #define _OPENCOG_SATISFIER_H
 
+#include <mutex>
 #include <vector>
 
 #include <opencog/truthvalue/TruthValue.h>
@@ -89,6 +90,9 @@ class Satisfier :
  * This will record every grounding that is found. Thus, after running,
  * the SatisfyingSet can be examined to see all the groundings that were
  * found.
+ *
+ * For a parallel search, each thread gets its own copy, which places
+ * its groundings into the '_satisfying_set' of the original.
  */
 
 class SatisfyingSet :
@@ -98,7 +102,7 @@ class SatisfyingSet :
 	public:
 		SatisfyingSet(AtomSpace* as) :
 			InitiateSearchCB(as), DefaultPatternMatchCB(as),
-			max_results(SIZE_MAX) {}
+			max_results(SIZE_MAX), _sink(nullptr) {}
 
 		HandleSeq _varseq;
 		HandleSet _satisfying_set;
@@ -119,6 +123,20 @@ class SatisfyingSet :
 		// groundings.
 		virtual bool grounding(const HandleMap &var_soln,
 		                       const HandleMap &term_soln);
+
+	protected:
+		SatisfyingSet* _sink;
+		std::mutex _mtx;
+
+		Handle make_ground(const HandleMap &var_soln);
+
+		virtual InitiateSearchCB* clone_for_thread(void)
+		{
+			SatisfyingSet* sat = new SatisfyingSet(InitiateSearchCB::_as);
+			sat->max_results = max_results;
+			sat->_sink = this;
+			return sat;
+		}
 };
 
 }; // namespace opencog
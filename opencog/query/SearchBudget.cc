@@ -0,0 +1,102 @@
+/*
+ * SearchBudget.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <cstdint>
+
+#include "SearchBudget.h"
+
+using namespace opencog;
+
+// Look at the clock once every this many steps. A step costs a
+// microsecond or so; the clock a few tens of nanoseconds.
+#define CLOCK_INTERVAL 64
+
+SearchBudget::SearchBudget(void) :
+	_status(COMPLETE),
+	_steps(0),
+	_max_steps(SIZE_MAX),
+	_have_deadline(false)
+{
+}
+
+void SearchBudget::set_deadline(Clock::time_point t)
+{
+	_deadline = t;
+	_have_deadline = true;
+}
+
+void SearchBudget::set_timeout(Clock::duration d)
+{
+	set_deadline(Clock::now() + d);
+}
+
+void SearchBudget::set_max_steps(size_t n)
+{
+	_max_steps = n;
+}
+
+void SearchBudget::cancel(void)
+{
+	stop(CANCELLED);
+}
+
+/// Only the first reason for stopping is kept.
+void SearchBudget::stop(Status why)
+{
+	Status running = COMPLETE;
+	_status.compare_exchange_strong(running, why);
+}
+
+bool SearchBudget::step(void)
+{
+	if (exhausted()) return true;
+
+	size_t n = _steps.fetch_add(1, std::memory_order_relaxed) + 1;
+	if (_max_steps < n)
+	{
+		stop(OUT_OF_STEPS);
+		return true;
+	}
+
+	if (_have_deadline and 0 == n % CLOCK_INTERVAL and
+	    _deadline <= Clock::now())
+	{
+		stop(TIMED_OUT);
+		return true;
+	}
+
+	return exhausted();
+}
+
+const char* SearchBudget::status_name(Status s)
+{
+	switch (s)
+	{
+		case COMPLETE: return "complete";
+		case TIMED_OUT: return "timed-out";
+		case OUT_OF_STEPS: return "out-of-steps";
+		case CANCELLED: return "cancelled";
+	}
+	return "unknown";
+}
+
+/* ===================== END OF FILE ===================== */
@@ -0,0 +1,103 @@
+/*
+ * SearchBudget.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_SEARCH_BUDGET_H
+#define _OPENCOG_SEARCH_BUDGET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace opencog {
+
+/**
+ * Limits on how much work a single search may do: a deadline, a
+ * number of steps, and a flag that another thread can raise to cancel
+ * the search. Hand one to InitiateSearchCB::set_budget(), or to the
+ * bindlink() and satisfying_set() variants that take one.
+ *
+ * A step is one candidate grounding tried for one pattern term, or
+ * one combination of groundings tried for a multi-component pattern.
+ * The engine counts steps as it goes; once the budget is used up, it
+ * unwinds the search as if the callback had asked it to stop. The
+ * groundings reported until then are kept, so the results are partial:
+ * every result is a correct one, but some may be missing. get_status()
+ * tells whether the search ran to the end (or was stopped by the
+ * callback, e.g. after max_results) or why it was cut short.
+ *
+ * The clock is only looked at every so many steps, so the deadline
+ * can be overshot by that much work; a single step that takes a long
+ * time (a slow GroundedPredicateNode, say) is not interrupted.
+ *
+ * All of the methods may be called from any thread; a parallel search
+ * shares one budget between all of its threads.
+ */
+class SearchBudget
+{
+public:
+	enum Status
+	{
+		COMPLETE,      // Not (yet) cut short.
+		TIMED_OUT,     // The deadline passed.
+		OUT_OF_STEPS,  // The step limit was reached.
+		CANCELLED      // cancel() was called.
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	SearchBudget(void);
+
+	/// Stop the search at the given time, or after the given time
+	/// from now.
+	void set_deadline(Clock::time_point);
+	void set_timeout(Clock::duration);
+
+	/// Stop the search after this many steps.
+	void set_max_steps(size_t);
+
+	/// Stop the search as soon as possible.
+	void cancel(void);
+
+	/// Count one step. Return true if the search must stop.
+	bool step(void);
+
+	/// Return true if the search must stop.
+	bool exhausted(void) const { return COMPLETE != _status; }
+
+	Status get_status(void) const { return _status; }
+	size_t get_steps(void) const { return _steps; }
+
+	static const char* status_name(Status);
+
+private:
+	std::atomic<Status> _status;
+	std::atomic<size_t> _steps;
+	size_t _max_steps;
+	bool _have_deadline;
+	Clock::time_point _deadline;
+
+	void stop(Status);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_SEARCH_BUDGET_H
@@ -0,0 +1,434 @@
+/*
+ * StandingQuery.cc
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <opencog/util/exceptions.h>
+#include <opencog/util/Logger.h>
+#include <opencog/atomspace/AtomSpace.h>
+#include <opencog/atoms/execution/Instantiator.h>
+#include <opencog/atoms/pattern/BindLink.h>
+
+#include "PatternMatchEngine.h"
+#include "Satisfier.h"
+#include "StandingQuery.h"
+
+namespace opencog {
+
+/**
+ * Collect the groundings reported by the engine, together with the
+ * results they give, for the StandingQuery to file away. Nothing is
+ * locked here; the StandingQuery merges them in afterwards.
+ */
+class StandingQueryCB : public SatisfyingSet
+{
+	Instantiator _inst;
+	Handle _implicand;
+	HandleSeq _key_clauses;
+
+public:
+	StandingQueryCB(AtomSpace* as, const Handle& implicand) :
+		InitiateSearchCB(as),
+		DefaultPatternMatchCB(as),
+		SatisfyingSet(as),
+		_inst(as),
+		_implicand(implicand) {}
+
+	std::vector<std::pair<HandleSeq, Handle>> found;
+
+	virtual void set_pattern(const Variables& vars,
+	                         const Pattern& pat)
+	{
+		SatisfyingSet::set_pattern(vars, pat);
+
+		// Evaluatable clauses have no grounding in the atomspace.
+		_key_clauses.clear();
+		for (const Handle& cl : pat.cnf_clauses)
+			if (0 == pat.evaluatable_holders.count(cl))
+				_key_clauses.push_back(cl);
+	}
+
+	virtual bool grounding(const HandleMap &var_soln,
+	                       const HandleMap &term_soln)
+	{
+		HandleSeq key;
+		for (const Handle& cl : _key_clauses)
+		{
+			auto it = term_soln.find(cl);
+			key.push_back(term_soln.end() == it ? Handle::UNDEFINED : it->second);
+		}
+
+		// As in Implicator::grounding(), ill-formed implicands are
+		// skipped, rather than treated as errors.
+		Handle result;
+		if (_implicand)
+		{
+			try {
+				result = _inst.instantiate(_implicand, var_soln, true);
+			} catch(...) {}
+			if (nullptr == result) return false;
+		}
+		else
+			result = InitiateSearchCB::_as->add_atom(make_ground(var_soln));
+
+		found.emplace_back(key, result);
+		return false;
+	}
+
+	// The standing query takes all of its groundings in one thread.
+	virtual InitiateSearchCB* clone_for_thread(void) { return nullptr; }
+};
+
+} // namespace opencog
+
+using namespace opencog;
+
+StandingQueryPtr StandingQuery::create(AtomSpace* as, const Handle& h)
+{
+	StandingQueryPtr sq(new StandingQuery(as, h));
+	sq->start();
+	return sq;
+}
+
+StandingQuery::StandingQuery(AtomSpace* as, const Handle& h) :
+	_as(as),
+	_query(h),
+	_incremental(true),
+	_busy(true),
+	_stale(false)
+{
+	Type t = h->get_type();
+	if (BIND_LINK != t and GET_LINK != t)
+		throw InvalidParamException(TRACE_INFO,
+			"Expecting a BindLink or a GetLink, got %s",
+			h->to_string().c_str());
+
+	if (BIND_LINK == t)
+		_implicand = BindLinkCast(h)->get_implicand();
+
+	PatternLinkPtr pl(PatternLinkCast(h));
+	const Pattern& pat = pl->get_pattern();
+
+	// See the class description for why these are not incremental.
+	if (not pat.optionals.empty() or 1 < pl->get_num_components()
+	    or not pat.globby_terms.empty())
+		_incremental = false;
+
+	for (const auto& tc : pat.connected_terms_map)
+	{
+		const Handle& term = tc.first.first;
+		const Handle& clause = tc.first.second;
+		Type tt = term->get_type();
+		if (CHOICE_LINK == tt or VARIABLE_NODE == clause->get_type())
+			_incremental = false;
+
+		if (not term->is_link()) continue;
+		if (0 < pat.evaluatable_holders.count(clause)) continue;
+		if (0 < pat.evaluatable_terms.count(term)) continue;
+		if (0 < pat.evaluatable_holders.count(term)) continue;
+		_starts.insert({tt, {term, clause}});
+	}
+	if (_starts.empty()) _incremental = false;
+}
+
+/// Listen for changes, and then run the query in full. Changes that
+/// happen during the first run are queued (we are busy), and handled
+/// once it is done; those that it already saw are recognized as such.
+void StandingQuery::start(void)
+{
+	std::weak_ptr<StandingQuery> wsq(shared_from_this());
+	_add_conn = _as->addAtomSignal(
+		[wsq](const Handle& h) {
+			StandingQueryPtr sq(wsq.lock());
+			if (sq) sq->changed(h, true);
+		});
+	_remove_conn = _as->removeAtomSignal(
+		[wsq](const AtomPtr& a) {
+			StandingQueryPtr sq(wsq.lock());
+			if (sq) sq->changed(Handle(a), false);
+		});
+
+	rerun();
+	drain();
+}
+
+StandingQuery::~StandingQuery()
+{
+	stop();
+}
+
+void StandingQuery::stop(void)
+{
+	_add_conn.disconnect();
+	_remove_conn.disconnect();
+}
+
+/* ======================================================== */
+
+void StandingQuery::changed(const Handle& h, bool added)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		if (not _incremental)
+		{
+			_stale = true;
+			return;
+		}
+		_pending.emplace_back(h, added);
+		if (_busy) return;
+		_busy = true;
+	}
+	drain();
+}
+
+/// Handle queued changes until there are none left. Only one thread
+/// at a time gets here (the one that set _busy).
+void StandingQuery::drain(void)
+{
+	while (true)
+	{
+		std::pair<Handle, bool> chg;
+		{
+			std::lock_guard<std::mutex> lck(_mtx);
+			if (_pending.empty())
+			{
+				_busy = false;
+				return;
+			}
+			chg = _pending.front();
+			_pending.pop_front();
+		}
+
+		// A broken standing query must not break whoever is changing
+		// the atomspace.
+		try
+		{
+			if (chg.second)
+				explore(chg.first);
+			else
+				retract(chg.first);
+		}
+		catch (const std::exception& ex)
+		{
+			logger().warn("StandingQuery: %s", ex.what());
+		}
+	}
+}
+
+/// Look for groundings that use the newly-added atom h.
+void StandingQuery::explore(const Handle& h)
+{
+	// It might have been removed again already.
+	if (nullptr == h->getAtomSpace()) return;
+
+	auto range = _starts.equal_range(h->get_type());
+	if (range.first == range.second) return;
+
+	PatternLinkPtr pl(PatternLinkCast(_query));
+	StandingQueryCB cb(_as, _implicand);
+	PooledEngine pme(cb);
+	pme->set_pattern(pl->get_variables(), pl->get_pattern());
+	cb.set_pattern(pl->get_variables(), pl->get_pattern());
+
+	for (auto it = range.first; it != range.second; it++)
+		pme->explore_neighborhood(it->second.second, it->second.first, h);
+
+	HandleSeq added, removed;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		for (const auto& kr : cb.found)
+		{
+			bool gone = false;
+			for (const Handle& g : kr.first)
+				if (g and nullptr == g->getAtomSpace()) gone = true;
+			if (not gone) insert(kr.first, kr.second, added);
+		}
+		record(added, removed);
+	}
+	notify(added, removed);
+}
+
+/// Drop the groundings that used the removed atom h.
+void StandingQuery::retract(const Handle& h)
+{
+	HandleSeq added, removed;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		auto range = _support.equal_range(h);
+		if (range.first == range.second) return;
+
+		std::vector<Key> keys;
+		for (auto it = range.first; it != range.second; it++)
+			keys.push_back(it->second);
+		for (const Key& k : keys)
+			erase(k, removed);
+		record(added, removed);
+	}
+	notify(added, removed);
+}
+
+/// Run the whole query again, and work out what changed.
+void StandingQuery::rerun(void)
+{
+	// Changes made while the query runs (including those made by the
+	// query itself) leave it stale again.
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		_stale = false;
+	}
+
+	PatternLinkPtr pl(PatternLinkCast(_query));
+	StandingQueryCB cb(_as, _implicand);
+	pl->satisfy(cb);
+
+	HandleSeq added, removed;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+
+		// Start over, but remember what the results were, so that
+		// only real changes are reported.
+		std::unordered_map<Handle, size_t> before;
+		before.swap(_results);
+		_groundings.clear();
+		_support.clear();
+
+		HandleSeq ignore;
+		for (const auto& kr : cb.found)
+			insert(kr.first, kr.second, ignore);
+
+		for (const auto& rc : _results)
+			if (0 == before.count(rc.first)) added.push_back(rc.first);
+		for (const auto& rc : before)
+			if (0 == _results.count(rc.first)) removed.push_back(rc.first);
+		record(added, removed);
+	}
+	notify(added, removed);
+}
+
+/* ======================================================== */
+
+bool StandingQuery::insert(const Key& key, const Handle& result,
+                           HandleSeq& added)
+{
+	if (not _groundings.emplace(key, result).second) return false;
+
+	for (const Handle& g : key)
+		if (g) _support.insert({g, key});
+
+	if (1 == ++_results[result])
+		added.push_back(result);
+	return true;
+}
+
+void StandingQuery::erase(const Key& key, HandleSeq& removed)
+{
+	auto git = _groundings.find(key);
+	if (_groundings.end() == git) return;
+	Handle result(git->second);
+	_groundings.erase(git);
+
+	for (const Handle& g : key)
+	{
+		if (nullptr == g) continue;
+		auto range = _support.equal_range(g);
+		for (auto it = range.first; it != range.second; it++)
+		{
+			if (it->second != key) continue;
+			_support.erase(it);
+			break;
+		}
+	}
+
+	auto rit = _results.find(result);
+	if (0 < --rit->second) return;
+	_results.erase(rit);
+	removed.push_back(result);
+}
+
+/// Keep track of the changes for take_changes(); the lock must be held.
+void StandingQuery::record(const HandleSeq& added, const HandleSeq& removed)
+{
+	for (const Handle& h : added)
+		if (0 == _removed.erase(h)) _added.insert(h);
+	for (const Handle& h : removed)
+		if (0 == _added.erase(h)) _removed.insert(h);
+}
+
+void StandingQuery::notify(const HandleSeq& added, const HandleSeq& removed)
+{
+	if (added.empty() and removed.empty()) return;
+
+	Listener fn;
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		fn = _listener;
+	}
+	if (fn) fn(added, removed);
+}
+
+/* ======================================================== */
+
+/// Bring a non-incremental query up to date, unless some other
+/// thread is busy with it.
+void StandingQuery::refresh(void)
+{
+	{
+		std::lock_guard<std::mutex> lck(_mtx);
+		if (not _stale or _busy) return;
+		_busy = true;
+	}
+	rerun();
+	drain();
+}
+
+HandleSeq StandingQuery::get_results(void)
+{
+	refresh();
+	std::lock_guard<std::mutex> lck(_mtx);
+	HandleSeq res;
+	for (const auto& rc : _results)
+		res.push_back(rc.first);
+	return res;
+}
+
+size_t StandingQuery::size(void)
+{
+	refresh();
+	std::lock_guard<std::mutex> lck(_mtx);
+	return _results.size();
+}
+
+void StandingQuery::take_changes(HandleSeq& added, HandleSeq& removed)
+{
+	refresh();
+	std::lock_guard<std::mutex> lck(_mtx);
+	added.insert(added.end(), _added.begin(), _added.end());
+	removed.insert(removed.end(), _removed.begin(), _removed.end());
+	_added.clear();
+	_removed.clear();
+}
+
+void StandingQuery::set_listener(const Listener& fn)
+{
+	std::lock_guard<std::mutex> lck(_mtx);
+	_listener = fn;
+}
+
+/* ===================== END OF FILE ===================== */
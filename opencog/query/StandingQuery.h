@@ -0,0 +1,168 @@
+/*
+ * StandingQuery.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_STANDING_QUERY_H
+#define _OPENCOG_STANDING_QUERY_H
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <opencog/atoms/base/Handle.h>
+#include <opencog/atomspace/SigSlot.h>
+
+namespace opencog {
+
+class AtomSpace;
+class StandingQuery;
+typedef std::shared_ptr<StandingQuery> StandingQueryPtr;
+
+/**
+ * Keep the results of a BindLink or a GetLink up to date, as atoms
+ * are added to and removed from the AtomSpace, instead of re-running
+ * the whole search over and over to see what changed.
+ *
+ * The query is run once, when it is registered. After that, each
+ * added link is tried as the grounding of every term of the same type
+ * in the pattern, and the search is continued outwards from there,
+ * with PatternMatchEngine::explore_neighborhood(). Any new grounding
+ * has to use the new atom somewhere, so this finds all of them, at a
+ * cost that depends on the neighborhood of the change, not on the size
+ * of the AtomSpace. When an atom is removed, the groundings that used
+ * it are dropped; a result is dropped once no grounding supports it.
+ *
+ * The results are the same as for bindlink() and satisfying_set():
+ * the grounded implicands, or the variable groundings. They are placed
+ * in the AtomSpace, but they are not removed from it when they lose
+ * their support; they only leave the result set.
+ *
+ * Some patterns cannot be maintained this way: those with optional or
+ * absent clauses (an added atom can take a grounding away), those
+ * with several components joined by virtual clauses, those where a
+ * clause is a lone variable, and those with ChoiceLinks or globs.
+ * For these, every change just marks the results as stale, and the
+ * query is run again in full the next time the results or changes are
+ * asked for. is_incremental() tells which kind of query this is.
+ *
+ * Changes are handled in the thread that made them. If another change
+ * is being handled already (in this thread, because the implicand added
+ * atoms, or in another thread), it is queued, and handled by that same
+ * thread, once it is done with the current one.
+ */
+class StandingQuery : public std::enable_shared_from_this<StandingQuery>
+{
+	friend class StandingQueryCB;
+
+	public:
+		/// Called with the results that were added and removed by
+		/// each change.
+		typedef std::function<void(const HandleSeq& added,
+		                           const HandleSeq& removed)> Listener;
+
+		/// Run the BindLink or GetLink `h`, and keep its results up
+		/// to date from then on.
+		static StandingQueryPtr create(AtomSpace*, const Handle& h);
+		~StandingQuery();
+
+		/// Stop following changes. Also done by the destructor.
+		void stop(void);
+
+		/// The current results.
+		HandleSeq get_results(void);
+		size_t size(void);
+
+		/// The results added and removed since the last call (or
+		/// since the query was registered). A result that came and
+		/// went in the meantime is in neither list.
+		void take_changes(HandleSeq& added, HandleSeq& removed);
+
+		/// Call `fn` after every change that alters the results of an
+		/// incremental query; pass an empty function to stop. It is
+		/// called in the thread handling the change, without the lock
+		/// of this query held, so it may look at the query. Removals
+		/// are reported from within AtomSpace::remove_atom().
+		void set_listener(const Listener& fn);
+
+		bool is_incremental(void) const { return _incremental; }
+		const Handle& get_query(void) const { return _query; }
+
+	private:
+		StandingQuery(AtomSpace*, const Handle&);
+		void start(void);
+
+		AtomSpace* _as;
+		Handle _query;
+		Handle _implicand;
+		bool _incremental;
+
+		// The pattern terms that a newly-added atom of the given
+		// type might ground: (term, clause) pairs.
+		std::multimap<Type, std::pair<Handle, Handle>> _starts;
+
+		// The groundings found so far, keyed by the groundings of the
+		// clauses, in the order of the pattern's clauses; each one
+		// maps to the result it gives.
+		typedef HandleSeq Key;
+		std::map<Key, Handle> _groundings;
+
+		// The groundings each clause-grounding atom takes part in.
+		std::unordered_multimap<Handle, Key> _support;
+
+		// The results, with the number of groundings giving each.
+		std::unordered_map<Handle, size_t> _results;
+
+		// Changes not yet picked up by take_changes().
+		UnorderedHandleSet _added;
+		UnorderedHandleSet _removed;
+
+		// Atoms added (true) and removed (false), not yet handled.
+		std::deque<std::pair<Handle, bool>> _pending;
+		bool _busy;
+		bool _stale;
+
+		std::mutex _mtx;
+		Listener _listener;
+		SignalConnection _add_conn;
+		SignalConnection _remove_conn;
+
+		void changed(const Handle&, bool added);
+		void drain(void);
+		void explore(const Handle&);
+		void retract(const Handle&);
+		void rerun(void);
+		void refresh(void);
+
+		// Record a grounding; the lock must be held. Return false if
+		// it was already known.
+		bool insert(const Key&, const Handle& result,
+		            HandleSeq& added);
+		void erase(const Key&, HandleSeq& removed);
+		void record(const HandleSeq& added, const HandleSeq& removed);
+		void notify(const HandleSeq& added, const HandleSeq& removed);
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_STANDING_QUERY_H
@@ -0,0 +1,154 @@
+/*
+ * TrailMap.h
+ *
+ * Copyright (C) 2017 OpenCog Foundation
+ * All Rights Reserved
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License v3 as
+ * published by the Free Software Foundation and including the exceptions
+ * at http://opencog.org/wiki/Licenses
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program; if not, write to:
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OPENCOG_TRAIL_MAP_H
+#define _OPENCOG_TRAIL_MAP_H
+
+#include <map>
+#include <vector>
+
+namespace opencog {
+
+/**
+ * A std::map that can be taken back to an earlier state, for
+ * backtracking searches.
+ *
+ * push() marks the current state, and pop() goes back to the most
+ * recent mark. Rather than copying the whole map at each push(), every
+ * change made through set() or erase() is written to a trail, along
+ * with the value it replaced; pop() undoes the changes on the trail,
+ * newest first. Thus push() costs nothing, and pop() costs as much as
+ * the number of changes made since the push(), no matter how big the
+ * map is. drop() forgets the most recent mark, but keeps the changes
+ * made since; a pop() to an earlier mark will still undo them.
+ *
+ * This behaves exactly as a stack of copies of the map would, as long
+ * as all changes go through set() and erase(). clear() empties the
+ * map, and forgets all marks.
+ */
+template<typename K, typename V>
+class TrailMap
+{
+	public:
+		typedef std::map<K, V> Map;
+		typedef typename Map::const_iterator const_iterator;
+
+	private:
+		struct Undo
+		{
+			K key;
+			V old;
+			bool had;
+		};
+
+		Map _map;
+		std::vector<Undo> _trail;
+		std::vector<size_t> _marks;
+
+	public:
+		// Read-only access, e.g. for passing to callbacks.
+		operator const Map&(void) const { return _map; }
+		const Map& map(void) const { return _map; }
+
+		const_iterator begin(void) const { return _map.begin(); }
+		const_iterator end(void) const { return _map.end(); }
+		const_iterator find(const K& key) const { return _map.find(key); }
+		size_t count(const K& key) const { return _map.count(key); }
+		size_t size(void) const { return _map.size(); }
+		bool empty(void) const { return _map.empty(); }
+
+		/// The value for key, or a default-constructed one. Unlike
+		/// std::map::operator[], this does not insert anything.
+		V get(const K& key) const
+		{
+			auto it = _map.find(key);
+			if (_map.end() == it) return V();
+			return it->second;
+		}
+
+		void set(const K& key, const V& val)
+		{
+			auto it = _map.find(key);
+			if (_map.end() == it)
+			{
+				// Nothing to undo to, if there is no mark.
+				if (not _marks.empty())
+					_trail.push_back({key, V(), false});
+				_map.emplace(key, val);
+				return;
+			}
+			if (not _marks.empty())
+				_trail.push_back({key, it->second, true});
+			it->second = val;
+		}
+
+		void erase(const K& key)
+		{
+			auto it = _map.find(key);
+			if (_map.end() == it) return;
+			if (not _marks.empty())
+				_trail.push_back({key, std::move(it->second), true});
+			_map.erase(it);
+		}
+
+		void clear(void)
+		{
+			_map.clear();
+			forget();
+		}
+
+		void push(void) { _marks.push_back(_trail.size()); }
+
+		void pop(void)
+		{
+			size_t mark = _marks.back();
+			_marks.pop_back();
+			while (mark < _trail.size())
+			{
+				Undo& u = _trail.back();
+				if (u.had)
+					_map[u.key] = std::move(u.old);
+				else
+					_map.erase(u.key);
+				_trail.pop_back();
+			}
+		}
+
+		void drop(void)
+		{
+			_marks.pop_back();
+			if (_marks.empty()) _trail.clear();
+		}
+
+		/// Forget all marks, keeping the map as it is.
+		void forget(void)
+		{
+			_trail.clear();
+			_marks.clear();
+		}
+
+		size_t depth(void) const { return _marks.size(); }
+};
+
+} // namespace opencog
+
+#endif // _OPENCOG_TRAIL_MAP_H
@@ -0,0 +1,71 @@
+;
+; OpenCog local-file Persistance module
+;
+
+(define-module (opencog persist-local))
+
+(load-extension "libpersist-local" "opencog_persist_local_init")
+
+(export local-clear-cache local-close local-compact local-load local-open
+	local-store local-stats)
+
+(set-procedure-property! local-clear-cache 'documentation
+"
+ local-clear-cache - clear the TLB of cached data
+    This will free up RAM, depending on how many atoms are in the
+    cache. Atoms that are looked up again will be found by their
+    contents in the file, instead.
+")
+
+(set-procedure-property! local-close 'documentation
+"
+ local-close - close the currently open file.
+    Any pending writes are written out, and synced to disk, before
+    the file is closed. After the close, atoms can no longer be
+    stored to or fetched from the file.
+")
+
+(set-procedure-property! local-compact 'documentation
+"
+ local-compact - rewrite the open file, without the dead records.
+    The file is a log, that is only ever appended to; atoms and values
+    that are deleted or overwritten still take up room in it, until
+    it is compacted. This is done when the file is opened, if more
+    than half of it is dead; this forces it to be done right away.
+")
+
+(set-procedure-property! local-load 'documentation
+"
+ local-load - load all atoms in the file.
+    This will cause ALL of the atoms in the open file to be loaded
+    into the atomspace. In normal operation, it is rarely necessary
+    to load all atoms; atoms can always be fetched and stored one at
+    a time, on demand.
+")
+
+(set-procedure-property! local-open 'documentation
+"
+ local-open PATH - Open a local file for storing atoms.
+    Open the file at PATH, creating it if it does not yet exist.
+    No database server is needed. Once open, the atoms and values in
+    the file can be fetched and stored with the primitives in the
+    (opencog persist) module, such as fetch-atom and store-atom.
+
+  Example of use:
+     (local-open \"/tmp/atoms.db\")
+")
+
+(set-procedure-property! local-store 'documentation
+"
+ local-store - Store all atoms in the atomspace to the file.
+    This will dump the ENTIRE contents of the atomspace to the file.
+    During normal operation, a bulk-save is rarely required, as
+    individual atoms can always be stored, one at a time.
+")
+
+(set-procedure-property! local-stats 'documentation
+"
+ local-stats - report performance statistics.
+    This will cause some statistics about the open file, and about
+    the use made of it, to be printed to the stdout of the server.
+")
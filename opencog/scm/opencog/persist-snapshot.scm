@@ -0,0 +1,33 @@
+;
+; OpenCog AtomSpace snapshot module
+;
+
+(define-module (opencog persist-snapshot))
+
+(load-extension "libpersist-snapshot" "opencog_persist_snapshot_init")
+
+(export load-snapshot save-snapshot)
+
+(set-procedure-property! load-snapshot 'documentation
+"
+ load-snapshot PATH - Load all atoms in the snapshot file at PATH.
+    All of the atoms in the snapshot, and all of their values, are
+    added to the current atomspace. This is much faster than loading
+    the same atoms from scheme files, or from a database, and so is
+    the quickest way to start up with a large knowledge base.
+
+  Example of use:
+     (load-snapshot \"/tmp/kb.snap\")
+")
+
+(set-procedure-property! save-snapshot 'documentation
+"
+ save-snapshot PATH - Save all atoms in the atomspace to a snapshot.
+    This will write the ENTIRE contents of the current atomspace, and
+    all of the values on the atoms, to the file at PATH. An existing
+    file is replaced, once the new one is completely written. The
+    snapshot can be loaded again with load-snapshot.
+
+  Example of use:
+     (save-snapshot \"/tmp/kb.snap\")
+")
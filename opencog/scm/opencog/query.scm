@@ -26,6 +26,28 @@
 	(cog-satisfying-set-first-n handle 1)
 )
 
+; The procedures made by cog-stream are guarded; once one of them is
+; garbage, its search is closed after the next garbage collection, so
+; that the search thread does not linger.
+(define stream-guardian (make-guardian))
+(define (close-lost-streams)
+	(let ((proc (stream-guardian)))
+		(if proc
+			(begin (proc 'close) (close-lost-streams))))
+)
+(add-hook! after-gc-hook close-lost-streams)
+
+(define-public (cog-stream handle)
+	(define id (cog-stream-open handle))
+	(define proc
+		(lambda* (#:optional (cmd 'next))
+			(if (eq? cmd 'close)
+				(cog-stream-close id)
+				(cog-stream-next id))))
+	(stream-guardian proc)
+	proc
+)
+
 (set-procedure-property! cog-bind 'documentation
 "
  cog-bind handle
@@ -61,3 +83,132 @@
     Run pattern matcher on handle.  handle must be a SatisfactionLink.
     Return a TV. Only satisfaction is performed, no implication.
 ")
+
+(set-procedure-property! cog-bind-parallel 'documentation
+"
+ cog-bind-parallel handle N
+    Same as cog-bind, but the search is split over N threads.
+    Only useful when the pattern has very many starting points,
+    e.g. when its rarest constant has a huge incoming set.
+")
+
+(set-procedure-property! cog-satisfying-set-parallel 'documentation
+"
+ cog-satisfying-set-parallel handle N
+    Same as cog-satisfying-set, but the search is split over N threads.
+")
+
+(set-procedure-property! cog-bind-bounded 'documentation
+"
+ cog-bind-bounded handle SECS STEPS
+    Same as cog-bind, but the search gives up after SECS seconds, or
+    after trying STEPS candidate groundings, whichever comes first.
+    Zero means no limit. Return a pair: the SetLink of the results
+    found, and one of the symbols 'complete, 'timed-out or
+    'out-of-steps. Unless it is 'complete, some results may be missing.
+
+    Example:
+       (define r (cog-bind-bounded (BindLink ...) 0.5 0))
+       (car r)   ; the results
+       (cdr r)   ; 'complete or 'timed-out
+")
+
+(set-procedure-property! cog-satisfying-set-bounded 'documentation
+"
+ cog-satisfying-set-bounded handle SECS STEPS
+    Same as cog-satisfying-set, but the search gives up after SECS
+    seconds or STEPS steps. See cog-bind-bounded.
+")
+
+(set-procedure-property! cog-stream 'documentation
+"
+ cog-stream handle
+    Start a search for the BindLink or GetLink handle, and return a
+    procedure that hands out the results one at a time, as they are
+    found. Calling the procedure returns the next result, or the empty
+    list once there are no more. Calling it with 'close stops the
+    search early. The search does not run ahead of the caller by more
+    than a few results, and no SetLink holding all of them is made.
+    The search is also stopped once the procedure is garbage.
+
+    Example:
+       (define next-pet (cog-stream (GetLink ...)))
+       (next-pet)   ; the first grounding
+       (next-pet)   ; the second grounding
+       (next-pet 'close)
+")
+
+(set-procedure-property! cog-stream-open 'documentation
+"
+ cog-stream-open handle
+    Start a search for the BindLink or GetLink handle, and return a
+    number identifying it. See cog-stream for a friendlier interface.
+    At most 256 streams are kept open; opening one more closes the
+    oldest, which then returns the empty list. Close streams that are
+    no longer needed with cog-stream-close.
+")
+
+(set-procedure-property! cog-stream-next 'documentation
+"
+ cog-stream-next N
+    Return the next result of the search number N, or the empty list
+    once there are no more.
+")
+
+(set-procedure-property! cog-stream-close 'documentation
+"
+ cog-stream-close N
+    Stop the search number N, and forget about it.
+")
+
+(set-procedure-property! cog-standing-query 'documentation
+"
+ cog-standing-query handle
+    Run the BindLink or GetLink handle, and keep its results up to
+    date from then on, as atoms are added to and removed from the
+    atomspace. Only the neighborhood of each change is searched. Return
+    a number identifying the standing query.
+
+    Patterns with optional or absent clauses, ChoiceLinks, globs, lone
+    variable clauses, or several components cannot be maintained this
+    way; these are run again in full when their results are asked for,
+    if anything changed.
+
+    Example:
+       (define pets (cog-standing-query (GetLink ...)))
+       (cog-standing-results pets)
+       (cog-standing-changes pets)
+       (cog-standing-stop pets)
+")
+
+(set-procedure-property! cog-standing-results 'documentation
+"
+ cog-standing-results N
+    Return a list of the current results of the standing query N.
+")
+
+(set-procedure-property! cog-standing-changes 'documentation
+"
+ cog-standing-changes N
+    Return a list of two lists: the results of the standing query N
+    that were added, and those that were removed, since the last call.
+")
+
+(set-procedure-property! cog-standing-stop 'documentation
+"
+ cog-standing-stop N
+    Stop keeping the standing query N up to date, and forget about it.
+")
+
+(set-procedure-property! cog-explain 'documentation
+"
+ cog-explain handle
+    Return a string describing how the query planner would start the
+    search for the BindLink or GetLink handle: the estimated number of
+    groundings of each clause, and the estimated cost of starting at
+    each constant. The chosen start is marked with a star. Nothing is
+    searched, and the atomspace is not changed.
+
+    Example:
+       (display (cog-explain (GetLink ...)))
+")
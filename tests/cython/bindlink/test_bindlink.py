@@ -6,7 +6,7 @@ from opencog.bindlink import stub_bindlink, bindlink, single_bindlink,\
                              first_n_bindlink, af_bindlink, \
                              satisfaction_link, satisfying_set, \
                              satisfying_element, first_n_satisfying_set, \
-                             execute_atom, evaluate_atom
+                             execute_atom, evaluate_atom, ResultStream
 
 from opencog.type_constructors import *
 from opencog.utilities import initialize_opencog, finalize_opencog
@@ -135,6 +135,21 @@ class BindlinkTest(TestCase):
         atom = first_n_satisfying_set(self.atomspace, self.getlink_atom, 5)
         self._check_result_setlink(atom, 3)
 
+    def test_result_stream(self):
+        results = set(ResultStream(self.atomspace, self.bindlink_atom))
+        self.assertEquals(len(results), 3)
+        self.assertTrue(ConceptNode("Zebra") in results)
+
+        # No SetLink is made.
+        self.assertEquals(self.atomspace.size(), self.starting_size)
+
+        stream = ResultStream(self.atomspace, self.getlink_atom)
+        first = next(stream)
+        self.assertEquals(first.type, types.ConceptNode)
+        stream.close()
+        self.assertEquals(stream.count, 1)
+        self.assertEquals(list(stream), [])
+
     def test_satisfy(self):
         satisfaction_atom = SatisfactionLink(
             VariableList(),  # no variables
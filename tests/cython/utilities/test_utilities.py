@@ -1,8 +1,11 @@
+import os
+import tempfile
 from unittest import TestCase
 
 from opencog.type_constructors import *
-from opencog.atomspace import AtomSpace
+from opencog.atomspace import AtomSpace, TruthValue, types
 from opencog.utilities import initialize_opencog, finalize_opencog
+from opencog.utilities import save_snapshot, load_snapshot
 
 __author__ = 'Curtis Faith'
 
@@ -18,3 +21,26 @@ class UtilitiesTest(TestCase):
     def test_initialize_finalize(self):
         initialize_opencog(self.atomspace)
         finalize_opencog()
+
+    def test_snapshot(self):
+        a = self.atomspace.add_node(types.ConceptNode, "a")
+        b = self.atomspace.add_node(types.ConceptNode, "b")
+        self.atomspace.add_link(types.InheritanceLink, [a, b],
+                                TruthValue(0.8, 0.6))
+
+        fd, path = tempfile.mkstemp(suffix=".snap")
+        os.close(fd)
+        try:
+            save_snapshot(self.atomspace, path)
+            other = AtomSpace()
+            self.assertEqual(3, load_snapshot(other, path))
+            self.assertEqual(3, other.size())
+            link = other.add_link(types.InheritanceLink, [
+                other.add_node(types.ConceptNode, "a"),
+                other.add_node(types.ConceptNode, "b")])
+            self.assertAlmostEqual(0.8, link.tv.mean, places=5)
+            self.assertAlmostEqual(0.6, link.tv.confidence, places=5)
+        finally:
+            os.remove(path)
+
+        self.assertRaises(RuntimeError, load_snapshot, self.atomspace, path)